@@ -0,0 +1,1095 @@
+/**
+ * @file benchmarks.c
+ * @brief Benchmarks do Nível Mestre: inclui o programa inteiro (com o main renomeado, como
+ * os testes) e mede as estruturas do jogo em mansões e lotes sintéticos de semente fixa.
+ * O make bench compila com -O2 em bench/bin/benchmarks; cada modo é escolhido pelo
+ * primeiro argumento (ver o main no fim do arquivo).
+ */
+#define main mainDoJogo
+#include "../desafio-nivel-mestre.c"
+#undef main
+
+// Formas de mansão geradas pela suíte de benchmarks
+#define FORMA_EQUILIBRADA 0
+#define FORMA_ENVIESADA 1
+#define FORMA_ORDENADA 2
+// Tamanho de cada texto gerado pela suíte de benchmarks
+#define TAMANHO_TEXTO_BENCH 32
+
+// ==========================================================
+//                      BENCHMARKS
+// ==========================================================
+
+/**
+ * @brief Mede a inserção de 'ids' na AVL de pistas e mostra tempo e altura final.
+ */
+void medirInsercaoPistas(const Dicionario *dicionario, const char *rotulo, const int *ids, long n)
+{
+    Arena arena;
+    iniciarArena(&arena);
+    Pista *raiz = NULL;
+    double inicio = agoraSegundos();
+    for (long i = 0; i < n; i++)
+    {
+        inserirPistaBalanceada(dicionario, &arena, &raiz, ids[i], NULL);
+    }
+    double tempoInsercao = agoraSegundos() - inicio;
+
+    int altura = alturaPista(raiz);
+
+    inicio = agoraSegundos();
+    reiniciarArena(&arena);
+    double tempoLiberacao = agoraSegundos() - inicio;
+    liberarArena(&arena);
+
+    printf("%9.1f ns/inserção | altura %3d | liberação (arena) %7.3f ms | entrada %s\n",
+           tempoInsercao * 1e9 / n, altura, tempoLiberacao * 1e3, rotulo);
+}
+
+/**
+ * @brief Benchmark da AVL de pistas com entrada ordenada e aleatória.
+ * Com a BST comum, a entrada ordenada viraria uma lista de altura n.
+ */
+int executarBenchmarkPistas(long n)
+{
+    if (n <= 0)
+    {
+        fprintf(stderr, "Quantidade de pistas inválida.\n");
+        return EXIT_FAILURE;
+    }
+
+    Dicionario dicionario;
+    iniciarDicionario(&dicionario);
+    int *ids = (int *)malloc(sizeof(int) * n);
+    if (ids == NULL)
+    {
+        perror("Erro ao alocar memória para o benchmark");
+        exit(EXIT_FAILURE);
+    }
+
+    // Nomes com zeros à esquerda: a ordem dos ids é a ordem alfabética
+    char texto[32];
+    for (long i = 0; i < n; i++)
+    {
+        snprintf(texto, sizeof(texto), "Pista %09ld", i);
+        ids[i] = internar(&dicionario, texto);
+    }
+
+    int limite = 0;
+    for (long m = n + 2; m > 1; m >>= 1)
+    {
+        limite++;
+    }
+    printf("Benchmark da AVL de pistas: %ld pistas (limite teórico de altura ~%.0f)\n", n, 1.44 * limite);
+    medirInsercaoPistas(&dicionario, "ordenada", ids, n);
+
+    // Embaralhamento de Fisher-Yates com semente fixa (xorshift)
+    unsigned long long estado = 88172645463325252ULL;
+    for (long i = n - 1; i > 0; i--)
+    {
+        long j = (long)(proximoAleatorio(&estado) % (unsigned long long)(i + 1));
+        int temp = ids[i];
+        ids[i] = ids[j];
+        ids[j] = temp;
+    }
+    medirInsercaoPistas(&dicionario, "aleatória", ids, n);
+
+    free(ids);
+    liberarDicionario(&dicionario);
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Gera uma árvore aleatória de 'n' salas com criarSala (semente fixa): cada sala
+ * nova ocupa uma vaga livre (esquerda ou direita) sorteada entre todas as vagas abertas.
+ * Os nomes se repetem em ciclos curtos para o pool de strings não dominar a memória.
+ */
+Sala *gerarMansaoAleatoria(Dicionario *dicionario, Arena *arena, long n, unsigned long long *estado)
+{
+    Sala ***vagas = (Sala ***)malloc(sizeof(Sala **) * (n + 2));
+    if (vagas == NULL)
+    {
+        perror("Erro ao alocar memória para o benchmark");
+        exit(EXIT_FAILURE);
+    }
+    char nome[32];
+    char pista[32];
+    const char *suspeitos[] = {"Mordomo", "Jardineiro", "Cozinheira", "Governanta"};
+
+    Sala *raiz = criarSala(dicionario, arena, "Hall de Entrada", "", "");
+    long numVagas = 0;
+    vagas[numVagas++] = &raiz->esquerda;
+    vagas[numVagas++] = &raiz->direita;
+    for (long i = 1; i < n; i++)
+    {
+        snprintf(nome, sizeof(nome), "Sala %ld", i % 256);
+        snprintf(pista, sizeof(pista), "Pista %ld", i % 1024);
+        Sala *nova = criarSala(dicionario, arena, nome, i % 3 ? pista : "", i % 3 ? suspeitos[i % 4] : "");
+
+        // Ocupa a vaga sorteada e troca-a pela última (remoção O(1))
+        long j = (long)(proximoAleatorio(estado) % (unsigned long long)numVagas);
+        *vagas[j] = nova;
+        vagas[j] = &nova->esquerda;
+        vagas[numVagas++] = &nova->direita;
+    }
+    free(vagas);
+    return raiz;
+}
+
+/**
+ * @brief Percorre toda a árvore de ponteiros (pré-ordem, pilha explícita).
+ * @return A soma dos ids de pista visitados (evita que o laço seja descartado).
+ */
+long percorrerArvoreSalas(Sala *raiz, Sala **pilha)
+{
+    long soma = 0;
+    long topo = 0;
+    pilha[topo++] = raiz;
+    while (topo > 0)
+    {
+        Sala *atual = pilha[--topo];
+        soma += atual->pista_encontrada;
+        if (atual->direita != NULL)
+        {
+            pilha[topo++] = atual->direita;
+        }
+        if (atual->esquerda != NULL)
+        {
+            pilha[topo++] = atual->esquerda;
+        }
+    }
+    return soma;
+}
+
+/**
+ * @brief Mesmo percurso de percorrerArvoreSalas, seguindo os índices da mansão compilada.
+ */
+long percorrerMansao(const Mansao *mansao, uint32_t *pilha)
+{
+    const SalaCompilada *salas = mansao->salas;
+    long soma = 0;
+    long topo = 0;
+    pilha[topo++] = mansao->raiz;
+    while (topo > 0)
+    {
+        const SalaCompilada *atual = &salas[pilha[--topo]];
+        soma += atual->pista;
+        if (atual->direita != SEM_SALA)
+        {
+            pilha[topo++] = atual->direita;
+        }
+        if (atual->esquerda != SEM_SALA)
+        {
+            pilha[topo++] = atual->esquerda;
+        }
+    }
+    return soma;
+}
+
+/**
+ * @brief Faz 'caminhadas' descidas da raiz até uma folha, sorteando o lado a cada sala
+ * (quando só há um filho, segue por ele). A mesma semente gera os mesmos caminhos
+ * em qualquer layout da mesma árvore.
+ * @return A soma dos ids de pista visitados; '*passos' recebe o total de salas visitadas.
+ */
+long caminharArvoreSalas(Sala *raiz, long caminhadas, unsigned long long semente, long *passos)
+{
+    long soma = 0;
+    long total = 0;
+    for (long c = 0; c < caminhadas; c++)
+    {
+        unsigned long long bits = proximoAleatorio(&semente);
+        int restantes = 64;
+        for (Sala *atual = raiz; atual != NULL; total++)
+        {
+            soma += atual->pista_encontrada;
+            if (restantes-- == 0)
+            {
+                bits = proximoAleatorio(&semente);
+                restantes = 63;
+            }
+            Sala *proxima = (bits & 1) ? atual->direita : atual->esquerda;
+            atual = proxima != NULL ? proxima : ((bits & 1) ? atual->esquerda : atual->direita);
+            bits >>= 1;
+        }
+    }
+    *passos = total;
+    return soma;
+}
+
+/**
+ * @brief Mesmas caminhadas de caminharArvoreSalas, seguindo os índices da mansão compilada.
+ */
+long caminharMansao(const Mansao *mansao, long caminhadas, unsigned long long semente, long *passos)
+{
+    const SalaCompilada *salas = mansao->salas;
+    long soma = 0;
+    long total = 0;
+    for (long c = 0; c < caminhadas; c++)
+    {
+        unsigned long long bits = proximoAleatorio(&semente);
+        int restantes = 64;
+        for (uint32_t atual = mansao->raiz; atual != SEM_SALA; total++)
+        {
+            soma += salas[atual].pista;
+            if (restantes-- == 0)
+            {
+                bits = proximoAleatorio(&semente);
+                restantes = 63;
+            }
+            uint32_t proxima = (bits & 1) ? salas[atual].direita : salas[atual].esquerda;
+            atual = proxima != SEM_SALA ? proxima : ((bits & 1) ? salas[atual].esquerda : salas[atual].direita);
+            bits >>= 1;
+        }
+    }
+    *passos = total;
+    return soma;
+}
+
+/**
+ * @brief Benchmark de layout da mansão: a mesma árvore aleatória de 'n' salas como
+ * árvore de ponteiros (criarSala) e como array plano em largura, profundidade e vEB.
+ * Mede o percurso completo (ns/sala) e descidas aleatórias raiz→folha (ns/passo).
+ */
+int executarBenchmarkMansao(long n)
+{
+    if (n <= 0 || n >= (long)SEM_SALA)
+    {
+        fprintf(stderr, "Quantidade de salas inválida.\n");
+        return EXIT_FAILURE;
+    }
+    const long caminhadas = 1000000;
+    const unsigned long long sementeCaminhadas = 2463534242ULL;
+
+    Dicionario dicionario;
+    iniciarDicionario(&dicionario);
+    Arena arenaSalas;
+    iniciarArena(&arenaSalas);
+    unsigned long long estado = 88172645463325252ULL;
+    double inicio = agoraSegundos();
+    Sala *raiz = gerarMansaoAleatoria(&dicionario, &arenaSalas, n, &estado);
+    double tempoGeracao = agoraSegundos() - inicio;
+
+    // A pilha do percurso nunca passa de n entradas
+    Sala **pilhaSalas = (Sala **)malloc(sizeof(Sala *) * n);
+    uint32_t *pilhaIndices = (uint32_t *)malloc(sizeof(uint32_t) * n);
+    if (pilhaSalas == NULL || pilhaIndices == NULL)
+    {
+        perror("Erro ao alocar memória para o benchmark");
+        exit(EXIT_FAILURE);
+    }
+
+    printf("Benchmark de layout da mansão: %ld salas (geração com criarSala: %.2f s), %ld descidas raiz→folha\n",
+           n, tempoGeracao, caminhadas);
+
+    long passos = 0;
+    inicio = agoraSegundos();
+    long somaPercurso = percorrerArvoreSalas(raiz, pilhaSalas);
+    double tempoPercurso = agoraSegundos() - inicio;
+    inicio = agoraSegundos();
+    long somaCaminhadas = caminharArvoreSalas(raiz, caminhadas, sementeCaminhadas, &passos);
+    double tempoCaminhadas = agoraSegundos() - inicio;
+    printf("%7.2f ns/sala (percurso) | %7.2f ns/passo (%.1f passos/descida) | %2zu bytes/sala | ponteiros (criarSala)\n",
+           tempoPercurso * 1e9 / n, tempoCaminhadas * 1e9 / passos, (double)passos / caminhadas, sizeof(Sala));
+
+    Mansao mansao;
+    compilarMansao(raiz, &dicionario, &mansao);
+    liberarArvoreSalas(&arenaSalas);
+    free(pilhaSalas);
+
+    const int ordens[] = {ORDEM_LARGURA, ORDEM_PROFUNDIDADE, ORDEM_VEB};
+    const char *rotulos[] = {"plano em largura", "plano em profundidade", "plano vEB"};
+    for (int o = 0; o < 3; o++)
+    {
+        inicio = agoraSegundos();
+        reordenarMansao(&mansao, ordens[o]);
+        double tempoOrdem = agoraSegundos() - inicio;
+
+        inicio = agoraSegundos();
+        long soma = percorrerMansao(&mansao, pilhaIndices);
+        tempoPercurso = agoraSegundos() - inicio;
+        long passosMansao = 0;
+        inicio = agoraSegundos();
+        long somaMansao = caminharMansao(&mansao, caminhadas, sementeCaminhadas, &passosMansao);
+        tempoCaminhadas = agoraSegundos() - inicio;
+        if (soma != somaPercurso || somaMansao != somaCaminhadas || passosMansao != passos)
+        {
+            fprintf(stderr, "Layout '%s' divergiu da árvore de ponteiros.\n", rotulos[o]);
+            return EXIT_FAILURE;
+        }
+        printf("%7.2f ns/sala (percurso) | %7.2f ns/passo (%.1f passos/descida) | %2zu bytes/sala | %s (reordenação %.2f s)\n",
+               tempoPercurso * 1e9 / n, tempoCaminhadas * 1e9 / passos, (double)passos / caminhadas,
+               sizeof(SalaCompilada), rotulos[o], tempoOrdem);
+    }
+
+    free(pilhaIndices);
+    liberarMansao(&mansao);
+    liberarDicionario(&dicionario);
+    return EXIT_SUCCESS;
+}
+
+// --- Suíte de benchmarks (gerador sintético) ---
+
+/**
+ * @brief Converte o nome de uma forma ("equilibrada", "enviesada", "ordenada") na constante.
+ * @return A constante FORMA_*, ou -1 se o nome for desconhecido.
+ */
+int formaPorNome(const char *nome)
+{
+    if (strcmp(nome, "equilibrada") == 0)
+    {
+        return FORMA_EQUILIBRADA;
+    }
+    if (strcmp(nome, "enviesada") == 0)
+    {
+        return FORMA_ENVIESADA;
+    }
+    if (strcmp(nome, "ordenada") == 0)
+    {
+        return FORMA_ORDENADA;
+    }
+    return -1;
+}
+
+/**
+ * @brief Bytes ocupados pelo pool de strings (textos, offsets, hashes e índice).
+ */
+size_t bytesDoPool(const PoolStrings *pool)
+{
+    return pool->capacidadeDados + (size_t)pool->capacidadeIds * 2 * sizeof(unsigned int) +
+           (size_t)pool->capacidade * sizeof(int);
+}
+
+/**
+ * @brief Bytes ocupados pela Tabela Hash (índice + associações densas).
+ */
+size_t bytesDaHash(const TabelaHash *tabela)
+{
+    return (size_t)tabela->capacidade * sizeof(SlotHash) + (size_t)tabela->capacidadeEntradas * sizeof(Associacao);
+}
+
+/**
+ * @brief Imprime uma linha da suíte: tempo por operação, memória (se houver) e o nome.
+ */
+void relatarMedicao(const char *operacao, double segundos, long operacoes, size_t bytes)
+{
+    if (bytes > 0)
+    {
+        printf("%10.1f ns/op | %9.2f MiB | %s\n", segundos * 1e9 / operacoes, bytes / (1024.0 * 1024.0), operacao);
+    }
+    else
+    {
+        printf("%10.1f ns/op | %13s | %s\n", segundos * 1e9 / operacoes, "-", operacao);
+    }
+}
+
+/**
+ * @brief Gera os textos de uma mansão sintética (fora da medição): a sala i recebe
+ * "Sala i", a pista "Pista k" e um suspeito sorteado entre 'numSuspeitos'.
+ * Na forma ordenada k = i, então as pistas chegam à AVL em ordem alfabética;
+ * nas outras, k é uma permutação aleatória (Fisher-Yates).
+ */
+char *gerarTextosBench(int forma, long n, int numSuspeitos, unsigned long long *estado)
+{
+    char *textos = (char *)malloc((size_t)n * 3 * TAMANHO_TEXTO_BENCH);
+    long *permutacao = (long *)malloc(sizeof(long) * n);
+    if (textos == NULL || permutacao == NULL)
+    {
+        perror("Erro ao alocar memória para o benchmark");
+        exit(EXIT_FAILURE);
+    }
+    for (long i = 0; i < n; i++)
+    {
+        permutacao[i] = i;
+    }
+    if (forma != FORMA_ORDENADA)
+    {
+        for (long i = n - 1; i > 0; i--)
+        {
+            long j = (long)(proximoAleatorio(estado) % (unsigned long long)(i + 1));
+            long temp = permutacao[i];
+            permutacao[i] = permutacao[j];
+            permutacao[j] = temp;
+        }
+    }
+
+    for (long i = 0; i < n; i++)
+    {
+        char *texto = textos + (size_t)i * 3 * TAMANHO_TEXTO_BENCH;
+        // Zeros à esquerda: a ordem numérica é a ordem alfabética
+        snprintf(texto, TAMANHO_TEXTO_BENCH, "Sala %ld", i);
+        snprintf(texto + TAMANHO_TEXTO_BENCH, TAMANHO_TEXTO_BENCH, "Pista %09ld", permutacao[i]);
+        snprintf(texto + 2 * TAMANHO_TEXTO_BENCH, TAMANHO_TEXTO_BENCH, "Suspeito %llu",
+                 proximoAleatorio(estado) % (unsigned long long)numSuspeitos);
+    }
+    free(permutacao);
+    return textos;
+}
+
+/**
+ * @brief Monta a mansão sintética com criarSala a partir dos textos gerados.
+ * Equilibrada/ordenada: árvore completa (a sala i é filha de (i-1)/2).
+ * Enviesada: um corredor para a direita, com becos sem saída à esquerda em ~1/4 das salas.
+ * @param salas Recebe o ponteiro de cada sala criada, na ordem de criação.
+ */
+Sala *montarMansaoBench(Dicionario *dicionario, Arena *arena, int forma, long n, const char *textos, Sala **salas, unsigned long long *estado)
+{
+    Sala *corredor = NULL;
+    for (long i = 0; i < n; i++)
+    {
+        const char *texto = textos + (size_t)i * 3 * TAMANHO_TEXTO_BENCH;
+        Sala *nova = criarSala(dicionario, arena, texto, texto + TAMANHO_TEXTO_BENCH, texto + 2 * TAMANHO_TEXTO_BENCH);
+        salas[i] = nova;
+        if (i == 0)
+        {
+            corredor = nova;
+        }
+        else if (forma != FORMA_ENVIESADA)
+        {
+            Sala *pai = salas[(i - 1) / 2];
+            if (i % 2 == 1)
+            {
+                pai->esquerda = nova;
+            }
+            else
+            {
+                pai->direita = nova;
+            }
+        }
+        else if (corredor->esquerda == NULL && proximoAleatorio(estado) % 4 == 0)
+        {
+            corredor->esquerda = nova;
+        }
+        else
+        {
+            corredor->direita = nova;
+            corredor = nova;
+        }
+    }
+    return salas[0];
+}
+
+/**
+ * @brief Executa a suíte para uma forma: monta a mansão, coleta todas as pistas
+ * (AVL + Tabela Hash), analisa, lista em ordem e desmonta, medindo cada etapa.
+ * O renderizador das saídas de analisarEvidencias e listarPistasEmOrdem aponta para /dev/null.
+ */
+void executarSuiteForma(int forma, const char *nomeForma, long n, int numSuspeitos, unsigned long long semente)
+{
+    unsigned long long estado = semente;
+    char *textos = gerarTextosBench(forma, n, numSuspeitos, &estado);
+    Sala **salas = (Sala **)malloc(sizeof(Sala *) * n);
+    int *pistas = (int *)malloc(sizeof(int) * n);
+    int *suspeitos = (int *)malloc(sizeof(int) * n);
+    FILE *saidaNula = fopen("/dev/null", "w");
+    if (salas == NULL || pistas == NULL || suspeitos == NULL || saidaNula == NULL)
+    {
+        perror("Erro ao preparar o benchmark");
+        exit(EXIT_FAILURE);
+    }
+
+    printf("\n--- Forma %s: %ld salas, %d suspeitos, semente %llu ---\n", nomeForma, n, numSuspeitos, semente);
+    Dicionario dicionario;
+    iniciarDicionario(&dicionario);
+    Arena arenaSalas;
+    iniciarArena(&arenaSalas);
+    TabelaHash evidencias;
+    Placar placar;
+    inicializarHash(&evidencias, &dicionario);
+    iniciarPlacar(&placar, &dicionario);
+
+    // 1. Montagem da árvore de salas (inclui o interning dos três textos de cada sala)
+    double inicio = agoraSegundos();
+    montarMansaoBench(&dicionario, &arenaSalas, forma, n, textos, salas, &estado);
+    relatarMedicao("criarSala (montagem da árvore)", agoraSegundos() - inicio, n, bytesDaArena(&arenaSalas) + bytesDoPool(&dicionario.pool));
+
+    // A coleta segue a ordem de criação das salas
+    for (long i = 0; i < n; i++)
+    {
+        pistas[i] = salas[i]->pista_encontrada;
+        suspeitos[i] = salas[i]->suspeito_associado;
+    }
+
+    // 2. funcaoHash sobre o texto de cada pista
+    unsigned int acumulado = 0;
+    inicio = agoraSegundos();
+    for (long i = 0; i < n; i++)
+    {
+        acumulado ^= funcaoHash(textoDe(&dicionario, pistas[i]));
+    }
+    relatarMedicao("funcaoHash", agoraSegundos() - inicio, n, 0);
+
+    // 3. Inserção na AVL de pistas (o núcleo de inserirPista, sem a mensagem)
+    Arena arenaPistas;
+    iniciarArena(&arenaPistas);
+    Pista *raiz = NULL;
+    inicio = agoraSegundos();
+    for (long i = 0; i < n; i++)
+    {
+        inserirPistaBalanceada(&dicionario, &arenaPistas, &raiz, pistas[i], NULL);
+    }
+    relatarMedicao("inserirPista (AVL)", agoraSegundos() - inicio, n, bytesDaArena(&arenaPistas));
+    int alturaAvl = alturaPista(raiz);
+
+    // 4. Associações na Tabela Hash (e citações no Registro de Suspeitos)
+    inicio = agoraSegundos();
+    for (long i = 0; i < n; i++)
+    {
+        inserirNaHash(&evidencias, &placar, pistas[i], suspeitos[i]);
+    }
+    relatarMedicao("inserirNaHash", agoraSegundos() - inicio, n, bytesDaHash(&evidencias));
+
+    // 5. Análise completa (uma linha por evidência), com o renderizador em /dev/null
+    Renderizador saida;
+    iniciarSaida(&saida, fileno(saidaNula), VERBOSIDADE_COMPLETA, TAMANHO_BUFFER_SAIDA);
+    inicio = agoraSegundos();
+    analisarEvidencias(&saida, &evidencias, &placar);
+    descarregarSaida(&saida);
+    relatarMedicao("analisarEvidencias (por evidência)", agoraSegundos() - inicio, n, 0);
+
+    // 6. Diário em ordem alfabética
+    inicio = agoraSegundos();
+    listarPistasEmOrdem(&saida, &dicionario, raiz);
+    descarregarSaida(&saida);
+    relatarMedicao("listarPistasEmOrdem (por pista)", agoraSegundos() - inicio, n, 0);
+
+    // 7. Reinício da sessão (O(1) na arena e na hash) e desmontagem completa
+    inicio = agoraSegundos();
+    reiniciarArena(&arenaPistas);
+    reiniciarHash(&evidencias);
+    zerarCitacoes(&placar);
+    relatarMedicao("reinício de sessão (por pista)", agoraSegundos() - inicio, n, 0);
+
+    size_t bytesTotais = bytesDaArena(&arenaSalas) + bytesDoPool(&dicionario.pool) + bytesDaArena(&arenaPistas) + bytesDaHash(&evidencias);
+    inicio = agoraSegundos();
+    liberarArena(&arenaPistas);
+    liberarArvoreSalas(&arenaSalas);
+    liberarHash(&evidencias);
+    liberarPlacar(&placar);
+    liberarDicionario(&dicionario);
+    relatarMedicao("desmontagem completa (por sala)", agoraSegundos() - inicio, n, bytesTotais);
+    printf("(altura da AVL: %d, controle: %08x)\n", alturaAvl, acumulado);
+
+    liberarSaida(&saida);
+    fclose(saidaNula);
+    free(suspeitos);
+    free(pistas);
+    free(salas);
+    free(textos);
+}
+
+/**
+ * @brief Suíte de benchmarks com mansões sintéticas (semente fixa, reprodutível).
+ * @param nomeForma "equilibrada", "enviesada", "ordenada" ou "todas".
+ */
+int executarSuiteBenchmarks(long n, int numSuspeitos, const char *nomeForma, unsigned long long semente)
+{
+    const char *formas[] = {"equilibrada", "enviesada", "ordenada"};
+    int todas = strcmp(nomeForma, "todas") == 0;
+    if (n <= 0 || numSuspeitos <= 0 || semente == 0 || (!todas && formaPorNome(nomeForma) < 0))
+    {
+        fprintf(stderr, "Uso: --bench [salas > 0] [suspeitos > 0] [equilibrada|enviesada|ordenada|todas] [semente != 0]\n");
+        return EXIT_FAILURE;
+    }
+
+    printf("Suíte de benchmarks do Nível Mestre (memória = bytes reservados pela estrutura)\n");
+    for (int f = 0; f < 3; f++)
+    {
+        if (todas || strcmp(nomeForma, formas[f]) == 0)
+        {
+            executarSuiteForma(formaPorNome(formas[f]), formas[f], n, numSuspeitos, semente);
+        }
+    }
+
+    struct rusage uso;
+    getrusage(RUSAGE_SELF, &uso);
+    printf("\nPico de memória do processo: %.1f MiB\n", uso.ru_maxrss / 1024.0);
+    return EXIT_SUCCESS;
+}
+
+// --- Análise das funções de hash (ocupação e colisões) ---
+
+int compararHashes(const void *a, const void *b)
+{
+    unsigned int x = *(const unsigned int *)a;
+    unsigned int y = *(const unsigned int *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Mede uma função de hash sobre os textos do dicionário (ids 1 em diante) numa tabela de
+ * 'capacidade' slots: tempo por hash, baldes ocupados, chaves por balde, sondagens do
+ * endereçamento aberto (como no jogo) e hashes de 32 bits repetidos entre textos diferentes.
+ * @param distribuicao Recebe quantos baldes têm 0, 1, ..., 7 ou mais chaves.
+ */
+void analisarFuncaoHash(const Dicionario *dicionario, const char *nome, unsigned int (*funcao)(const char *),
+                        int ativa, int capacidade, long distribuicao[8])
+{
+    int n = dicionario->pool.quantidade - 1;
+    unsigned int mascara = (unsigned int)capacidade - 1;
+    unsigned int *hashes = (unsigned int *)malloc(sizeof(unsigned int) * n);
+    int *chavesPorBalde = (int *)calloc(capacidade, sizeof(int));
+    int *slots = alocarIndice(capacidade);
+    if (hashes == NULL || chavesPorBalde == NULL)
+    {
+        perror("Erro ao alocar memória para a análise de hash");
+        exit(EXIT_FAILURE);
+    }
+
+    // Tempo: passadas repetidas até somar uns 2 milhões de hashes
+    long passadas = 2000000 / n + 1;
+    unsigned int acumulado = 0;
+    double inicio = agoraSegundos();
+    for (long p = 0; p < passadas; p++)
+    {
+        for (int id = 1; id <= n; id++)
+        {
+            acumulado += funcao(textoDe(dicionario, id));
+        }
+    }
+    double nsPorHash = (agoraSegundos() - inicio) * 1e9 / ((double)passadas * n);
+
+    // Ocupação dos baldes de origem e sondagem linear, na ordem em que os textos chegaram
+    int usados = 0;
+    int maiorBalde = 0;
+    long somaSondagens = 0;
+    int maiorSondagem = 0;
+    for (int id = 1; id <= n; id++)
+    {
+        unsigned int hash = funcao(textoDe(dicionario, id));
+        hashes[id - 1] = hash;
+        int *balde = &chavesPorBalde[hash & mascara];
+        usados += *balde == 0;
+        if (++*balde > maiorBalde)
+        {
+            maiorBalde = *balde;
+        }
+        int sondagens = 1;
+        unsigned int i = hash & mascara;
+        while (slots[i] != SLOT_VAZIO)
+        {
+            i = (i + 1) & mascara;
+            sondagens++;
+        }
+        slots[i] = id;
+        somaSondagens += sondagens;
+        if (sondagens > maiorSondagem)
+        {
+            maiorSondagem = sondagens;
+        }
+    }
+    for (int b = 0; b < 8; b++)
+    {
+        distribuicao[b] = 0;
+    }
+    for (int b = 0; b < capacidade; b++)
+    {
+        distribuicao[chavesPorBalde[b] < 7 ? chavesPorBalde[b] : 7]++;
+    }
+
+    // Hashes completos iguais (textos diferentes, pois o pool não repete textos)
+    qsort(hashes, n, sizeof(unsigned int), compararHashes);
+    int repetidos = 0;
+    for (int i = 1; i < n; i++)
+    {
+        repetidos += hashes[i] == hashes[i - 1];
+    }
+
+    // Baldes ocupados esperados com hashes uniformes: capacidade * (1 - (1 - 1/capacidade)^n)
+    double vazio = 1.0;
+    double fator = 1.0 - 1.0 / capacidade;
+    for (long e = n; e > 0; e >>= 1)
+    {
+        if (e & 1)
+        {
+            vazio *= fator;
+        }
+        fator *= fator;
+    }
+    printf("%-9s%-8s %8.1f %8d (%8.0f) %8d %8.2f / %-6d %7d   %08x\n", nome, ativa ? " (ativa)" : "", nsPorHash,
+           usados, capacidade * (1.0 - vazio), maiorBalde, (double)somaSondagens / n, maiorSondagem, repetidos, acumulado);
+
+    free(hashes);
+    free(chavesPorBalde);
+    free(slots);
+}
+
+/**
+ * @brief Ferramenta de escolha da função de hash: lê um corpus (um texto por linha, do arquivo
+ * ou da entrada padrão), descarta repetidos e compara as funções disponíveis numa tabela com a
+ * capacidade que o jogo usaria para esses textos (carga até 3/4).
+ */
+int executarAnaliseHash(const char *caminho)
+{
+    FILE *arquivo = caminho != NULL ? fopen(caminho, "r") : stdin;
+    if (arquivo == NULL)
+    {
+        perror("Erro ao abrir o corpus de pistas");
+        return EXIT_FAILURE;
+    }
+
+    // O pool descarta os textos repetidos; as linhas vazias não contam
+    Dicionario dicionario;
+    iniciarDicionario(&dicionario);
+    char linha[1024];
+    long numeroLinha = 0;
+    int valido = 1;
+    while (valido && fgets(linha, sizeof(linha), arquivo) != NULL)
+    {
+        numeroLinha++;
+        if (strchr(linha, '\n') == NULL && !feof(arquivo))
+        {
+            fprintf(stderr, "%s:%ld: linha longa demais.\n", caminho != NULL ? caminho : "stdin", numeroLinha);
+            valido = 0;
+            break;
+        }
+        char *texto = aparar(linha);
+        if (texto[0] != '\0')
+        {
+            internar(&dicionario, texto);
+        }
+    }
+    if (caminho != NULL)
+    {
+        fclose(arquivo);
+    }
+    int n = dicionario.pool.quantidade - 1;
+    if (!valido || n == 0)
+    {
+        if (valido)
+        {
+            fprintf(stderr, "Corpus vazio: nenhuma pista para analisar.\n");
+        }
+        liberarDicionario(&dicionario);
+        return EXIT_FAILURE;
+    }
+
+    int capacidade = TAMANHO_HASH;
+    while ((long)n * CARGA_MAXIMA_DEN > (long)capacidade * CARGA_MAXIMA_NUM)
+    {
+        capacidade *= 2;
+    }
+
+    const char *nomes[] = {"fnv1a", "mistura64", "palavras"};
+    unsigned int (*funcoes[])(const char *) = {hashFnv1a, hashMistura64, hashPalavras};
+    int ids[] = {HASH_FNV1A, HASH_MISTURA64, HASH_PALAVRAS};
+    long distribuicoes[3][8];
+
+    printf("Análise das funções de hash: %d texto(s) distinto(s), tabela de %d slots (carga %.2f)\n\n",
+           n, capacidade, (double)n / capacidade);
+    printf("%-17s %8s %19s %8s %17s %7s   %s\n", "função", "ns/hash", "baldes usados (esp.)", "maior", "sondagens méd/máx",
+           "iguais", "controle");
+    for (int f = 0; f < 3; f++)
+    {
+        analisarFuncaoHash(&dicionario, nomes[f], funcoes[f], ids[f] == FUNCAO_HASH, capacidade, distribuicoes[f]);
+    }
+
+    printf("\nBaldes com 0, 1, 2, ..., 7+ chaves:\n");
+    for (int f = 0; f < 3; f++)
+    {
+        printf("%-9s", nomes[f]);
+        for (int b = 0; b < 8; b++)
+        {
+            printf(" %8ld", distribuicoes[f][b]);
+        }
+        printf("\n");
+    }
+    printf("\n'iguais' conta hashes de 32 bits repetidos (esperado com hashes uniformes: %.2f).\n"
+           "Para trocar a função do jogo, compile com -DFUNCAO_HASH=HASH_FNV1A|HASH_MISTURA64|HASH_PALAVRAS.\n",
+           (double)n * (n - 1) / 2.0 / 4294967296.0);
+
+    liberarDicionario(&dicionario);
+    return EXIT_SUCCESS;
+}
+
+// --- Benchmark do motor de dedução ---
+
+/**
+ * @brief Mede o motor de dedução com 'numSuspeitos' suspeitos e 'numPistas' pistas sintéticas:
+ * pista esparsa (um suspeito), pista do jogo (um suspeito no rascunho, aplicada pelo kernel
+ * denso), pista densa (verossimilhança para todos), e pista densa seguida do top 5, que é o
+ * que o jogo refaria a cada coleta. A referência é o laço escalar ingênuo
+ * (multiplica, soma e divide tudo a cada pista), que precisa chegar ao mesmo líder.
+ */
+int executarBenchmarkDeducao(int numSuspeitos, long numPistas)
+{
+    if (numSuspeitos <= 0 || numPistas <= 0)
+    {
+        fprintf(stderr, "Uso: --bench-deducao [suspeitos > 0] [pistas > 0]\n");
+        return EXIT_FAILURE;
+    }
+
+    MotorDeducao motor;
+    iniciarMotorDeducao(&motor);
+    garantirSuspeitoNoMotor(&motor, numSuspeitos - 1);
+
+    // 64 vetores de verossimilhança em [0.5, 2), usados em rodízio (quem fica para trás vai a zero)
+    const int numVetores = 64;
+    float *vetores = (float *)malloc(sizeof(float) * motor.capacidade * numVetores);
+    double *referencia = (double *)malloc(sizeof(double) * numSuspeitos);
+    int *suspeitos = (int *)malloc(sizeof(int) * numPistas);
+    if (vetores == NULL || referencia == NULL || suspeitos == NULL)
+    {
+        perror("Erro ao alocar memória para o benchmark");
+        exit(EXIT_FAILURE);
+    }
+    unsigned long long estado = 88172645463325252ULL;
+    for (long i = 0; i < (long)motor.capacidade * numVetores; i++)
+    {
+        vetores[i] = 0.5f + (float)(proximoAleatorio(&estado) % 1536) / 1024.0f;
+    }
+    for (long i = 0; i < numPistas; i++)
+    {
+        suspeitos[i] = (int)(proximoAleatorio(&estado) % (unsigned long long)numSuspeitos);
+    }
+    printf("Benchmark do motor de dedução: %d suspeitos, %ld pistas (%d floats por vetor)\n",
+           numSuspeitos, numPistas, motor.capacidade);
+
+    // 1. Pistas esparsas: um suspeito implicado por pista
+    float peso = 1.0f;
+    double inicio = agoraSegundos();
+    for (long i = 0; i < numPistas; i++)
+    {
+        aplicarPistaEsparsa(&motor, &suspeitos[i], &peso, 1);
+    }
+    relatarMedicao("pista esparsa (1 suspeito)", agoraSegundos() - inicio, numPistas, 0);
+
+    // 1b. Pistas do jogo: o mesmo suspeito marcado no rascunho e aplicado pelo kernel denso
+    reiniciarMotorDeducao(&motor);
+    inicio = agoraSegundos();
+    for (long i = 0; i < numPistas; i++)
+    {
+        implicarNaPista(&motor, suspeitos[i], peso);
+        aplicarPistaImplicada(&motor);
+    }
+    relatarMedicao("pista do jogo (rascunho + kernel denso)", agoraSegundos() - inicio, numPistas,
+                   sizeof(float) * motor.capacidade);
+
+    // 2. Pistas densas: kernel vetorizado sobre todos os suspeitos
+    reiniciarMotorDeducao(&motor);
+    inicio = agoraSegundos();
+    for (long i = 0; i < numPistas; i++)
+    {
+        aplicarVerossimilhancas(&motor, &vetores[(i % numVetores) * motor.capacidade]);
+    }
+    double tempoDenso = agoraSegundos() - inicio;
+    relatarMedicao("pista densa (todos os suspeitos)", tempoDenso, numPistas, sizeof(float) * motor.capacidade);
+
+    // 3. Pista densa + top 5 a cada coleta
+    ProbabilidadeSuspeito ranking[SUSPEITOS_NA_PROBABILIDADE];
+    reiniciarMotorDeducao(&motor);
+    inicio = agoraSegundos();
+    for (long i = 0; i < numPistas; i++)
+    {
+        aplicarVerossimilhancas(&motor, &vetores[(i % numVetores) * motor.capacidade]);
+        melhoresPosteriores(&motor, SUSPEITOS_NA_PROBABILIDADE, ranking);
+    }
+    relatarMedicao("pista densa + top 5", agoraSegundos() - inicio, numPistas, 0);
+
+    // 4. Referência escalar em double, normalizando a cada pista
+    for (int s = 0; s < numSuspeitos; s++)
+    {
+        referencia[s] = 1.0 / numSuspeitos;
+    }
+    inicio = agoraSegundos();
+    for (long i = 0; i < numPistas; i++)
+    {
+        const float *vetor = &vetores[(i % numVetores) * motor.capacidade];
+        double soma = 0.0;
+        for (int s = 0; s < numSuspeitos; s++)
+        {
+            referencia[s] *= vetor[s];
+            soma += referencia[s];
+        }
+        for (int s = 0; s < numSuspeitos; s++)
+        {
+            referencia[s] /= soma;
+            referencia[s] = referencia[s] < PESO_MINIMO_DEDUCAO ? 0.0 : referencia[s];
+        }
+    }
+    double tempoReferencia = agoraSegundos() - inicio;
+    relatarMedicao("referência escalar (double, normaliza sempre)", tempoReferencia, numPistas, 0);
+
+    int lider = 0;
+    for (int s = 1; s < numSuspeitos; s++)
+    {
+        lider = referencia[s] > referencia[lider] ? s : lider;
+    }
+    printf("(kernel %.1fx mais rápido; líder: suspeito %d com %.4f, referência: suspeito %d com %.4f)\n",
+           tempoReferencia / tempoDenso, ranking[0].suspeito, ranking[0].probabilidade, lider, referencia[lider]);
+
+    int confere = ranking[0].suspeito == lider;
+    free(vetores);
+    free(referencia);
+    free(suspeitos);
+    liberarMotorDeducao(&motor);
+    return confere ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// --- Benchmark da carga em lote ---
+
+/**
+ * @brief Mede a carga de 'n' coletas sintéticas (1/8 repetindo uma pista anterior, em ordem
+ * aleatória): coletarPistaDe sala a sala, carregarColetasEmLote e restaurarSessao de um
+ * snapshot. As três sessões precisam sair iguais.
+ */
+int executarBenchmarkCarga(long n)
+{
+    if (n <= 0 || n > (1L << 28)) // Os contadores da Tabela Hash são int
+    {
+        fprintf(stderr, "Quantidade de pistas inválida.\n");
+        return EXIT_FAILURE;
+    }
+    const int numSuspeitos = 16;
+
+    Dicionario dicionario;
+    iniciarDicionario(&dicionario);
+    Mansao mansao;
+    alocarMansao(&mansao, &dicionario, (uint32_t)n);
+    uint32_t *salas = (uint32_t *)malloc(sizeof(uint32_t) * n);
+    int *suspeitos = (int *)malloc(sizeof(int) * numSuspeitos);
+    if (salas == NULL || suspeitos == NULL)
+    {
+        perror("Erro ao alocar memória para o benchmark");
+        exit(EXIT_FAILURE);
+    }
+    char texto[32];
+    for (int s = 0; s < numSuspeitos; s++)
+    {
+        snprintf(texto, sizeof(texto), "Suspeito %d", s);
+        suspeitos[s] = internar(&dicionario, texto);
+    }
+
+    // Árvore completa; a pista da sala i é uma permutação aleatória, com 1/8 de repetidas
+    unsigned long long estado = 88172645463325252ULL;
+    for (long i = 0; i < n; i++)
+    {
+        salas[i] = (uint32_t)i;
+    }
+    for (long i = n - 1; i > 0; i--)
+    {
+        long j = (long)(proximoAleatorio(&estado) % (unsigned long long)(i + 1));
+        uint32_t temp = salas[i];
+        salas[i] = salas[j];
+        salas[j] = temp;
+    }
+    for (long i = 0; i < n; i++)
+    {
+        SalaCompilada *sala = &mansao.salasProprias[i];
+        sala->nome = STRING_VAZIA;
+        if (i > 0 && proximoAleatorio(&estado) % 8 == 0)
+        {
+            sala->pista = mansao.salas[proximoAleatorio(&estado) % (unsigned long long)i].pista;
+        }
+        else
+        {
+            snprintf(texto, sizeof(texto), "Pista %09u", salas[i]);
+            sala->pista = (uint32_t)internar(&dicionario, texto);
+        }
+        sala->suspeito = (uint32_t)suspeitos[proximoAleatorio(&estado) % (unsigned long long)numSuspeitos];
+        sala->esquerda = 2 * i + 1 < n ? (uint32_t)(2 * i + 1) : SEM_SALA;
+        sala->direita = 2 * i + 2 < n ? (uint32_t)(2 * i + 2) : SEM_SALA;
+    }
+    registrarSuspeitosDoMapa(&mansao);
+
+    // Ordem de coleta: outra permutação das salas
+    for (long i = n - 1; i > 0; i--)
+    {
+        long j = (long)(proximoAleatorio(&estado) % (unsigned long long)(i + 1));
+        uint32_t temp = salas[i];
+        salas[i] = salas[j];
+        salas[j] = temp;
+    }
+    printf("Benchmark da carga de pistas: %ld coletas, %d suspeitos\n", n, numSuspeitos);
+
+    // 1. Uma coleta por vez: descida na AVL com strcmp e busca na Tabela Hash
+    Sessao sequencial;
+    iniciarSessao(&sequencial, &mansao);
+    double inicio = agoraSegundos();
+    for (long i = 0; i < n; i++)
+    {
+        coletarPistaDe(&sequencial, salas[i]);
+    }
+    double tempoSequencial = agoraSegundos() - inicio;
+    relatarMedicao("coletarPistaDe (uma por vez)", tempoSequencial, n, bytesDaArena(&sequencial.arenaPistas) + bytesDaHash(&sequencial.evidencias));
+
+    // 2. Carga em lote: ordenação única, AVL em O(n) e hash no tamanho final
+    Sessao lote;
+    iniciarSessao(&lote, &mansao);
+    inicio = agoraSegundos();
+    carregarColetasEmLote(&lote, salas, (uint32_t)n);
+    double tempoLote = agoraSegundos() - inicio;
+    relatarMedicao("carregarColetasEmLote", tempoLote, n, bytesDaArena(&lote.arenaPistas) + bytesDaHash(&lote.evidencias));
+
+    // 3. Restauração de um snapshot (usa a carga em lote)
+    size_t tamanho = tamanhoSnapshot(&sequencial);
+    unsigned char *dados = (unsigned char *)malloc(tamanho);
+    if (dados == NULL)
+    {
+        perror("Erro ao alocar memória para o benchmark");
+        exit(EXIT_FAILURE);
+    }
+    serializarSessao(&sequencial, dados, tamanho);
+    Sessao restaurada;
+    iniciarSessao(&restaurada, &mansao);
+    inicio = agoraSegundos();
+    int restaurou = restaurarSessao(&restaurada, dados, tamanho);
+    relatarMedicao("restaurarSessao (snapshot)", agoraSegundos() - inicio, n, 0);
+
+    int confere = restaurou && sessoesEquivalentes(&sequencial, &lote) && sessoesEquivalentes(&sequencial, &restaurada);
+    printf("(%d pistas distintas; altura da AVL: %d uma por vez, %d em lote; lote %.1fx mais rápido; %s)\n",
+           lote.evidencias.quantidade, alturaPista(sequencial.pistasRaiz), alturaPista(lote.pistasRaiz),
+           tempoSequencial / tempoLote, confere ? "sessões iguais" : "SESSÕES DIFERENTES");
+
+    free(dados);
+    liberarSessao(&restaurada);
+    liberarSessao(&lote);
+    liberarSessao(&sequencial);
+    liberarMansao(&mansao);
+    free(suspeitos);
+    free(salas);
+    liberarDicionario(&dicionario);
+    return confere ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// ==========================================================
+//                      MAIN
+// ==========================================================
+
+int main(int argc, char *argv[])
+{
+    // Modo de benchmark: bench/bin/benchmarks --bench-pistas [quantidade]
+    if (argc > 1 && strcmp(argv[1], "--bench-pistas") == 0)
+    {
+        return executarBenchmarkPistas(argc > 2 ? atol(argv[2]) : 1000000);
+    }
+    // Suíte de benchmarks: bench/bin/benchmarks --bench [salas] [suspeitos] [forma] [semente]
+    if (argc > 1 && strcmp(argv[1], "--bench") == 0)
+    {
+        return executarSuiteBenchmarks(argc > 2 ? atol(argv[2]) : 1000000, argc > 3 ? atoi(argv[3]) : 16,
+                                       argc > 4 ? argv[4] : "todas", argc > 5 ? strtoull(argv[5], NULL, 10) : 88172645463325252ULL);
+    }
+    // Benchmark do motor de dedução: bench/bin/benchmarks --bench-deducao [suspeitos] [pistas]
+    if (argc > 1 && strcmp(argv[1], "--bench-deducao") == 0)
+    {
+        return executarBenchmarkDeducao(argc > 2 ? atoi(argv[2]) : 4096, argc > 3 ? atol(argv[3]) : 100000);
+    }
+    // Benchmark da carga em lote: bench/bin/benchmarks --bench-carga [coletas]
+    if (argc > 1 && strcmp(argv[1], "--bench-carga") == 0)
+    {
+        return executarBenchmarkCarga(argc > 2 ? atol(argv[2]) : 1000000);
+    }
+    // Análise das funções de hash: bench/bin/benchmarks --analisar-hash [corpus]
+    if (argc > 1 && strcmp(argv[1], "--analisar-hash") == 0)
+    {
+        return executarAnaliseHash(argc > 2 ? argv[2] : NULL);
+    }
+    // Modo de benchmark: bench/bin/benchmarks --bench-mansao [salas]
+    if (argc > 1 && strcmp(argv[1], "--bench-mansao") == 0)
+    {
+        return executarBenchmarkMansao(argc > 2 ? atol(argv[2]) : 10000000);
+    }
+
+    fprintf(stderr, "Uso: %s --bench [salas] [suspeitos] [forma] [semente] | --bench-pistas [n] | --bench-mansao [salas] | --bench-deducao [suspeitos] [pistas] | --bench-carga [coletas] | --analisar-hash [corpus]\n", argv[0]);
+    return EXIT_FAILURE;
+}
@@ -3,18 +3,22 @@
 #include <string.h>
 #include <ctype.h>
 
+// Altura máxima de uma AVL com até 2^32 nós (~1.44 log2 n) com folga; limita as pilhas de percurso
+#define ALTURA_MAXIMA_AVL 64
+
 // ==========================================================
 //                    ESTRUTURAS DE DADOS
 // ==========================================================
 
-// 1. ESTRUTURA PARA PISTA (Nó da ÁRVORE DE BUSCA BINÁRIA - BST)
+// 1. ESTRUTURA PARA PISTA (Nó da ÁRVORE DE BUSCA BINÁRIA - BST AVL)
 /**
  * @brief Estrutura de um nó da Árvore de Busca Binária (BST), representando uma Pista.
- * A ordenação é feita pela string 'descricao'.
+ * A ordenação é feita pela string 'descricao'; a árvore é balanceada (AVL).
  */
 typedef struct Pista
 {
     char descricao[100];
+    int altura; // Altura da subárvore (folha = 1)
     struct Pista *esquerda;
     struct Pista *direita;
 } Pista;
@@ -33,7 +37,7 @@ typedef struct Sala
 } Sala;
 
 // ==========================================================
-//                 FUNÇÕES DA BST (PISTAS)
+//               FUNÇÕES DA BST AVL (PISTAS)
 // ==========================================================
 
 /**
@@ -49,41 +53,120 @@ Pista *criarPista(const char *descricao)
     }
     strncpy(novaPista->descricao, descricao, sizeof(novaPista->descricao) - 1);
     novaPista->descricao[sizeof(novaPista->descricao) - 1] = '\0';
+    novaPista->altura = 1;
     novaPista->esquerda = NULL;
     novaPista->direita = NULL;
     return novaPista;
 }
 
 /**
- * @brief Insere uma nova pista na Árvore de Busca Binária (BST).
+ * @brief Retorna a altura de uma subárvore (0 para NULL).
+ */
+int alturaPista(Pista *no)
+{
+    return no ? no->altura : 0;
+}
+
+/**
+ * @brief Recalcula a altura de um nó a partir dos filhos.
+ */
+void atualizarAltura(Pista *no)
+{
+    int e = alturaPista(no->esquerda);
+    int d = alturaPista(no->direita);
+    no->altura = (e > d ? e : d) + 1;
+}
+
+Pista *rotacionarDireita(Pista *no)
+{
+    Pista *novaRaiz = no->esquerda;
+    no->esquerda = novaRaiz->direita;
+    novaRaiz->direita = no;
+    atualizarAltura(no);
+    atualizarAltura(novaRaiz);
+    return novaRaiz;
+}
+
+Pista *rotacionarEsquerda(Pista *no)
+{
+    Pista *novaRaiz = no->direita;
+    no->direita = novaRaiz->esquerda;
+    novaRaiz->esquerda = no;
+    atualizarAltura(no);
+    atualizarAltura(novaRaiz);
+    return novaRaiz;
+}
+
+/**
+ * @brief Recalcula a altura do nó e aplica a rotação AVL necessária.
+ * @return A nova raiz da subárvore.
+ */
+Pista *balancearPista(Pista *no)
+{
+    atualizarAltura(no);
+    int fator = alturaPista(no->esquerda) - alturaPista(no->direita);
+
+    if (fator > 1)
+    {
+        if (alturaPista(no->esquerda->esquerda) < alturaPista(no->esquerda->direita))
+        {
+            no->esquerda = rotacionarEsquerda(no->esquerda); // Caso esquerda-direita
+        }
+        return rotacionarDireita(no);
+    }
+    if (fator < -1)
+    {
+        if (alturaPista(no->direita->direita) < alturaPista(no->direita->esquerda))
+        {
+            no->direita = rotacionarDireita(no->direita); // Caso direita-esquerda
+        }
+        return rotacionarEsquerda(no);
+    }
+    return no;
+}
+
+/**
+ * @brief Insere uma nova pista na Árvore de Busca Binária balanceada (AVL), sem recursão.
+ * Desce guardando os ponteiros percorridos e depois sobe rebalanceando até a altura parar de mudar.
  * @param raiz A raiz da BST.
  * @param descricao A string da pista a ser inserida.
- * @return A nova raiz da BST.
+ * @return A nova raiz da BST (pode mudar por causa das rotações).
  */
 Pista *inserirPista(Pista *raiz, const char *descricao)
 {
-    // 1. Caso base: Atingiu NULL, cria o nó e retorna
-    if (raiz == NULL)
+    Pista **caminho[ALTURA_MAXIMA_AVL];
+    int profundidade = 0;
+    Pista **link = &raiz;
+
+    // 1. Desce comparando a nova pista com cada nó (ordem alfabética)
+    while (*link != NULL)
     {
-        printf("✅ Pista '%s' adicionada ao seu Diário de Investigação!\n", descricao);
-        return criarPista(descricao);
+        int comparacao = strcmp(descricao, (*link)->descricao);
+        if (comparacao == 0)
+        {
+            // Pista duplicada
+            printf("⚠️ Pista '%s' já havia sido coletada e foi ignorada.\n", descricao);
+            return raiz;
+        }
+        caminho[profundidade++] = link;
+        // Menor (alfabeticamente) vai para a esquerda, maior para a direita
+        link = comparacao < 0 ? &(*link)->esquerda : &(*link)->direita;
     }
 
-    // 2. Compara a nova pista com a pista na raiz (ordem alfabética)
-    int comparacao = strcmp(descricao, raiz->descricao);
+    // 2. Atingiu NULL: cria o nó
+    *link = criarPista(descricao);
+    printf("✅ Pista '%s' adicionada ao seu Diário de Investigação!\n", descricao);
 
-    if (comparacao < 0)
-    { // Nova pista é menor (alfabeticamente), vai para a esquerda
-        raiz->esquerda = inserirPista(raiz->esquerda, descricao);
-    }
-    else if (comparacao > 0)
-    { // Nova pista é maior, vai para a direita
-        raiz->direita = inserirPista(raiz->direita, descricao);
-    }
-    else
+    // 3. Sobe rebalanceando; quando a altura de um nó não muda, os de cima também não mudam
+    while (profundidade > 0)
     {
-        // Pista duplicada
-        printf("⚠️ Pista '%s' já havia sido coletada e foi ignorada.\n", descricao);
+        link = caminho[--profundidade];
+        int alturaAntes = (*link)->altura;
+        *link = balancearPista(*link);
+        if ((*link)->altura == alturaAntes)
+        {
+            break;
+        }
     }
 
     return raiz;
@@ -91,33 +174,54 @@ Pista *inserirPista(Pista *raiz, const char *descricao)
 
 /**
  * @brief Percorre a BST em ordem (In-Order) para listar as pistas em ordem alfabética.
+ * Usa uma pilha explícita; a altura da AVL limita o tamanho da pilha.
  * @param raiz A raiz da BST.
  */
 void listarPistasEmOrdem(Pista *raiz)
 {
-    if (raiz != NULL)
+    Pista *pilha[ALTURA_MAXIMA_AVL];
+    int topo = 0;
+    Pista *atual = raiz;
+
+    while (atual != NULL || topo > 0)
     {
-        // Percorre Esquerda (Menores)
-        listarPistasEmOrdem(raiz->esquerda);
+        // Desce pela Esquerda (Menores)
+        while (atual != NULL)
+        {
+            pilha[topo++] = atual;
+            atual = atual->esquerda;
+        }
 
-        // Visita a Raiz (Imprime a pista)
-        printf("   -> %s\n", raiz->descricao);
+        // Visita o nó (Imprime a pista)
+        atual = pilha[--topo];
+        printf("   -> %s\n", atual->descricao);
 
-        // Percorre Direita (Maiores)
-        listarPistasEmOrdem(raiz->direita);
+        // Segue pela Direita (Maiores)
+        atual = atual->direita;
     }
 }
 
 /**
- * @brief Libera a memória alocada para a BST de pistas.
+ * @brief Libera a memória alocada para a BST de pistas, sem recursão.
+ * Rotaciona à direita até não haver filho esquerdo e então libera a raiz.
  */
 void liberarPistas(Pista *raiz)
 {
-    if (raiz != NULL)
+    while (raiz != NULL)
     {
-        liberarPistas(raiz->esquerda);
-        liberarPistas(raiz->direita);
-        free(raiz);
+        if (raiz->esquerda != NULL)
+        {
+            Pista *esquerda = raiz->esquerda;
+            raiz->esquerda = esquerda->direita;
+            esquerda->direita = raiz;
+            raiz = esquerda;
+        }
+        else
+        {
+            Pista *direita = raiz->direita;
+            free(raiz);
+            raiz = direita;
+        }
     }
 }
 
@@ -166,8 +270,29 @@ void liberarArvoreSalas(Sala *raiz)
 //               LÓGICA DO JOGO E INTERAÇÃO
 // ==========================================================
 
+/**
+ * @brief Exibe o Diário de Pistas (BST em ordem alfabética).
+ */
+void exibirDiario(Pista *pistasRaiz)
+{
+    printf("\n=============================================\n");
+    printf("📝 DIÁRIO DE PISTAS (Em Ordem Alfabética)\n");
+    printf("=============================================\n");
+    if (pistasRaiz == NULL)
+    {
+        printf("Nenhuma pista coletada ainda.\n");
+    }
+    else
+    {
+        listarPistasEmOrdem(pistasRaiz);
+    }
+    printf("=============================================\n");
+}
+
 /**
  * @brief Função principal para navegação interativa na mansão.
+ * É um laço (não recursivo): cada comando só troca a sala atual, então a pilha
+ * não cresce com a duração da sessão.
  * @param salaAtual O ponteiro para a sala onde o jogador está atualmente.
  * @param pistasRaiz Ponteiro para a raiz da BST de pistas (usado para inserção).
  */
@@ -182,118 +307,92 @@ void explorarSalas(Sala *salaAtual, Pista **pistasRaiz)
         return;
     }
 
-    printf("\n-------------------------------------------------\n");
-    printf("🚪 Você está em: %s\n", salaAtual->nome);
-
-    // --- Lógica de Encontrar e Coletar Pista ---
-    if (strlen(salaAtual->pista_encontrada) > 0 && salaAtual->pista_coletada == 0)
+    while (1)
     {
-        printf("\n🌟 PISTA ENCONTRADA! Você encontrou: \"%s\"\n", salaAtual->pista_encontrada);
-        // Insere a pista na BST
-        *pistasRaiz = inserirPista(*pistasRaiz, salaAtual->pista_encontrada);
-        salaAtual->pista_coletada = 1; // Marca como coletada
-    }
+        printf("\n-------------------------------------------------\n");
+        printf("🚪 Você está em: %s\n", salaAtual->nome);
 
-    // Verifica se é um nó folha
-    if (salaAtual->esquerda == NULL && salaAtual->direita == NULL)
-    {
-        printf("\n🎉 Você chegou ao fim deste caminho da mansão !\n");//Nó Folha
-        // Opção para listar as pistas ao final de um caminho
-        printf("\n📝 Deseja ver seu Diário de Pistas? [l] Listar / [s] Sair: ");
-        if (scanf(" %c", &escolha) == 1)
+        // --- Lógica de Encontrar e Coletar Pista ---
+        if (strlen(salaAtual->pista_encontrada) > 0 && salaAtual->pista_coletada == 0)
+        {
+            printf("\n🌟 PISTA ENCONTRADA! Você encontrou: \"%s\"\n", salaAtual->pista_encontrada);
+            // Insere a pista na BST
+            *pistasRaiz = inserirPista(*pistasRaiz, salaAtual->pista_encontrada);
+            salaAtual->pista_coletada = 1; // Marca como coletada
+        }
+
+        // Verifica se é um nó folha
+        if (salaAtual->esquerda == NULL && salaAtual->direita == NULL)
         {
-            escolha = tolower(escolha);
-            if (escolha == 'l')
+            printf("\n🎉 Você chegou ao fim deste caminho da mansão !\n");//Nó Folha
+            // Opção para listar as pistas ao final de um caminho
+            printf("\n📝 Deseja ver seu Diário de Pistas? [l] Listar / [s] Sair: ");
+            if (scanf(" %c", &escolha) == 1)
             {
-                printf("\n=============================================\n");
-                printf("📝 DIÁRIO DE PISTAS (Em Ordem Alfabética)\n");
-                printf("=============================================\n");
-                if (*pistasRaiz == NULL)
-                {
-                    printf("Nenhuma pista coletada ainda.\n");
-                }
-                else
+                escolha = tolower(escolha);
+                if (escolha == 'l')
                 {
-                    listarPistasEmOrdem(*pistasRaiz);
+                    exibirDiario(*pistasRaiz);
                 }
-                printf("=============================================\n");
             }
+            // Limpa o buffer
+            int c;
+            while ((c = getchar()) != '\n' && c != EOF)
+                ;
+            return;
         }
-        // Limpa o buffer
-        int c;
-        while ((c = getchar()) != '\n' && c != EOF)
-            ;
-        return;
-    }
 
-    // --- Opções de Navegação ---
-    printf("\n Escolha o próximo caminho:\n");
-    printf("\n  [e] -> Esquerda (%s)\n", salaAtual->esquerda ? salaAtual->esquerda->nome : "Caminho Bloqueado 🚧");
-    printf("  [d] -> Direita (%s)\n", salaAtual->direita ? salaAtual->direita->nome : "Caminho Bloqueado 🚧");
-    printf("  [l] -> Listar Pistas Coletadas\n");
-    printf("  [s] -> Sair da Exploração\n");
-    printf(" \n Sua escolha: ");
+        // --- Opções de Navegação ---
+        printf("\n Escolha o próximo caminho:\n");
+        printf("\n  [e] -> Esquerda (%s)\n", salaAtual->esquerda ? salaAtual->esquerda->nome : "Caminho Bloqueado 🚧");
+        printf("  [d] -> Direita (%s)\n", salaAtual->direita ? salaAtual->direita->nome : "Caminho Bloqueado 🚧");
+        printf("  [l] -> Listar Pistas Coletadas\n");
+        printf("  [s] -> Sair da Exploração\n");
+        printf(" \n Sua escolha: ");
 
-    // Leitura da escolha do usuário e limpeza do buffer de entrada
-    if (scanf(" %c", &escolha) != 1)
-    {
-        int c;
-        while ((c = getchar()) != '\n' && c != EOF)
-            ;
-        printf("\n⚠️ Entrada inválida. Tente novamente.\n");
-        explorarSalas(salaAtual, pistasRaiz);
-        return;
-    }
-
-    escolha = tolower(escolha);
-
-    // Processa a escolha
-    switch (escolha)
-    {
-    case 'e':
-        if (salaAtual->esquerda != NULL)
-        {
-            explorarSalas(salaAtual->esquerda, pistasRaiz);
-        }
-        else
-        {
-            printf("\n🚫 Caminho para a Esquerda Bloqueado! Escolha outra direção.\n");
-            explorarSalas(salaAtual, pistasRaiz);
-        }
-        break;
-    case 'd':
-        if (salaAtual->direita != NULL)
-        {
-            explorarSalas(salaAtual->direita, pistasRaiz);
-        }
-        else
-        {
-            printf("\n🚫 Caminho para a Direita Bloqueado! Escolha outra direção.\n");
-            explorarSalas(salaAtual, pistasRaiz);
-        }
-        break;
-    case 'l':
-        printf("\n=============================================\n");
-        printf("📝DIÁRIO DE PISTAS (Em Ordem Alfabética)\n");
-        printf("=============================================\n");
-        if (*pistasRaiz == NULL)
+        // Leitura da escolha do usuário
+        if (scanf(" %c", &escolha) != 1)
         {
-            printf("Nenhuma pista coletada ainda.\n");
+            // Fim da entrada: não há como tentar de novo
+            printf("\n⚠️ Entrada encerrada. Saindo da exploração.\n");
+            return;
         }
-        else
+
+        escolha = tolower(escolha);
+
+        // Processa a escolha: apenas atualiza a sala atual e volta ao início do laço
+        switch (escolha)
         {
-            listarPistasEmOrdem(*pistasRaiz);
+        case 'e':
+            if (salaAtual->esquerda != NULL)
+            {
+                salaAtual = salaAtual->esquerda;
+            }
+            else
+            {
+                printf("\n🚫 Caminho para a Esquerda Bloqueado! Escolha outra direção.\n");
+            }
+            break;
+        case 'd':
+            if (salaAtual->direita != NULL)
+            {
+                salaAtual = salaAtual->direita;
+            }
+            else
+            {
+                printf("\n🚫 Caminho para a Direita Bloqueado! Escolha outra direção.\n");
+            }
+            break;
+        case 'l':
+            exibirDiario(*pistasRaiz); // Permanece na sala atual
+            break;
+        case 's':
+            printf("\n👋 Saindo da exploração da mansão. Obrigado por jogar!\n");
+            return;
+        default:
+            printf("\n⚠️  Opção inválida. Por favor, escolha: 'e', 'd', 'l', ou 's'.\n");
+            break;
         }
-        printf("=============================================\n");
-        explorarSalas(salaAtual, pistasRaiz); // Retorna à sala atual
-        break;
-    case 's':
-        printf("\n👋 Saindo da exploração da mansão. Obrigado por jogar!\n");
-        break;
-    default:
-        printf("\n⚠️  Opção inválida. Por favor, escolha: 'e', 'd', 'l', ou 's'.\n");
-        explorarSalas(salaAtual, pistasRaiz);
-        break;
     }
 }
 
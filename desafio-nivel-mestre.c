@@ -1,483 +1,8258 @@
+// Expõe as funções POSIX/BSD usadas aqui (lstat, S_ISSOCK, mmap, clock_gettime...) e o
+// accept4 do Linux também quando o compilador roda em modo ISO estrito (ex.: gcc -std=c11)
+#define _GNU_SOURCE
+
 #include <stdio.h>
+#include <stdarg.h>
+#include <errno.h>
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/epoll.h>
+#include <signal.h>
+#include <pthread.h>
+#include <sched.h>
 
-// Definição do tamanho da Tabela Hash
-#define TAMANHO_HASH 10
+// Capacidade inicial do índice da Tabela Hash (sempre potência de 2)
+#define TAMANHO_HASH 16
+// Fator de carga máximo do índice (3/4) antes de dobrar a capacidade
+#define CARGA_MAXIMA_NUM 3
+#define CARGA_MAXIMA_DEN 4
+#define SLOT_VAZIO (-1)
 #define MAX_NOME 50
 
+// Funções de hash disponíveis; a usada por funcaoHash é escolhida na compilação
+// (ex.: -DFUNCAO_HASH=HASH_PALAVRAS). O número é gravado no mapa compilado.
+#define HASH_FNV1A 1     // FNV-1a de 32 bits, byte a byte
+#define HASH_MISTURA64 2 // Palavras de 8 bytes misturadas por multiplicação de 128 bits
+#define HASH_PALAVRAS 3  // Palavras de 8 bytes com uma multiplicação de 64 bits cada (estilo FxHash)
+#ifndef FUNCAO_HASH
+#define FUNCAO_HASH HASH_FNV1A
+#endif
+
+// Id reservado para a string vazia (sala sem pista / sem suspeito)
+#define STRING_VAZIA 0
+// Altura máxima de uma AVL com até 2^32 nós (~1.44 log2 n) com folga; limita as pilhas de percurso
+#define ALTURA_MAXIMA_AVL 64
+// Tamanho do buffer do leitor de comandos
+#define TAMANHO_BUFFER_ENTRADA 65536
+// Tamanho do buffer do renderizador de saída
+#define TAMANHO_BUFFER_SAIDA 65536
+// Níveis de verbosidade da saída do jogo
+#define VERBOSIDADE_SILENCIOSA 0
+#define VERBOSIDADE_RESUMO 1
+#define VERBOSIDADE_COMPLETA 2
+// Descritor que faz o renderizador acumular a saída em memória (ex.: relatório em cache)
+#define SAIDA_EM_MEMORIA (-1)
+// Servidor: buffers de cada conexão, leituras por vez e eventos por espera do epoll
+#define TAMANHO_BUFFER_CONEXAO 4096
+#define TAMANHO_LEITURA_CONEXAO 4096
+#define LEITURAS_POR_VEZ 16
+#define EVENTOS_POR_ESPERA 64
+// Saída ainda não enviada a partir da qual o servidor para de ler os comandos do cliente
+#define LIMITE_SAIDA_PENDENTE (256 * 1024)
+// Índice que marca "sem sala" (caminho bloqueado) na mansão compilada
+#define SEM_SALA 0xFFFFFFFFu
+// Assinatura e versão do formato binário (mapeável) da mansão
+#define ASSINATURA_MAPA "DQMAPA1"
+#define VERSAO_MAPA 3
+// Lista de implicações sem pares: a sala implica só o seu suspeito, com peso 1
+#define LISTA_VAZIA 0
+// Maior peso de um suspeito no mapa ("Dama:3")
+#define PESO_MAXIMO_SUSPEITO 1000
+// Assinatura e versão do snapshot binário de uma sessão
+#define ASSINATURA_SESSAO "DQSESS1"
+#define VERSAO_SESSAO 1
+// Tamanho do primeiro bloco de uma arena (os seguintes dobram)
+#define TAMANHO_BLOCO_ARENA 4096
+// Ordens possíveis das salas no array da mansão
+#define ORDEM_LARGURA 0
+#define ORDEM_PROFUNDIDADE 1
+#define ORDEM_VEB 2
+// Capacidade inicial do deque de subárvores pendentes de cada trabalhador do resolvedor
+#define TAMANHO_DEQUE_ROTAS 64
+// Quantas pistas o comando de busca por trecho mostra de uma vez
+#define LIMITE_BUSCA_TRECHO 50
+// Baldes de cada histograma das estatísticas (o último acumula os valores maiores)
+#define TAMANHO_HISTOGRAMA 32
+// Motor de dedução: pesos por suspeito em blocos de 8 floats (os kernels somam 8 parciais)
+#define LARGURA_VETOR_DEDUCAO 8
+// Chance de uma pista apontar um inocente: a pista de peso w multiplica o suspeito por (w + ruído) / ruído
+#define RUIDO_DEDUCAO 0.25f
+// Faixa da soma dos pesos antes de renormalizar (evita overflow/underflow em float)
+#define LIMITE_SOMA_DEDUCAO 1e12
+// Pesos abaixo disto viram zero: um suspeito assim já está descartado, e float subnormal é lento
+#define PESO_MINIMO_DEDUCAO 1e-30f
+// Quantos suspeitos a análise completa mostra com a probabilidade de culpa
+#define SUSPEITOS_NA_PROBABILIDADE 5
+// Resultado de coletar a pista de uma sala
+#define COLETA_NENHUMA 0   // Sala sem pista, ou pista desta sala já coletada
+#define COLETA_NOVA 1      // Pista nova no diário e nas evidências
+#define COLETA_DUPLICADA 2 // O texto já estava no diário (veio de outra sala)
+// Passos de cada investigação aleatória do modo --motores (sem contar a chegada a uma folha)
+#define PASSOS_POR_INVESTIGACAO 256
+// Carga em lote: quantos itens à frente os laços pedem ao cache (os acessos ao pool são aleatórios)
+#define DISTANCIA_PREFETCH 16
+
 // ==========================================================
 //                    ESTRUTURAS DE DADOS
 // ==========================================================
 
-// --- 1. ESTRUTURA PARA TABELA HASH (Suspeitos & Pistas) ---
+// --- 1. ESTRUTURA PARA ARENA (alocação por blocos) ---
+
+/**
+ * @brief Bloco de memória de uma arena; os nós são alocados em sequência dentro dele.
+ */
+typedef struct BlocoArena
+{
+    struct BlocoArena *proximo;
+    size_t usado;
+    size_t capacidade;
+    unsigned char dados[];
+} BlocoArena;
+
+/**
+ * @brief Arena: alocar é avançar um ponteiro dentro do bloco atual, e reiniciar é voltar
+ * ao primeiro bloco (O(1)), mantendo os blocos para reuso. Não há free por nó.
+ */
+typedef struct Arena
+{
+    BlocoArena *primeiro;
+    BlocoArena *atual;
+} Arena;
+
+// --- 2. ESTRUTURAS DAS ESTATÍSTICAS (contadores e histogramas das estruturas) ---
+
+/**
+ * @brief Distribuição de uma medida inteira: um balde por valor, e o último acumula
+ * tudo a partir de TAMANHO_HISTOGRAMA - 1. O total de amostras é a soma dos baldes.
+ */
+typedef struct Histograma
+{
+    unsigned long long baldes[TAMANHO_HISTOGRAMA];
+    unsigned long long soma;
+    unsigned long long maximo;
+} Histograma;
+
+/**
+ * @brief Contadores de um contexto (a montagem de uma mansão ou uma sessão), coletados
+ * nos pontos de alocação e de busca.
+ */
+typedef struct Estatisticas
+{
+    unsigned long long salasCriadas;           // criarSala e salas adicionadas na edição
+    unsigned long long pistasCriadas;          // Nós novos da AVL
+    unsigned long long associacoesCriadas;     // criarAssociacao
+    unsigned long long pistasDuplicadas;       // Inserções recusadas na AVL
+    unsigned long long associacoesDuplicadas;  // Inserções recusadas na Tabela Hash
+    unsigned long long redimensionamentosHash; // Vezes que o índice da Tabela Hash dobrou
+    Histograma sondagensHash;                  // Slots visitados por busca na Tabela Hash
+    Histograma sondagensPool;                  // Slots visitados por busca no pool de strings
+    Histograma profundidadePistas;             // Profundidade de cada pista nova na AVL
+} Estatisticas;
+
+// Com -DDQ_ESTATISTICAS os pontos de coleta somam nos contadores do contexto indicado
+// (NULL = não contar). Cada contexto é escrito por uma thread de cada vez, então as somas
+// são simples. Sem a opção, as macros não geram código.
+#ifdef DQ_ESTATISTICAS
+#define ESTATISTICAS_ATIVAS 1
+#define CONTAR(estatisticas, contador) SOMAR(estatisticas, contador, 1)
+#define SOMAR(estatisticas, contador, valor) \
+    ((estatisticas) != NULL ? (void)((estatisticas)->contador += (valor)) : (void)0)
+#define AMOSTRAR(estatisticas, histograma, valor) \
+    ((estatisticas) != NULL ? registrarAmostra(&(estatisticas)->histograma, (valor)) : (void)0)
+#else
+#define ESTATISTICAS_ATIVAS 0
+#define CONTAR(estatisticas, contador) ((void)(estatisticas))
+#define SOMAR(estatisticas, contador, valor) ((void)(estatisticas), (void)(valor))
+#define AMOSTRAR(estatisticas, histograma, valor) ((void)(estatisticas), (void)(valor))
+#endif
+
+// --- 3. ESTRUTURA PARA O POOL DE STRINGS (Interning) ---
+
+/**
+ * @brief Pool de strings internadas: cada texto distinto é guardado uma única vez
+ * e identificado por um id inteiro compacto. Dois ids iguais <=> dois textos iguais.
+ */
+typedef struct PoolStrings
+{
+    char *dados;             // Todos os textos, concatenados e terminados em '\0'
+    size_t usado;
+    size_t capacidadeDados;
+    unsigned int *offsets;   // offsets[id] = início do texto em 'dados'
+    unsigned int *hashes;    // hashes[id] = funcaoHash do texto (reaproveitado pelas tabelas)
+    int quantidade;
+    int capacidadeIds;
+    int *slots;              // Índice de endereçamento aberto (id ou SLOT_VAZIO); criado sob demanda
+    int capacidade;          // Número de slots (potência de 2)
+    int emprestado;          // 1 se dados/offsets/hashes apontam para um mapa compilado (mmap)
+} PoolStrings;
+
+// --- 4. ESTRUTURA PARA TABELA HASH (Suspeitos & Pistas) ---
 
 /**
- * @brief Estrutura do nó da lista encadeada da Tabela Hash (cada nó é uma associação).
+ * @brief Uma associação Pista -> Suspeito (ambos como ids do pool de strings).
+ * As associações ficam guardadas de forma contígua (array denso) em ordem de inserção.
  */
 typedef struct Associacao
 {
-    char pista[100];
-    char suspeito[MAX_NOME];
-    struct Associacao *proximo;
+    int pista;
+    int suspeito;
+    int suspeito_id; // Posição do suspeito no Registro de Suspeitos
 } Associacao;
 
-// A Tabela Hash é um array de ponteiros para Associacao.
-Associacao *tabelaHash[TAMANHO_HASH];
+/**
+ * @brief Posição do índice da Tabela Hash (endereçamento aberto com sondagem linear).
+ * Guarda o hash completo para descartar slots sem olhar a entrada. O slot só está
+ * ocupado se a sua geração for a geração atual da tabela.
+ */
+typedef struct SlotHash
+{
+    unsigned int hash;
+    int indice;           // Posição em 'entradas'
+    unsigned int geracao; // Geração em que o slot foi preenchido
+} SlotHash;
+
+/**
+ * @brief Tabela Hash com índice compacto + array denso de associações.
+ * O índice cresce (dobra) sempre que o fator de carga passa de 3/4.
+ * Cada sessão tem a sua (as evidências são o progresso do jogador).
+ */
+typedef struct TabelaHash
+{
+    SlotHash *slots;      // Índice de endereçamento aberto
+    int capacidade;       // Número de slots (potência de 2)
+    Associacao *entradas; // Associações densas, em ordem de inserção
+    int quantidade;
+    int capacidadeEntradas;
+    unsigned int geracao; // Incrementar esvazia todos os slots em O(1)
+    struct Dicionario *dicionario; // Textos das pistas e registro dos suspeitos
+    Estatisticas *estatisticas;    // Onde contar buscas e inserções (NULL = não contar)
+} TabelaHash;
+
+// --- 5. ESTRUTURA PARA O REGISTRO DE SUSPEITOS (nome -> id) E O PLACAR ---
+
+/**
+ * @brief Um suspeito registrado.
+ */
+typedef struct Suspeito
+{
+    int nome; // Id do nome no pool de strings
+} Suspeito;
+
+/**
+ * @brief Registro dinâmico de suspeitos.
+ * O id de um suspeito é a sua posição em 'lista'. Como os nomes já são internados,
+ * o mapa nome -> id é um array indexado pelo id da string.
+ * Os suspeitos do mapa são registrados ao carregá-lo; depois disso o registro só é
+ * lido, e pode ser compartilhado por várias sessões ao mesmo tempo.
+ */
+typedef struct RegistroSuspeitos
+{
+    Suspeito *lista;     // Suspeitos em ordem de registro
+    int quantidade;
+    int capacidadeLista;
+    int *idPorString;    // idPorString[id da string] = id do suspeito ou -1
+    int capacidadeMapa;
+} RegistroSuspeitos;
+
+/**
+ * @brief Um suspeito implicado pela pista de uma sala, com o peso da implicação.
+ * É também o registro gravado na seção de implicações do arquivo compilado (8 bytes).
+ */
+typedef struct Implicacao
+{
+    uint32_t suspeito; // Id do nome no pool de strings
+    uint32_t peso;     // De 1 a PESO_MAXIMO_SUSPEITO
+} Implicacao;
+
+/**
+ * @brief Listas de suspeitos com pesos das salas, em CSR: a lista i são os pares
+ * [inicios[i], inicios[i + 1]) de 'pares'. A lista LISTA_VAZIA existe sempre e não tem
+ * pares. As listas nunca mudam; trocar os suspeitos de uma sala cria outra.
+ */
+typedef struct ListasImplicacoes
+{
+    uint32_t *inicios; // quantidade + 1 posições
+    Implicacao *pares;
+    uint32_t quantidade;
+    uint32_t numPares;
+    uint32_t capacidadeListas;
+    uint32_t capacidadePares;
+    int emprestado; // 1 se inicios/pares apontam para um mapa compilado (mmap)
+} ListasImplicacoes;
+
+/**
+ * @brief Dicionário de um mapa: o pool com os textos, o registro dos suspeitos e as
+ * listas de suspeitos com pesos. Cada mansão aponta para o seu, então mapas diferentes
+ * convivem no mesmo processo; as sessões chegam a ele pela mansão.
+ */
+typedef struct Dicionario
+{
+    PoolStrings pool;
+    RegistroSuspeitos suspeitos;
+    ListasImplicacoes implicacoes; // Salas que implicam mais de um suspeito (ou com peso diferente de 1)
+    int congelado; // 1 depois de congelarDicionario: daí em diante só há leituras
+    Estatisticas estatisticas; // Contadores da montagem do mapa (salas e textos internados)
+} Dicionario;
+
+/**
+ * @brief Contagem de citações por suspeito em uma sessão, com o ranking completo.
+ * O ranking é mantido a cada nova citação: os suspeitos ficam em ordem decrescente de
+ * citações e os empatados ficam contíguos, então o líder, a posição de cada suspeito e
+ * os grupos de empate são consultados em O(1).
+ */
+typedef struct Placar
+{
+    int *citacoes; // citacoes[id do suspeito]
+    int *ranking;  // Ids em ordem decrescente de citações
+    int *posicao;  // posicao[id]: índice do suspeito em 'ranking'
+    int capacidade;
+    int numSuspeitos; // Suspeitos já no ranking
+    int *acima;       // acima[c]: quantos suspeitos têm mais de c citações (início do grupo c)
+    int capacidadeAcima;
+    int maxCitacoes; // Citações do líder
+    const Dicionario *dicionario; // Suspeitos registrados (o ranking inclui os nunca citados)
+} Placar;
+
+/**
+ * @brief Um grupo de empate do ranking: as posições [inicio, inicio + quantidade)
+ * têm todas 'citacoes' citações.
+ */
+typedef struct GrupoRanking
+{
+    int citacoes;
+    int inicio;
+    int quantidade;
+} GrupoRanking;
+
+/**
+ * @brief Uma pista no índice por suspeito, com o peso com que ela implica o suspeito.
+ */
+typedef struct PistaPonderada
+{
+    int pista; // Id do texto no pool de strings
+    int peso;
+} PistaPonderada;
+
+/**
+ * @brief Índice invertido suspeito -> pistas (muitos para muitos: uma pista pode estar na
+ * lista de vários suspeitos, cada vez com o seu peso).
+ * Enquanto cresce (durante o jogo), cada suspeito tem a sua lista. Congelado, vira CSR:
+ * todas as listas num array só, e as do suspeito s ficam em [inicio[s], inicio[s + 1]).
+ */
+typedef struct IndiceSuspeitos
+{
+    PistaPonderada **listas; // Crescendo: listas[s], em ordem de associação
+    int *tamanhos;           // Crescendo: pistas em listas[s]
+    int *capacidades;
+    int *pesos;              // Soma dos pesos das pistas de cada suspeito
+    int numSuspeitos;        // Posições alocadas nos arrays acima
+    int *inicio;             // Congelado: numSuspeitos + 1 posições
+    PistaPonderada *pistas;  // Congelado: todas as listas, contíguas
+    int totalPistas;
+    int congelado;
+} IndiceSuspeitos;
+
+/**
+ * @brief Motor de dedução ponderada: a probabilidade de cada suspeito ser o culpado,
+ * atualizada pela regra de Bayes a cada pista (multiplica pela verossimilhança e normaliza).
+ * Os pesos não normalizados ficam num array contíguo, com a capacidade em múltiplos de
+ * LARGURA_VETOR_DEDUCAO e zeros depois do último suspeito; a probabilidade do suspeito s
+ * é pesos[s] / soma. As pistas do jogo montam a sua verossimilhança num vetor de rascunho
+ * do mesmo tamanho (1 para quem ela não implica) e passam pelo kernel denso.
+ */
+typedef struct MotorDeducao
+{
+    float *pesos;
+    float *verossimilhancas; // Rascunho da pista em montagem: 1 fora dos implicados
+    int *implicados;         // Suspeitos marcados no rascunho (para devolvê-lo a 1)
+    int numImplicados;
+    int capacidadeImplicados;
+    int numSuspeitos;
+    int capacidade;
+    double soma;
+    float base; // Peso de um suspeito que nenhuma pista implicou (muda só ao renormalizar)
+    int pistas; // Pistas aplicadas desde o último reinício
+} MotorDeducao;
+
+/**
+ * @brief Um suspeito do ranking de probabilidades.
+ */
+typedef struct ProbabilidadeSuspeito
+{
+    int suspeito;
+    double probabilidade;
+} ProbabilidadeSuspeito;
+
+/**
+ * @brief Dedução das evidências de uma sessão, sem texto: o líder do placar e o
+ * suspeito mais provável segundo o motor ponderado. Quem mostra é o chamador.
+ */
+typedef struct Deducao
+{
+    int suspeito; // Mais citado (-1 sem suspeitos)
+    int empate;   // 1 se outro suspeito tem as mesmas citações
+    int citacoes; // Citações do mais citado
+    int pistas;   // Evidências coletadas
+    ProbabilidadeSuspeito maisProvavel; // suspeito -1 sem pistas
+} Deducao;
 
-// --- 2. ESTRUTURA PARA PISTA (Nó da ÁRVORE DE BUSCA BINÁRIA - BST) ---
+// --- 6. ESTRUTURA PARA PISTA (Nó da ÁRVORE DE BUSCA BINÁRIA - BST AVL) ---
 typedef struct Pista
 {
-    char descricao[100];
+    int descricao; // Id do texto no pool de strings
+    int altura;    // Altura da subárvore (folha = 1), mantida pelo balanceamento AVL
+    int tamanho;   // Pistas na subárvore (para consultas por posição)
     struct Pista *esquerda;
     struct Pista *direita;
 } Pista;
 
-// --- 3. ESTRUTURA PARA SALA (Nó da ÁRVORE BINÁRIA DE NAVEGAÇÃO) ---
+/**
+ * @brief Iterador em ordem alfabética sobre a BST de Pistas, com pilha explícita.
+ * O topo da pilha é sempre a próxima pista; a altura da AVL limita o tamanho da pilha.
+ */
+typedef struct IteradorPistas
+{
+    const Pista *pilha[ALTURA_MAXIMA_AVL];
+    int topo;
+} IteradorPistas;
+
+/**
+ * @brief Uma pista da carga em lote: ids no pool e a posição na ordem de coleta.
+ * O prefixo guarda os 16 primeiros bytes do texto em big-endian, então a ordenação
+ * compara inteiros dentro do próprio array e só vai ao pool (strcmp) quando os
+ * prefixos empatam.
+ */
+typedef struct PistaDoLote
+{
+    uint64_t prefixo[2];
+    int pista;
+    int suspeito;
+    uint32_t ordem;
+} PistaDoLote;
+
+// --- 7. ESTRUTURA PARA SALA (Nó da ÁRVORE BINÁRIA DE NAVEGAÇÃO) ---
+/**
+ * @brief Sala usada para montar o mapa em código (criarSala + ligações à mão).
+ * Antes do jogo a árvore é compilada para a Mansao (array plano).
+ */
 typedef struct Sala
 {
-    char nome[MAX_NOME];
-    char pista_encontrada[100];
-    char suspeito_associado[MAX_NOME]; // Novo: Suspeito vinculado a esta pista
-    int pista_coletada;
+    int nome;               // Ids do pool de strings
+    int pista_encontrada;   // STRING_VAZIA se a sala não tem pista
+    int suspeito_associado; // Novo: Suspeito vinculado a esta pista
     struct Sala *esquerda;
     struct Sala *direita;
 } Sala;
 
+// --- 8. ESTRUTURA PARA A MANSÃO COMPILADA (array plano, mapeável) ---
+
+/**
+ * @brief Sala da mansão compilada: textos como ids do pool e filhos como índices no array.
+ * É também o registro gravado no arquivo compilado, então tem tamanho fixo (24 bytes;
+ * 20 nas versões 1 e 2, sem 'implicacoes').
+ */
+typedef struct SalaCompilada
+{
+    uint32_t nome;
+    uint32_t pista;       // STRING_VAZIA se a sala não tem pista
+    uint32_t suspeito;    // O suspeito principal (o primeiro da lista, se houver lista)
+    uint32_t esquerda;    // Índice da sala ou SEM_SALA
+    uint32_t direita;
+    uint32_t implicacoes; // Lista de suspeitos com pesos no dicionário (LISTA_VAZIA: só 'suspeito', peso 1)
+} SalaCompilada;
+
+/**
+ * @brief Cabeçalho do arquivo compilado. Os offsets são a partir do início do arquivo.
+ */
+typedef struct CabecalhoMapa
+{
+    char assinatura[8]; // ASSINATURA_MAPA
+    uint32_t versao;
+    uint32_t numSalas;
+    uint32_t raiz;
+    uint32_t numStrings;
+    uint64_t bytesStrings;
+    uint64_t offsetSalas;   // SalaCompilada[numSalas]
+    uint64_t offsetOffsets; // uint32_t[numStrings]
+    uint64_t offsetHashes;  // uint32_t[numStrings]
+    uint64_t offsetDados;   // char[bytesStrings]
+    uint32_t funcaoHash;    // HASH_* que gerou os hashes gravados (a versão 1 não tem: era FNV-1a)
+    uint32_t reservado;
+    uint64_t offsetListas;      // uint32_t[numListas + 1]: início de cada lista (a partir da versão 3)
+    uint64_t offsetImplicacoes; // Implicacao[numImplicacoes]
+    uint32_t numListas;
+    uint32_t numImplicacoes;
+} CabecalhoMapa;
+
+/**
+ * @brief Mapa da mansão usado no jogo. As salas vêm de um array próprio (compilado em
+ * memória ou lido de texto) ou apontam direto para um arquivo mapeado com mmap.
+ */
+typedef struct Mansao
+{
+    const SalaCompilada *salas;
+    uint32_t numSalas;
+    uint32_t raiz;
+    SalaCompilada *salasProprias; // Não-NULL quando o array pertence à mansão
+    uint32_t capacidadeSalas;     // Salas que cabem em salasProprias (a edição cresce o array)
+    void *mapeamento;             // Não-NULL quando as salas estão em um arquivo mapeado
+    size_t tamanhoMapeamento;
+    Dicionario *dicionario;       // Textos e suspeitos das salas (de quem carregou a mansão)
+    int editada;                  // Alguma edição mudou as salas: um snapshot não valeria no mapa original
+} Mansao;
+
+/**
+ * @brief Índice de salas da mansão: sala por nome, pai, profundidade e um ponteiro de
+ * salto por sala (Myers). Os saltos seguem a decomposição binária oblíqua da
+ * profundidade, então subir até qualquer ancestral e achar o ancestral comum de duas
+ * salas custam O(log n) com memória O(n).
+ */
+typedef struct IndiceSalas
+{
+    const Mansao *mansao;
+    uint32_t *pais;          // SEM_SALA na raiz
+    uint32_t *saltos;        // Ancestral para onde se pode pular (a raiz aponta para si mesma)
+    uint32_t *profundidades; // A raiz tem profundidade 0
+    uint32_t *salaPorNome;   // salaPorNome[id do texto]: a sala mais rasa com esse nome
+    int capacidadeNomes;
+    uint32_t capacidadeSalas; // Posições em pais, saltos, profundidades e nas listas por nome
+    // Só depois da primeira edição da mansão (NULL antes): as salas de cada nome em uma
+    // lista duplamente ligada que começa em salaPorNome, e os topos das alas desanexadas.
+    uint32_t *proximaComNome;
+    uint32_t *anteriorComNome;
+    uint32_t *alasSoltas;
+    int numAlasSoltas;
+    int capacidadeAlasSoltas;
+    Estatisticas *estatisticas; // Onde contar as buscas por nome (NULL = não contar)
+} IndiceSalas;
+
+// --- 9. ESTRUTURA PARA O RENDERIZADOR (saída bufferizada) ---
+
+/**
+ * @brief Saída do jogo acumulada em um buffer próprio e escrita com um único write()
+ * por passo (antes de esperar um comando) ou quando o buffer enche.
+ * A verbosidade decide o que é formatado: no modo silencioso nada é formatado.
+ */
+typedef struct Renderizador
+{
+    int descritor;
+    int verbosidade;
+    char *buffer;
+    size_t capacidade;
+    size_t usado;
+    int falhou;    // 1 depois de um erro de escrita (o resto da saída é descartado)
+    char *memoria; // Com SAIDA_EM_MEMORIA: tudo o que já foi descarregado
+    size_t tamanhoMemoria;
+    size_t capacidadeMemoria;
+} Renderizador;
+
+// --- 10. ESTRUTURA PARA O LEITOR DE COMANDOS (entrada bufferizada) ---
+
+/**
+ * @brief Leitor de comandos com buffer próprio sobre um descritor de arquivo.
+ * Substitui o par scanf(" %c") + getchar(): cada read() traz um bloco inteiro de comandos.
+ */
+typedef struct LeitorComandos
+{
+    int descritor;
+    Renderizador *saida; // Descarregado antes de cada read() (pode ser NULL)
+    unsigned char buffer[TAMANHO_BUFFER_ENTRADA];
+    size_t posicao;
+    size_t tamanho;
+} LeitorComandos;
+
+// --- 11. ESTRUTURA PARA SESSÃO (uma investigação) ---
+
+/**
+ * @brief Slot do índice de trigramas: a lista (encadeada, em ordem de coleta) das
+ * evidências cujo texto contém o trigrama. Vale só na geração atual do índice.
+ */
+typedef struct SlotTrigrama
+{
+    uint32_t trigrama; // Três bytes em minúsculo, empacotados
+    unsigned int geracao;
+    int primeira; // Índice em 'ocorrencias' (-1 = lista vazia)
+    int ultima;
+    int quantidade;
+} SlotTrigrama;
+
+/**
+ * @brief Elo de uma lista de ocorrências: a evidência (índice na Tabela Hash) e a próxima.
+ */
+typedef struct OcorrenciaTrigrama
+{
+    int entrada;
+    int proxima;
+} OcorrenciaTrigrama;
+
+/**
+ * @brief Índice invertido trigrama -> evidências, para buscar trechos das pistas sem
+ * varrer todas. Endereçamento aberto com geração (como a Tabela Hash), e as listas
+ * ficam em um array único, então reiniciar é O(1).
+ */
+typedef struct IndiceTrigramas
+{
+    SlotTrigrama *slots; // NULL até a primeira busca
+    int capacidade;
+    int usados;
+    unsigned int geracao;
+    OcorrenciaTrigrama *ocorrencias;
+    int numOcorrencias;
+    int capacidadeOcorrencias;
+    int indexadas; // Evidências da Tabela Hash já indexadas
+} IndiceTrigramas;
+
+/**
+ * @brief Estado de uma investigação: sala atual, BST de pistas, o conjunto de salas
+ * cujas pistas já foram coletadas, as evidências e o placar. O progresso fica aqui,
+ * não na mansão, então várias sessões podem compartilhar a mesma mansão.
+ * Os nós da BST vêm da arena da sessão, liberada de uma vez ao reiniciar.
+ */
+typedef struct Sessao
+{
+    const Mansao *mansao;
+    uint32_t salaAtual;
+    Pista *pistasRaiz;
+    Arena arenaPistas;
+    uint64_t *coletadas;      // Bitset: bit i = pista da sala i coletada
+    uint32_t salasNoBitset;   // Salas que cabem em 'coletadas' (cresce se a mansão for editada)
+    uint32_t *salasColetadas; // Salas marcadas no bitset (para reiniciar só esses bits)
+    int numColetadas;
+    int capacidadeColetadas;
+    TabelaHash evidencias; // Associações Pista -> Suspeito coletadas
+    Placar placar;         // Citações por suspeito
+    long comandos; // Comandos processados (acumulado entre sessões)
+    IndiceTrigramas trechos;    // Busca por trecho nas pistas coletadas
+    IndiceSalas *indiceSalas;   // Salas por nome e ancestrais (criado no primeiro teleporte)
+    IndiceSuspeitos porSuspeito; // Pistas coletadas de cada suspeito (cresce durante o jogo)
+    IndiceSuspeitos *catalogo;  // Todas as pistas do mapa por suspeito (congelado, criado na primeira consulta)
+    MotorDeducao motor;         // Probabilidade de culpa de cada suspeito, refeita a cada pista
+    Renderizador relatorio;     // Última análise renderizada (em memória, criada no primeiro [a])
+    unsigned int geracaoRelatorio; // Estado das evidências quando ela foi renderizada
+    int quantidadeRelatorio;
+    Estatisticas estatisticas;     // Contadores desta sessão (acumulados entre reinícios)
+} Sessao;
+
+/**
+ * @brief Cabeçalho do snapshot de uma sessão. Depois dele vêm as salas coletadas, em
+ * ordem de coleta (uint32_t[numColetadas]), e as citações (uint32_t[numSuspeitos]).
+ * Refazer as coletas na mesma ordem reconstrói a BST, a Tabela Hash e o placar exatos.
+ */
+typedef struct CabecalhoSessao
+{
+    char assinatura[8]; // ASSINATURA_SESSAO
+    uint32_t versao;
+    uint32_t numSalas;     // Tamanho da mansão em que o snapshot foi tirado
+    uint32_t salaAtual;
+    uint32_t numColetadas;
+    uint32_t numSuspeitos;
+    uint32_t conferencia;  // Mistura dos hashes das pistas coletadas (detecta outro mapa)
+    uint64_t comandos;
+} CabecalhoSessao;
+
+// --- 12. ESTRUTURAS DO SERVIDOR (várias sessões por processo) ---
+
+/**
+ * @brief Um cliente conectado ao servidor: uma investigação própria sobre a mansão
+ * compartilhada e a sua saída. Só um trabalhador por vez cuida de uma conexão, pois
+ * o descritor só volta a ser vigiado pelo epoll depois de processado (EPOLLONESHOT).
+ * O socket não bloqueia: as respostas se acumulam na memória da saída e vão sendo
+ * enviadas conforme o cliente lê.
+ */
+typedef struct Conexao
+{
+    int descritor;
+    Sessao sessao;
+    Renderizador saida;       // Em memória (SAIDA_EM_MEMORIA): o que falta enviar fica nela
+    size_t enviados;          // Bytes da memória da saída já enviados
+    int fimDaEntrada;         // 1 quando o cliente fechou a escrita: só falta enviar o resto
+    int descartando;          // 1 depois do fim de uma investigação: ignora o resto da linha
+    struct Conexao *anterior; // Lista das conexões abertas (para o encerramento)
+    struct Conexao *proxima;
+} Conexao;
+
+/**
+ * @brief Servidor: a mansão (só leitura), o epoll com as conexões e a fila de conexões
+ * com dados para ler, atendida por um grupo fixo de threads.
+ */
+typedef struct Servidor
+{
+    const Mansao *mansao;
+    int escuta; // Socket Unix que aceita as conexões
+    int epoll;
+    int verbosidade;
+    pthread_mutex_t trava; // Protege a fila, a lista de conexões e os contadores
+    pthread_cond_t temTrabalho;
+    Conexao **fila; // Fila circular (cada conexão aparece no máximo uma vez)
+    int capacidadeFila;
+    int inicioFila;
+    int tamanhoFila;
+    int encerrando;
+    Conexao *abertas;
+    int numAbertas;
+    long conexoesAtendidas;
+    long investigacoesConcluidas;
+} Servidor;
+
+// --- 13. ESTRUTURAS DO RESOLVEDOR DE ROTAS (todas as rotas até as folhas) ---
+
+/**
+ * @brief Uma subárvore ainda não explorada: a sala e a profundidade em que ela entra na rota.
+ */
+typedef struct TarefaRota
+{
+    uint32_t sala;
+    uint32_t profundidade;
+} TarefaRota;
+
+/**
+ * @brief Um trabalhador do resolvedor. A rota atual é mantida de forma incremental
+ * (entrar em uma sala soma a sua pista, voltar desfaz), então cada folha custa O(1).
+ * As subárvores pendentes ficam em um deque: o dono empilha e desempilha no topo, e
+ * quem está sem trabalho rouba da base, onde estão as subárvores mais próximas da raiz.
+ */
+typedef struct TrabalhadorRotas
+{
+    struct Resolvedor *resolvedor;
+    int id;
+    pthread_mutex_t trava; // Protege o deque
+    TarefaRota *deque;
+    int baseDeque;
+    int topoDeque;
+    int capacidadeDeque;
+    uint32_t *trilha;      // Salas da rota atual, da raiz até a sala atual
+    char *rota;            // 'e' ou 'd' usado para entrar em cada sala da trilha
+    uint32_t *ancestrais;  // Auxiliar para reconstruir a rota de uma subárvore roubada
+    uint32_t profundidade; // Salas na trilha
+    uint32_t capacidadeTrilha;
+    uint32_t *ocorrencias; // Por texto de pista: quantas vezes ele aparece na rota
+    int pistasNaRota;      // Pistas distintas na rota
+    int *citacoes;         // Por suspeito
+    int *porContagem;      // Quantos suspeitos têm cada número de citações
+    int *xorPorContagem;   // XOR dos ids desses suspeitos (o id, quando só há um)
+    int capacidadeContagem;
+    int maximo; // Maior número de citações na rota
+    long *vereditos; // Por suspeito: rotas em que ele é o único mais citado
+    long folhas;
+    long empates;
+    long semPistas;
+    long roubos;
+    unsigned long long somaProfundidades;
+    uint32_t maiorProfundidade;
+    Renderizador saida; // Relatório por rota (cada trabalhador escreve o seu)
+} TrabalhadorRotas;
+
+/**
+ * @brief Resolvedor: a mansão (só leitura), o pai de cada sala e os trabalhadores.
+ * 'ativos' conta os trabalhadores que ainda têm rotas para explorar; quando chega a zero
+ * com todos os deques vazios, a mansão inteira foi percorrida.
+ */
+typedef struct Resolvedor
+{
+    const Mansao *mansao;
+    uint32_t *pais;
+    TrabalhadorRotas *trabalhadores;
+    int numTrabalhadores;
+    pthread_mutex_t trava; // Protege 'ativos'
+    int ativos;
+    pthread_mutex_t travaSaida; // Um relatório descarregado por vez (um pipe só garante 4 KiB atômicos)
+} Resolvedor;
+
+// --- 14. ESTRUTURA DOS MOTORES EM PARALELO (--motores) ---
+
+/**
+ * @brief Um motor do jogo rodando em uma thread: a sessão é criada pela própria thread
+ * sobre a mansão compartilhada (só leitura), com um gerador próprio. Os totais só são
+ * lidos depois do join, então nada aqui precisa de trava.
+ */
+typedef struct MotorJogo
+{
+    const Mansao *mansao;
+    unsigned long long semente;
+    long investigacoes;
+    long passos;    // Passos que mudaram de sala (movimentos, voltas e teleportes)
+    long vereditos; // Investigações com um único suspeito mais citado
+    unsigned long long assinatura; // Mistura das deduções, na ordem em que saíram
+} MotorJogo;
+
 // ==========================================================
-//                 FUNÇÕES DA TABELA HASH
+//                ARENA (ALOCAÇÃO EM BLOCOS)
 // ==========================================================
 
 /**
- * @brief Função de espalhamento (Hashing Function).
- * Baseada na soma dos valores ASCII dos 4 primeiros caracteres da pista.
- * @param chave A string (pista) a ser hasheada.
- * @return O índice da tabela hash (0 a TAMANHO_HASH - 1).
+ * @brief Prepara uma arena vazia (o primeiro bloco é criado na primeira alocação).
+ */
+void iniciarArena(Arena *arena)
+{
+    arena->primeiro = NULL;
+    arena->atual = NULL;
+}
+
+/**
+ * @brief Aloca 'tamanho' bytes (alinhados em 8) avançando o ponteiro do bloco atual.
+ * Quando o bloco enche, passa para o próximo já existente ou cria um bloco maior.
+ */
+void *alocarNaArena(Arena *arena, size_t tamanho)
+{
+    tamanho = (tamanho + 7) & ~(size_t)7;
+    BlocoArena *bloco = arena->atual;
+
+    while (bloco == NULL || bloco->usado + tamanho > bloco->capacidade)
+    {
+        if (bloco != NULL && bloco->proximo != NULL)
+        {
+            // Reaproveita um bloco de antes do último reinício
+            bloco = bloco->proximo;
+            bloco->usado = 0;
+            continue;
+        }
+
+        size_t capacidade = bloco ? bloco->capacidade * 2 : TAMANHO_BLOCO_ARENA;
+        while (capacidade < tamanho)
+        {
+            capacidade *= 2;
+        }
+        BlocoArena *novo = (BlocoArena *)malloc(sizeof(BlocoArena) + capacidade);
+        if (novo == NULL)
+        {
+            perror("Erro ao alocar memória para a Arena");
+            exit(EXIT_FAILURE);
+        }
+        novo->proximo = NULL;
+        novo->usado = 0;
+        novo->capacidade = capacidade;
+        if (bloco == NULL)
+        {
+            arena->primeiro = novo;
+        }
+        else
+        {
+            bloco->proximo = novo;
+        }
+        bloco = novo;
+    }
+
+    arena->atual = bloco;
+    void *memoria = bloco->dados + bloco->usado;
+    bloco->usado += tamanho;
+    return memoria;
+}
+
+/**
+ * @brief Descarta tudo o que foi alocado, em O(1): os blocos ficam para as próximas alocações.
+ */
+void reiniciarArena(Arena *arena)
+{
+    arena->atual = arena->primeiro;
+    if (arena->primeiro != NULL)
+    {
+        arena->primeiro->usado = 0;
+    }
+}
+
+/**
+ * @brief Devolve todos os blocos da arena ao sistema.
+ */
+void liberarArena(Arena *arena)
+{
+    BlocoArena *bloco = arena->primeiro;
+    while (bloco != NULL)
+    {
+        BlocoArena *proximo = bloco->proximo;
+        free(bloco);
+        bloco = proximo;
+    }
+    iniciarArena(arena);
+}
+
+/**
+ * @brief Total de bytes reservados pelos blocos da arena (usados ou não).
+ */
+size_t bytesDaArena(const Arena *arena)
+{
+    size_t total = 0;
+    for (const BlocoArena *bloco = arena->primeiro; bloco != NULL; bloco = bloco->proximo)
+    {
+        total += sizeof(BlocoArena) + bloco->capacidade;
+    }
+    return total;
+}
+
+// ==========================================================
+//            RENDERIZADOR (SAÍDA BUFFERIZADA)
+// ==========================================================
+
+/**
+ * @brief Prepara um renderizador sobre 'descritor' com a verbosidade dada (VERBOSIDADE_*)
+ * e um buffer de 'capacidade' bytes.
+ */
+void iniciarSaida(Renderizador *saida, int descritor, int verbosidade, size_t capacidade)
+{
+    saida->descritor = descritor;
+    saida->verbosidade = verbosidade;
+    saida->buffer = (char *)malloc(capacidade);
+    if (saida->buffer == NULL)
+    {
+        perror("Erro ao alocar memória para a saída");
+        exit(EXIT_FAILURE);
+    }
+    saida->capacidade = capacidade;
+    saida->usado = 0;
+    saida->falhou = 0;
+    saida->memoria = NULL;
+    saida->tamanhoMemoria = 0;
+    saida->capacidadeMemoria = 0;
+}
+
+/**
+ * @brief Retorna 1 se a saída deve mostrar mensagens do nível pedido.
+ * Quem chama testa antes de formatar, então o que não aparece também não custa.
+ */
+int mostrar(const Renderizador *saida, int nivel)
+{
+    return saida->verbosidade >= nivel;
+}
+
+/**
+ * @brief Escreve 'tamanho' bytes direto no descritor, repetindo em escritas parciais.
+ * Um erro (ex.: o outro lado fechou) marca a saída como falha e descarta o resto.
+ * Com SAIDA_EM_MEMORIA os bytes são acrescentados à memória do renderizador.
+ */
+void escreverNoDescritor(Renderizador *saida, const char *dados, size_t tamanho)
+{
+    if (saida->descritor == SAIDA_EM_MEMORIA && tamanho > 0)
+    {
+        if (saida->tamanhoMemoria + tamanho > saida->capacidadeMemoria)
+        {
+            size_t novaCapacidade = saida->capacidadeMemoria ? saida->capacidadeMemoria * 2 : saida->capacidade;
+            while (novaCapacidade < saida->tamanhoMemoria + tamanho)
+            {
+                novaCapacidade *= 2;
+            }
+            char *nova = (char *)realloc(saida->memoria, novaCapacidade);
+            if (nova == NULL)
+            {
+                perror("Erro ao alocar memória para a saída");
+                exit(EXIT_FAILURE);
+            }
+            saida->memoria = nova;
+            saida->capacidadeMemoria = novaCapacidade;
+        }
+        memcpy(saida->memoria + saida->tamanhoMemoria, dados, tamanho);
+        saida->tamanhoMemoria += tamanho;
+        return;
+    }
+    while (tamanho > 0 && !saida->falhou)
+    {
+        ssize_t escritos = write(saida->descritor, dados, tamanho);
+        if (escritos < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            saida->falhou = 1;
+            return;
+        }
+        dados += escritos;
+        tamanho -= (size_t)escritos;
+    }
+}
+
+/**
+ * @brief Escreve tudo o que está no buffer com um único write() e esvazia o buffer.
  */
-int funcaoHash(const char *chave)
+void descarregarSaida(Renderizador *saida)
 {
-    unsigned int soma = 0;
-    for (int i = 0; i < 4 && chave[i] != '\0'; i++)
+    escreverNoDescritor(saida, saida->buffer, saida->usado);
+    saida->usado = 0;
+}
+
+/**
+ * @brief Acrescenta 'tamanho' bytes prontos ao buffer (sem formatação).
+ */
+void escreverBytes(Renderizador *saida, const char *texto, size_t tamanho)
+{
+    if (tamanho > saida->capacidade - saida->usado)
+    {
+        descarregarSaida(saida);
+        if (tamanho > saida->capacidade)
+        {
+            escreverNoDescritor(saida, texto, tamanho);
+            return;
+        }
+    }
+    memcpy(saida->buffer + saida->usado, texto, tamanho);
+    saida->usado += tamanho;
+}
+
+/**
+ * @brief Acrescenta um texto pronto ao buffer (sem formatação).
+ */
+void escreverTexto(Renderizador *saida, const char *texto)
+{
+    escreverBytes(saida, texto, strlen(texto));
+}
+
+/**
+ * @brief Formata (como printf) direto no buffer. Se não couber, descarrega e tenta de novo;
+ * um texto maior que o buffer inteiro é formatado à parte e escrito direto.
+ */
+void escrever(Renderizador *saida, const char *formato, ...)
+{
+    va_list argumentos;
+    size_t livre = saida->capacidade - saida->usado;
+    va_start(argumentos, formato);
+    int tamanho = vsnprintf(saida->buffer + saida->usado, livre, formato, argumentos);
+    va_end(argumentos);
+    if (tamanho < 0)
+    {
+        return;
+    }
+    if ((size_t)tamanho < livre)
+    {
+        saida->usado += (size_t)tamanho;
+        return;
+    }
+
+    descarregarSaida(saida);
+    if ((size_t)tamanho < saida->capacidade)
+    {
+        va_start(argumentos, formato);
+        vsnprintf(saida->buffer, saida->capacidade, formato, argumentos);
+        va_end(argumentos);
+        saida->usado = (size_t)tamanho;
+        return;
+    }
+
+    char *texto = (char *)malloc((size_t)tamanho + 1);
+    if (texto == NULL)
+    {
+        perror("Erro ao alocar memória para a saída");
+        exit(EXIT_FAILURE);
+    }
+    va_start(argumentos, formato);
+    vsnprintf(texto, (size_t)tamanho + 1, formato, argumentos);
+    va_end(argumentos);
+    escreverNoDescritor(saida, texto, (size_t)tamanho);
+    free(texto);
+}
+
+/**
+ * @brief Descarrega o que falta e libera o buffer (o descritor pertence a quem chamou).
+ */
+void liberarSaida(Renderizador *saida)
+{
+    descarregarSaida(saida);
+    free(saida->buffer);
+    free(saida->memoria);
+    saida->buffer = NULL;
+    saida->capacidade = 0;
+    saida->memoria = NULL;
+    saida->tamanhoMemoria = 0;
+    saida->capacidadeMemoria = 0;
+}
+
+/**
+ * @brief Converte o nome de uma verbosidade ("silenciosa", "resumo", "completa") na constante.
+ * @return A constante VERBOSIDADE_*, ou -1 se o nome for desconhecido.
+ */
+int verbosidadePorNome(const char *nome)
+{
+    if (strcmp(nome, "silenciosa") == 0)
+    {
+        return VERBOSIDADE_SILENCIOSA;
+    }
+    if (strcmp(nome, "resumo") == 0)
+    {
+        return VERBOSIDADE_RESUMO;
+    }
+    if (strcmp(nome, "completa") == 0)
+    {
+        return VERBOSIDADE_COMPLETA;
+    }
+    return -1;
+}
+
+// ==========================================================
+//          ESTATÍSTICAS DAS ESTRUTURAS (CONTADORES)
+// ==========================================================
+
+/**
+ * @brief Soma uma amostra no histograma. Só é chamada pela macro AMOSTRAR, ou seja,
+ * quando o programa é compilado com -DDQ_ESTATISTICAS.
+ */
+void registrarAmostra(Histograma *histograma, unsigned long long valor)
+{
+    int balde = valor < TAMANHO_HISTOGRAMA - 1 ? (int)valor : TAMANHO_HISTOGRAMA - 1;
+    histograma->baldes[balde]++;
+    histograma->soma += valor;
+    if (valor > histograma->maximo)
+    {
+        histograma->maximo = valor;
+    }
+}
+
+unsigned long long amostrasDe(const Histograma *histograma)
+{
+    unsigned long long total = 0;
+    for (int i = 0; i < TAMANHO_HISTOGRAMA; i++)
+    {
+        total += histograma->baldes[i];
+    }
+    return total;
+}
+
+/**
+ * @brief Mostra um histograma: resumo (amostras, média, máximo) e uma barra por balde não vazio.
+ */
+void mostrarHistograma(Renderizador *saida, const char *titulo, const Histograma *histograma)
+{
+    unsigned long long amostras = amostrasDe(histograma);
+    if (amostras == 0)
+    {
+        escrever(saida, "   %s: nenhuma amostra\n", titulo);
+        return;
+    }
+    unsigned long long maiorBalde = 0;
+    for (int i = 0; i < TAMANHO_HISTOGRAMA; i++)
+    {
+        if (histograma->baldes[i] > maiorBalde)
+        {
+            maiorBalde = histograma->baldes[i];
+        }
+    }
+    escrever(saida, "   %s: %llu amostra(s), média %.2f, máximo %llu\n",
+             titulo, amostras, (double)histograma->soma / amostras, histograma->maximo);
+    for (int i = 0; i < TAMANHO_HISTOGRAMA; i++)
+    {
+        if (histograma->baldes[i] == 0)
+        {
+            continue;
+        }
+        int barra = (int)((histograma->baldes[i] * 30 + maiorBalde - 1) / maiorBalde);
+        escrever(saida, "      %3d%s | ", i, i == TAMANHO_HISTOGRAMA - 1 ? "+" : " ");
+        for (int j = 0; j < barra; j++)
+        {
+            escreverTexto(saida, "█");
+        }
+        escrever(saida, " %llu\n", histograma->baldes[i]);
+    }
+}
+
+/**
+ * @brief Mostra os contadores e os histogramas de um contexto, sob um título.
+ */
+void mostrarContadores(Renderizador *saida, const char *titulo, const Estatisticas *estatisticas)
+{
+    escrever(saida, "\n📈 %s:\n"
+             "   Nós criados: %llu sala(s), %llu pista(s), %llu associação(ões)\n"
+             "   Duplicatas recusadas: %llu pista(s), %llu associação(ões)\n"
+             "   Redimensionamentos da Tabela Hash: %llu\n",
+             titulo, estatisticas->salasCriadas, estatisticas->pistasCriadas, estatisticas->associacoesCriadas,
+             estatisticas->pistasDuplicadas, estatisticas->associacoesDuplicadas, estatisticas->redimensionamentosHash);
+    mostrarHistograma(saida, "Sondagens por busca na Tabela Hash", &estatisticas->sondagensHash);
+    mostrarHistograma(saida, "Sondagens por busca no pool de strings", &estatisticas->sondagensPool);
+    mostrarHistograma(saida, "Profundidade das pistas novas na AVL", &estatisticas->profundidadePistas);
+}
+
+/**
+ * @brief Comando de estatísticas do jogo: os contadores da montagem da mansão e os da
+ * sessão que pediu (cada cliente do servidor vê os seus, sem somar os das outras sessões).
+ */
+void mostrarEstatisticas(Renderizador *saida, const Sessao *sessao)
+{
+    if (!ESTATISTICAS_ATIVAS)
+    {
+        escreverTexto(saida, "\n📈 Estatísticas desativadas nesta compilação (compile com -DDQ_ESTATISTICAS).\n");
+        return;
+    }
+    mostrarContadores(saida, "Estatísticas da montagem da mansão", &sessao->mansao->dicionario->estatisticas);
+    mostrarContadores(saida, "Estatísticas desta sessão", &sessao->estatisticas);
+}
+
+void gravarHistograma(Renderizador *saida, const char *nome, const Histograma *histograma)
+{
+    escrever(saida, ",\"%s\":{\"amostras\":%llu,\"soma\":%llu,\"maximo\":%llu,\"baldes\":[",
+             nome, amostrasDe(histograma), histograma->soma, histograma->maximo);
+    for (int i = 0; i < TAMANHO_HISTOGRAMA; i++)
+    {
+        escrever(saida, "%s%llu", i ? "," : "", histograma->baldes[i]);
+    }
+    escreverTexto(saida, "]}");
+}
+
+/**
+ * @brief Grava os contadores de um contexto como o objeto JSON '"nome":{...}'.
+ */
+void gravarContadores(Renderizador *saida, const char *nome, const Estatisticas *estatisticas)
+{
+    escrever(saida, "\"%s\":{\"salasCriadas\":%llu,\"pistasCriadas\":%llu,\"associacoesCriadas\":%llu,"
+             "\"pistasDuplicadas\":%llu,\"associacoesDuplicadas\":%llu,\"redimensionamentosHash\":%llu",
+             nome, estatisticas->salasCriadas, estatisticas->pistasCriadas, estatisticas->associacoesCriadas,
+             estatisticas->pistasDuplicadas, estatisticas->associacoesDuplicadas, estatisticas->redimensionamentosHash);
+    gravarHistograma(saida, "sondagensHash", &estatisticas->sondagensHash);
+    gravarHistograma(saida, "sondagensPool", &estatisticas->sondagensPool);
+    gravarHistograma(saida, "profundidadePistas", &estatisticas->profundidadePistas);
+    escreverTexto(saida, "}");
+}
+
+/**
+ * @brief Grava as estatísticas em JSON, numa linha, no arquivo indicado (ou em stderr,
+ * se 'caminho' for NULL): {"mansao":{...},"sessao":{...}}. O último balde de cada
+ * histograma acumula os valores maiores.
+ * @param mansao Contadores da montagem da mansão.
+ * @param sessao Contadores da sessão do processo (NULL nos modos com várias sessões: fica de fora).
+ * @return 1 em caso de sucesso, 0 se o arquivo não pôde ser criado.
+ */
+int gravarEstatisticas(const char *caminho, const Estatisticas *mansao, const Estatisticas *sessao)
+{
+    int descritor = caminho != NULL ? open(caminho, O_WRONLY | O_CREAT | O_TRUNC, 0644) : STDERR_FILENO;
+    if (descritor < 0)
+    {
+        perror("Erro ao criar o arquivo de estatísticas");
+        return 0;
+    }
+    Renderizador saida;
+    iniciarSaida(&saida, descritor, VERBOSIDADE_COMPLETA, TAMANHO_BUFFER_SAIDA);
+    escreverTexto(&saida, "{");
+    gravarContadores(&saida, "mansao", mansao);
+    if (sessao != NULL)
+    {
+        escreverTexto(&saida, ",");
+        gravarContadores(&saida, "sessao", sessao);
+    }
+    escreverTexto(&saida, "}\n");
+    liberarSaida(&saida);
+    if (caminho != NULL)
+    {
+        close(descritor);
+    }
+    return 1;
+}
+
+// ==========================================================
+//                 FUNÇÕES DA TABELA HASH
+// ==========================================================
+
+/**
+ * @brief FNV-1a de 32 bits sobre a string inteira, byte a byte.
+ */
+unsigned int hashFnv1a(const char *chave)
+{
+    unsigned int hash = 2166136261u;
+    for (int i = 0; chave[i] != '\0'; i++)
+    {
+        hash ^= (unsigned char)chave[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * @brief Multiplica 64 x 64 -> 128 bits e junta as duas metades com XOR.
+ * Sem inteiro de 128 bits no compilador, o produto é montado com quatro multiplicações
+ * de 32 x 32 bits; o resultado é o mesmo nos dois casos.
+ */
+uint64_t misturar64(uint64_t a, uint64_t b)
+{
+#ifdef __SIZEOF_INT128__
+    __uint128_t produto = (__uint128_t)a * b;
+    return (uint64_t)produto ^ (uint64_t)(produto >> 64);
+#else
+    uint64_t aBaixo = a & 0xffffffffull, aAlto = a >> 32;
+    uint64_t bBaixo = b & 0xffffffffull, bAlto = b >> 32;
+    uint64_t baixoBaixo = aBaixo * bBaixo, baixoAlto = aBaixo * bAlto;
+    uint64_t altoBaixo = aAlto * bBaixo, altoAlto = aAlto * bAlto;
+    // Coluna do meio: a parte alta de baixoBaixo mais as partes baixas dos produtos
+    // cruzados (cabe em 64 bits: no máximo 3 x (2^32 - 1))
+    uint64_t meio = (baixoBaixo >> 32) + (baixoAlto & 0xffffffffull) + (altoBaixo & 0xffffffffull);
+    uint64_t metadeBaixa = (meio << 32) | (baixoBaixo & 0xffffffffull);
+    uint64_t metadeAlta = altoAlto + (baixoAlto >> 32) + (altoBaixo >> 32) + (meio >> 32);
+    return metadeBaixa ^ metadeAlta;
+#endif
+}
+
+/**
+ * @brief Hash de 8 em 8 bytes: cada palavra passa por uma multiplicação de 128 bits,
+ * e o final é misturado de novo para espalhar os bits altos nos baixos.
+ */
+unsigned int hashMistura64(const char *chave)
+{
+    size_t tamanho = strlen(chave);
+    uint64_t hash = 0x243f6a8885a308d3ull ^ tamanho;
+    size_t i = 0;
+    for (; i + 8 <= tamanho; i += 8)
+    {
+        uint64_t palavra;
+        memcpy(&palavra, chave + i, sizeof(palavra));
+        hash = misturar64(hash ^ palavra, 0x9e3779b97f4a7c15ull);
+    }
+    uint64_t resto = 0;
+    memcpy(&resto, chave + i, tamanho - i);
+    hash = misturar64(hash ^ resto, 0xbf58476d1ce4e5b9ull);
+    hash = misturar64(hash, 0x94d049bb133111ebull);
+    return (unsigned int)(hash ^ (hash >> 32));
+}
+
+/**
+ * @brief Hash de 8 em 8 bytes com o mínimo de trabalho por palavra: XOR, uma multiplicação
+ * de 64 bits e uma dobra. A multiplicação só leva cada bit para cima; sem a dobra (hash >> 32),
+ * a diferença nos bytes altos de uma palavra nunca chegaria aos bits baixos.
+ */
+unsigned int hashPalavras(const char *chave)
+{
+    size_t tamanho = strlen(chave);
+    uint64_t hash = tamanho;
+    size_t i = 0;
+    for (; i + 8 <= tamanho; i += 8)
+    {
+        uint64_t palavra;
+        memcpy(&palavra, chave + i, sizeof(palavra));
+        hash = (hash ^ palavra) * 0x517cc1b727220a95ull;
+        hash ^= hash >> 32;
+    }
+    uint64_t resto = 0;
+    memcpy(&resto, chave + i, tamanho - i);
+    hash = (hash ^ resto) * 0x517cc1b727220a95ull;
+    hash = (hash ^ (hash >> 32)) * 0x517cc1b727220a95ull;
+    return (unsigned int)(hash >> 32);
+}
+
+/**
+ * @brief Função de espalhamento (Hashing Function) usada pelo pool e pelas tabelas.
+ * É a escolhida em FUNCAO_HASH na compilação (padrão: FNV-1a); todas usam a string inteira,
+ * para que pistas com o mesmo prefixo não colidam.
+ * @param chave A string (pista) a ser hasheada.
+ * @return O hash completo; o índice do slot é obtido com (hash & (capacidade - 1)).
+ */
+unsigned int funcaoHash(const char *chave)
+{
+#if FUNCAO_HASH == HASH_MISTURA64
+    return hashMistura64(chave);
+#elif FUNCAO_HASH == HASH_PALAVRAS
+    return hashPalavras(chave);
+#else
+    return hashFnv1a(chave);
+#endif
+}
+
+// --- Pool de Strings ---
+
+/**
+ * @brief Aloca um índice de endereçamento aberto vazio com a capacidade indicada.
+ */
+int *alocarIndice(int capacidade)
+{
+    int *slots = (int *)malloc(sizeof(int) * capacidade);
+    if (slots == NULL)
+    {
+        perror("Erro ao alocar memória para o índice");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < capacidade; i++)
+    {
+        slots[i] = SLOT_VAZIO;
+    }
+    return slots;
+}
+
+/**
+ * @brief Retorna o texto de um id do dicionário.
+ * O ponteiro só é válido até a próxima chamada de internar() no mesmo dicionário.
+ */
+const char *textoDe(const Dicionario *dicionario, int id)
+{
+    return dicionario->pool.dados + dicionario->pool.offsets[id];
+}
+
+/**
+ * @brief Procura o slot de um texto no índice do pool (sondagem linear).
+ * @param estatisticas Onde contar as sondagens (NULL = não contar).
+ * @return O slot que contém o id do texto ou o primeiro slot vazio da sequência.
+ */
+int *localizarString(PoolStrings *pool, const char *texto, unsigned int hash, Estatisticas *estatisticas)
+{
+    unsigned int mascara = (unsigned int)pool->capacidade - 1;
+    unsigned int i = hash & mascara;
+    unsigned int sondagens = 1;
+    while (pool->slots[i] != SLOT_VAZIO)
+    {
+        int id = pool->slots[i];
+        if (pool->hashes[id] == hash && strcmp(pool->dados + pool->offsets[id], texto) == 0)
+        {
+            AMOSTRAR(estatisticas, sondagensPool, sondagens);
+            return &pool->slots[i];
+        }
+        i = (i + 1) & mascara;
+        sondagens++;
+    }
+    AMOSTRAR(estatisticas, sondagensPool, sondagens);
+    return &pool->slots[i];
+}
+
+/**
+ * @brief Dobra o índice do pool (ou cria, se ainda não existe) e redistribui os ids
+ * usando os hashes guardados.
+ */
+void redimensionarPool(PoolStrings *pool)
+{
+    int novaCapacidade = pool->capacidade ? pool->capacidade * 2 : TAMANHO_HASH;
+    while ((pool->quantidade + 1) * CARGA_MAXIMA_DEN > novaCapacidade * CARGA_MAXIMA_NUM)
+    {
+        novaCapacidade *= 2;
+    }
+    int *novos = alocarIndice(novaCapacidade);
+    unsigned int mascara = (unsigned int)novaCapacidade - 1;
+
+    for (int id = 0; id < pool->quantidade; id++)
+    {
+        unsigned int j = pool->hashes[id] & mascara;
+        while (novos[j] != SLOT_VAZIO)
+        {
+            j = (j + 1) & mascara;
+        }
+        novos[j] = id;
+    }
+
+    free(pool->slots);
+    pool->slots = novos;
+    pool->capacidade = novaCapacidade;
+}
+
+/**
+ * @brief Consulta o id de um texto sem internar.
+ * @param estatisticas Onde contar as sondagens: as de quem consulta, não as do dicionário.
+ * @return O id do texto ou -1 se ele nunca foi internado.
+ */
+int buscarString(Dicionario *dicionario, const char *texto, Estatisticas *estatisticas)
+{
+    if (dicionario->pool.capacidade == 0)
+    {
+        redimensionarPool(&dicionario->pool); // Pool adotado de um mapa: o índice é montado na primeira busca
+    }
+    return *localizarString(&dicionario->pool, texto, funcaoHash(texto), estatisticas);
+}
+
+/**
+ * @brief Copia para memória própria os arrays de um pool adotado de um mapa compilado,
+ * para que ele possa crescer.
+ */
+void garantirPoolProprio(PoolStrings *pool)
+{
+    if (!pool->emprestado)
+    {
+        return;
+    }
+    char *dados = (char *)malloc(pool->usado);
+    unsigned int *offsets = (unsigned int *)malloc(sizeof(unsigned int) * pool->quantidade);
+    unsigned int *hashes = (unsigned int *)malloc(sizeof(unsigned int) * pool->quantidade);
+    if (dados == NULL || offsets == NULL || hashes == NULL)
+    {
+        perror("Erro ao alocar memória para o pool de strings");
+        exit(EXIT_FAILURE);
+    }
+    memcpy(dados, pool->dados, pool->usado);
+    memcpy(offsets, pool->offsets, sizeof(unsigned int) * pool->quantidade);
+    memcpy(hashes, pool->hashes, sizeof(unsigned int) * pool->quantidade);
+    pool->dados = dados;
+    pool->offsets = offsets;
+    pool->hashes = hashes;
+    pool->capacidadeDados = pool->usado;
+    pool->capacidadeIds = pool->quantidade;
+    pool->emprestado = 0;
+}
+
+/**
+ * @brief Encerra o programa se alguém tenta escrever em um dicionário congelado: as
+ * sessões o leem sem travas, então um texto ou suspeito novo seria uma corrida.
+ */
+void exigirDicionarioAberto(const Dicionario *dicionario, const char *operacao)
+{
+    if (dicionario->congelado)
+    {
+        fprintf(stderr, "Erro: %s em um dicionário congelado.\n", operacao);
+        exit(EXIT_FAILURE);
+    }
+}
+
+/**
+ * @brief Interna um texto: devolve o id existente ou copia o texto para o pool.
+ * Um texto novo exige o dicionário aberto (ver congelarDicionario).
+ * @return O id do texto.
+ */
+int internar(Dicionario *dicionario, const char *texto)
+{
+    PoolStrings *pool = &dicionario->pool;
+    if ((pool->quantidade + 1) * CARGA_MAXIMA_DEN > pool->capacidade * CARGA_MAXIMA_NUM)
+    {
+        redimensionarPool(pool);
+    }
+
+    unsigned int hash = funcaoHash(texto);
+    int *slot = localizarString(pool, texto, hash, &dicionario->estatisticas);
+    if (*slot != SLOT_VAZIO)
+    {
+        return *slot;
+    }
+
+    exigirDicionarioAberto(dicionario, "texto novo");
+    garantirPoolProprio(pool);
+    size_t tamanho = strlen(texto) + 1;
+    if (pool->usado + tamanho > pool->capacidadeDados)
+    {
+        size_t novaCapacidade = pool->capacidadeDados ? pool->capacidadeDados * 2 : 1024;
+        while (novaCapacidade < pool->usado + tamanho)
+        {
+            novaCapacidade *= 2;
+        }
+        char *novos = (char *)realloc(pool->dados, novaCapacidade);
+        if (novos == NULL)
+        {
+            perror("Erro ao alocar memória para o pool de strings");
+            exit(EXIT_FAILURE);
+        }
+        pool->dados = novos;
+        pool->capacidadeDados = novaCapacidade;
+    }
+
+    if (pool->quantidade == pool->capacidadeIds)
+    {
+        int novaCapacidade = pool->capacidadeIds ? pool->capacidadeIds * 2 : TAMANHO_HASH;
+        unsigned int *offsets = (unsigned int *)realloc(pool->offsets, sizeof(unsigned int) * novaCapacidade);
+        unsigned int *hashes = (unsigned int *)realloc(pool->hashes, sizeof(unsigned int) * novaCapacidade);
+        if (offsets == NULL || hashes == NULL)
+        {
+            perror("Erro ao alocar memória para o pool de strings");
+            exit(EXIT_FAILURE);
+        }
+        pool->offsets = offsets;
+        pool->hashes = hashes;
+        pool->capacidadeIds = novaCapacidade;
+    }
+
+    int id = pool->quantidade++;
+    pool->offsets[id] = (unsigned int)pool->usado;
+    pool->hashes[id] = hash;
+    memcpy(pool->dados + pool->usado, texto, tamanho);
+    pool->usado += tamanho;
+    *slot = id;
+    return id;
+}
+
+/**
+ * @brief Libera a memória alocada para o pool de strings.
+ */
+void liberarPool(PoolStrings *pool)
+{
+    if (!pool->emprestado)
+    {
+        free(pool->dados);
+        free(pool->offsets);
+        free(pool->hashes);
+    }
+    free(pool->slots);
+    memset(pool, 0, sizeof(*pool));
+}
+
+/**
+ * @brief Troca o conteúdo do pool do dicionário pelos textos de um mapa compilado, sem
+ * copiar nada. O índice de busca só é montado se alguém buscar ou internar um texto.
+ */
+void adotarPoolMapeado(Dicionario *dicionario, const char *dados, size_t usado, const uint32_t *offsets,
+                       const uint32_t *hashes, int quantidade)
+{
+    PoolStrings *pool = &dicionario->pool;
+    liberarPool(pool);
+    pool->dados = (char *)dados;
+    pool->usado = usado;
+    pool->capacidadeDados = usado;
+    pool->offsets = (unsigned int *)offsets;
+    pool->hashes = (unsigned int *)hashes;
+    pool->quantidade = quantidade;
+    pool->capacidadeIds = quantidade;
+    pool->emprestado = 1;
+}
+
+// --- Registro de Suspeitos ---
+
+/**
+ * @brief Consulta o id de um suspeito pelo nome.
+ * @param estatisticas Onde contar as sondagens (NULL = não contar).
+ * @return O id do suspeito ou -1 se ele não foi registrado.
+ */
+int buscarSuspeito(Dicionario *dicionario, const char *nome, Estatisticas *estatisticas)
+{
+    const RegistroSuspeitos *registro = &dicionario->suspeitos;
+    int nomeId = buscarString(dicionario, nome, estatisticas);
+    if (nomeId < 0 || nomeId >= registro->capacidadeMapa)
+    {
+        return -1;
+    }
+    return registro->idPorString[nomeId];
+}
+
+/**
+ * @brief Registra um suspeito (se ainda não existir).
+ * Para um suspeito já registrado só há leituras, então chamar isto durante as sessões
+ * é seguro quando todos os suspeitos vieram do mapa.
+ * @param nome Id do nome do suspeito no pool de strings.
+ * @return O id do suspeito.
+ */
+int registrarSuspeito(Dicionario *dicionario, int nome)
+{
+    RegistroSuspeitos *registro = &dicionario->suspeitos;
+    if (nome >= registro->capacidadeMapa || registro->idPorString[nome] < 0)
+    {
+        exigirDicionarioAberto(dicionario, "suspeito novo");
+    }
+    if (nome >= registro->capacidadeMapa)
+    {
+        int novaCapacidade = registro->capacidadeMapa ? registro->capacidadeMapa : TAMANHO_HASH;
+        while (novaCapacidade <= nome)
+        {
+            novaCapacidade *= 2;
+        }
+        int *novo = (int *)realloc(registro->idPorString, sizeof(int) * novaCapacidade);
+        if (novo == NULL)
+        {
+            perror("Erro ao alocar memória para o Registro de Suspeitos");
+            exit(EXIT_FAILURE);
+        }
+        for (int i = registro->capacidadeMapa; i < novaCapacidade; i++)
+        {
+            novo[i] = -1;
+        }
+        registro->idPorString = novo;
+        registro->capacidadeMapa = novaCapacidade;
+    }
+
+    if (registro->idPorString[nome] >= 0)
+    {
+        return registro->idPorString[nome];
+    }
+
+    if (registro->quantidade == registro->capacidadeLista)
+    {
+        int novaCapacidade = registro->capacidadeLista ? registro->capacidadeLista * 2 : TAMANHO_HASH;
+        Suspeito *nova = (Suspeito *)realloc(registro->lista, sizeof(Suspeito) * novaCapacidade);
+        if (nova == NULL)
+        {
+            perror("Erro ao alocar memória para Suspeito");
+            exit(EXIT_FAILURE);
+        }
+        registro->lista = nova;
+        registro->capacidadeLista = novaCapacidade;
+    }
+
+    int id = registro->quantidade++;
+    registro->lista[id].nome = nome;
+    registro->idPorString[nome] = id;
+    return id;
+}
+
+/**
+ * @brief Nome de um suspeito registrado.
+ */
+const char *nomeDoSuspeito(const Dicionario *dicionario, int id)
+{
+    return textoDe(dicionario, dicionario->suspeitos.lista[id].nome);
+}
+
+// --- Listas de Suspeitos com Pesos ---
+
+/**
+ * @brief Copia para memória própria as listas adotadas de um mapa compilado, para que
+ * possam crescer.
+ */
+void garantirListasProprias(ListasImplicacoes *listas)
+{
+    if (!listas->emprestado)
+    {
+        return;
+    }
+    uint32_t *inicios = (uint32_t *)malloc(sizeof(uint32_t) * (listas->quantidade + 1));
+    Implicacao *pares = (Implicacao *)malloc(sizeof(Implicacao) * (listas->numPares ? listas->numPares : 1));
+    if (inicios == NULL || pares == NULL)
+    {
+        perror("Erro ao alocar memória para as listas de suspeitos");
+        exit(EXIT_FAILURE);
+    }
+    memcpy(inicios, listas->inicios, sizeof(uint32_t) * (listas->quantidade + 1));
+    if (listas->numPares > 0)
+    {
+        memcpy(pares, listas->pares, sizeof(Implicacao) * listas->numPares);
+    }
+    listas->inicios = inicios;
+    listas->pares = pares;
+    listas->capacidadeListas = listas->quantidade + 1;
+    listas->capacidadePares = listas->numPares ? listas->numPares : 1;
+    listas->emprestado = 0;
+}
+
+/**
+ * @brief Acrescenta ao dicionário uma lista com os 'quantidade' pares dados.
+ * Exige o dicionário aberto (ver congelarDicionario).
+ * @return O id da nova lista.
+ */
+uint32_t criarListaDeImplicacoes(Dicionario *dicionario, const Implicacao *pares, uint32_t quantidade)
+{
+    exigirDicionarioAberto(dicionario, "lista de suspeitos nova");
+    ListasImplicacoes *listas = &dicionario->implicacoes;
+    garantirListasProprias(listas);
+    if (listas->quantidade + 2 > listas->capacidadeListas)
+    {
+        uint32_t novaCapacidade = listas->capacidadeListas ? listas->capacidadeListas * 2 : TAMANHO_HASH;
+        uint32_t *novos = (uint32_t *)realloc(listas->inicios, sizeof(uint32_t) * novaCapacidade);
+        if (novos == NULL)
+        {
+            perror("Erro ao alocar memória para as listas de suspeitos");
+            exit(EXIT_FAILURE);
+        }
+        if (listas->inicios == NULL)
+        {
+            novos[0] = 0;
+        }
+        listas->inicios = novos;
+        listas->capacidadeListas = novaCapacidade;
+    }
+    if (listas->numPares + quantidade > listas->capacidadePares)
+    {
+        uint32_t novaCapacidade = listas->capacidadePares ? listas->capacidadePares * 2 : TAMANHO_HASH;
+        while (novaCapacidade < listas->numPares + quantidade)
+        {
+            novaCapacidade *= 2;
+        }
+        Implicacao *novos = (Implicacao *)realloc(listas->pares, sizeof(Implicacao) * novaCapacidade);
+        if (novos == NULL)
+        {
+            perror("Erro ao alocar memória para as listas de suspeitos");
+            exit(EXIT_FAILURE);
+        }
+        listas->pares = novos;
+        listas->capacidadePares = novaCapacidade;
+    }
+    if (quantidade > 0)
+    {
+        memcpy(listas->pares + listas->numPares, pares, sizeof(Implicacao) * quantidade);
+    }
+    listas->numPares += quantidade;
+    listas->inicios[++listas->quantidade] = listas->numPares;
+    return listas->quantidade - 1;
+}
+
+/**
+ * @brief Pares (suspeito, peso) de uma lista do dicionário.
+ * @param quantidade Recebe quantos pares a lista tem.
+ */
+const Implicacao *paresDaLista(const Dicionario *dicionario, uint32_t lista, uint32_t *quantidade)
+{
+    const ListasImplicacoes *listas = &dicionario->implicacoes;
+    *quantidade = listas->inicios[lista + 1] - listas->inicios[lista];
+    return *quantidade > 0 ? listas->pares + listas->inicios[lista] : NULL;
+}
+
+/**
+ * @brief Suspeitos implicados pela pista de uma sala, com os pesos: a lista da sala ou,
+ * sem lista, o suspeito da sala com peso 1 (nenhum, se a sala não tem suspeito).
+ * @param unico Onde montar o par do suspeito da sala quando ela não tem lista.
+ * @param quantidade Recebe quantos pares há.
+ */
+const Implicacao *implicacoesDaSala(const Dicionario *dicionario, const SalaCompilada *sala, Implicacao *unico,
+                                    uint32_t *quantidade)
+{
+    if (sala->implicacoes != LISTA_VAZIA)
+    {
+        return paresDaLista(dicionario, sala->implicacoes, quantidade);
+    }
+    unico->suspeito = sala->suspeito;
+    unico->peso = 1;
+    *quantidade = sala->suspeito != STRING_VAZIA;
+    return unico;
+}
+
+/**
+ * @brief Troca as listas do dicionário pelas de um mapa compilado, sem copiar nada
+ * (como adotarPoolMapeado). A lista 0 do arquivo é a LISTA_VAZIA.
+ */
+void adotarListasMapeadas(Dicionario *dicionario, const uint32_t *inicios, const Implicacao *pares,
+                          uint32_t quantidade, uint32_t numPares)
+{
+    ListasImplicacoes *listas = &dicionario->implicacoes;
+    if (!listas->emprestado)
+    {
+        free(listas->inicios);
+        free(listas->pares);
+    }
+    listas->inicios = (uint32_t *)inicios;
+    listas->pares = (Implicacao *)pares;
+    listas->quantidade = quantidade;
+    listas->numPares = numPares;
+    listas->capacidadeListas = quantidade + 1;
+    listas->capacidadePares = numPares;
+    listas->emprestado = 1;
+}
+
+/**
+ * @brief Inicializa um dicionário vazio: o pool já com a string vazia no id STRING_VAZIA,
+ * nenhum suspeito registrado e só a lista LISTA_VAZIA.
+ */
+void iniciarDicionario(Dicionario *dicionario)
+{
+    memset(dicionario, 0, sizeof(*dicionario));
+    internar(dicionario, "");
+    criarListaDeImplicacoes(dicionario, NULL, 0);
+}
+
+/**
+ * @brief Libera o pool, o registro e as listas do dicionário.
+ */
+void liberarDicionario(Dicionario *dicionario)
+{
+    liberarPool(&dicionario->pool);
+    free(dicionario->suspeitos.lista);
+    free(dicionario->suspeitos.idPorString);
+    if (!dicionario->implicacoes.emprestado)
+    {
+        free(dicionario->implicacoes.inicios);
+        free(dicionario->implicacoes.pares);
+    }
+    memset(dicionario, 0, sizeof(*dicionario));
+}
+
+/**
+ * @brief Garante espaço no placar para os suspeitos [0, quantidade). Os novos entram no
+ * fim do ranking, no grupo de zero citações.
+ */
+void incluirNoPlacar(Placar *placar, int quantidade)
+{
+    if (quantidade > placar->capacidade)
+    {
+        int novaCapacidade = placar->capacidade ? placar->capacidade : TAMANHO_HASH;
+        while (novaCapacidade < quantidade)
+        {
+            novaCapacidade *= 2;
+        }
+        int *citacoes = (int *)realloc(placar->citacoes, sizeof(int) * novaCapacidade);
+        int *ranking = (int *)realloc(placar->ranking, sizeof(int) * novaCapacidade);
+        int *posicao = (int *)realloc(placar->posicao, sizeof(int) * novaCapacidade);
+        if (citacoes == NULL || ranking == NULL || posicao == NULL)
+        {
+            perror("Erro ao alocar memória para o Placar");
+            exit(EXIT_FAILURE);
+        }
+        placar->citacoes = citacoes;
+        placar->ranking = ranking;
+        placar->posicao = posicao;
+        placar->capacidade = novaCapacidade;
+    }
+    for (int id = placar->numSuspeitos; id < quantidade; id++)
+    {
+        placar->citacoes[id] = 0;
+        placar->ranking[id] = id;
+        placar->posicao[id] = id;
+    }
+    if (quantidade > placar->numSuspeitos)
+    {
+        placar->numSuspeitos = quantidade;
+    }
+}
+
+/**
+ * @brief Soma uma citação ao suspeito e atualiza o ranking em O(1).
+ * As contagens só crescem de um em um: o suspeito troca de lugar com o primeiro do seu
+ * grupo e esse grupo passa a começar uma posição depois, então ele vira o último do
+ * grupo de cima. Os empatados continuam contíguos.
+ */
+void registrarCitacao(Placar *placar, int id)
+{
+    int registrados = placar->dicionario->suspeitos.quantidade;
+    if (id >= placar->numSuspeitos || placar->numSuspeitos < registrados)
+    {
+        incluirNoPlacar(placar, id + 1 > registrados ? id + 1 : registrados);
+    }
+
+    int citacoes = placar->citacoes[id];
+    if (citacoes + 1 >= placar->capacidadeAcima)
+    {
+        int novaCapacidade = placar->capacidadeAcima ? placar->capacidadeAcima * 2 : TAMANHO_HASH;
+        int *acima = (int *)realloc(placar->acima, sizeof(int) * novaCapacidade);
+        if (acima == NULL)
+        {
+            perror("Erro ao alocar memória para o Placar");
+            exit(EXIT_FAILURE);
+        }
+        memset(acima + placar->capacidadeAcima, 0, sizeof(int) * (novaCapacidade - placar->capacidadeAcima));
+        placar->acima = acima;
+        placar->capacidadeAcima = novaCapacidade;
+    }
+
+    int posicao = placar->posicao[id];
+    int primeiro = placar->acima[citacoes];
+    int outro = placar->ranking[primeiro];
+    placar->ranking[posicao] = outro;
+    placar->posicao[outro] = posicao;
+    placar->ranking[primeiro] = id;
+    placar->posicao[id] = primeiro;
+    placar->acima[citacoes]++;
+
+    placar->citacoes[id] = citacoes + 1;
+    if (citacoes + 1 > placar->maxCitacoes)
+    {
+        placar->maxCitacoes = citacoes + 1;
+    }
+}
+
+/**
+ * @brief Citações de um suspeito no placar (0 se ele nunca foi citado).
+ */
+int citacoesDe(const Placar *placar, int id)
+{
+    return id < placar->numSuspeitos ? placar->citacoes[id] : 0;
+}
+
+/**
+ * @brief Quantos suspeitos têm mais de 'citacoes' citações (onde começa o grupo delas).
+ */
+int suspeitosAcimaDe(const Placar *placar, int citacoes)
+{
+    return citacoes < placar->capacidadeAcima ? placar->acima[citacoes] : 0;
+}
+
+/**
+ * @brief Tamanho do ranking: todos os suspeitos registrados, citados ou não.
+ */
+int tamanhoDoRanking(const Placar *placar)
+{
+    int registrados = placar->dicionario->suspeitos.quantidade;
+    return placar->numSuspeitos > registrados ? placar->numSuspeitos : registrados;
+}
+
+/**
+ * @brief Suspeito em uma posição do ranking (0 é o mais citado). Quem foi registrado
+ * depois da última citação ainda não está no array e fica no fim, em ordem de id.
+ */
+int suspeitoNaPosicao(const Placar *placar, int posicao)
+{
+    return posicao < placar->numSuspeitos ? placar->ranking[posicao] : posicao;
+}
+
+/**
+ * @brief Posição de um suspeito no ranking (a mesma base de suspeitoNaPosicao).
+ */
+int posicaoNoRanking(const Placar *placar, int id)
+{
+    return id < placar->numSuspeitos ? placar->posicao[id] : id;
+}
+
+/**
+ * @brief Grupo de empate que contém a posição dada: os suspeitos com o mesmo número de
+ * citações ocupam as posições [inicio, inicio + quantidade) do ranking.
+ */
+GrupoRanking grupoNaPosicao(const Placar *placar, int posicao)
+{
+    GrupoRanking grupo;
+    grupo.citacoes = citacoesDe(placar, suspeitoNaPosicao(placar, posicao));
+    grupo.inicio = suspeitosAcimaDe(placar, grupo.citacoes);
+    int fim = grupo.citacoes == 0 ? tamanhoDoRanking(placar) : suspeitosAcimaDe(placar, grupo.citacoes - 1);
+    grupo.quantidade = fim - grupo.inicio;
+    return grupo;
+}
+
+/**
+ * @brief Copia os ids dos 'k' suspeitos mais citados, em ordem de ranking.
+ * @return Quantos ids foram copiados (menos que 'k' se houver menos suspeitos).
+ */
+int melhoresSuspeitos(const Placar *placar, int k, int *ids)
+{
+    int total = tamanhoDoRanking(placar);
+    int quantidade = k < total ? k : total;
+    for (int i = 0; i < quantidade; i++)
+    {
+        ids[i] = suspeitoNaPosicao(placar, i);
+    }
+    return quantidade;
+}
+
+/**
+ * @brief Consulta o suspeito mais citado em O(1).
+ * Enquanto ninguém foi citado, todos os suspeitos registrados empatam com zero.
+ * @param empate Recebe 1 se outro suspeito tem o mesmo número de citações do líder.
+ * @return O id do líder ou -1 se não há suspeitos registrados.
+ */
+int suspeitoMaisCitado(const Placar *placar, int *empate)
+{
+    if (placar->maxCitacoes == 0)
+    {
+        int registrados = placar->dicionario->suspeitos.quantidade;
+        *empate = registrados > 1;
+        return registrados > 0 ? 0 : -1;
+    }
+    *empate = grupoNaPosicao(placar, 0).quantidade > 1;
+    return placar->ranking[0];
+}
+
+/**
+ * @brief Zera as citações de todos os suspeitos, mantendo a memória do placar.
+ * A ordem do ranking fica como está: com todos em zero, qualquer permutação vale.
+ */
+void zerarCitacoes(Placar *placar)
+{
+    if (placar->maxCitacoes > 0)
+    {
+        memset(placar->citacoes, 0, sizeof(int) * placar->numSuspeitos);
+        memset(placar->acima, 0, sizeof(int) * placar->capacidadeAcima);
+    }
+    placar->maxCitacoes = 0;
+}
+
+/**
+ * @brief Inicializa um placar vazio dos suspeitos do dicionário (os arrays crescem sob demanda).
+ */
+void iniciarPlacar(Placar *placar, const Dicionario *dicionario)
+{
+    memset(placar, 0, sizeof(*placar));
+    placar->dicionario = dicionario;
+}
+
+/**
+ * @brief Libera a memória do placar.
+ */
+void liberarPlacar(Placar *placar)
+{
+    free(placar->citacoes);
+    free(placar->ranking);
+    free(placar->posicao);
+    free(placar->acima);
+    iniciarPlacar(placar, placar->dicionario);
+}
+
+// --- Tabela de Associações ---
+
+/**
+ * @brief Procura o slot de uma pista no índice (sondagem linear).
+ * A comparação é entre ids internados, sem strcmp.
+ * @return O slot que contém a pista ou o primeiro slot vazio da sequência de sondagem.
+ */
+SlotHash *localizarSlot(const TabelaHash *tabela, int pista, unsigned int hash)
+{
+    unsigned int mascara = (unsigned int)tabela->capacidade - 1;
+    unsigned int i = hash & mascara;
+    unsigned int sondagens = 1;
+    while (tabela->slots[i].geracao == tabela->geracao)
+    {
+        SlotHash *slot = &tabela->slots[i];
+        if (slot->hash == hash && tabela->entradas[slot->indice].pista == pista)
+        {
+            AMOSTRAR(tabela->estatisticas, sondagensHash, sondagens);
+            return slot;
+        }
+        i = (i + 1) & mascara;
+        sondagens++;
+    }
+    AMOSTRAR(tabela->estatisticas, sondagensHash, sondagens);
+    return &tabela->slots[i];
+}
+
+/**
+ * @brief Aloca um índice vazio com a capacidade indicada (geração 0 nunca é a atual).
+ */
+SlotHash *alocarSlots(int capacidade)
+{
+    SlotHash *slots = (SlotHash *)malloc(sizeof(SlotHash) * capacidade);
+    if (slots == NULL)
+    {
+        perror("Erro ao alocar memória para a Tabela Hash");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < capacidade; i++)
+    {
+        slots[i].geracao = 0;
+    }
+    return slots;
+}
+
+/**
+ * @brief Troca o índice por um de 'novaCapacidade' slots (potência de 2) e redistribui os slots.
+ * Usa o hash guardado em cada slot, então nenhuma string é re-hasheada.
+ */
+void redimensionarHashPara(TabelaHash *tabela, int novaCapacidade)
+{
+    SlotHash *novos = alocarSlots(novaCapacidade);
+    unsigned int mascara = (unsigned int)novaCapacidade - 1;
+
+    for (int i = 0; i < tabela->capacidade; i++)
+    {
+        SlotHash slot = tabela->slots[i];
+        if (slot.geracao != tabela->geracao)
+        {
+            continue;
+        }
+        unsigned int j = slot.hash & mascara;
+        while (novos[j].geracao == tabela->geracao)
+        {
+            j = (j + 1) & mascara;
+        }
+        novos[j] = slot;
+    }
+
+    free(tabela->slots);
+    tabela->slots = novos;
+    tabela->capacidade = novaCapacidade;
+    CONTAR(tabela->estatisticas, redimensionamentosHash);
+}
+
+/**
+ * @brief Dobra a capacidade do índice.
+ */
+void redimensionarHash(TabelaHash *tabela)
+{
+    redimensionarHashPara(tabela, tabela->capacidade * 2);
+}
+
+/**
+ * @brief Acrescenta uma nova Associação ao array denso da Tabela Hash.
+ * @return Ponteiro para a associação criada (válido até a próxima inserção).
+ */
+Associacao *criarAssociacao(TabelaHash *tabela, int pista, int suspeito)
+{
+    if (tabela->quantidade == tabela->capacidadeEntradas)
+    {
+        int novaCapacidade = tabela->capacidadeEntradas ? tabela->capacidadeEntradas * 2 : TAMANHO_HASH;
+        Associacao *novas = (Associacao *)realloc(tabela->entradas, sizeof(Associacao) * novaCapacidade);
+        if (novas == NULL)
+        {
+            perror("Erro ao alocar memória para Associacao");
+            exit(EXIT_FAILURE);
+        }
+        tabela->entradas = novas;
+        tabela->capacidadeEntradas = novaCapacidade;
+    }
+
+    Associacao *nova = &tabela->entradas[tabela->quantidade++];
+    nova->pista = pista;
+    nova->suspeito = suspeito;
+    nova->suspeito_id = registrarSuspeito(tabela->dicionario, suspeito);
+    CONTAR(tabela->estatisticas, associacoesCriadas);
+    return nova;
+}
+
+/**
+ * @brief Insere uma nova associação Pista-Suspeito na Tabela Hash.
+ * Também registra o suspeito (se for novo) e soma a citação no placar.
+ * @param pista Id da pista no pool de strings.
+ * @param suspeito Id do nome do suspeito no pool de strings.
+ * @return 1 se a associação foi inserida, 0 se a pista já estava associada.
+ */
+int inserirNaHash(TabelaHash *tabela, Placar *placar, int pista, int suspeito)
+{
+    // Mantém o fator de carga abaixo de 3/4 (a nova entrada já conta)
+    if ((tabela->quantidade + 1) * CARGA_MAXIMA_DEN > tabela->capacidade * CARGA_MAXIMA_NUM)
+    {
+        redimensionarHash(tabela);
+    }
+
+    // O hash do texto já foi calculado quando a pista foi internada
+    unsigned int hash = tabela->dicionario->pool.hashes[pista];
+    SlotHash *slot = localizarSlot(tabela, pista, hash);
+
+    // Verifica se a associação já existe (evita duplicação)
+    if (slot->geracao == tabela->geracao)
+    {
+        CONTAR(tabela->estatisticas, associacoesDuplicadas);
+        return 0;
+    }
+
+    Associacao *nova = criarAssociacao(tabela, pista, suspeito);
+    slot->hash = hash;
+    slot->indice = tabela->quantidade - 1;
+    slot->geracao = tabela->geracao;
+    registrarCitacao(placar, nova->suspeito_id);
+    return 1;
+}
+
+/**
+ * @brief Prepara a tabela para receber mais 'quantidade' associações sem crescer no meio:
+ * o índice vai direto para a capacidade final (um só redimensionamento) e o array denso
+ * é realocado uma vez.
+ */
+void reservarHash(TabelaHash *tabela, int quantidade)
+{
+    int total = tabela->quantidade + quantidade;
+    int novaCapacidade = tabela->capacidade;
+    while (total * CARGA_MAXIMA_DEN > novaCapacidade * CARGA_MAXIMA_NUM)
+    {
+        novaCapacidade *= 2;
+    }
+    if (novaCapacidade != tabela->capacidade)
+    {
+        redimensionarHashPara(tabela, novaCapacidade);
+    }
+
+    if (total > tabela->capacidadeEntradas)
+    {
+        Associacao *novas = (Associacao *)realloc(tabela->entradas, sizeof(Associacao) * total);
+        if (novas == NULL)
+        {
+            perror("Erro ao alocar memória para Associacao");
+            exit(EXIT_FAILURE);
+        }
+        tabela->entradas = novas;
+        tabela->capacidadeEntradas = total;
+    }
+}
+
+/**
+ * @brief Insere de uma vez as associações de 'lote', na ordem do array.
+ * As pistas precisam ser distintas entre si e ainda ausentes da tabela (a carga em lote
+ * já descartou as repetidas ao ordenar), então cada uma vai para o primeiro slot livre
+ * da sua sondagem, sem comparar com as entradas que estão lá.
+ */
+void inserirLoteNaHash(TabelaHash *tabela, Placar *placar, const PistaDoLote *lote, int quantidade)
+{
+    reservarHash(tabela, quantidade);
+    const unsigned int *hashes = tabela->dicionario->pool.hashes;
+    unsigned int mascara = (unsigned int)tabela->capacidade - 1;
+    for (int i = 0; i < quantidade; i++)
+    {
+        // Em dois estágios: o hash guardado no pool e, mais perto, o slot
+        if (i + 2 * DISTANCIA_PREFETCH < quantidade)
+        {
+            __builtin_prefetch(&hashes[lote[i + 2 * DISTANCIA_PREFETCH].pista]);
+        }
+        if (i + DISTANCIA_PREFETCH < quantidade)
+        {
+            __builtin_prefetch(&tabela->slots[hashes[lote[i + DISTANCIA_PREFETCH].pista] & mascara], 1);
+        }
+        unsigned int hash = hashes[lote[i].pista];
+        unsigned int j = hash & mascara;
+        while (tabela->slots[j].geracao == tabela->geracao)
+        {
+            j = (j + 1) & mascara;
+        }
+        Associacao *nova = criarAssociacao(tabela, lote[i].pista, lote[i].suspeito);
+        tabela->slots[j].hash = hash;
+        tabela->slots[j].indice = tabela->quantidade - 1;
+        tabela->slots[j].geracao = tabela->geracao;
+        registrarCitacao(placar, nova->suspeito_id);
+    }
+}
+
+/**
+ * @brief Busca a associação de uma pista na Tabela Hash.
+ * @return A associação encontrada ou NULL se a pista não foi registrada.
+ */
+const Associacao *buscarPista(const TabelaHash *tabela, const char *pista)
+{
+    int id = buscarString(tabela->dicionario, pista, tabela->estatisticas);
+    if (id < 0)
+    {
+        return NULL;
+    }
+    SlotHash *slot = localizarSlot(tabela, id, tabela->dicionario->pool.hashes[id]);
+    return slot->geracao != tabela->geracao ? NULL : &tabela->entradas[slot->indice];
+}
+
+/**
+ * @brief Inicializa a Tabela Hash vazia, com TAMANHO_HASH slots, para pistas do dicionário.
+ */
+void inicializarHash(TabelaHash *tabela, Dicionario *dicionario)
+{
+    tabela->dicionario = dicionario;
+    tabela->slots = alocarSlots(TAMANHO_HASH);
+    tabela->capacidade = TAMANHO_HASH;
+    tabela->entradas = NULL;
+    tabela->quantidade = 0;
+    tabela->capacidadeEntradas = 0;
+    tabela->geracao = 1;
+    tabela->estatisticas = NULL;
+}
+
+/**
+ * @brief Esvazia a Tabela Hash em O(1) mantendo a memória já alocada:
+ * as associações são densas (basta zerar a quantidade) e os slots da geração
+ * anterior passam a valer como vazios.
+ */
+void reiniciarHash(TabelaHash *tabela)
+{
+    tabela->quantidade = 0;
+    if (++tabela->geracao == 0)
+    {
+        // A geração deu a volta: limpa os slots de verdade (raro)
+        for (int i = 0; i < tabela->capacidade; i++)
+        {
+            tabela->slots[i].geracao = 0;
+        }
+        tabela->geracao = 1;
+    }
+}
+
+/**
+ * @brief Libera a memória alocada para a Tabela Hash.
+ */
+void liberarHash(TabelaHash *tabela)
+{
+    free(tabela->slots);
+    free(tabela->entradas);
+    tabela->slots = NULL;
+    tabela->entradas = NULL;
+    tabela->capacidade = 0;
+    tabela->quantidade = 0;
+    tabela->capacidadeEntradas = 0;
+}
+
+// ==========================================================
+//        ÍNDICE INVERTIDO (SUSPEITO -> PISTAS)
+// ==========================================================
+
+/**
+ * @brief Inicializa um índice vazio e em crescimento (os arrays crescem sob demanda).
+ */
+void iniciarIndiceSuspeitos(IndiceSuspeitos *indice)
+{
+    memset(indice, 0, sizeof(*indice));
+}
+
+/**
+ * @brief Garante posições para os suspeitos 0..suspeito (dobrando os arrays).
+ */
+void garantirSuspeitoNoIndice(IndiceSuspeitos *indice, int suspeito)
+{
+    if (suspeito < indice->numSuspeitos)
+    {
+        return;
+    }
+    int novaCapacidade = indice->numSuspeitos ? indice->numSuspeitos * 2 : TAMANHO_HASH;
+    while (novaCapacidade <= suspeito)
+    {
+        novaCapacidade *= 2;
+    }
+    PistaPonderada **listas = (PistaPonderada **)realloc(indice->listas, sizeof(PistaPonderada *) * novaCapacidade);
+    int *tamanhos = (int *)realloc(indice->tamanhos, sizeof(int) * novaCapacidade);
+    int *capacidades = (int *)realloc(indice->capacidades, sizeof(int) * novaCapacidade);
+    int *pesos = (int *)realloc(indice->pesos, sizeof(int) * novaCapacidade);
+    if (listas == NULL || tamanhos == NULL || capacidades == NULL || pesos == NULL)
+    {
+        perror("Erro ao alocar memória para o índice de suspeitos");
+        exit(EXIT_FAILURE);
+    }
+    for (int s = indice->numSuspeitos; s < novaCapacidade; s++)
+    {
+        listas[s] = NULL;
+        tamanhos[s] = 0;
+        capacidades[s] = 0;
+        pesos[s] = 0;
+    }
+    indice->listas = listas;
+    indice->tamanhos = tamanhos;
+    indice->capacidades = capacidades;
+    indice->pesos = pesos;
+    indice->numSuspeitos = novaCapacidade;
+}
+
+/**
+ * @brief Acrescenta a pista à lista do suspeito, com o peso indicado, em O(1) amortizado.
+ * Não procura repetidos: quem chama garante o par único (a Tabela Hash já recusa pistas
+ * repetidas) ou deixa para congelarIndiceSuspeitos somar os pesos.
+ * @param suspeito Id do suspeito no Registro de Suspeitos.
+ */
+void associarPistaAoSuspeito(IndiceSuspeitos *indice, int pista, int suspeito, int peso)
+{
+    garantirSuspeitoNoIndice(indice, suspeito);
+    if (indice->tamanhos[suspeito] == indice->capacidades[suspeito])
+    {
+        int novaCapacidade = indice->capacidades[suspeito] ? indice->capacidades[suspeito] * 2 : 4;
+        PistaPonderada *novas = (PistaPonderada *)realloc(indice->listas[suspeito], sizeof(PistaPonderada) * novaCapacidade);
+        if (novas == NULL)
+        {
+            perror("Erro ao alocar memória para o índice de suspeitos");
+            exit(EXIT_FAILURE);
+        }
+        indice->listas[suspeito] = novas;
+        indice->capacidades[suspeito] = novaCapacidade;
+    }
+    PistaPonderada *nova = &indice->listas[suspeito][indice->tamanhos[suspeito]++];
+    nova->pista = pista;
+    nova->peso = peso;
+    indice->pesos[suspeito] += peso;
+    indice->totalPistas++;
+}
+
+int compararPistasPonderadas(const void *a, const void *b)
+{
+    int x = ((const PistaPonderada *)a)->pista;
+    int y = ((const PistaPonderada *)b)->pista;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Congela o índice em CSR: copia as listas para um array só, ordena cada uma por id
+ * de pista e junta os pares repetidos somando os pesos. As listas separadas são liberadas;
+ * depois disso o índice só é lido (e pode ser compartilhado entre threads).
+ */
+void congelarIndiceSuspeitos(IndiceSuspeitos *indice)
+{
+    indice->inicio = (int *)malloc(sizeof(int) * (indice->numSuspeitos + 1));
+    indice->pistas = (PistaPonderada *)malloc(sizeof(PistaPonderada) * (indice->totalPistas + 1));
+    if (indice->inicio == NULL || indice->pistas == NULL)
+    {
+        perror("Erro ao alocar memória para o índice de suspeitos");
+        exit(EXIT_FAILURE);
+    }
+
+    int total = 0;
+    for (int s = 0; s < indice->numSuspeitos; s++)
+    {
+        indice->inicio[s] = total;
+        PistaPonderada *lista = indice->listas[s];
+        if (indice->tamanhos[s] > 1)
+        {
+            qsort(lista, indice->tamanhos[s], sizeof(PistaPonderada), compararPistasPonderadas);
+        }
+        for (int i = 0; i < indice->tamanhos[s]; i++)
+        {
+            if (total > indice->inicio[s] && indice->pistas[total - 1].pista == lista[i].pista)
+            {
+                indice->pistas[total - 1].peso += lista[i].peso;
+            }
+            else
+            {
+                indice->pistas[total++] = lista[i];
+            }
+        }
+        free(lista);
+        indice->listas[s] = NULL;
+        indice->capacidades[s] = 0;
+    }
+    indice->inicio[indice->numSuspeitos] = total;
+    indice->totalPistas = total;
+    indice->congelado = 1;
+}
+
+/**
+ * @brief Volta o índice congelado para listas separadas (uma cópia por suspeito), para
+ * que ele possa mudar de novo. Custa O(pistas) uma vez; as listas saem sem repetidos.
+ */
+void descongelarIndiceSuspeitos(IndiceSuspeitos *indice)
+{
+    if (!indice->congelado)
+    {
+        return;
+    }
+    for (int s = 0; s < indice->numSuspeitos; s++)
+    {
+        int quantidade = indice->inicio[s + 1] - indice->inicio[s];
+        indice->tamanhos[s] = quantidade;
+        indice->capacidades[s] = quantidade;
+        if (quantidade > 0)
+        {
+            indice->listas[s] = (PistaPonderada *)malloc(sizeof(PistaPonderada) * quantidade);
+            if (indice->listas[s] == NULL)
+            {
+                perror("Erro ao alocar memória para o índice de suspeitos");
+                exit(EXIT_FAILURE);
+            }
+            memcpy(indice->listas[s], &indice->pistas[indice->inicio[s]], sizeof(PistaPonderada) * quantidade);
+        }
+    }
+    free(indice->inicio);
+    free(indice->pistas);
+    indice->inicio = NULL;
+    indice->pistas = NULL;
+    indice->congelado = 0;
+}
+
+/**
+ * @brief Soma 'delta' (positivo ou negativo) ao peso do par pista/suspeito de um índice
+ * em crescimento sem repetidos, procurando o par só na lista do suspeito: O(pistas dele).
+ * Um par novo entra no fim; um par cujo peso chega a zero sai da lista.
+ */
+void ajustarPesoDaPista(IndiceSuspeitos *indice, int pista, int suspeito, int delta)
+{
+    garantirSuspeitoNoIndice(indice, suspeito);
+    PistaPonderada *lista = indice->listas[suspeito];
+    for (int i = 0; i < indice->tamanhos[suspeito]; i++)
+    {
+        if (lista[i].pista == pista)
+        {
+            lista[i].peso += delta;
+            indice->pesos[suspeito] += delta;
+            if (lista[i].peso <= 0)
+            {
+                indice->pesos[suspeito] -= lista[i].peso;
+                lista[i] = lista[--indice->tamanhos[suspeito]];
+                indice->totalPistas--;
+            }
+            return;
+        }
+    }
+    if (delta > 0)
+    {
+        associarPistaAoSuspeito(indice, pista, suspeito, delta);
+    }
+}
+
+/**
+ * @brief Pistas de um suspeito, nas duas fases do índice, sem percorrer as dos outros.
+ * @param quantidade Recebe quantas pistas há na lista devolvida.
+ * @return As pistas do suspeito (NULL se ele não tiver nenhuma).
+ */
+const PistaPonderada *pistasDoSuspeito(const IndiceSuspeitos *indice, int suspeito, int *quantidade)
+{
+    if (suspeito < 0 || suspeito >= indice->numSuspeitos)
+    {
+        *quantidade = 0;
+        return NULL;
+    }
+    if (indice->congelado)
+    {
+        *quantidade = indice->inicio[suspeito + 1] - indice->inicio[suspeito];
+        return &indice->pistas[indice->inicio[suspeito]];
+    }
+    *quantidade = indice->tamanhos[suspeito];
+    return indice->listas[suspeito];
+}
+
+/**
+ * @brief Soma dos pesos das pistas que implicam o suspeito.
+ */
+int pesoDoSuspeito(const IndiceSuspeitos *indice, int suspeito)
+{
+    return suspeito >= 0 && suspeito < indice->numSuspeitos ? indice->pesos[suspeito] : 0;
+}
+
+/**
+ * @brief Esvazia o índice em crescimento mantendo a memória (para reaproveitar a sessão).
+ */
+void reiniciarIndiceSuspeitos(IndiceSuspeitos *indice)
+{
+    if (indice->totalPistas == 0)
+    {
+        return;
+    }
+    for (int s = 0; s < indice->numSuspeitos; s++)
+    {
+        indice->tamanhos[s] = 0;
+        indice->pesos[s] = 0;
+    }
+    indice->totalPistas = 0;
+}
+
+void liberarIndiceSuspeitos(IndiceSuspeitos *indice)
+{
+    for (int s = 0; s < indice->numSuspeitos; s++)
+    {
+        free(indice->listas[s]);
+    }
+    free(indice->listas);
+    free(indice->tamanhos);
+    free(indice->capacidades);
+    free(indice->pesos);
+    free(indice->inicio);
+    free(indice->pistas);
+    memset(indice, 0, sizeof(*indice));
+}
+
+/**
+ * @brief Monta o catálogo congelado de um mapa: cada sala com pista implica os suspeitos
+ * da sua lista com os pesos dela (sem lista, o seu suspeito com peso 1), e a mesma pista
+ * em várias salas soma peso.
+ */
+void construirCatalogoSuspeitos(const Mansao *mansao, IndiceSuspeitos *indice)
+{
+    iniciarIndiceSuspeitos(indice);
+    garantirSuspeitoNoIndice(indice, mansao->dicionario->suspeitos.quantidade);
+    for (uint32_t i = 0; i < mansao->numSalas; i++)
+    {
+        const SalaCompilada *sala = &mansao->salas[i];
+        if (sala->pista == STRING_VAZIA)
+        {
+            continue;
+        }
+        Implicacao unico;
+        uint32_t quantidade;
+        const Implicacao *pares = implicacoesDaSala(mansao->dicionario, sala, &unico, &quantidade);
+        for (uint32_t j = 0; j < quantidade; j++)
+        {
+            associarPistaAoSuspeito(indice, (int)sala->pista, registrarSuspeito(mansao->dicionario, (int)pares[j].suspeito),
+                                    (int)pares[j].peso);
+        }
+    }
+    congelarIndiceSuspeitos(indice);
+}
+
+// ==========================================================
+//        MOTOR DE DEDUÇÃO PONDERADA (BAYES)
+// ==========================================================
+
+void iniciarMotorDeducao(MotorDeducao *motor)
+{
+    memset(motor, 0, sizeof(*motor));
+    motor->base = 1.0f;
+}
+
+/**
+ * @brief Soma pesos[0..capacidade) com LARGURA_VETOR_DEDUCAO parciais independentes, que o
+ * compilador vetoriza sem precisar reordenar somas de ponto flutuante.
+ */
+double somarPesos(const float *restrict pesos, int capacidade)
+{
+    float parciais[LARGURA_VETOR_DEDUCAO] = {0};
+    for (int i = 0; i < capacidade; i += LARGURA_VETOR_DEDUCAO)
+    {
+        for (int l = 0; l < LARGURA_VETOR_DEDUCAO; l++)
+        {
+            parciais[l] += pesos[i + l];
+        }
+    }
+    double soma = 0.0;
+    for (int l = 0; l < LARGURA_VETOR_DEDUCAO; l++)
+    {
+        soma += parciais[l];
+    }
+    return soma;
+}
+
+/**
+ * @brief Multiplica todos os pesos por 'fator' (kernel vetorizável) e refaz a soma exata.
+ */
+void escalarPesos(MotorDeducao *motor, float fator)
+{
+    float *pesos = motor->pesos;
+    for (int i = 0; i < motor->capacidade; i += LARGURA_VETOR_DEDUCAO)
+    {
+        for (int l = 0; l < LARGURA_VETOR_DEDUCAO; l++)
+        {
+            float peso = pesos[i + l] * fator;
+            pesos[i + l] = peso < PESO_MINIMO_DEDUCAO ? 0.0f : peso;
+        }
+    }
+    motor->base *= fator;
+    motor->soma = somarPesos(pesos, motor->capacidade);
+}
+
+/**
+ * @brief Traz a soma de volta para perto do número de suspeitos quando ela sai da faixa segura.
+ */
+void renormalizarMotor(MotorDeducao *motor)
+{
+    if (motor->soma > LIMITE_SOMA_DEDUCAO || motor->soma < 1.0 / LIMITE_SOMA_DEDUCAO)
+    {
+        escalarPesos(motor, (float)(motor->numSuspeitos / motor->soma));
+    }
+}
+
+/**
+ * @brief Garante os suspeitos 0..suspeito no motor. Quem entra agora não foi implicado por
+ * nenhuma pista anterior, então começa com o peso base (prior uniforme).
+ */
+void garantirSuspeitoNoMotor(MotorDeducao *motor, int suspeito)
+{
+    if (suspeito >= motor->capacidade)
+    {
+        int novaCapacidade = motor->capacidade ? motor->capacidade * 2 : TAMANHO_HASH;
+        while (novaCapacidade <= suspeito)
+        {
+            novaCapacidade *= 2;
+        }
+        float *novos = (float *)realloc(motor->pesos, sizeof(float) * novaCapacidade);
+        float *novasVerossimilhancas = (float *)realloc(motor->verossimilhancas, sizeof(float) * novaCapacidade);
+        if (novos == NULL || novasVerossimilhancas == NULL)
+        {
+            perror("Erro ao alocar memória para o motor de dedução");
+            exit(EXIT_FAILURE);
+        }
+        for (int i = motor->capacidade; i < novaCapacidade; i++)
+        {
+            novos[i] = 0.0f;
+            novasVerossimilhancas[i] = 1.0f;
+        }
+        motor->pesos = novos;
+        motor->verossimilhancas = novasVerossimilhancas;
+        motor->capacidade = novaCapacidade;
+    }
+    while (motor->numSuspeitos <= suspeito)
+    {
+        motor->pesos[motor->numSuspeitos++] = motor->base;
+        motor->soma += motor->base;
+    }
+}
+
+/**
+ * @brief Volta ao prior uniforme, mantendo a memória (para reaproveitar a sessão).
+ */
+void reiniciarMotorDeducao(MotorDeducao *motor)
+{
+    for (int i = 0; i < motor->numSuspeitos; i++)
+    {
+        motor->pesos[i] = 1.0f;
+    }
+    motor->base = 1.0f;
+    motor->soma = motor->numSuspeitos;
+    motor->pistas = 0;
+}
+
+void liberarMotorDeducao(MotorDeducao *motor)
+{
+    free(motor->pesos);
+    free(motor->verossimilhancas);
+    free(motor->implicados);
+    iniciarMotorDeducao(motor);
+}
+
+/**
+ * @brief Aplica uma pista que implica poucos suspeitos, em O(k): cada suspeito implicado com
+ * peso w é multiplicado por (w + RUIDO_DEDUCAO) / RUIDO_DEDUCAO e os demais ficam como estão
+ * (multiplicar todos pela mesma constante não muda as probabilidades).
+ */
+void aplicarPistaEsparsa(MotorDeducao *motor, const int *suspeitos, const float *pesos, int quantidade)
+{
+    for (int i = 0; i < quantidade; i++)
+    {
+        garantirSuspeitoNoMotor(motor, suspeitos[i]);
+        float *peso = &motor->pesos[suspeitos[i]];
+        float fator = (pesos[i] + RUIDO_DEDUCAO) / RUIDO_DEDUCAO;
+        motor->soma += (double)*peso * (fator - 1.0f);
+        *peso *= fator;
+    }
+    motor->pistas++;
+    renormalizarMotor(motor);
+}
+
+/**
+ * @brief Aplica uma pista com verossimilhança para todos os suspeitos:
+ * pesos[s] *= verossimilhancas[s]. Kernel denso e vetorizável, com a soma feita em
+ * LARGURA_VETOR_DEDUCAO parciais no mesmo laço.
+ * @param verossimilhancas Pelo menos motor->capacidade valores (os do fim são ignorados,
+ *        pois multiplicam pesos zerados).
+ */
+void aplicarVerossimilhancas(MotorDeducao *motor, const float *restrict verossimilhancas)
+{
+    float *restrict pesos = motor->pesos;
+    float parciais[LARGURA_VETOR_DEDUCAO] = {0};
+    for (int i = 0; i < motor->capacidade; i += LARGURA_VETOR_DEDUCAO)
+    {
+        for (int l = 0; l < LARGURA_VETOR_DEDUCAO; l++)
+        {
+            float peso = pesos[i + l] * verossimilhancas[i + l];
+            peso = peso < PESO_MINIMO_DEDUCAO ? 0.0f : peso;
+            pesos[i + l] = peso;
+            parciais[l] += peso;
+        }
+    }
+    double soma = 0.0;
+    for (int l = 0; l < LARGURA_VETOR_DEDUCAO; l++)
+    {
+        soma += parciais[l];
+    }
+    motor->soma = soma;
+    motor->pistas++;
+    renormalizarMotor(motor);
+}
+
+/**
+ * @brief Marca no rascunho da próxima pista que ela implica 'suspeito' com o peso dado:
+ * a verossimilhança dele fica (peso + RUIDO_DEDUCAO) / RUIDO_DEDUCAO. Um suspeito marcado
+ * de novo na mesma pista acumula os fatores.
+ */
+void implicarNaPista(MotorDeducao *motor, int suspeito, float peso)
+{
+    garantirSuspeitoNoMotor(motor, suspeito);
+    if (motor->numImplicados == motor->capacidadeImplicados)
+    {
+        int novaCapacidade = motor->capacidadeImplicados ? motor->capacidadeImplicados * 2 : LARGURA_VETOR_DEDUCAO;
+        int *novos = (int *)realloc(motor->implicados, sizeof(int) * novaCapacidade);
+        if (novos == NULL)
+        {
+            perror("Erro ao alocar memória para o motor de dedução");
+            exit(EXIT_FAILURE);
+        }
+        motor->implicados = novos;
+        motor->capacidadeImplicados = novaCapacidade;
+    }
+    motor->implicados[motor->numImplicados++] = suspeito;
+    motor->verossimilhancas[suspeito] *= (peso + RUIDO_DEDUCAO) / RUIDO_DEDUCAO;
+}
+
+/**
+ * @brief Aplica a pista montada com implicarNaPista pelo kernel denso (aplicarVerossimilhancas)
+ * e devolve o rascunho a 1 em O(implicados). Uma pista sem implicados não muda as
+ * probabilidades, mas conta como aplicada.
+ */
+void aplicarPistaImplicada(MotorDeducao *motor)
+{
+    if (motor->capacidade == 0)
+    {
+        motor->pistas++;
+        return;
+    }
+    aplicarVerossimilhancas(motor, motor->verossimilhancas);
+    for (int i = 0; i < motor->numImplicados; i++)
+    {
+        motor->verossimilhancas[motor->implicados[i]] = 1.0f;
+    }
+    motor->numImplicados = 0;
+}
+
+double probabilidadeDeCulpa(const MotorDeducao *motor, int suspeito)
+{
+    return suspeito < motor->numSuspeitos && motor->soma > 0 ? motor->pesos[suspeito] / motor->soma : 0.0;
+}
+
+/**
+ * @brief Os k suspeitos mais prováveis, em ordem decrescente (empates pelo menor id).
+ * Uma passada pelos pesos; só quem supera o k-ésimo atual entra no ranking parcial.
+ * @return Quantos suspeitos foram escritos em 'ranking' (até k).
+ */
+int melhoresPosteriores(const MotorDeducao *motor, int k, ProbabilidadeSuspeito *ranking)
+{
+    int tamanho = 0;
+    float limiar = -1.0f; // Peso do k-ésimo atual (só vale com o ranking cheio)
+    for (int s = 0; s < motor->numSuspeitos && k > 0; s++)
+    {
+        float peso = motor->pesos[s];
+        if (peso <= limiar)
+        {
+            continue;
+        }
+        int i = tamanho < k ? tamanho++ : k - 1;
+        while (i > 0 && motor->pesos[ranking[i - 1].suspeito] < peso)
+        {
+            ranking[i] = ranking[i - 1];
+            i--;
+        }
+        ranking[i].suspeito = s;
+        if (tamanho == k)
+        {
+            limiar = motor->pesos[ranking[k - 1].suspeito];
+        }
+    }
+    for (int i = 0; i < tamanho; i++)
+    {
+        ranking[i].probabilidade = probabilidadeDeCulpa(motor, ranking[i].suspeito);
+    }
+    return tamanho;
+}
+
+// --- Evidências da sessão nos índices ---
+
+/**
+ * @brief Leva a associação que a Tabela Hash da sessão acabou de aceitar para o índice por
+ * suspeito e para o motor de dedução. A pista entra no índice sob cada suspeito que a
+ * sala implica, com o peso do mapa, e no motor com a verossimilhança montada desses pesos
+ * (sem suspeito na sala, a do nome vazio com peso 1).
+ */
+void indexarEvidencia(Sessao *sessao, const Associacao *evidencia, const SalaCompilada *sala)
+{
+    Dicionario *dicionario = sessao->mansao->dicionario;
+    Implicacao unico;
+    uint32_t quantidade;
+    const Implicacao *pares = implicacoesDaSala(dicionario, sala, &unico, &quantidade);
+    for (uint32_t i = 0; i < quantidade; i++)
+    {
+        int suspeito = registrarSuspeito(dicionario, (int)pares[i].suspeito);
+        associarPistaAoSuspeito(&sessao->porSuspeito, evidencia->pista, suspeito, (int)pares[i].peso);
+        implicarNaPista(&sessao->motor, suspeito, (float)pares[i].peso);
+    }
+    if (quantidade == 0)
+    {
+        associarPistaAoSuspeito(&sessao->porSuspeito, evidencia->pista, evidencia->suspeito_id, 1);
+        implicarNaPista(&sessao->motor, evidencia->suspeito_id, 1.0f);
+    }
+    aplicarPistaImplicada(&sessao->motor);
+}
+
+// ==========================================================
+//             FUNÇÕES DE ANÁLISE E DEDUÇÃO
+// ==========================================================
+
+/**
+ * @brief Dedução pelas citações (sem E/S): o líder do placar, em O(1).
+ * O suspeito mais provável fica vazio; quem tem o motor da sessão completa (deduzir).
+ */
+Deducao deduzirDoPlacar(const TabelaHash *evidencias, const Placar *placar)
+{
+    Deducao deducao;
+    deducao.suspeito = suspeitoMaisCitado(placar, &deducao.empate);
+    deducao.citacoes = placar->maxCitacoes;
+    deducao.pistas = evidencias->quantidade;
+    deducao.maisProvavel.suspeito = -1;
+    deducao.maisProvavel.probabilidade = 0.0;
+    return deducao;
+}
+
+/**
+ * @brief Texto do veredito: o suspeito mais citado, "EMPATE" ou "SEM PISTAS".
+ */
+const char *textoDoVeredito(const Dicionario *dicionario, const Deducao *deducao)
+{
+    if (deducao->pistas == 0)
+    {
+        return "SEM PISTAS";
+    }
+    return deducao->empate ? "EMPATE" : nomeDoSuspeito(dicionario, deducao->suspeito);
+}
+
+/**
+ * @brief Lista as evidências da Tabela Hash e mostra o suspeito mais citado.
+ * As contagens já são mantidas por inserirNaHash, então nada é recontado aqui.
+ * No resumo só o veredito é mostrado; no modo silencioso, nada.
+ */
+void analisarEvidencias(Renderizador *saida, const TabelaHash *evidencias, const Placar *placar)
+{
+    const Dicionario *dicionario = evidencias->dicionario;
+    if (!mostrar(saida, VERBOSIDADE_COMPLETA))
+    {
+        if (mostrar(saida, VERBOSIDADE_RESUMO))
+        {
+            Deducao deducao = deduzirDoPlacar(evidencias, placar);
+            escrever(saida, "🔎 Dedução: %s (%d pista(s))\n", textoDoVeredito(dicionario, &deducao), deducao.pistas);
+        }
+        return;
+    }
+
+    escreverTexto(saida, "\n=============================================\n"
+                  "🕵️  ANÁLISE DE EVIDÊNCIAS (DEDUÇÃO) \n"
+                  "=============================================\n");
+
+    // 1. Lista as associações do array denso
+    for (int i = 0; i < evidencias->quantidade; i++)
+    {
+        const Associacao *atual = &evidencias->entradas[i];
+        escrever(saida, "Evidência: '%s' -> Suspeito: %s\n", textoDe(dicionario, atual->pista), textoDe(dicionario, atual->suspeito));
+    }
+
+    if (evidencias->quantidade == 0)
+    {
+        escreverTexto(saida, "Não há pistas coletadas para realizar a dedução.\n");
+        return;
+    }
+
+    // 2. Mostra o ranking, um grupo de empate por linha
+    escreverTexto(saida, "\n🏆 Ranking dos suspeitos:");
+    for (int posicao = 0; posicao < tamanhoDoRanking(placar);)
+    {
+        GrupoRanking grupo = grupoNaPosicao(placar, posicao);
+        escrever(saida, "\n  %dº ", grupo.inicio + 1);
+        for (int i = 0; i < grupo.quantidade; i++)
+        {
+            escrever(saida, "%s%s", i ? ", " : "", nomeDoSuspeito(dicionario, suspeitoNaPosicao(placar, grupo.inicio + i)));
+        }
+        escrever(saida, ": %d pista(s)%s", grupo.citacoes, grupo.quantidade > 1 ? " (empate)" : "");
+        posicao = grupo.inicio + grupo.quantidade;
+    }
+
+    // 3. Exibe o resultado final (líder consultado em O(1))
+    int empates;
+    int culpado = suspeitoMaisCitado(placar, &empates);
+    int max_citacoes = placar->maxCitacoes;
+
+    escreverTexto(saida, "\n\n---------------------------------------------\n");
+    if (empates)
+    {
+        escreverTexto(saida, "🛑 DEDUÇÃO FINAL: EMPATE!\n");
+        escrever(saida, "Vários suspeitos têm o mesmo número máximo de %d evidências.\n", max_citacoes);
+    }
+    else
+    {
+        escrever(saida, "🎉 DEDUÇÃO FINAL: O suspeito mais citado é: %s\n", nomeDoSuspeito(dicionario, culpado));
+        escrever(saida, "Com um total de %d evidências encontradas.\n", max_citacoes);
+    }
+    escreverTexto(saida, "---------------------------------------------\n");
+}
+
+// ==========================================================
+//            FUNÇÕES DA BST E NAVEGAÇÃO (Reutilizadas)
+// ==========================================================
+
+// --- BST de Pistas (AVL) ---
+
+/**
+ * @brief Cria um nó de Pista na arena indicada (sem malloc por nó).
+ */
+Pista *criarPista(Arena *arena, int descricao)
+{
+    Pista *novaPista = (Pista *)alocarNaArena(arena, sizeof(Pista));
+    novaPista->descricao = descricao;
+    novaPista->altura = 1;
+    novaPista->tamanho = 1;
+    novaPista->esquerda = NULL;
+    novaPista->direita = NULL;
+    return novaPista;
+}
+
+int alturaPista(Pista *no)
+{
+    return no ? no->altura : 0;
+}
+
+int tamanhoPista(const Pista *no)
+{
+    return no ? no->tamanho : 0;
+}
+
+/**
+ * @brief Recalcula a altura e o tamanho do nó a partir dos filhos.
+ */
+void atualizarAltura(Pista *no)
+{
+    int e = alturaPista(no->esquerda);
+    int d = alturaPista(no->direita);
+    no->altura = (e > d ? e : d) + 1;
+    no->tamanho = tamanhoPista(no->esquerda) + tamanhoPista(no->direita) + 1;
+}
+
+Pista *rotacionarDireita(Pista *no)
+{
+    Pista *novaRaiz = no->esquerda;
+    no->esquerda = novaRaiz->direita;
+    novaRaiz->direita = no;
+    atualizarAltura(no);
+    atualizarAltura(novaRaiz);
+    return novaRaiz;
+}
+
+Pista *rotacionarEsquerda(Pista *no)
+{
+    Pista *novaRaiz = no->direita;
+    no->direita = novaRaiz->esquerda;
+    novaRaiz->esquerda = no;
+    atualizarAltura(no);
+    atualizarAltura(novaRaiz);
+    return novaRaiz;
+}
+
+/**
+ * @brief Recalcula a altura do nó e aplica a rotação AVL necessária.
+ * @return A nova raiz da subárvore.
+ */
+Pista *balancearPista(Pista *no)
+{
+    atualizarAltura(no);
+    int fator = alturaPista(no->esquerda) - alturaPista(no->direita);
+
+    if (fator > 1)
+    {
+        if (alturaPista(no->esquerda->esquerda) < alturaPista(no->esquerda->direita))
+        {
+            no->esquerda = rotacionarEsquerda(no->esquerda); // Caso esquerda-direita
+        }
+        return rotacionarDireita(no);
+    }
+    if (fator < -1)
+    {
+        if (alturaPista(no->direita->direita) < alturaPista(no->direita->esquerda))
+        {
+            no->direita = rotacionarDireita(no->direita); // Caso direita-esquerda
+        }
+        return rotacionarEsquerda(no);
+    }
+    return no;
+}
+
+/**
+ * @brief Insere uma pista na AVL sem recursão e sem imprimir nada.
+ * Desce guardando os ponteiros percorridos e depois sobe rebalanceando até a altura parar
+ * de mudar; dali para cima só o tamanho das subárvores cresce.
+ * @param dicionario Dicionário dos textos das pistas (a ordem é a de strcmp).
+ * @param arena Arena de onde sai o novo nó.
+ * @param estatisticas Onde contar a inserção (NULL = não contar).
+ * @return 1 se a pista foi inserida, 0 se já existia.
+ */
+int inserirPistaBalanceada(const Dicionario *dicionario, Arena *arena, Pista **raiz, int descricao,
+                           Estatisticas *estatisticas)
+{
+    Pista **caminho[ALTURA_MAXIMA_AVL];
+    int profundidade = 0;
+    Pista **link = raiz;
+    const char *texto = textoDe(dicionario, descricao);
+
+    while (*link != NULL)
+    {
+        Pista *no = *link;
+        if (no->descricao == descricao)
+        {
+            CONTAR(estatisticas, pistasDuplicadas);
+            return 0;
+        }
+        caminho[profundidade++] = link;
+        link = strcmp(texto, textoDe(dicionario, no->descricao)) < 0 ? &no->esquerda : &no->direita;
+    }
+    *link = criarPista(arena, descricao);
+    CONTAR(estatisticas, pistasCriadas);
+    AMOSTRAR(estatisticas, profundidadePistas, profundidade);
+
+    int rebalanceando = 1;
+    while (profundidade > 0)
+    {
+        link = caminho[--profundidade];
+        if (!rebalanceando)
+        {
+            (*link)->tamanho++; // Acima daqui nenhuma altura muda
+            continue;
+        }
+        int alturaAntes = (*link)->altura;
+        *link = balancearPista(*link);
+        rebalanceando = (*link)->altura != alturaAntes;
+    }
+    return 1;
+}
+
+// --- Carga em lote da BST de Pistas ---
+
+/**
+ * @brief Os 16 primeiros bytes do texto em big-endian (completados com zeros), em duas
+ * palavras, para que a ordem dos inteiros seja a ordem de strcmp nesses bytes.
+ */
+void prefixoDaPista(const char *texto, uint64_t prefixo[2])
+{
+    prefixo[0] = 0;
+    prefixo[1] = 0;
+    int terminou = 0;
+    for (int i = 0; i < 16; i++)
+    {
+        terminou = terminou || texto[i] == '\0';
+        uint64_t byte = terminou ? 0 : (unsigned char)texto[i];
+        prefixo[i / 8] = (prefixo[i / 8] << 8) | byte;
+    }
+}
+
+/**
+ * @brief Ordem alfabética das pistas do lote; a mesma pista fica na ordem de coleta.
+ * Prefixos iguais sem '\0' dentro deixam o desempate para strcmp a partir do 17º byte.
+ * Comparador do qsort_r: 'dicionario' é o dicionário dos textos.
+ */
+int compararPistasDoLote(const void *a, const void *b, void *dicionario)
+{
+    const PistaDoLote *x = (const PistaDoLote *)a;
+    const PistaDoLote *y = (const PistaDoLote *)b;
+    const Dicionario *textos = (const Dicionario *)dicionario;
+    for (int i = 0; i < 2; i++)
+    {
+        if (x->prefixo[i] != y->prefixo[i])
+        {
+            return x->prefixo[i] < y->prefixo[i] ? -1 : 1;
+        }
+    }
+    if (x->pista != y->pista)
+    {
+        // Textos diferentes com o mesmo prefixo: nenhum termina nos 16 primeiros bytes
+        return strcmp(textoDe(textos, x->pista) + 16, textoDe(textos, y->pista) + 16);
+    }
+    return x->ordem < y->ordem ? -1 : (x->ordem > y->ordem);
+}
+
+/**
+ * @brief Byte 'b' (0 = o primeiro do texto) do prefixo de uma pista do lote.
+ */
+unsigned int byteDoPrefixo(const PistaDoLote *pista, int b)
+{
+    return (unsigned int)(pista->prefixo[b / 8] >> (56 - 8 * (b % 8))) & 0xff;
+}
+
+/**
+ * @brief Radix sort LSD pelos 16 bytes do prefixo: um byte por passada, do último para o
+ * primeiro, estável (a mesma pista continua na ordem de coleta). Os histogramas dos 16
+ * bytes saem de uma leitura só, e um byte igual no lote inteiro (como o começo comum de
+ * "Pista ...") não gera passada.
+ * @param auxiliar Array com espaço para 'n' pistas.
+ * @return O array que ficou com o resultado ('lote' ou 'auxiliar').
+ */
+PistaDoLote *ordenarPorPrefixo(PistaDoLote *lote, PistaDoLote *auxiliar, int n)
+{
+    int(*contagens)[256] = (int(*)[256])calloc(16, sizeof(int[256]));
+    if (contagens == NULL)
+    {
+        perror("Erro ao alocar memória para a carga em lote");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < n; i++)
+    {
+        for (int b = 0; b < 16; b++)
+        {
+            contagens[b][byteDoPrefixo(&lote[i], b)]++;
+        }
+    }
+
+    PistaDoLote *origem = lote;
+    PistaDoLote *destino = auxiliar;
+    for (int b = 15; b >= 0; b--)
+    {
+        if (n == 0 || contagens[b][byteDoPrefixo(&origem[0], b)] == n)
+        {
+            continue; // Todas as pistas têm o mesmo byte aqui
+        }
+        int posicao = 0;
+        for (int x = 0; x < 256; x++)
+        {
+            int quantidade = contagens[b][x];
+            contagens[b][x] = posicao;
+            posicao += quantidade;
+        }
+        for (int i = 0; i < n; i++)
+        {
+            destino[contagens[b][byteDoPrefixo(&origem[i], b)]++] = origem[i];
+        }
+        PistaDoLote *temp = origem;
+        origem = destino;
+        destino = temp;
+    }
+    free(contagens);
+    return origem;
+}
+
+/**
+ * @brief Ordena o lote em ordem alfabética e deixa só a primeira coleta de cada pista.
+ * O radix sort resolve os 16 primeiros bytes; só as faixas com o mesmo prefixo e pistas
+ * diferentes (textos longos) vão para o qsort. As repetidas ficam vizinhas depois da
+ * ordenação, então são descartadas na mesma passada que compacta o array, comparando só ids.
+ * @return Quantas pistas distintas ficaram no início de 'lote'.
+ */
+int ordenarLoteDePistas(const Dicionario *dicionario, PistaDoLote *lote, int n)
+{
+    PistaDoLote *auxiliar = (PistaDoLote *)malloc(sizeof(PistaDoLote) * (n ? n : 1));
+    if (auxiliar == NULL)
+    {
+        perror("Erro ao alocar memória para a carga em lote");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < n; i++)
+    {
+        // Em dois estágios: o offset do texto e, mais perto, o próprio texto
+        if (i + 2 * DISTANCIA_PREFETCH < n)
+        {
+            __builtin_prefetch(&dicionario->pool.offsets[lote[i + 2 * DISTANCIA_PREFETCH].pista]);
+        }
+        if (i + DISTANCIA_PREFETCH < n)
+        {
+            __builtin_prefetch(textoDe(dicionario, lote[i + DISTANCIA_PREFETCH].pista));
+        }
+        prefixoDaPista(textoDe(dicionario, lote[i].pista), lote[i].prefixo);
+    }
+    PistaDoLote *ordenado = ordenarPorPrefixo(lote, auxiliar, n);
+
+    for (int inicio = 0, fim; inicio < n; inicio = fim)
+    {
+        int misturada = 0;
+        for (fim = inicio + 1; fim < n && memcmp(ordenado[fim].prefixo, ordenado[inicio].prefixo, 16) == 0; fim++)
+        {
+            misturada = misturada || ordenado[fim].pista != ordenado[inicio].pista;
+        }
+        if (misturada)
+        {
+            qsort_r(ordenado + inicio, (size_t)(fim - inicio), sizeof(PistaDoLote), compararPistasDoLote, (void *)dicionario);
+        }
+    }
+
+    int distintas = 0;
+    for (int i = 0; i < n; i++)
+    {
+        if (distintas == 0 || ordenado[i].pista != lote[distintas - 1].pista)
+        {
+            lote[distintas++] = ordenado[i];
+        }
+    }
+    free(auxiliar);
+    return distintas;
+}
+
+/**
+ * @brief Meio da faixa [inicio, fim): a raiz da subárvore dessa faixa na carga em lote.
+ */
+int meioDaFaixa(int inicio, int fim)
+{
+    return inicio + (fim - inicio) / 2;
+}
+
+/**
+ * @brief Monta a AVL perfeitamente balanceada com as 'n' pistas de 'lote' (já em ordem e
+ * sem repetições) em O(n), sem comparar textos. Os nós saem contíguos da arena, em ordem
+ * alfabética. A faixa de m pistas tem raiz no meio, m/2 pistas à esquerda e o resto à
+ * direita, então a altura é o número de bits de m e o tamanho é m, sem passada de volta.
+ * @return A raiz da árvore (NULL se n == 0).
+ */
+Pista *construirPistasBalanceadas(Arena *arena, const PistaDoLote *lote, int n)
+{
+    if (n == 0)
+    {
+        return NULL;
+    }
+    Pista *nos = (Pista *)alocarNaArena(arena, sizeof(Pista) * (size_t)n);
+
+    // Pilha de faixas: cada passo tira uma e empilha no máximo duas, então não passa da altura + 1
+    int inicios[ALTURA_MAXIMA_AVL];
+    int fins[ALTURA_MAXIMA_AVL];
+    int topo = 0;
+    inicios[topo] = 0;
+    fins[topo++] = n;
+    while (topo > 0)
+    {
+        topo--;
+        int inicio = inicios[topo];
+        int fim = fins[topo];
+        int meio = meioDaFaixa(inicio, fim);
+        Pista *no = &nos[meio];
+        no->descricao = lote[meio].pista;
+        no->tamanho = fim - inicio;
+        no->altura = 0;
+        for (int m = fim - inicio; m > 0; m >>= 1)
+        {
+            no->altura++;
+        }
+        no->esquerda = inicio < meio ? &nos[meioDaFaixa(inicio, meio)] : NULL;
+        no->direita = meio + 1 < fim ? &nos[meioDaFaixa(meio + 1, fim)] : NULL;
+        if (inicio < meio)
+        {
+            inicios[topo] = inicio;
+            fins[topo++] = meio;
+        }
+        if (meio + 1 < fim)
+        {
+            inicios[topo] = meio + 1;
+            fins[topo++] = fim;
+        }
+    }
+    return &nos[meioDaFaixa(0, n)];
+}
+
+/**
+ * @brief Lista as pistas em ordem alfabética (percurso em ordem com pilha explícita).
+ * A altura da AVL é limitada, então a pilha tem tamanho fixo.
+ */
+void listarPistasEmOrdem(Renderizador *saida, const Dicionario *dicionario, const Pista *raiz)
+{
+    const Pista *pilha[ALTURA_MAXIMA_AVL];
+    int topo = 0;
+    const Pista *atual = raiz;
+
+    while (atual != NULL || topo > 0)
+    {
+        // Desce pela Esquerda (Menores)
+        while (atual != NULL)
+        {
+            pilha[topo++] = atual;
+            atual = atual->esquerda;
+        }
+
+        // Visita o nó e segue pela Direita (Maiores)
+        atual = pilha[--topo];
+        escrever(saida, "   -> %s\n", textoDe(dicionario, atual->descricao));
+        atual = atual->direita;
+    }
+}
+
+// --- Consultas na BST de Pistas (posição, faixa e prefixo) ---
+
+/**
+ * @brief Posiciona o iterador na pista de posição 'k' (0 = primeira em ordem alfabética).
+ * Desce uma vez usando o tamanho das subárvores: O(log n).
+ */
+void iniciarIteradorNaPosicao(IteradorPistas *iterador, const Pista *raiz, int k)
+{
+    iterador->topo = 0;
+    const Pista *atual = raiz;
+    while (atual != NULL)
+    {
+        int menores = tamanhoPista(atual->esquerda);
+        if (k < menores)
+        {
+            iterador->pilha[iterador->topo++] = atual; // Ainda será visitado, depois da esquerda
+            atual = atual->esquerda;
+        }
+        else if (k == menores)
+        {
+            iterador->pilha[iterador->topo++] = atual;
+            return;
+        }
+        else
+        {
+            k -= menores + 1;
+            atual = atual->direita;
+        }
+    }
+}
+
+/**
+ * @brief Posiciona o iterador na primeira pista que não vem antes de 'texto' na ordem
+ * alfabética (o "lower bound"): O(log n).
+ */
+void iniciarIteradorEm(IteradorPistas *iterador, const Dicionario *dicionario, const Pista *raiz, const char *texto)
+{
+    iterador->topo = 0;
+    const Pista *atual = raiz;
+    while (atual != NULL)
+    {
+        if (strcmp(textoDe(dicionario, atual->descricao), texto) >= 0)
+        {
+            iterador->pilha[iterador->topo++] = atual;
+            atual = atual->esquerda;
+        }
+        else
+        {
+            atual = atual->direita;
+        }
+    }
+}
+
+/**
+ * @brief Devolve a pista atual e avança o iterador (O(1) amortizado).
+ * @return A pista, ou NULL quando não há mais pistas.
+ */
+const Pista *proximaPista(IteradorPistas *iterador)
+{
+    if (iterador->topo == 0)
+    {
+        return NULL;
+    }
+    const Pista *atual = iterador->pilha[--iterador->topo];
+    for (const Pista *no = atual->direita; no != NULL; no = no->esquerda)
+    {
+        iterador->pilha[iterador->topo++] = no;
+    }
+    return atual;
+}
+
+/**
+ * @brief A pista de posição 'k' em ordem alfabética, ou NULL se k está fora do diário.
+ */
+const Pista *pistaNaPosicao(const Pista *raiz, int k)
+{
+    if (k < 0 || k >= tamanhoPista(raiz))
+    {
+        return NULL;
+    }
+    IteradorPistas iterador;
+    iniciarIteradorNaPosicao(&iterador, raiz, k);
+    return proximaPista(&iterador);
+}
+
+/**
+ * @brief Quantas pistas vêm antes de 'texto' na ordem alfabética (a posição em que ele
+ * estaria no diário): O(log n).
+ */
+int posicaoDaPista(const Dicionario *dicionario, const Pista *raiz, const char *texto)
+{
+    int posicao = 0;
+    const Pista *atual = raiz;
+    while (atual != NULL)
+    {
+        if (strcmp(textoDe(dicionario, atual->descricao), texto) >= 0)
+        {
+            atual = atual->esquerda;
+        }
+        else
+        {
+            posicao += tamanhoPista(atual->esquerda) + 1;
+            atual = atual->direita;
+        }
+    }
+    return posicao;
+}
+
+/**
+ * @brief Lista as pistas das posições [inicio, fim) do diário, numeradas a partir de 1.
+ * @return Quantas pistas foram listadas.
+ */
+int listarPaginaDePistas(Renderizador *saida, const Dicionario *dicionario, const Pista *raiz, int inicio, int fim)
+{
+    if (inicio < 0)
+    {
+        inicio = 0;
+    }
+    IteradorPistas iterador;
+    iniciarIteradorNaPosicao(&iterador, raiz, inicio);
+    int listadas = 0;
+    const Pista *pista;
+    while (inicio + listadas < fim && (pista = proximaPista(&iterador)) != NULL)
+    {
+        listadas++;
+        escrever(saida, "   %d. %s\n", inicio + listadas, textoDe(dicionario, pista->descricao));
+    }
+    return listadas;
+}
+
+/**
+ * @brief Lista as pistas entre 'de' e 'ate' (inclusive) em ordem alfabética.
+ * @return Quantas pistas foram listadas.
+ */
+int listarPistasNaFaixa(Renderizador *saida, const Dicionario *dicionario, const Pista *raiz, const char *de, const char *ate)
+{
+    IteradorPistas iterador;
+    iniciarIteradorEm(&iterador, dicionario, raiz, de);
+    int listadas = 0;
+    const Pista *pista;
+    while ((pista = proximaPista(&iterador)) != NULL && strcmp(textoDe(dicionario, pista->descricao), ate) <= 0)
+    {
+        escrever(saida, "   -> %s\n", textoDe(dicionario, pista->descricao));
+        listadas++;
+    }
+    return listadas;
+}
+
+/**
+ * @brief Lista as pistas que começam com 'prefixo' (elas são contíguas na ordem alfabética).
+ * @return Quantas pistas foram listadas.
+ */
+int listarPistasComPrefixo(Renderizador *saida, const Dicionario *dicionario, const Pista *raiz, const char *prefixo)
+{
+    size_t tamanho = strlen(prefixo);
+    IteradorPistas iterador;
+    iniciarIteradorEm(&iterador, dicionario, raiz, prefixo);
+    int listadas = 0;
+    const Pista *pista;
+    while ((pista = proximaPista(&iterador)) != NULL && strncmp(textoDe(dicionario, pista->descricao), prefixo, tamanho) == 0)
+    {
+        escrever(saida, "   -> %s\n", textoDe(dicionario, pista->descricao));
+        listadas++;
+    }
+    return listadas;
+}
+
+// --- Árvore de Salas ---
+
+/**
+ * @brief Cria uma sala na arena indicada (nós contíguos, sem malloc por sala), com os
+ * textos internados no dicionário do mapa.
+ * @param arena Arena de onde saem todas as salas da árvore (ver liberarArvoreSalas).
+ */
+Sala *criarSala(Dicionario *dicionario, Arena *arena, const char *nome, const char *pista_inicial,
+                const char *suspeito_assoc)
+{
+    Sala *novaSala = (Sala *)alocarNaArena(arena, sizeof(Sala));
+
+    novaSala->nome = internar(dicionario, nome);
+    novaSala->pista_encontrada = internar(dicionario, pista_inicial);
+    novaSala->suspeito_associado = internar(dicionario, suspeito_assoc);
+
+    novaSala->esquerda = NULL;
+    novaSala->direita = NULL;
+    CONTAR(&dicionario->estatisticas, salasCriadas);
+    return novaSala;
+}
+
+/**
+ * @brief Libera de uma vez todas as salas criadas com criarSala na arena.
+ */
+void liberarArvoreSalas(Arena *arena)
+{
+    liberarArena(arena);
+}
+
+// ==========================================================
+//           MANSÃO COMPILADA (MAPA EM ARRAY PLANO)
+// ==========================================================
+
+/**
+ * @brief Retorna 1 se a sala não tem caminhos (nó folha).
+ */
+int ehFolha(const Mansao *mansao, uint32_t sala)
+{
+    return mansao->salas[sala].esquerda == SEM_SALA && mansao->salas[sala].direita == SEM_SALA;
+}
+
+/**
+ * @brief Aloca o array de salas de uma mansão que será montada em memória, com os textos
+ * no dicionário dado. As salas começam zeradas (LISTA_VAZIA em 'implicacoes').
+ */
+void alocarMansao(Mansao *mansao, Dicionario *dicionario, uint32_t numSalas)
+{
+    memset(mansao, 0, sizeof(*mansao));
+    mansao->dicionario = dicionario;
+    mansao->salasProprias = (SalaCompilada *)calloc(numSalas ? numSalas : 1, sizeof(SalaCompilada));
+    if (mansao->salasProprias == NULL)
+    {
+        perror("Erro ao alocar memória para a Mansão");
+        exit(EXIT_FAILURE);
+    }
+    mansao->salas = mansao->salasProprias;
+    mansao->numSalas = numSalas;
+    mansao->capacidadeSalas = numSalas ? numSalas : 1;
+    mansao->raiz = 0;
+}
+
+/**
+ * @brief Converte a árvore de Salas (montada com criarSala sobre 'dicionario') para o array plano.
+ * As salas são numeradas em largura (BFS) a partir da raiz, que fica no índice 0.
+ */
+void compilarMansao(Sala *raiz, Dicionario *dicionario, Mansao *destino)
+{
+    // 1. Conta as salas (percurso em largura com fila explícita, sem recursão)
+    uint32_t capacidadeFila = TAMANHO_HASH;
+    Sala **fila = (Sala **)malloc(sizeof(Sala *) * capacidadeFila);
+    if (fila == NULL)
+    {
+        perror("Erro ao alocar memória para a Mansão");
+        exit(EXIT_FAILURE);
+    }
+    uint32_t fim = 0;
+    if (raiz != NULL)
+    {
+        fila[fim++] = raiz;
+    }
+    for (uint32_t i = 0; i < fim; i++)
+    {
+        Sala *filhos[2] = {fila[i]->esquerda, fila[i]->direita};
+        for (int f = 0; f < 2; f++)
+        {
+            if (filhos[f] == NULL)
+            {
+                continue;
+            }
+            if (fim == capacidadeFila)
+            {
+                capacidadeFila *= 2;
+                Sala **nova = (Sala **)realloc(fila, sizeof(Sala *) * capacidadeFila);
+                if (nova == NULL)
+                {
+                    perror("Erro ao alocar memória para a Mansão");
+                    exit(EXIT_FAILURE);
+                }
+                fila = nova;
+            }
+            fila[fim++] = filhos[f];
+        }
+    }
+
+    // 2. A posição na fila é o índice da sala; os filhos aparecem na fila na mesma ordem
+    alocarMansao(destino, dicionario, fim);
+    uint32_t proximoFilho = 1;
+    for (uint32_t i = 0; i < fim; i++)
+    {
+        SalaCompilada *sala = &destino->salasProprias[i];
+        sala->nome = (uint32_t)fila[i]->nome;
+        sala->pista = (uint32_t)fila[i]->pista_encontrada;
+        sala->suspeito = (uint32_t)fila[i]->suspeito_associado;
+        sala->implicacoes = LISTA_VAZIA;
+        sala->esquerda = fila[i]->esquerda ? proximoFilho++ : SEM_SALA;
+        sala->direita = fila[i]->direita ? proximoFilho++ : SEM_SALA;
+    }
+    free(fila);
+}
+
+/**
+ * @brief Confere se o array de salas forma uma única árvore a partir da raiz:
+ * índices válidos, nenhuma sala com dois pais e todas alcançáveis.
+ * @return 1 se for uma árvore válida, 0 caso contrário (com mensagem em stderr).
+ */
+int validarArvoreMansao(const Mansao *mansao)
+{
+    uint32_t n = mansao->numSalas;
+    if (n == 0 || mansao->raiz >= n)
+    {
+        fprintf(stderr, "Mapa inválido: a mansão não tem sala raiz.\n");
+        return 0;
+    }
+
+    unsigned char *temPai = (unsigned char *)calloc(n, 1);
+    if (temPai == NULL)
+    {
+        perror("Erro ao alocar memória para validar a Mansão");
+        exit(EXIT_FAILURE);
+    }
+
+    int valido = 1;
+    for (uint32_t i = 0; i < n && valido; i++)
+    {
+        uint32_t filhos[2] = {mansao->salas[i].esquerda, mansao->salas[i].direita};
+        for (int f = 0; f < 2; f++)
+        {
+            if (filhos[f] == SEM_SALA)
+            {
+                continue;
+            }
+            if (filhos[f] >= n || filhos[f] == mansao->raiz || temPai[filhos[f]])
+            {
+                fprintf(stderr, "Mapa inválido: ligação da sala %u para a sala %u.\n", i, filhos[f]);
+                valido = 0;
+                break;
+            }
+            temPai[filhos[f]] = 1;
+        }
+    }
+    free(temPai);
+
+    // Cada sala tem no máximo um pai, então o percurso a partir da raiz nunca repete salas;
+    // se ele não alcança todas, sobrou um ciclo ou um pedaço solto.
+    if (valido)
+    {
+        uint32_t *fila = (uint32_t *)malloc(sizeof(uint32_t) * n);
+        if (fila == NULL)
+        {
+            perror("Erro ao alocar memória para validar a Mansão");
+            exit(EXIT_FAILURE);
+        }
+        uint32_t fim = 0;
+        fila[fim++] = mansao->raiz;
+        for (uint32_t i = 0; i < fim; i++)
+        {
+            const SalaCompilada *sala = &mansao->salas[fila[i]];
+            if (sala->esquerda != SEM_SALA)
+            {
+                fila[fim++] = sala->esquerda;
+            }
+            if (sala->direita != SEM_SALA)
+            {
+                fila[fim++] = sala->direita;
+            }
+        }
+        free(fila);
+        if (fim != n)
+        {
+            fprintf(stderr, "Mapa inválido: %u sala(s) não são alcançáveis a partir da raiz.\n", n - fim);
+            valido = 0;
+        }
+    }
+    return valido;
+}
+
+/**
+ * @brief Remove espaços do início e do fim de um campo (in-place).
+ */
+char *aparar(char *texto)
+{
+    while (isspace((unsigned char)*texto))
+    {
+        texto++;
+    }
+    char *fim = texto + strlen(texto);
+    while (fim > texto && isspace((unsigned char)fim[-1]))
+    {
+        *--fim = '\0';
+    }
+    return texto;
+}
+
+/**
+ * @brief Converte o campo de um filho ('-' ou vazio = sem caminho).
+ * @return 1 se o campo é válido.
+ */
+int lerIndiceSala(const char *campo, uint32_t *indice)
+{
+    if (campo[0] == '\0' || strcmp(campo, "-") == 0)
+    {
+        *indice = SEM_SALA;
+        return 1;
+    }
+    char *fim;
+    unsigned long valor = strtoul(campo, &fim, 10);
+    if (*fim != '\0' || !isdigit((unsigned char)campo[0]) || valor >= SEM_SALA)
+    {
+        return 0;
+    }
+    *indice = (uint32_t)valor;
+    return 1;
+}
+
+/**
+ * @brief Converte o campo de suspeitos de uma sala: nomes separados por ',', cada um com
+ * um peso opcional em ':peso' (1 a PESO_MAXIMO_SUSPEITO, padrão 1), como em
+ * "Mordomo:3, Dama". O primeiro é o suspeito principal da sala; a lista só é criada
+ * quando há mais de um suspeito ou um peso diferente de 1. Campo vazio = sem suspeito.
+ * @param suspeito Recebe o id (no pool) do suspeito principal.
+ * @param lista Recebe o id da lista de pesos, ou LISTA_VAZIA.
+ * @return 1 se o campo é válido, 0 se há nome vazio, peso inválido ou suspeito repetido.
+ */
+int lerSuspeitosDaSala(Dicionario *dicionario, const char *campo, uint32_t *suspeito, uint32_t *lista)
+{
+    *suspeito = STRING_VAZIA;
+    *lista = LISTA_VAZIA;
+    if (campo[0] == '\0')
+    {
+        return 1;
+    }
+
+    size_t tamanho = strlen(campo) + 1;
+    char *copia = (char *)malloc(tamanho);
+    Implicacao *pares = (Implicacao *)malloc(sizeof(Implicacao) * tamanho);
+    if (copia == NULL || pares == NULL)
+    {
+        perror("Erro ao alocar memória para os suspeitos da sala");
+        exit(EXIT_FAILURE);
+    }
+    memcpy(copia, campo, tamanho);
+
+    uint32_t quantidade = 0;
+    int valido = 1;
+    char *inicio = copia;
+    while (valido)
+    {
+        char *virgula = strchr(inicio, ',');
+        if (virgula != NULL)
+        {
+            *virgula = '\0';
+        }
+        char *nome = aparar(inicio);
+        unsigned long peso = 1;
+        char *doisPontos = strrchr(nome, ':');
+        if (doisPontos != NULL)
+        {
+            *doisPontos = '\0';
+            char *textoPeso = aparar(doisPontos + 1);
+            char *fim;
+            peso = strtoul(textoPeso, &fim, 10);
+            if (!isdigit((unsigned char)textoPeso[0]) || *fim != '\0' || peso < 1 || peso > PESO_MAXIMO_SUSPEITO)
+            {
+                valido = 0;
+                break;
+            }
+            nome = aparar(nome);
+        }
+        if (nome[0] == '\0')
+        {
+            valido = 0;
+            break;
+        }
+        uint32_t id = (uint32_t)internar(dicionario, nome);
+        for (uint32_t i = 0; i < quantidade; i++)
+        {
+            if (pares[i].suspeito == id)
+            {
+                valido = 0;
+            }
+        }
+        pares[quantidade].suspeito = id;
+        pares[quantidade].peso = (uint32_t)peso;
+        quantidade++;
+        if (virgula == NULL)
+        {
+            break;
+        }
+        inicio = virgula + 1;
+    }
+
+    if (valido)
+    {
+        *suspeito = pares[0].suspeito;
+        if (quantidade > 1 || pares[0].peso != 1)
+        {
+            *lista = criarListaDeImplicacoes(dicionario, pares, quantidade);
+        }
+    }
+    free(pares);
+    free(copia);
+    return valido;
+}
+
+/**
+ * @brief Carrega um mapa no formato texto, uma sala por linha:
+ *     id | nome | esquerda | direita | pista | suspeito[:peso], suspeito[:peso], ...
+ * Os ids vão de 0 a N-1 em qualquer ordem; a raiz é a sala 0; '-' marca caminho bloqueado.
+ * A pista implica cada suspeito listado com o seu peso (ver lerSuspeitosDaSala).
+ * Linhas vazias e começadas por '#' são ignoradas. Os textos vão para 'dicionario'.
+ * @return 1 em caso de sucesso, 0 se o arquivo for inválido (com mensagem em stderr).
+ */
+int carregarMapaTexto(const char *caminho, Dicionario *dicionario, Mansao *destino)
+{
+    FILE *arquivo = fopen(caminho, "r");
+    if (arquivo == NULL)
+    {
+        perror("Erro ao abrir o mapa");
+        return 0;
+    }
+
+    SalaCompilada *salas = NULL;
+    unsigned char *definida = NULL;
+    uint32_t capacidade = 0;
+    uint32_t numSalas = 0;
+    char linha[1024];
+    long numeroLinha = 0;
+    int valido = 1;
+
+    while (valido && fgets(linha, sizeof(linha), arquivo) != NULL)
+    {
+        numeroLinha++;
+        if (strchr(linha, '\n') == NULL && !feof(arquivo))
+        {
+            fprintf(stderr, "%s:%ld: linha longa demais.\n", caminho, numeroLinha);
+            valido = 0;
+            break;
+        }
+
+        char *conteudo = aparar(linha);
+        if (conteudo[0] == '\0' || conteudo[0] == '#')
+        {
+            continue;
+        }
+
+        // Separa os 6 campos por '|'
+        char *campos[6];
+        int numCampos = 0;
+        char *inicio = conteudo;
+        while (numCampos < 6)
+        {
+            char *barra = strchr(inicio, '|');
+            campos[numCampos++] = inicio;
+            if (barra == NULL)
+            {
+                break;
+            }
+            *barra = '\0';
+            inicio = barra + 1;
+        }
+        if (numCampos != 6 || strchr(campos[5], '|') != NULL)
+        {
+            fprintf(stderr, "%s:%ld: esperado 'id | nome | esquerda | direita | pista | suspeito'.\n", caminho, numeroLinha);
+            valido = 0;
+            break;
+        }
+        for (int i = 0; i < 6; i++)
+        {
+            campos[i] = aparar(campos[i]);
+        }
+
+        uint32_t id, esquerda, direita;
+        if (!lerIndiceSala(campos[0], &id) || id == SEM_SALA || !lerIndiceSala(campos[2], &esquerda) || !lerIndiceSala(campos[3], &direita))
+        {
+            fprintf(stderr, "%s:%ld: índice de sala inválido.\n", caminho, numeroLinha);
+            valido = 0;
+            break;
+        }
+        if (campos[1][0] == '\0')
+        {
+            fprintf(stderr, "%s:%ld: a sala precisa de um nome.\n", caminho, numeroLinha);
+            valido = 0;
+            break;
+        }
+
+        if (id >= capacidade)
+        {
+            uint32_t novaCapacidade = capacidade ? capacidade : TAMANHO_HASH;
+            while (novaCapacidade <= id)
+            {
+                novaCapacidade *= 2;
+            }
+            SalaCompilada *novas = (SalaCompilada *)realloc(salas, sizeof(SalaCompilada) * novaCapacidade);
+            unsigned char *novasDefinidas = (unsigned char *)realloc(definida, novaCapacidade);
+            if (novas == NULL || novasDefinidas == NULL)
+            {
+                perror("Erro ao alocar memória para o mapa");
+                exit(EXIT_FAILURE);
+            }
+            memset(novasDefinidas + capacidade, 0, novaCapacidade - capacidade);
+            salas = novas;
+            definida = novasDefinidas;
+            capacidade = novaCapacidade;
+        }
+        if (definida[id])
+        {
+            fprintf(stderr, "%s:%ld: sala %u definida duas vezes.\n", caminho, numeroLinha, id);
+            valido = 0;
+            break;
+        }
+
+        definida[id] = 1;
+        salas[id].nome = (uint32_t)internar(dicionario, campos[1]);
+        salas[id].pista = (uint32_t)internar(dicionario, campos[4]);
+        if (!lerSuspeitosDaSala(dicionario, campos[5], &salas[id].suspeito, &salas[id].implicacoes))
+        {
+            fprintf(stderr, "%s:%ld: suspeitos inválidos; esperado 'suspeito[:peso], ...' com peso de 1 a %d.\n",
+                    caminho, numeroLinha, PESO_MAXIMO_SUSPEITO);
+            valido = 0;
+            break;
+        }
+        salas[id].esquerda = esquerda;
+        salas[id].direita = direita;
+        if (id + 1 > numSalas)
+        {
+            numSalas = id + 1;
+        }
+    }
+    fclose(arquivo);
+
+    for (uint32_t i = 0; valido && i < numSalas; i++)
+    {
+        if (!definida[i])
+        {
+            fprintf(stderr, "%s: a sala %u é citada mas não foi definida.\n", caminho, i);
+            valido = 0;
+        }
+    }
+    free(definida);
+
+    memset(destino, 0, sizeof(*destino));
+    destino->dicionario = dicionario;
+    destino->salasProprias = salas;
+    destino->salas = salas;
+    destino->numSalas = numSalas;
+    destino->capacidadeSalas = capacidade;
+    destino->raiz = 0;
+    if (valido && !validarArvoreMansao(destino))
+    {
+        valido = 0;
+    }
+    if (!valido)
+    {
+        free(salas);
+        memset(destino, 0, sizeof(*destino));
+    }
+    return valido;
+}
+
+/**
+ * @brief Arredonda um deslocamento para múltiplo de 8 (alinhamento das seções).
+ */
+uint64_t alinhar8(uint64_t valor)
+{
+    return (valor + 7) & ~(uint64_t)7;
+}
+
+/**
+ * @brief Grava a mansão no formato compilado: cabeçalho, array de salas, offsets e hashes
+ * das strings, os textos e as listas de suspeitos com pesos (início de cada lista e os
+ * pares), cada seção alinhada em 8 bytes. O arquivo pode ser mapeado com
+ * mmap e usado sem nenhuma conversão (mesma arquitetura que o gravou).
+ * @return 1 em caso de sucesso.
+ */
+int salvarMapaCompilado(const Mansao *mansao, const char *caminho)
+{
+    const PoolStrings *pool = &mansao->dicionario->pool;
+    const ListasImplicacoes *listas = &mansao->dicionario->implicacoes;
+    CabecalhoMapa cabecalho;
+    memset(&cabecalho, 0, sizeof(cabecalho));
+    memcpy(cabecalho.assinatura, ASSINATURA_MAPA, sizeof(cabecalho.assinatura));
+    cabecalho.versao = VERSAO_MAPA;
+    cabecalho.funcaoHash = FUNCAO_HASH;
+    cabecalho.numSalas = mansao->numSalas;
+    cabecalho.raiz = mansao->raiz;
+    cabecalho.numStrings = (uint32_t)pool->quantidade;
+    cabecalho.bytesStrings = pool->usado;
+    cabecalho.offsetSalas = alinhar8(sizeof(CabecalhoMapa));
+    cabecalho.offsetOffsets = alinhar8(cabecalho.offsetSalas + sizeof(SalaCompilada) * (uint64_t)mansao->numSalas);
+    cabecalho.offsetHashes = alinhar8(cabecalho.offsetOffsets + sizeof(uint32_t) * (uint64_t)cabecalho.numStrings);
+    cabecalho.offsetDados = alinhar8(cabecalho.offsetHashes + sizeof(uint32_t) * (uint64_t)cabecalho.numStrings);
+    cabecalho.numListas = listas->quantidade;
+    cabecalho.numImplicacoes = listas->numPares;
+    cabecalho.offsetListas = alinhar8(cabecalho.offsetDados + pool->usado);
+    cabecalho.offsetImplicacoes = alinhar8(cabecalho.offsetListas + sizeof(uint32_t) * ((uint64_t)listas->quantidade + 1));
+
+    FILE *arquivo = fopen(caminho, "wb");
+    if (arquivo == NULL)
+    {
+        perror("Erro ao criar o mapa compilado");
+        return 0;
+    }
+
+    static const char zeros[8] = {0};
+    int ok = fwrite(&cabecalho, sizeof(cabecalho), 1, arquivo) == 1;
+    ok = ok && fwrite(zeros, 1, cabecalho.offsetSalas - sizeof(cabecalho), arquivo) == cabecalho.offsetSalas - sizeof(cabecalho);
+    ok = ok && fwrite(mansao->salas, sizeof(SalaCompilada), mansao->numSalas, arquivo) == mansao->numSalas;
+    ok = ok && fseek(arquivo, (long)cabecalho.offsetOffsets, SEEK_SET) == 0;
+    ok = ok && fwrite(pool->offsets, sizeof(uint32_t), cabecalho.numStrings, arquivo) == cabecalho.numStrings;
+    ok = ok && fseek(arquivo, (long)cabecalho.offsetHashes, SEEK_SET) == 0;
+    ok = ok && fwrite(pool->hashes, sizeof(uint32_t), cabecalho.numStrings, arquivo) == cabecalho.numStrings;
+    ok = ok && fseek(arquivo, (long)cabecalho.offsetDados, SEEK_SET) == 0;
+    ok = ok && fwrite(pool->dados, 1, pool->usado, arquivo) == pool->usado;
+    ok = ok && fseek(arquivo, (long)cabecalho.offsetListas, SEEK_SET) == 0;
+    ok = ok && fwrite(listas->inicios, sizeof(uint32_t), listas->quantidade + 1, arquivo) == listas->quantidade + 1;
+    // Completa o alinhamento com zeros: sem pares, a seção vazia fica no fim do arquivo
+    uint64_t enchimento = cabecalho.offsetImplicacoes - cabecalho.offsetListas - sizeof(uint32_t) * ((uint64_t)listas->quantidade + 1);
+    ok = ok && fwrite(zeros, 1, enchimento, arquivo) == enchimento;
+    ok = ok && (listas->numPares == 0 ||
+                fwrite(listas->pares, sizeof(Implicacao), listas->numPares, arquivo) == listas->numPares);
+    ok = (fclose(arquivo) == 0) && ok;
+    if (!ok)
+    {
+        perror("Erro ao gravar o mapa compilado");
+    }
+    return ok;
+}
+
+/**
+ * @brief Confere se a seção de 'quantidade' itens de 'tamanhoItem' bytes, a partir de 'offset',
+ * cabe no arquivo depois do cabeçalho. As contas são feitas sem somar offset + tamanho,
+ * que poderia dar a volta em 64 bits com um cabeçalho forjado.
+ */
+int secaoDentroDoArquivo(uint64_t offset, uint64_t quantidade, uint64_t tamanhoItem,
+                         uint64_t tamanhoCabecalho, uint64_t tamanhoArquivo)
+{
+    if (tamanhoItem != 0 && quantidade > UINT64_MAX / tamanhoItem)
+    {
+        return 0;
+    }
+    uint64_t bytes = quantidade * tamanhoItem;
+    return offset >= tamanhoCabecalho && offset <= tamanhoArquivo && bytes <= tamanhoArquivo - offset;
+}
+
+/**
+ * @brief Mapeia (mmap) um mapa compilado e passa a usá-lo diretamente: as salas, o pool
+ * de strings e as listas de suspeitos apontam para o arquivo, sem malloc por sala nem
+ * cópia dos textos. Substitui o pool e as listas de 'dicionario' pelos do arquivo.
+ * As versões 1 e 2 (salas de 20 bytes, sem listas) são aceitas: só as salas são copiadas,
+ * cada uma com LISTA_VAZIA.
+ * @return 1 em caso de sucesso, 0 se o arquivo for inválido.
+ */
+int carregarMapaCompilado(const char *caminho, Dicionario *dicionario, Mansao *destino)
+{
+    memset(destino, 0, sizeof(*destino));
+
+    int descritor = open(caminho, O_RDONLY);
+    if (descritor < 0)
+    {
+        perror("Erro ao abrir o mapa compilado");
+        return 0;
+    }
+    struct stat info;
+    if (fstat(descritor, &info) != 0 || (uint64_t)info.st_size < offsetof(CabecalhoMapa, funcaoHash))
+    {
+        fprintf(stderr, "%s: arquivo pequeno demais para um mapa compilado.\n", caminho);
+        close(descritor);
+        return 0;
+    }
+    size_t tamanho = (size_t)info.st_size;
+    void *mapa = mmap(NULL, tamanho, PROT_READ, MAP_PRIVATE, descritor, 0);
+    close(descritor);
+    if (mapa == MAP_FAILED)
+    {
+        perror("Erro ao mapear o mapa compilado");
+        return 0;
+    }
+
+    // Confere cabeçalho e limites das seções antes de usar qualquer índice
+    // (o cabeçalho da versão 1 termina antes de funcaoHash e o da versão 2 antes de offsetListas)
+    const CabecalhoMapa *cabecalho = (const CabecalhoMapa *)mapa;
+    const unsigned char *base = (const unsigned char *)mapa;
+    uint32_t versao = cabecalho->versao;
+    uint64_t tamanhoCabecalho = versao == 1   ? offsetof(CabecalhoMapa, funcaoHash)
+                                : versao == 2 ? offsetof(CabecalhoMapa, offsetListas)
+                                              : sizeof(CabecalhoMapa);
+    uint64_t tamanhoSala = versao < VERSAO_MAPA ? offsetof(SalaCompilada, implicacoes) : sizeof(SalaCompilada);
+    int valido = memcmp(cabecalho->assinatura, ASSINATURA_MAPA, sizeof(cabecalho->assinatura)) == 0 &&
+                 versao >= 1 && versao <= VERSAO_MAPA && tamanho >= tamanhoCabecalho &&
+                 cabecalho->numStrings > 0 && cabecalho->bytesStrings > 0 &&
+                 secaoDentroDoArquivo(cabecalho->offsetSalas, cabecalho->numSalas, tamanhoSala, tamanhoCabecalho, tamanho) &&
+                 secaoDentroDoArquivo(cabecalho->offsetOffsets, cabecalho->numStrings, sizeof(uint32_t), tamanhoCabecalho, tamanho) &&
+                 secaoDentroDoArquivo(cabecalho->offsetHashes, cabecalho->numStrings, sizeof(uint32_t), tamanhoCabecalho, tamanho) &&
+                 secaoDentroDoArquivo(cabecalho->offsetDados, cabecalho->bytesStrings, 1, tamanhoCabecalho, tamanho) &&
+                 (cabecalho->offsetSalas | cabecalho->offsetOffsets | cabecalho->offsetHashes) % 8 == 0;
+    valido = valido && (versao < VERSAO_MAPA ||
+                        (cabecalho->numListas > 0 &&
+                         secaoDentroDoArquivo(cabecalho->offsetListas, (uint64_t)cabecalho->numListas + 1, sizeof(uint32_t), tamanhoCabecalho, tamanho) &&
+                         secaoDentroDoArquivo(cabecalho->offsetImplicacoes, cabecalho->numImplicacoes, sizeof(Implicacao), tamanhoCabecalho, tamanho) &&
+                         (cabecalho->offsetListas | cabecalho->offsetImplicacoes) % 8 == 0));
+
+    // Versões 1 e 2: as salas são copiadas para o registro atual, sem lista de pesos
+    const SalaCompilada *salas = valido ? (const SalaCompilada *)(base + cabecalho->offsetSalas) : NULL;
+    SalaCompilada *convertidas = NULL;
+    if (valido && versao < VERSAO_MAPA)
+    {
+        convertidas = (SalaCompilada *)calloc(cabecalho->numSalas ? cabecalho->numSalas : 1, sizeof(SalaCompilada));
+        if (convertidas == NULL)
+        {
+            perror("Erro ao alocar memória para as salas do mapa");
+            exit(EXIT_FAILURE);
+        }
+        for (uint32_t i = 0; i < cabecalho->numSalas; i++)
+        {
+            memcpy(&convertidas[i], base + cabecalho->offsetSalas + i * tamanhoSala, tamanhoSala);
+        }
+        salas = convertidas;
+    }
+    const uint32_t *inicios = valido && versao == VERSAO_MAPA ? (const uint32_t *)(base + cabecalho->offsetListas) : NULL;
+    const Implicacao *pares = valido && versao == VERSAO_MAPA ? (const Implicacao *)(base + cabecalho->offsetImplicacoes) : NULL;
+    const uint32_t *offsets = valido ? (const uint32_t *)(base + cabecalho->offsetOffsets) : NULL;
+    const char *dados = valido ? (const char *)(base + cabecalho->offsetDados) : NULL;
+
+    // Textos: todo offset dentro da seção, que termina em '\0', e a string 0 é a vazia
+    valido = valido && dados[cabecalho->bytesStrings - 1] == '\0' && dados[offsets[STRING_VAZIA]] == '\0';
+    for (uint32_t i = 0; valido && i < cabecalho->numStrings; i++)
+    {
+        valido = offsets[i] < cabecalho->bytesStrings;
+    }
+    for (uint32_t i = 0; valido && i < cabecalho->numSalas; i++)
+    {
+        valido = salas[i].nome < cabecalho->numStrings && salas[i].pista < cabecalho->numStrings &&
+                 salas[i].suspeito < cabecalho->numStrings &&
+                 (inicios == NULL || salas[i].implicacoes < cabecalho->numListas);
+    }
+
+    // Listas: inícios crescentes dentro dos pares, a LISTA_VAZIA sem pares e cada par com
+    // um suspeito do pool (não vazio) e peso de 1 a PESO_MAXIMO_SUSPEITO
+    if (valido && inicios != NULL)
+    {
+        valido = inicios[LISTA_VAZIA] == 0 && inicios[LISTA_VAZIA + 1] == 0 &&
+                 inicios[cabecalho->numListas] == cabecalho->numImplicacoes;
+        for (uint32_t i = 0; valido && i < cabecalho->numListas; i++)
+        {
+            valido = inicios[i] <= inicios[i + 1];
+        }
+        for (uint32_t i = 0; valido && i < cabecalho->numImplicacoes; i++)
+        {
+            valido = pares[i].suspeito != STRING_VAZIA && pares[i].suspeito < cabecalho->numStrings &&
+                     pares[i].peso >= 1 && pares[i].peso <= PESO_MAXIMO_SUSPEITO;
+        }
+    }
+
+    destino->salas = salas;
+    destino->numSalas = valido ? cabecalho->numSalas : 0;
+    destino->raiz = valido ? cabecalho->raiz : 0;
+    if (!valido || !validarArvoreMansao(destino))
+    {
+        fprintf(stderr, "%s: mapa compilado inválido ou corrompido.\n", caminho);
+        munmap(mapa, tamanho);
+        free(convertidas);
+        memset(destino, 0, sizeof(*destino));
+        return 0;
+    }
+
+    destino->salasProprias = convertidas;
+    destino->capacidadeSalas = convertidas != NULL ? cabecalho->numSalas : 0;
+    destino->mapeamento = mapa;
+    destino->tamanhoMapeamento = tamanho;
+    destino->dicionario = dicionario;
+    adotarPoolMapeado(dicionario, dados, cabecalho->bytesStrings, offsets,
+                      (const uint32_t *)(base + cabecalho->offsetHashes), (int)cabecalho->numStrings);
+    if (inicios != NULL)
+    {
+        adotarListasMapeadas(dicionario, inicios, pares, cabecalho->numListas, cabecalho->numImplicacoes);
+    }
+    else
+    {
+        // Sem listas no arquivo: o dicionário fica só com a LISTA_VAZIA
+        ListasImplicacoes *listas = &dicionario->implicacoes;
+        garantirListasProprias(listas);
+        listas->quantidade = 1;
+        listas->numPares = 0;
+        listas->inicios[LISTA_VAZIA + 1] = 0;
+    }
+
+    // Mapa gravado com outra função de hash: os hashes gravados não servem para as buscas,
+    // então o pool passa para memória própria e é re-hasheado (só nesse caso há cópia)
+    uint32_t funcaoDoMapa = versao == 1 ? HASH_FNV1A : cabecalho->funcaoHash;
+    if (funcaoDoMapa != FUNCAO_HASH)
+    {
+        garantirPoolProprio(&dicionario->pool);
+        for (int id = 0; id < dicionario->pool.quantidade; id++)
+        {
+            dicionario->pool.hashes[id] = funcaoHash(textoDe(dicionario, id));
+        }
+    }
+    return 1;
+}
+
+/**
+ * @brief Carrega um mapa detectando o formato pela assinatura (compilado ou texto).
+ * @return 1 em caso de sucesso.
+ */
+int carregarMapa(const char *caminho, Dicionario *dicionario, Mansao *destino)
+{
+    char assinatura[sizeof(ASSINATURA_MAPA)] = {0};
+    FILE *arquivo = fopen(caminho, "rb");
+    if (arquivo == NULL)
+    {
+        perror("Erro ao abrir o mapa");
+        return 0;
+    }
+    size_t lidos = fread(assinatura, 1, sizeof(assinatura), arquivo);
+    fclose(arquivo);
+
+    if (lidos == sizeof(assinatura) && memcmp(assinatura, ASSINATURA_MAPA, sizeof(assinatura)) == 0)
+    {
+        return carregarMapaCompilado(caminho, dicionario, destino);
+    }
+    return carregarMapaTexto(caminho, dicionario, destino);
+}
+
+/**
+ * @brief Registra todos os suspeitos citados nas salas da mansão (em ordem de índice).
+ */
+void registrarSuspeitosDoMapa(const Mansao *mansao)
+{
+    for (uint32_t i = 0; i < mansao->numSalas; i++)
+    {
+        Implicacao unico;
+        uint32_t quantidade;
+        const Implicacao *pares = implicacoesDaSala(mansao->dicionario, &mansao->salas[i], &unico, &quantidade);
+        for (uint32_t j = 0; j < quantidade; j++)
+        {
+            registrarSuspeito(mansao->dicionario, (int)pares[j].suspeito);
+        }
+    }
+}
+
+/**
+ * @brief Deixa o dicionário da mansão pronto para ser só lido por sessões em várias
+ * threads: monta já o índice do pool (que buscarString montaria na primeira busca) e
+ * registra o nome vazio se alguma pista não tem suspeito (uma sessão o registraria ao
+ * coletá-la). Depois disso nenhum passo escreve no que é compartilhado, e as edições
+ * da mansão ficam recusadas.
+ */
+void congelarDicionario(const Mansao *mansao)
+{
+    Dicionario *dicionario = mansao->dicionario;
+    if (dicionario->pool.capacidade == 0)
+    {
+        redimensionarPool(&dicionario->pool);
+    }
+    for (uint32_t i = 0; i < mansao->numSalas; i++)
+    {
+        if (mansao->salas[i].pista == STRING_VAZIA)
+        {
+            continue;
+        }
+        Implicacao unico;
+        uint32_t quantidade;
+        const Implicacao *pares = implicacoesDaSala(dicionario, &mansao->salas[i], &unico, &quantidade);
+        registrarSuspeito(dicionario, (int)mansao->salas[i].suspeito);
+        for (uint32_t j = 0; j < quantidade; j++)
+        {
+            registrarSuspeito(dicionario, (int)pares[j].suspeito);
+        }
+    }
+    dicionario->congelado = 1;
+}
+
+/**
+ * @brief Libera a mansão (desfaz o mmap ou libera o array próprio).
+ * O dicionário é de quem carregou a mansão, e deve ser liberado antes se o pool dele
+ * adotou o arquivo mapeado.
+ */
+void liberarMansao(Mansao *mansao)
+{
+    if (mansao->mapeamento != NULL)
+    {
+        munmap(mansao->mapeamento, mansao->tamanhoMapeamento);
+    }
+    free(mansao->salasProprias);
+    memset(mansao, 0, sizeof(*mansao));
+}
+
+// ==========================================================
+//              LAYOUT DA MANSÃO (ORDEM DAS SALAS)
+// ==========================================================
+
+/**
+ * @brief Converte o nome de uma ordem ("largura", "profundidade" ou "veb") na constante.
+ * @return A constante ORDEM_* correspondente, ou -1 se o nome for desconhecido.
+ */
+int ordemPorNome(const char *nome)
+{
+    if (strcmp(nome, "largura") == 0)
+    {
+        return ORDEM_LARGURA;
+    }
+    if (strcmp(nome, "profundidade") == 0)
+    {
+        return ORDEM_PROFUNDIDADE;
+    }
+    if (strcmp(nome, "veb") == 0)
+    {
+        return ORDEM_VEB;
+    }
+    return -1;
+}
+
+/**
+ * @brief Preenche 'ordem' com as salas em largura (nível a nível) a partir da raiz.
+ * @return A altura da árvore, em níveis (0 para a mansão vazia).
+ */
+uint32_t ordenarEmLargura(const Mansao *mansao, uint32_t *ordem)
+{
+    if (mansao->numSalas == 0)
+    {
+        return 0;
+    }
+    uint32_t fim = 0;
+    uint32_t altura = 0;
+    ordem[fim++] = mansao->raiz;
+    for (uint32_t inicioNivel = 0; inicioNivel < fim; altura++)
+    {
+        uint32_t fimNivel = fim;
+        for (uint32_t i = inicioNivel; i < fimNivel; i++)
+        {
+            const SalaCompilada *sala = &mansao->salas[ordem[i]];
+            if (sala->esquerda != SEM_SALA)
+            {
+                ordem[fim++] = sala->esquerda;
+            }
+            if (sala->direita != SEM_SALA)
+            {
+                ordem[fim++] = sala->direita;
+            }
+        }
+        inicioNivel = fimNivel;
+    }
+    return altura;
+}
+
+/**
+ * @brief Preenche 'ordem' em pré-ordem (sala, esquerda, direita), com pilha explícita.
+ * Cada caminho para a esquerda fica contíguo no array.
+ */
+void ordenarEmProfundidade(const Mansao *mansao, uint32_t *ordem, uint32_t *pilha)
+{
+    if (mansao->numSalas == 0)
+    {
+        return;
+    }
+    uint32_t fim = 0;
+    uint32_t topo = 0;
+    pilha[topo++] = mansao->raiz;
+    while (topo > 0)
+    {
+        uint32_t atual = pilha[--topo];
+        ordem[fim++] = atual;
+        // A direita entra primeiro na pilha para a esquerda sair antes
+        if (mansao->salas[atual].direita != SEM_SALA)
+        {
+            pilha[topo++] = mansao->salas[atual].direita;
+        }
+        if (mansao->salas[atual].esquerda != SEM_SALA)
+        {
+            pilha[topo++] = mansao->salas[atual].esquerda;
+        }
+    }
+}
+
+/**
+ * @brief Preenche 'ordem' no layout de van Emde Boas: a árvore de 'altura' níveis é
+ * cortada ao meio, a metade de cima vem primeiro e depois cada subárvore de baixo,
+ * da esquerda para a direita, aplicando o mesmo corte em cada parte.
+ * Assim, qualquer caminho raiz→folha toca O(log_B n) blocos de cache, para qualquer B.
+ * As tarefas (raiz, níveis) ficam numa pilha explícita em vez de recursão.
+ */
+void ordenarVanEmdeBoas(const Mansao *mansao, uint32_t altura, uint32_t *ordem,
+                        uint32_t *fronteira, uint32_t *pilhaRaiz, uint32_t *pilhaNiveis)
+{
+    if (mansao->numSalas == 0)
+    {
+        return;
+    }
+    uint32_t fim = 0;
+    uint32_t topo = 0;
+    pilhaRaiz[topo] = mansao->raiz;
+    pilhaNiveis[topo++] = altura;
+    while (topo > 0)
+    {
+        topo--;
+        uint32_t raiz = pilhaRaiz[topo];
+        uint32_t niveis = pilhaNiveis[topo];
+        if (niveis == 1)
+        {
+            ordem[fim++] = raiz;
+            continue;
+        }
+
+        // Desce 'niveisTopo' níveis a partir da raiz: o último nível são as raízes de baixo
+        uint32_t niveisTopo = niveis / 2;
+        uint32_t inicioNivel = 0;
+        uint32_t fimNivel = 1;
+        fronteira[0] = raiz;
+        for (uint32_t nivel = 0; nivel < niveisTopo && inicioNivel < fimNivel; nivel++)
+        {
+            uint32_t proximo = fimNivel;
+            for (uint32_t i = inicioNivel; i < fimNivel; i++)
+            {
+                const SalaCompilada *sala = &mansao->salas[fronteira[i]];
+                if (sala->esquerda != SEM_SALA)
+                {
+                    fronteira[proximo++] = sala->esquerda;
+                }
+                if (sala->direita != SEM_SALA)
+                {
+                    fronteira[proximo++] = sala->direita;
+                }
+            }
+            inicioNivel = fimNivel;
+            fimNivel = proximo;
+        }
+
+        // Empilha as subárvores de baixo de trás para frente e, por último, a parte de cima
+        for (uint32_t i = fimNivel; i > inicioNivel; i--)
+        {
+            pilhaRaiz[topo] = fronteira[i - 1];
+            pilhaNiveis[topo++] = niveis - niveisTopo;
+        }
+        pilhaRaiz[topo] = raiz;
+        pilhaNiveis[topo++] = niveisTopo;
+    }
+}
+
+/**
+ * @brief Reorganiza as salas na ordem pedida (ORDEM_*) e renumera os filhos.
+ * A raiz continua no índice 0. Se a mansão veio de um arquivo mapeado, o mapeamento
+ * é mantido (o pool de strings pode apontar para ele) e só o array de salas é trocado.
+ */
+void reordenarMansao(Mansao *mansao, int tipoOrdem)
+{
+    uint32_t n = mansao->numSalas;
+    size_t bytes = sizeof(uint32_t) * (n ? n : 1);
+    uint32_t *ordem = (uint32_t *)malloc(bytes);
+    uint32_t *auxiliar = (uint32_t *)malloc(bytes);
+    uint32_t *pilhaRaiz = NULL;
+    uint32_t *pilhaNiveis = NULL;
+    if (tipoOrdem == ORDEM_VEB)
+    {
+        pilhaRaiz = (uint32_t *)malloc(bytes);
+        pilhaNiveis = (uint32_t *)malloc(bytes);
+    }
+    if (ordem == NULL || auxiliar == NULL || (tipoOrdem == ORDEM_VEB && (pilhaRaiz == NULL || pilhaNiveis == NULL)))
+    {
+        perror("Erro ao alocar memória para reordenar a Mansão");
+        exit(EXIT_FAILURE);
+    }
+
+    uint32_t altura = ordenarEmLargura(mansao, ordem);
+    if (tipoOrdem == ORDEM_PROFUNDIDADE)
+    {
+        ordenarEmProfundidade(mansao, ordem, auxiliar);
+    }
+    else if (tipoOrdem == ORDEM_VEB)
+    {
+        ordenarVanEmdeBoas(mansao, altura, ordem, auxiliar, pilhaRaiz, pilhaNiveis);
+    }
+    free(pilhaRaiz);
+    free(pilhaNiveis);
+
+    // auxiliar[antigo] = novo índice da sala
+    for (uint32_t i = 0; i < n; i++)
+    {
+        auxiliar[ordem[i]] = i;
+    }
+    SalaCompilada *novas = (SalaCompilada *)malloc(sizeof(SalaCompilada) * (n ? n : 1));
+    if (novas == NULL)
+    {
+        perror("Erro ao alocar memória para reordenar a Mansão");
+        exit(EXIT_FAILURE);
+    }
+    for (uint32_t i = 0; i < n; i++)
+    {
+        SalaCompilada sala = mansao->salas[ordem[i]];
+        sala.esquerda = sala.esquerda != SEM_SALA ? auxiliar[sala.esquerda] : SEM_SALA;
+        sala.direita = sala.direita != SEM_SALA ? auxiliar[sala.direita] : SEM_SALA;
+        novas[i] = sala;
+    }
+    free(ordem);
+    free(auxiliar);
+
+    free(mansao->salasProprias);
+    mansao->salasProprias = novas;
+    mansao->salas = novas;
+    mansao->capacidadeSalas = n;
+    mansao->raiz = 0;
+}
+
+// ==========================================================
+//        ÍNDICE DE SALAS (NOMES, ANCESTRAIS E CAMINHOS)
+// ==========================================================
+
+/**
+ * @brief Salto de um filho de 'pai': pula dois saltos do pai quando os dois têm o mesmo
+ * comprimento; senão aponta para o pai. Só depende do pai, então vale também para uma
+ * sala acrescentada ou religada depois da montagem.
+ */
+uint32_t saltoDoFilho(const IndiceSalas *indice, uint32_t pai)
+{
+    uint32_t salto = indice->saltos[pai];
+    uint32_t saltoDoSalto = indice->saltos[salto];
+    int mesmoComprimento = indice->profundidades[pai] - indice->profundidades[salto] ==
+                           indice->profundidades[salto] - indice->profundidades[saltoDoSalto];
+    return mesmoComprimento ? saltoDoSalto : pai;
+}
+
+/**
+ * @brief Monta o índice de salas em O(n): percorre a mansão em largura (pai antes dos
+ * filhos) preenchendo pai, profundidade e salto (saltoDoFilho), e guarda a sala mais
+ * rasa de cada nome.
+ */
+void construirIndiceSalas(const Mansao *mansao, IndiceSalas *indice)
+{
+    uint32_t n = mansao->numSalas;
+    memset(indice, 0, sizeof(*indice));
+    indice->mansao = mansao;
+    indice->capacidadeNomes = mansao->dicionario->pool.quantidade;
+    indice->capacidadeSalas = n + 1;
+    indice->pais = (uint32_t *)malloc(sizeof(uint32_t) * (n + 1));
+    indice->saltos = (uint32_t *)malloc(sizeof(uint32_t) * (n + 1));
+    indice->profundidades = (uint32_t *)malloc(sizeof(uint32_t) * (n + 1));
+    indice->salaPorNome = (uint32_t *)malloc(sizeof(uint32_t) * (indice->capacidadeNomes + 1));
+    uint32_t *ordem = (uint32_t *)malloc(sizeof(uint32_t) * (n + 1));
+    if (indice->pais == NULL || indice->saltos == NULL || indice->profundidades == NULL ||
+        indice->salaPorNome == NULL || ordem == NULL)
+    {
+        perror("Erro ao alocar memória para o índice de salas");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < indice->capacidadeNomes; i++)
+    {
+        indice->salaPorNome[i] = SEM_SALA;
+    }
+    if (n == 0)
+    {
+        free(ordem);
+        return;
+    }
+
+    ordenarEmLargura(mansao, ordem);
+    indice->pais[mansao->raiz] = SEM_SALA;
+    indice->saltos[mansao->raiz] = mansao->raiz;
+    indice->profundidades[mansao->raiz] = 0;
+    for (uint32_t i = 0; i < n; i++)
+    {
+        uint32_t pai = ordem[i];
+        const SalaCompilada *sala = &mansao->salas[pai];
+        if (indice->salaPorNome[sala->nome] == SEM_SALA)
+        {
+            indice->salaPorNome[sala->nome] = pai;
+        }
+
+        uint32_t salto = saltoDoFilho(indice, pai);
+        uint32_t filhos[2] = {sala->esquerda, sala->direita};
+        for (int f = 0; f < 2; f++)
+        {
+            if (filhos[f] != SEM_SALA)
+            {
+                indice->pais[filhos[f]] = pai;
+                indice->profundidades[filhos[f]] = indice->profundidades[pai] + 1;
+                indice->saltos[filhos[f]] = salto;
+            }
+        }
+    }
+    free(ordem);
+}
+
+/**
+ * @brief Sala de um nome exato (a mais próxima da raiz, se houver várias).
+ * @return O índice da sala ou SEM_SALA.
+ */
+uint32_t buscarSalaPorNome(const IndiceSalas *indice, const char *nome)
+{
+    int id = buscarString(indice->mansao->dicionario, nome, indice->estatisticas);
+    if (id < 0 || id >= indice->capacidadeNomes)
+    {
+        return SEM_SALA;
+    }
+    uint32_t sala = indice->salaPorNome[id];
+    if (indice->proximaComNome != NULL && sala != SEM_SALA)
+    {
+        // Depois de edições a lista do nome não fica em ordem: a mais rasa é procurada nela
+        for (uint32_t outra = indice->proximaComNome[sala]; outra != SEM_SALA; outra = indice->proximaComNome[outra])
+        {
+            if (indice->profundidades[outra] < indice->profundidades[sala])
+            {
+                sala = outra;
+            }
+        }
+    }
+    return sala;
+}
+
+/**
+ * @brief Ancestral de 'sala' na profundidade dada (que não pode passar da dela): O(log n).
+ */
+uint32_t salaAncestral(const IndiceSalas *indice, uint32_t sala, uint32_t profundidade)
+{
+    while (indice->profundidades[sala] > profundidade)
+    {
+        uint32_t salto = indice->saltos[sala];
+        sala = indice->profundidades[salto] >= profundidade ? salto : indice->pais[sala];
+    }
+    return sala;
+}
+
+/**
+ * @brief Menor ancestral comum de duas salas: O(log n). Depois de igualar as
+ * profundidades, as duas sobem juntas; na mesma profundidade os saltos têm o mesmo
+ * comprimento, então pular só quando os destinos diferem nunca passa do ancestral.
+ */
+uint32_t ancestralComum(const IndiceSalas *indice, uint32_t a, uint32_t b)
+{
+    if (indice->profundidades[a] > indice->profundidades[b])
+    {
+        a = salaAncestral(indice, a, indice->profundidades[b]);
+    }
+    else
+    {
+        b = salaAncestral(indice, b, indice->profundidades[a]);
+    }
+    while (a != b)
+    {
+        if (indice->saltos[a] != indice->saltos[b])
+        {
+            a = indice->saltos[a];
+            b = indice->saltos[b];
+        }
+        else
+        {
+            a = indice->pais[a];
+            b = indice->pais[b];
+        }
+    }
+    return a;
+}
+
+/**
+ * @brief Número de passos (subindo e descendo) entre duas salas: O(log n).
+ */
+uint32_t distanciaEntreSalas(const IndiceSalas *indice, uint32_t a, uint32_t b)
+{
+    uint32_t comum = ancestralComum(indice, a, b);
+    return indice->profundidades[a] + indice->profundidades[b] - 2 * indice->profundidades[comum];
+}
+
+/**
+ * @brief Escreve o caminho de 'de' até 'ate': sobe até o ancestral comum (↑) e desce
+ * até o destino (↓, com a direção). O(log n + tamanho do caminho).
+ */
+void mostrarCaminho(Renderizador *saida, const IndiceSalas *indice, uint32_t de, uint32_t ate)
+{
+    const Mansao *mansao = indice->mansao;
+    const Dicionario *dicionario = mansao->dicionario;
+    uint32_t comum = ancestralComum(indice, de, ate);
+    uint32_t descida = indice->profundidades[ate] - indice->profundidades[comum];
+    escrever(saida, "\n🧭 Caminho de '%s' até '%s' (%u passo(s)):\n   %s", textoDe(dicionario, mansao->salas[de].nome),
+             textoDe(dicionario, mansao->salas[ate].nome), indice->profundidades[de] - indice->profundidades[comum] + descida,
+             textoDe(dicionario, mansao->salas[de].nome));
+    for (uint32_t sala = de; sala != comum;)
+    {
+        sala = indice->pais[sala];
+        escrever(saida, " ↑ %s", textoDe(dicionario, mansao->salas[sala].nome));
+    }
+
+    // A descida é lida de baixo para cima, então é guardada antes de ser escrita
+    uint32_t *trecho = (uint32_t *)malloc(sizeof(uint32_t) * (descida + 1));
+    if (trecho == NULL)
+    {
+        perror("Erro ao alocar memória para o caminho");
+        exit(EXIT_FAILURE);
+    }
+    uint32_t sala = ate;
+    for (uint32_t i = descida; i > 0; i--)
+    {
+        trecho[i - 1] = sala;
+        sala = indice->pais[sala];
+    }
+    for (uint32_t i = 0; i < descida; i++)
+    {
+        uint32_t pai = i == 0 ? comum : trecho[i - 1];
+        escrever(saida, " ↓%c %s", mansao->salas[pai].esquerda == trecho[i] ? 'e' : 'd', textoDe(dicionario, mansao->salas[trecho[i]].nome));
+    }
+    escreverTexto(saida, "\n");
+    free(trecho);
+}
+
+/**
+ * @brief Libera a memória do índice de salas.
+ */
+void liberarIndiceSalas(IndiceSalas *indice)
+{
+    free(indice->pais);
+    free(indice->saltos);
+    free(indice->profundidades);
+    free(indice->salaPorNome);
+    free(indice->proximaComNome);
+    free(indice->anteriorComNome);
+    free(indice->alasSoltas);
+    memset(indice, 0, sizeof(*indice));
+}
+
+// ==========================================================
+//           ÍNDICE DE TRIGRAMAS (BUSCA POR TRECHO)
+// ==========================================================
+
+/**
+ * @brief Byte 'i' do texto em minúsculo: ASCII pelo tolower e, em UTF-8, as maiúsculas
+ * acentuadas do Latin-1 (À a Þ, menos o ×), que viram as minúsculas (à a þ). As duas
+ * formas são 0xC3 seguido de um byte que só difere em 0x20, então o tamanho não muda.
+ */
+unsigned char byteEmMinusculo(const char *texto, size_t i)
+{
+    unsigned char c = (unsigned char)texto[i];
+    if (c >= 0x80 && c <= 0x9E && c != 0x97 && i > 0 && (unsigned char)texto[i - 1] == 0xC3)
+    {
+        return (unsigned char)(c + 0x20);
+    }
+    return (unsigned char)tolower(c);
+}
+
+/**
+ * @brief Empacota os bytes i, i+1 e i+2 do texto (em minúsculo) em um trigrama.
+ */
+uint32_t trigramaEm(const char *texto, size_t i)
+{
+    return (uint32_t)byteEmMinusculo(texto, i) << 16 |
+           (uint32_t)byteEmMinusculo(texto, i + 1) << 8 |
+           (uint32_t)byteEmMinusculo(texto, i + 2);
+}
+
+/**
+ * @brief Retorna 1 se 'texto' contém 'trecho', sem diferenciar maiúsculas (ASCII e as
+ * letras acentuadas do Latin-1).
+ */
+int contemTrecho(const char *texto, const char *trecho)
+{
+    size_t tamanho = strlen(trecho);
+    for (size_t inicio = 0; texto[inicio] != '\0'; inicio++)
+    {
+        size_t i = 0;
+        while (i < tamanho && texto[inicio + i] != '\0' &&
+               byteEmMinusculo(texto, inicio + i) == byteEmMinusculo(trecho, i))
+        {
+            i++;
+        }
+        if (i == tamanho)
+        {
+            return 1;
+        }
+    }
+    return tamanho == 0;
+}
+
+/**
+ * @brief Localiza o slot de um trigrama (o slot dele ou o vazio onde ele entraria).
+ */
+SlotTrigrama *localizarTrigrama(const IndiceTrigramas *indice, uint32_t trigrama)
+{
+    unsigned int mascara = (unsigned int)indice->capacidade - 1;
+    unsigned int i = (trigrama * 2654435761u) & mascara;
+    while (indice->slots[i].geracao == indice->geracao && indice->slots[i].trigrama != trigrama)
+    {
+        i = (i + 1) & mascara;
+    }
+    return &indice->slots[i];
+}
+
+/**
+ * @brief Aloca 'capacidade' slots vazios (geração 0 nunca é a atual).
+ */
+SlotTrigrama *alocarSlotsTrigrama(int capacidade)
+{
+    SlotTrigrama *slots = (SlotTrigrama *)calloc((size_t)capacidade, sizeof(SlotTrigrama));
+    if (slots == NULL)
+    {
+        perror("Erro ao alocar memória para o índice de trigramas");
+        exit(EXIT_FAILURE);
+    }
+    return slots;
+}
+
+/**
+ * @brief Dobra o número de slots e reinsere os trigramas da geração atual.
+ */
+void redimensionarIndiceTrigramas(IndiceTrigramas *indice)
+{
+    SlotTrigrama *antigos = indice->slots;
+    int capacidadeAntiga = indice->capacidade;
+    indice->capacidade *= 2;
+    indice->slots = alocarSlotsTrigrama(indice->capacidade);
+    for (int i = 0; i < capacidadeAntiga; i++)
+    {
+        if (antigos[i].geracao == indice->geracao)
+        {
+            *localizarTrigrama(indice, antigos[i].trigrama) = antigos[i];
+        }
+    }
+    free(antigos);
+}
+
+/**
+ * @brief Acrescenta a evidência à lista do trigrama (uma vez por evidência).
+ */
+void indexarTrigrama(IndiceTrigramas *indice, uint32_t trigrama, int entrada)
+{
+    if ((indice->usados + 1) * CARGA_MAXIMA_DEN > indice->capacidade * CARGA_MAXIMA_NUM)
+    {
+        redimensionarIndiceTrigramas(indice);
+    }
+    SlotTrigrama *slot = localizarTrigrama(indice, trigrama);
+    if (slot->geracao != indice->geracao)
+    {
+        slot->trigrama = trigrama;
+        slot->geracao = indice->geracao;
+        slot->primeira = -1;
+        slot->ultima = -1;
+        slot->quantidade = 0;
+        indice->usados++;
+    }
+    else if (indice->ocorrencias[slot->ultima].entrada == entrada)
+    {
+        return; // O trigrama se repete no mesmo texto
+    }
+
+    if (indice->numOcorrencias == indice->capacidadeOcorrencias)
+    {
+        int novaCapacidade = indice->capacidadeOcorrencias ? indice->capacidadeOcorrencias * 2 : TAMANHO_HASH * 4;
+        OcorrenciaTrigrama *novas = (OcorrenciaTrigrama *)realloc(indice->ocorrencias, sizeof(OcorrenciaTrigrama) * novaCapacidade);
+        if (novas == NULL)
+        {
+            perror("Erro ao alocar memória para o índice de trigramas");
+            exit(EXIT_FAILURE);
+        }
+        indice->ocorrencias = novas;
+        indice->capacidadeOcorrencias = novaCapacidade;
+    }
+    int nova = indice->numOcorrencias++;
+    indice->ocorrencias[nova].entrada = entrada;
+    indice->ocorrencias[nova].proxima = -1;
+    if (slot->ultima >= 0)
+    {
+        indice->ocorrencias[slot->ultima].proxima = nova;
+    }
+    else
+    {
+        slot->primeira = nova;
+    }
+    slot->ultima = nova;
+    slot->quantidade++;
+}
+
+/**
+ * @brief Indexa as evidências que chegaram desde a última busca. As evidências só são
+ * acrescentadas ao fim do array da Tabela Hash, então basta continuar de onde parou:
+ * cada pista é indexada uma vez, e quem nunca busca não paga nada.
+ */
+void atualizarIndiceTrigramas(IndiceTrigramas *indice, const TabelaHash *evidencias)
+{
+    if (indice->slots == NULL)
+    {
+        indice->capacidade = TAMANHO_HASH * 4;
+        indice->slots = alocarSlotsTrigrama(indice->capacidade);
+        indice->geracao = 1;
+    }
+    for (; indice->indexadas < evidencias->quantidade; indice->indexadas++)
+    {
+        const char *texto = textoDe(evidencias->dicionario, evidencias->entradas[indice->indexadas].pista);
+        for (size_t i = 0; texto[i] != '\0' && texto[i + 1] != '\0' && texto[i + 2] != '\0'; i++)
+        {
+            indexarTrigrama(indice, trigramaEm(texto, i), indice->indexadas);
+        }
+    }
+}
+
+/**
+ * @brief Busca as evidências cuja pista contém 'trecho' (sem diferenciar maiúsculas,
+ * inclusive as acentuadas).
+ * Com 3 ou mais caracteres, só as evidências do trigrama mais raro do trecho são
+ * conferidas; com menos, todas são.
+ * @param entradas Recebe até 'capacidade' índices de evidências, em ordem de coleta.
+ * @return O total de evidências encontradas (pode passar de 'capacidade').
+ */
+int buscarPorTrecho(IndiceTrigramas *indice, const TabelaHash *evidencias, const char *trecho, int *entradas, int capacidade)
+{
+    atualizarIndiceTrigramas(indice, evidencias);
+    int encontradas = 0;
+    size_t tamanho = strlen(trecho);
+    if (tamanho < 3)
+    {
+        for (int i = 0; i < evidencias->quantidade; i++)
+        {
+            if (contemTrecho(textoDe(evidencias->dicionario, evidencias->entradas[i].pista), trecho))
+            {
+                if (encontradas < capacidade)
+                {
+                    entradas[encontradas] = i;
+                }
+                encontradas++;
+            }
+        }
+        return encontradas;
+    }
+
+    const SlotTrigrama *maisRaro = NULL;
+    for (size_t i = 0; i + 2 < tamanho; i++)
+    {
+        const SlotTrigrama *slot = localizarTrigrama(indice, trigramaEm(trecho, i));
+        if (slot->geracao != indice->geracao)
+        {
+            return 0; // Um trigrama que nenhuma pista tem
+        }
+        if (maisRaro == NULL || slot->quantidade < maisRaro->quantidade)
+        {
+            maisRaro = slot;
+        }
+    }
+    for (int o = maisRaro->primeira; o >= 0; o = indice->ocorrencias[o].proxima)
+    {
+        int entrada = indice->ocorrencias[o].entrada;
+        if (contemTrecho(textoDe(evidencias->dicionario, evidencias->entradas[entrada].pista), trecho))
+        {
+            if (encontradas < capacidade)
+            {
+                entradas[encontradas] = entrada;
+            }
+            encontradas++;
+        }
+    }
+    return encontradas;
+}
+
+/**
+ * @brief Esvazia o índice em O(1) (nova geração), mantendo a memória.
+ */
+void reiniciarIndiceTrigramas(IndiceTrigramas *indice)
+{
+    indice->geracao++;
+    if (indice->geracao == 0)
+    {
+        // A geração deu a volta: limpa os slots para nenhum parecer ocupado
+        memset(indice->slots, 0, sizeof(SlotTrigrama) * (size_t)indice->capacidade);
+        indice->geracao = 1;
+    }
+    indice->usados = 0;
+    indice->numOcorrencias = 0;
+    indice->indexadas = 0;
+}
+
+/**
+ * @brief Libera a memória do índice.
+ */
+void liberarIndiceTrigramas(IndiceTrigramas *indice)
+{
+    free(indice->slots);
+    free(indice->ocorrencias);
+    memset(indice, 0, sizeof(*indice));
+}
+
+// ==========================================================
+//                 SESSÃO (INVESTIGAÇÃO)
+// ==========================================================
+
+/**
+ * @brief Prepara uma sessão vazia na raiz da mansão.
+ * O progresso (pistas coletadas) fica na sessão, então a mansão pode ser somente leitura.
+ */
+void iniciarSessao(Sessao *sessao, const Mansao *mansao)
+{
+    sessao->mansao = mansao;
+    sessao->salaAtual = mansao->raiz;
+    sessao->pistasRaiz = NULL;
+    iniciarArena(&sessao->arenaPistas);
+    sessao->coletadas = (uint64_t *)calloc((mansao->numSalas + 63) / 64 + 1, sizeof(uint64_t));
+    if (sessao->coletadas == NULL)
+    {
+        perror("Erro ao alocar memória para a Sessão");
+        exit(EXIT_FAILURE);
+    }
+    sessao->salasNoBitset = ((mansao->numSalas + 63) / 64 + 1) * 64;
+    sessao->salasColetadas = NULL;
+    sessao->numColetadas = 0;
+    sessao->capacidadeColetadas = 0;
+    memset(&sessao->estatisticas, 0, sizeof(sessao->estatisticas));
+    inicializarHash(&sessao->evidencias, mansao->dicionario);
+    sessao->evidencias.estatisticas = &sessao->estatisticas;
+    iniciarPlacar(&sessao->placar, mansao->dicionario);
+    sessao->comandos = 0;
+    memset(&sessao->trechos, 0, sizeof(sessao->trechos));
+    sessao->indiceSalas = NULL;
+    iniciarIndiceSuspeitos(&sessao->porSuspeito);
+    sessao->catalogo = NULL;
+    iniciarMotorDeducao(&sessao->motor);
+    garantirSuspeitoNoMotor(&sessao->motor, mansao->dicionario->suspeitos.quantidade - 1); // Prior uniforme sobre os suspeitos do mapa
+    memset(&sessao->relatorio, 0, sizeof(sessao->relatorio));
+    sessao->geracaoRelatorio = 0; // A geração da Tabela Hash começa em 1: nada em cache
+    sessao->quantidadeRelatorio = 0;
+}
+
+/**
+ * @brief Retorna 1 se a pista da sala já foi coletada nesta sessão.
+ */
+int pistaColetada(const Sessao *sessao, uint32_t sala)
+{
+    return (sessao->coletadas[sala / 64] >> (sala % 64)) & 1;
+}
+
+/**
+ * @brief Marca a pista da sala como coletada e lembra a sala para reiniciar depois.
+ */
+void marcarColetada(Sessao *sessao, uint32_t sala)
+{
+    sessao->coletadas[sala / 64] |= (uint64_t)1 << (sala % 64);
+
+    if (sessao->numColetadas == sessao->capacidadeColetadas)
+    {
+        int novaCapacidade = sessao->capacidadeColetadas ? sessao->capacidadeColetadas * 2 : TAMANHO_HASH;
+        uint32_t *novas = (uint32_t *)realloc(sessao->salasColetadas, sizeof(uint32_t) * novaCapacidade);
+        if (novas == NULL)
+        {
+            perror("Erro ao alocar memória para a Sessão");
+            exit(EXIT_FAILURE);
+        }
+        sessao->salasColetadas = novas;
+        sessao->capacidadeColetadas = novaCapacidade;
+    }
+    sessao->salasColetadas[sessao->numColetadas++] = sala;
+}
+
+/**
+ * @brief Coleta (sem imprimir) a pista de uma sala, se houver e ainda não foi coletada.
+ * Insere na BST e na Tabela Hash. A duplicata é detectada por comparação de ids;
+ * strcmp só decide a ordem alfabética.
+ * @return COLETA_NENHUMA, COLETA_NOVA ou COLETA_DUPLICADA.
+ */
+int coletarPistaDe(Sessao *sessao, uint32_t indice)
+{
+    const SalaCompilada *sala = &sessao->mansao->salas[indice];
+    if (sala->pista == STRING_VAZIA || pistaColetada(sessao, indice))
+    {
+        return COLETA_NENHUMA;
+    }
+
+    int resultado = COLETA_DUPLICADA;
+    if (inserirPistaBalanceada(sessao->mansao->dicionario, &sessao->arenaPistas, &sessao->pistasRaiz, (int)sala->pista,
+                               &sessao->estatisticas))
+    {
+        resultado = COLETA_NOVA;
+        if (inserirNaHash(&sessao->evidencias, &sessao->placar, (int)sala->pista, (int)sala->suspeito))
+        {
+            indexarEvidencia(sessao, &sessao->evidencias.entradas[sessao->evidencias.quantidade - 1], sala);
+        }
+    }
+    marcarColetada(sessao, indice);
+    return resultado;
+}
+
+/**
+ * @brief Coleta (sem imprimir) a pista da sala atual.
+ * @return COLETA_NENHUMA, COLETA_NOVA ou COLETA_DUPLICADA.
+ */
+int coletarPistaDaSala(Sessao *sessao)
+{
+    return coletarPistaDe(sessao, sessao->salaAtual);
+}
+
+/**
+ * @brief Desfaz o estado da sessão (pistas coletadas, BST, Tabela Hash e citações)
+ * e volta para a raiz, reaproveitando a memória já alocada. A BST e a Tabela Hash
+ * são descartadas em O(1) (arena e geração).
+ */
+void reiniciarSessao(Sessao *sessao)
+{
+    for (int i = 0; i < sessao->numColetadas; i++)
+    {
+        uint32_t sala = sessao->salasColetadas[i];
+        sessao->coletadas[sala / 64] &= ~((uint64_t)1 << (sala % 64));
+    }
+    sessao->numColetadas = 0;
+    reiniciarArena(&sessao->arenaPistas);
+    sessao->pistasRaiz = NULL;
+    sessao->salaAtual = sessao->mansao->raiz;
+    reiniciarHash(&sessao->evidencias);
+    zerarCitacoes(&sessao->placar);
+    reiniciarIndiceTrigramas(&sessao->trechos);
+    reiniciarIndiceSuspeitos(&sessao->porSuspeito);
+    reiniciarMotorDeducao(&sessao->motor);
+}
+
+/**
+ * @brief Coleta de uma vez as pistas das 'quantidade' salas de 'salas', na ordem dada, e
+ * deixa a sessão igual à de coletarPistaDe chamada sala a sala: mesma BST em ordem, mesma
+ * ordem das evidências na Tabela Hash e mesmo placar. A sessão precisa estar vazia.
+ * Em vez de uma descida na AVL e uma busca na hash por pista, ordena o lote uma vez
+ * (as repetidas são descartadas ali), monta a AVL balanceada em O(n) e insere na hash
+ * já no tamanho final.
+ * @return 1 em caso de sucesso; 0 se alguma sala não existir, não tiver pista ou se
+ * repetir (a sessão volta à raiz, vazia).
+ */
+int carregarColetasEmLote(Sessao *sessao, const uint32_t *salas, uint32_t quantidade)
+{
+    const Mansao *mansao = sessao->mansao;
+    PistaDoLote *lote = (PistaDoLote *)malloc(sizeof(PistaDoLote) * (quantidade ? quantidade : 1));
+    if (lote == NULL)
+    {
+        perror("Erro ao alocar memória para a carga em lote");
+        exit(EXIT_FAILURE);
+    }
+
+    // 1. Marca as salas e junta as pistas na ordem de coleta
+    for (uint32_t i = 0; i < quantidade; i++)
+    {
+        if (i + DISTANCIA_PREFETCH < quantidade && salas[i + DISTANCIA_PREFETCH] < mansao->numSalas)
+        {
+            __builtin_prefetch(&mansao->salas[salas[i + DISTANCIA_PREFETCH]]);
+        }
+        uint32_t sala = salas[i];
+        if (sala >= mansao->numSalas || mansao->salas[sala].pista == STRING_VAZIA || pistaColetada(sessao, sala))
+        {
+            free(lote);
+            reiniciarSessao(sessao);
+            return 0;
+        }
+        marcarColetada(sessao, sala);
+        lote[i].pista = (int)mansao->salas[sala].pista;
+        lote[i].suspeito = (int)mansao->salas[sala].suspeito;
+        lote[i].ordem = i;
+    }
+
+    // 2. Ordena, descarta as repetidas e monta a AVL
+    int distintas = ordenarLoteDePistas(sessao->mansao->dicionario, lote, (int)quantidade);
+    sessao->pistasRaiz = construirPistasBalanceadas(&sessao->arenaPistas, lote, distintas);
+    SOMAR(&sessao->estatisticas, pistasDuplicadas, quantidade - (uint32_t)distintas);
+    SOMAR(&sessao->estatisticas, pistasCriadas, distintas);
+
+    // 3. Volta as distintas para a ordem de coleta (as posições são distintas e < quantidade)
+    unsigned char *primeira = (unsigned char *)calloc(quantidade ? quantidade : 1, 1);
+    if (primeira == NULL)
+    {
+        perror("Erro ao alocar memória para a carga em lote");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < distintas; i++)
+    {
+        primeira[lote[i].ordem] = 1;
+    }
+    int k = 0;
+    for (uint32_t i = 0; i < quantidade; i++)
+    {
+        if (primeira[i])
+        {
+            const SalaCompilada *sala = &mansao->salas[salas[i]];
+            lote[k].pista = (int)sala->pista;
+            lote[k].suspeito = (int)sala->suspeito;
+            lote[k++].ordem = salas[i]; // Daqui em diante 'ordem' guarda a sala, para indexarEvidencia
+
+        }
+    }
+    free(primeira);
+
+    // 4. Evidências, placar e índices derivados, na ordem de coleta
+    int antes = sessao->evidencias.quantidade;
+    inserirLoteNaHash(&sessao->evidencias, &sessao->placar, lote, distintas);
+    for (int i = antes; i < sessao->evidencias.quantidade; i++)
+    {
+        indexarEvidencia(sessao, &sessao->evidencias.entradas[i], &mansao->salas[lote[i - antes].ordem]);
+    }
+    free(lote);
+    return 1;
+}
+
+/**
+ * @brief Libera a memória da sessão (a mansão pertence a quem chamou).
+ */
+void liberarSessao(Sessao *sessao)
+{
+    reiniciarSessao(sessao);
+    liberarArena(&sessao->arenaPistas);
+    liberarHash(&sessao->evidencias);
+    liberarPlacar(&sessao->placar);
+    liberarSaida(&sessao->relatorio);
+    liberarIndiceTrigramas(&sessao->trechos);
+    if (sessao->indiceSalas != NULL)
+    {
+        liberarIndiceSalas(sessao->indiceSalas);
+        free(sessao->indiceSalas);
+        sessao->indiceSalas = NULL;
+    }
+    liberarIndiceSuspeitos(&sessao->porSuspeito);
+    liberarMotorDeducao(&sessao->motor);
+    if (sessao->catalogo != NULL)
+    {
+        liberarIndiceSuspeitos(sessao->catalogo);
+        free(sessao->catalogo);
+        sessao->catalogo = NULL;
+    }
+    free(sessao->coletadas);
+    free(sessao->salasColetadas);
+    sessao->coletadas = NULL;
+    sessao->salasColetadas = NULL;
+    sessao->capacidadeColetadas = 0;
+}
+
+/**
+ * @brief Índice de salas da mansão da sessão, montado no primeiro uso (teleporte,
+ * volta ou caminho). Quem nunca usa esses comandos não paga o O(n) da montagem.
+ */
+const IndiceSalas *indiceDaSessao(Sessao *sessao)
+{
+    if (sessao->indiceSalas == NULL)
+    {
+        sessao->indiceSalas = (IndiceSalas *)malloc(sizeof(IndiceSalas));
+        if (sessao->indiceSalas == NULL)
+        {
+            perror("Erro ao alocar memória para o índice de salas");
+            exit(EXIT_FAILURE);
+        }
+        construirIndiceSalas(sessao->mansao, sessao->indiceSalas);
+        sessao->indiceSalas->estatisticas = &sessao->estatisticas;
+    }
+    return sessao->indiceSalas;
+}
+
+/**
+ * @brief Catálogo congelado de pistas por suspeito do mapa da sessão, montado na primeira consulta.
+ */
+const IndiceSuspeitos *catalogoDaSessao(Sessao *sessao)
+{
+    if (sessao->catalogo == NULL)
+    {
+        sessao->catalogo = (IndiceSuspeitos *)malloc(sizeof(IndiceSuspeitos));
+        if (sessao->catalogo == NULL)
+        {
+            perror("Erro ao alocar memória para o catálogo de suspeitos");
+            exit(EXIT_FAILURE);
+        }
+        construirCatalogoSuspeitos(sessao->mansao, sessao->catalogo);
+    }
+    return sessao->catalogo;
+}
+
+/**
+ * @brief Mostra os suspeitos mais prováveis segundo o motor de dedução ponderada.
+ */
+void mostrarProbabilidades(Renderizador *saida, const Dicionario *dicionario, const MotorDeducao *motor)
+{
+    ProbabilidadeSuspeito ranking[SUSPEITOS_NA_PROBABILIDADE];
+    int quantidade = melhoresPosteriores(motor, SUSPEITOS_NA_PROBABILIDADE, ranking);
+    escreverTexto(saida, "🎲 Probabilidade de culpa (pistas ponderadas):\n");
+    for (int i = 0; i < quantidade; i++)
+    {
+        escrever(saida, "  %-20s %5.1f%%\n", nomeDoSuspeito(dicionario, ranking[i].suspeito),
+                 100.0 * ranking[i].probabilidade);
+    }
+    escreverTexto(saida, "---------------------------------------------\n");
+}
+
+/**
+ * @brief Mostra a análise das evidências da sessão. O texto renderizado fica guardado e
+ * só é refeito quando o conjunto de evidências (ou a verbosidade) muda; repetir [a]
+ * sem novas pistas só copia os bytes para a saída.
+ */
+void mostrarDeducao(Sessao *sessao, Renderizador *saida)
+{
+    Renderizador *relatorio = &sessao->relatorio;
+    if (relatorio->buffer == NULL)
+    {
+        iniciarSaida(relatorio, SAIDA_EM_MEMORIA, saida->verbosidade, TAMANHO_BUFFER_CONEXAO);
+    }
+    if (sessao->geracaoRelatorio != sessao->evidencias.geracao ||
+        sessao->quantidadeRelatorio != sessao->evidencias.quantidade ||
+        relatorio->verbosidade != saida->verbosidade)
+    {
+        relatorio->verbosidade = saida->verbosidade;
+        relatorio->tamanhoMemoria = 0;
+        analisarEvidencias(relatorio, &sessao->evidencias, &sessao->placar);
+        if (mostrar(relatorio, VERBOSIDADE_COMPLETA) && sessao->evidencias.quantidade > 0)
+        {
+            mostrarProbabilidades(relatorio, sessao->mansao->dicionario, &sessao->motor);
+        }
+        descarregarSaida(relatorio);
+        sessao->geracaoRelatorio = sessao->evidencias.geracao;
+        sessao->quantidadeRelatorio = sessao->evidencias.quantidade;
+    }
+    escreverBytes(saida, relatorio->memoria, relatorio->tamanhoMemoria);
+}
+
+// ==========================================================
+//              MOTOR DO JOGO (PASSOS SEM E/S)
+// ==========================================================
+
+// Cada passo recebe a sessão (mansão, sala atual, diário, evidências e placar) e só mexe
+// nela: nada é impresso nem lido aqui. O jogo interativo, o lote e o servidor renderizam
+// o resultado do jeito deles, e sessões diferentes podem andar em threads diferentes sem
+// travas, desde que o dicionário tenha sido congelado antes (congelarDicionario).
+
+/**
+ * @brief Move a sessão para a esquerda ('e') ou a direita ('d'), sem coletar a pista.
+ * @return 1 se a sala mudou, 0 se o caminho está bloqueado ou a direção é inválida.
+ */
+int moverSessao(Sessao *sessao, int direcao)
+{
+    const SalaCompilada *sala = &sessao->mansao->salas[sessao->salaAtual];
+    uint32_t destino = direcao == 'e' ? sala->esquerda : direcao == 'd' ? sala->direita : SEM_SALA;
+    if (destino == SEM_SALA)
+    {
+        return 0;
+    }
+    sessao->salaAtual = destino;
+    return 1;
+}
+
+/**
+ * @brief Volta a sessão para a sala de onde se chega à atual.
+ * @return 1 se a sala mudou, 0 na entrada da mansão.
+ */
+int voltarSessao(Sessao *sessao)
+{
+    uint32_t pai = indiceDaSessao(sessao)->pais[sessao->salaAtual];
+    if (pai == SEM_SALA)
+    {
+        return 0;
+    }
+    sessao->salaAtual = pai;
+    return 1;
+}
+
+/**
+ * @brief Leva a sessão direto para a sala com esse nome, sem coletar a pista.
+ * @param passos Recebe quantos passos o caminho normal teria (pode ser NULL).
+ * @return 1 se a sala existe (e a sessão está nela), 0 caso contrário.
+ */
+int teleportarSessao(Sessao *sessao, const char *nome, uint32_t *passos)
+{
+    const IndiceSalas *indice = indiceDaSessao(sessao);
+    uint32_t destino = buscarSalaPorNome(indice, nome);
+    if (destino == SEM_SALA)
+    {
+        return 0;
+    }
+    if (passos != NULL)
+    {
+        *passos = distanciaEntreSalas(indice, sessao->salaAtual, destino);
+    }
+    sessao->salaAtual = destino;
+    return 1;
+}
+
+/**
+ * @brief Dedução atual da sessão: o líder do placar e o mais provável pelo motor ponderado.
+ */
+Deducao deduzir(const Sessao *sessao)
+{
+    Deducao deducao = deduzirDoPlacar(&sessao->evidencias, &sessao->placar);
+    if (deducao.pistas > 0)
+    {
+        melhoresPosteriores(&sessao->motor, 1, &deducao.maisProvavel);
+    }
+    return deducao;
+}
+
+/**
+ * @brief Aplica um comando do jogo à sessão, sem nenhuma saída: 'e'/'d' movem (se o
+ * caminho existe) e coletam a pista da nova sala; 's' encerra. Em uma folha, qualquer
+ * comando é a resposta da dedução final e encerra. 'a' e comandos inválidos não mudam nada.
+ * @return 1 se a investigação terminou com este comando, 0 caso contrário.
+ */
+int aplicarComando(Sessao *sessao, int comando)
+{
+    sessao->comandos++;
+    if (comando == 's' || ehFolha(sessao->mansao, sessao->salaAtual))
+    {
+        return 1;
+    }
+    if ((comando == 'e' || comando == 'd') && moverSessao(sessao, comando))
+    {
+        coletarPistaDaSala(sessao);
+    }
+    return 0;
+}
+
+// ==========================================================
+//         EDIÇÃO DA MANSÃO (ÍNDICES INCREMENTAIS)
+// ==========================================================
+
+// A mansão editada é a da sessão do jogo e não pode estar sendo lida por outras sessões.
+// A primeira edição torna o array de salas próprio e monta o índice de salas e o catálogo
+// de suspeitos da sessão (O(n), uma vez só). Depois disso, cada edição atualiza só o que
+// mudou. As salas de uma ala desanexada continuam no array, mas fora dos índices, até
+// serem religadas.
+
+/**
+ * @brief Ligação do lado 'e' ou 'd' de uma sala.
+ * @return Ponteiro para o campo esquerda/direita, ou NULL se o lado é inválido.
+ */
+uint32_t *ladoDaSala(Mansao *mansao, uint32_t sala, int lado)
+{
+    if (lado == 'e')
+    {
+        return &mansao->salasProprias[sala].esquerda;
+    }
+    return lado == 'd' ? &mansao->salasProprias[sala].direita : NULL;
+}
+
+/**
+ * @brief Garante uma posição em salaPorNome para o id de texto (os textos novos da edição
+ * passam da capacidade do índice).
+ */
+void garantirNomeNoIndice(IndiceSalas *indice, uint32_t nome)
+{
+    if ((int)nome < indice->capacidadeNomes)
+    {
+        return;
+    }
+    int novaCapacidade = indice->capacidadeNomes ? indice->capacidadeNomes * 2 : TAMANHO_HASH;
+    while (novaCapacidade <= (int)nome)
+    {
+        novaCapacidade *= 2;
+    }
+    uint32_t *novos = (uint32_t *)realloc(indice->salaPorNome, sizeof(uint32_t) * (novaCapacidade + 1));
+    if (novos == NULL)
+    {
+        perror("Erro ao alocar memória para o índice de salas");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = indice->capacidadeNomes; i < novaCapacidade; i++)
+    {
+        novos[i] = SEM_SALA;
+    }
+    indice->salaPorNome = novos;
+    indice->capacidadeNomes = novaCapacidade;
+}
+
+/**
+ * @brief Coloca a sala no começo da lista do seu nome: O(1).
+ */
+void ligarNomeDaSala(IndiceSalas *indice, uint32_t sala)
+{
+    uint32_t nome = indice->mansao->salas[sala].nome;
+    garantirNomeNoIndice(indice, nome);
+    uint32_t primeira = indice->salaPorNome[nome];
+    indice->anteriorComNome[sala] = SEM_SALA;
+    indice->proximaComNome[sala] = primeira;
+    if (primeira != SEM_SALA)
+    {
+        indice->anteriorComNome[primeira] = sala;
+    }
+    indice->salaPorNome[nome] = sala;
+}
+
+/**
+ * @brief Tira a sala da lista do seu nome: O(1).
+ */
+void desligarNomeDaSala(IndiceSalas *indice, uint32_t sala)
+{
+    uint32_t anterior = indice->anteriorComNome[sala];
+    uint32_t proxima = indice->proximaComNome[sala];
+    if (anterior != SEM_SALA)
+    {
+        indice->proximaComNome[anterior] = proxima;
+    }
+    else
+    {
+        indice->salaPorNome[indice->mansao->salas[sala].nome] = proxima;
+    }
+    if (proxima != SEM_SALA)
+    {
+        indice->anteriorComNome[proxima] = anterior;
+    }
+}
+
+/**
+ * @brief Soma 'delta' vezes o peso de cada suspeito da sala à pista dela no catálogo
+ * (se ela tem pista e suspeito).
+ */
+void contarPistaNoCatalogo(IndiceSuspeitos *catalogo, Dicionario *dicionario, const SalaCompilada *sala, int delta)
+{
+    if (sala->pista == STRING_VAZIA)
+    {
+        return;
+    }
+    Implicacao unico;
+    uint32_t quantidade;
+    const Implicacao *pares = implicacoesDaSala(dicionario, sala, &unico, &quantidade);
+    for (uint32_t i = 0; i < quantidade; i++)
+    {
+        ajustarPesoDaPista(catalogo, (int)sala->pista, registrarSuspeito(dicionario, (int)pares[i].suspeito),
+                           delta * (int)pares[i].peso);
+    }
+}
+
+/**
+ * @brief Próxima sala de uma ala em pré-ordem (pai antes dos filhos). Em vez de uma pilha,
+ * sobe pelos pais do índice; a ala inteira é percorrida em O(salas da ala).
+ * @param topo A sala do topo da ala (a subida para nela).
+ * @return A próxima sala ou SEM_SALA depois da última.
+ */
+uint32_t proximaSalaDaAla(const IndiceSalas *indice, uint32_t topo, uint32_t sala)
+{
+    const SalaCompilada *salas = indice->mansao->salas;
+    if (salas[sala].esquerda != SEM_SALA)
+    {
+        return salas[sala].esquerda;
+    }
+    if (salas[sala].direita != SEM_SALA)
+    {
+        return salas[sala].direita;
+    }
+    while (sala != topo)
+    {
+        uint32_t pai = indice->pais[sala];
+        if (salas[pai].esquerda == sala && salas[pai].direita != SEM_SALA)
+        {
+            return salas[pai].direita;
+        }
+        sala = pai;
+    }
+    return SEM_SALA;
+}
+
+/**
+ * @brief Deixa a mansão da sessão pronta para edição: copia o array de salas de um mapa
+ * mapeado, monta o índice de salas e o catálogo (se ainda não existem), descongela o
+ * catálogo e liga as salas de cada nome em listas. Só a primeira chamada custa O(n).
+ * @return 1 se a mansão pode ser editada, 0 se o dicionário dela está congelado.
+ */
+int prepararEdicao(Sessao *sessao, Mansao *mansao)
+{
+    if (mansao->dicionario->congelado)
+    {
+        return 0;
+    }
+    if (sessao->indiceSalas != NULL && sessao->indiceSalas->proximaComNome != NULL)
+    {
+        return 1;
+    }
+    if (mansao->salasProprias == NULL)
+    {
+        mansao->salasProprias = (SalaCompilada *)malloc(sizeof(SalaCompilada) * (mansao->numSalas ? mansao->numSalas : 1));
+        if (mansao->salasProprias == NULL)
+        {
+            perror("Erro ao alocar memória para a Mansão");
+            exit(EXIT_FAILURE);
+        }
+        memcpy(mansao->salasProprias, mansao->salas, sizeof(SalaCompilada) * mansao->numSalas);
+        mansao->salas = mansao->salasProprias;
+        mansao->capacidadeSalas = mansao->numSalas;
+    }
+
+    indiceDaSessao(sessao);
+    catalogoDaSessao(sessao);
+    descongelarIndiceSuspeitos(sessao->catalogo);
+
+    IndiceSalas *indice = sessao->indiceSalas;
+    uint32_t n = mansao->numSalas;
+    indice->proximaComNome = (uint32_t *)malloc(sizeof(uint32_t) * indice->capacidadeSalas);
+    indice->anteriorComNome = (uint32_t *)malloc(sizeof(uint32_t) * indice->capacidadeSalas);
+    uint32_t *ordem = (uint32_t *)malloc(sizeof(uint32_t) * (n ? n : 1));
+    if (indice->proximaComNome == NULL || indice->anteriorComNome == NULL || ordem == NULL)
+    {
+        perror("Erro ao alocar memória para o índice de salas");
+        exit(EXIT_FAILURE);
+    }
+
+    // Ligadas da mais funda para a mais rasa, cada lista começa pela sala que salaPorNome já guardava
+    for (int i = 0; i < indice->capacidadeNomes; i++)
+    {
+        indice->salaPorNome[i] = SEM_SALA;
+    }
+    ordenarEmLargura(mansao, ordem);
+    for (uint32_t i = n; i > 0; i--)
+    {
+        ligarNomeDaSala(indice, ordem[i - 1]);
+    }
+    free(ordem);
+    return 1;
+}
+
+/**
+ * @brief Garante espaço para mais uma sala no array da mansão, no índice de salas e no
+ * bitset da sessão (cada um dobra quando enche).
+ */
+void garantirEspacoParaSala(Sessao *sessao, Mansao *mansao)
+{
+    uint32_t n = mansao->numSalas + 1;
+    if (n > mansao->capacidadeSalas)
+    {
+        uint32_t novaCapacidade = mansao->capacidadeSalas ? mansao->capacidadeSalas * 2 : TAMANHO_HASH;
+        SalaCompilada *novas = (SalaCompilada *)realloc(mansao->salasProprias, sizeof(SalaCompilada) * novaCapacidade);
+        if (novas == NULL)
+        {
+            perror("Erro ao alocar memória para a Mansão");
+            exit(EXIT_FAILURE);
+        }
+        mansao->salasProprias = novas;
+        mansao->salas = novas;
+        mansao->capacidadeSalas = novaCapacidade;
+    }
+
+    IndiceSalas *indice = sessao->indiceSalas;
+    if (n + 1 > indice->capacidadeSalas)
+    {
+        uint32_t novaCapacidade = indice->capacidadeSalas * 2;
+        uint32_t **arrays[5] = {&indice->pais, &indice->saltos, &indice->profundidades,
+                                &indice->proximaComNome, &indice->anteriorComNome};
+        for (int i = 0; i < 5; i++)
+        {
+            uint32_t *novo = (uint32_t *)realloc(*arrays[i], sizeof(uint32_t) * novaCapacidade);
+            if (novo == NULL)
+            {
+                perror("Erro ao alocar memória para o índice de salas");
+                exit(EXIT_FAILURE);
+            }
+            *arrays[i] = novo;
+        }
+        indice->capacidadeSalas = novaCapacidade;
+    }
+
+    if (n > sessao->salasNoBitset)
+    {
+        uint32_t palavras = sessao->salasNoBitset / 64;
+        uint64_t *novas = (uint64_t *)realloc(sessao->coletadas, sizeof(uint64_t) * palavras * 2);
+        if (novas == NULL)
+        {
+            perror("Erro ao alocar memória para a Sessão");
+            exit(EXIT_FAILURE);
+        }
+        memset(novas + palavras, 0, sizeof(uint64_t) * palavras);
+        sessao->coletadas = novas;
+        sessao->salasNoBitset *= 2;
+    }
+}
+
+/**
+ * @brief Retorna 1 se a sala está ligada à mansão (não está em uma ala desanexada).
+ * Vale depois de prepararEdicao.
+ */
+int salaNaMansao(const Sessao *sessao, uint32_t sala)
+{
+    return sala < sessao->mansao->numSalas && sessao->indiceSalas->profundidades[sala] != SEM_SALA;
+}
+
+/**
+ * @brief Constrói uma sala nova (folha) no lado 'e' ou 'd' de uma sala da mansão.
+ * Pai, profundidade, salto, nome e catálogo são atualizados em O(1) amortizado (mais as
+ * pistas do suspeito, no catálogo).
+ * O suspeito segue o formato do mapa texto: "suspeito[:peso], ..." (ver lerSuspeitosDaSala).
+ * @return A nova sala, ou SEM_SALA se o pai não está na mansão, o lado já tem sala, o nome é
+ * vazio, os suspeitos são inválidos ou o dicionário está congelado.
+ */
+uint32_t adicionarSala(Sessao *sessao, Mansao *mansao, uint32_t pai, int lado, const char *nome,
+                       const char *pista, const char *suspeito)
+{
+    if (!prepararEdicao(sessao, mansao))
+    {
+        return SEM_SALA;
+    }
+    uint32_t *ligacao = salaNaMansao(sessao, pai) ? ladoDaSala(mansao, pai, lado) : NULL;
+    uint32_t principal, lista;
+    if (ligacao == NULL || *ligacao != SEM_SALA || nome[0] == '\0' ||
+        !lerSuspeitosDaSala(mansao->dicionario, suspeito, &principal, &lista))
+    {
+        return SEM_SALA;
+    }
+
+    garantirEspacoParaSala(sessao, mansao);
+    ligacao = ladoDaSala(mansao, pai, lado); // O array pode ter mudado de lugar
+    uint32_t nova = mansao->numSalas++;
+    SalaCompilada *sala = &mansao->salasProprias[nova];
+    sala->nome = (uint32_t)internar(mansao->dicionario, nome);
+    sala->pista = (uint32_t)internar(mansao->dicionario, pista);
+    sala->suspeito = principal;
+    sala->implicacoes = lista;
+    sala->esquerda = SEM_SALA;
+    sala->direita = SEM_SALA;
+    *ligacao = nova;
+    CONTAR(&sessao->estatisticas, salasCriadas);
+
+    IndiceSalas *indice = sessao->indiceSalas;
+    indice->pais[nova] = pai;
+    indice->profundidades[nova] = indice->profundidades[pai] + 1;
+    indice->saltos[nova] = saltoDoFilho(indice, pai);
+    ligarNomeDaSala(indice, nova);
+    contarPistaNoCatalogo(sessao->catalogo, mansao->dicionario, sala, 1);
+    mansao->editada = 1;
+    return nova;
+}
+
+/**
+ * @brief Desanexa a ala (subárvore) do lado 'e' ou 'd' de uma sala. As salas da ala saem
+ * da busca por nome e do catálogo em O(salas da ala). A ala fica guardada até ser religada
+ * com anexarAla. A sala atual da sessão não pode estar dentro dela.
+ * @param salasNaAla Recebe quantas salas a ala tem.
+ * @return A sala do topo da ala, ou SEM_SALA se o lado está vazio, a sessão está na ala ou o
+ * dicionário está congelado.
+ */
+uint32_t desanexarAla(Sessao *sessao, Mansao *mansao, uint32_t pai, int lado, uint32_t *salasNaAla)
+{
+    if (!prepararEdicao(sessao, mansao))
+    {
+        return SEM_SALA;
+    }
+    IndiceSalas *indice = sessao->indiceSalas;
+    uint32_t *ligacao = salaNaMansao(sessao, pai) ? ladoDaSala(mansao, pai, lado) : NULL;
+    if (ligacao == NULL || *ligacao == SEM_SALA)
+    {
+        return SEM_SALA;
+    }
+    uint32_t topo = *ligacao;
+    if (indice->profundidades[sessao->salaAtual] >= indice->profundidades[topo] &&
+        salaAncestral(indice, sessao->salaAtual, indice->profundidades[topo]) == topo)
+    {
+        return SEM_SALA;
+    }
+
+    if (indice->numAlasSoltas == indice->capacidadeAlasSoltas)
+    {
+        int novaCapacidade = indice->capacidadeAlasSoltas ? indice->capacidadeAlasSoltas * 2 : 4;
+        uint32_t *novas = (uint32_t *)realloc(indice->alasSoltas, sizeof(uint32_t) * novaCapacidade);
+        if (novas == NULL)
+        {
+            perror("Erro ao alocar memória para o índice de salas");
+            exit(EXIT_FAILURE);
+        }
+        indice->alasSoltas = novas;
+        indice->capacidadeAlasSoltas = novaCapacidade;
+    }
+    indice->alasSoltas[indice->numAlasSoltas++] = topo;
+    *ligacao = SEM_SALA;
+
+    uint32_t quantidade = 0;
+    for (uint32_t sala = topo; sala != SEM_SALA; sala = proximaSalaDaAla(indice, topo, sala))
+    {
+        desligarNomeDaSala(indice, sala);
+        contarPistaNoCatalogo(sessao->catalogo, mansao->dicionario, &mansao->salas[sala], -1);
+        indice->profundidades[sala] = SEM_SALA; // Marca a sala como fora da mansão
+        quantidade++;
+    }
+    indice->pais[topo] = SEM_SALA;
+    *salasNaAla = quantidade;
+    mansao->editada = 1;
+    return topo;
+}
+
+/**
+ * @brief Topo da ala desanexada com esse nome: O(alas soltas).
+ * @return A sala do topo ou SEM_SALA.
+ */
+uint32_t buscarAlaSolta(const Sessao *sessao, const char *nome)
+{
+    const IndiceSalas *indice = sessao->indiceSalas;
+    for (int i = 0; indice != NULL && i < indice->numAlasSoltas; i++)
+    {
+        if (strcmp(textoDe(sessao->mansao->dicionario, sessao->mansao->salas[indice->alasSoltas[i]].nome), nome) == 0)
+        {
+            return indice->alasSoltas[i];
+        }
+    }
+    return SEM_SALA;
+}
+
+/**
+ * @brief Religa uma ala desanexada no lado 'e' ou 'd' de uma sala da mansão. Profundidade,
+ * salto, nome e catálogo de cada sala da ala são refeitos em pré-ordem (o pai antes dos
+ * filhos, então o salto do pai já vale): O(salas da ala).
+ * @param salasNaAla Recebe quantas salas a ala tem.
+ * @return 1 se a ala foi religada, 0 se ela não está solta, o lado está ocupado ou o
+ * dicionário está congelado.
+ */
+int anexarAla(Sessao *sessao, Mansao *mansao, uint32_t topo, uint32_t pai, int lado, uint32_t *salasNaAla)
+{
+    if (!prepararEdicao(sessao, mansao))
+    {
+        return 0;
+    }
+    IndiceSalas *indice = sessao->indiceSalas;
+    int posicao = 0;
+    while (posicao < indice->numAlasSoltas && indice->alasSoltas[posicao] != topo)
+    {
+        posicao++;
+    }
+    uint32_t *ligacao = salaNaMansao(sessao, pai) ? ladoDaSala(mansao, pai, lado) : NULL;
+    if (posicao == indice->numAlasSoltas || ligacao == NULL || *ligacao != SEM_SALA)
+    {
+        return 0;
+    }
+    indice->alasSoltas[posicao] = indice->alasSoltas[--indice->numAlasSoltas];
+    *ligacao = topo;
+    indice->pais[topo] = pai;
+
+    uint32_t quantidade = 0;
+    for (uint32_t sala = topo; sala != SEM_SALA; sala = proximaSalaDaAla(indice, topo, sala))
+    {
+        uint32_t paiDaSala = indice->pais[sala];
+        indice->profundidades[sala] = indice->profundidades[paiDaSala] + 1;
+        indice->saltos[sala] = saltoDoFilho(indice, paiDaSala);
+        ligarNomeDaSala(indice, sala);
+        contarPistaNoCatalogo(sessao->catalogo, mansao->dicionario, &mansao->salas[sala], 1);
+        quantidade++;
+    }
+    *salasNaAla = quantidade;
+    mansao->editada = 1;
+    return 1;
+}
+
+/**
+ * @brief Troca a pista e os suspeitos ("suspeito[:peso], ...") de uma sala da mansão,
+ * atualizando o catálogo (O(pistas dos suspeitos antigos e novos)). Pistas que a sessão já
+ * coletou continuam no diário.
+ * @return 1 se a sala foi alterada, 0 se ela não está na mansão, os suspeitos são inválidos
+ * ou o dicionário está congelado.
+ */
+int alterarPistaDaSala(Sessao *sessao, Mansao *mansao, uint32_t sala, const char *pista, const char *suspeito)
+{
+    uint32_t principal, lista;
+    if (!prepararEdicao(sessao, mansao) || !salaNaMansao(sessao, sala) ||
+        !lerSuspeitosDaSala(mansao->dicionario, suspeito, &principal, &lista))
+    {
+        return 0;
+    }
+    SalaCompilada *alterada = &mansao->salasProprias[sala];
+    contarPistaNoCatalogo(sessao->catalogo, mansao->dicionario, alterada, -1);
+    alterada->pista = (uint32_t)internar(mansao->dicionario, pista);
+    alterada->suspeito = principal;
+    alterada->implicacoes = lista;
+    contarPistaNoCatalogo(sessao->catalogo, mansao->dicionario, alterada, 1);
+    mansao->editada = 1;
+    return 1;
+}
+
+// ==========================================================
+//               SNAPSHOT DA SESSÃO (SALVAR/RESTAURAR)
+// ==========================================================
+
+/**
+ * @brief Mistura os hashes das pistas coletadas, na ordem de coleta. Um snapshot
+ * aplicado a outro mapa (ou ao mesmo mapa em outra ordem) quase sempre diverge aqui.
+ * Usa sempre FNV-1a, e não funcaoHash, para valer entre executáveis com FUNCAO_HASH diferente.
+ */
+uint32_t conferenciaDasColetas(const Mansao *mansao, const uint32_t *salas, uint32_t quantidade)
+{
+    uint32_t conferencia = 2166136261u;
+    for (uint32_t i = 0; i < quantidade; i++)
+    {
+        conferencia = (conferencia ^ hashFnv1a(textoDe(mansao->dicionario, mansao->salas[salas[i]].pista))) * 16777619u;
+    }
+    return conferencia;
+}
+
+/**
+ * @brief Tamanho, em bytes, do snapshot da sessão no estado atual.
+ */
+size_t tamanhoSnapshot(const Sessao *sessao)
+{
+    return sizeof(CabecalhoSessao) + sizeof(uint32_t) * ((size_t)sessao->numColetadas + sessao->mansao->dicionario->suspeitos.quantidade);
+}
+
+/**
+ * @brief Grava o snapshot da sessão em 'destino' (sala atual, salas coletadas e citações).
+ * @return O número de bytes escritos, ou 0 se 'capacidade' não bastar.
+ */
+size_t serializarSessao(const Sessao *sessao, unsigned char *destino, size_t capacidade)
+{
+    size_t tamanho = tamanhoSnapshot(sessao);
+    if (tamanho > capacidade)
+    {
+        return 0;
+    }
+
+    CabecalhoSessao cabecalho;
+    memset(&cabecalho, 0, sizeof(cabecalho));
+    memcpy(cabecalho.assinatura, ASSINATURA_SESSAO, sizeof(cabecalho.assinatura));
+    cabecalho.versao = VERSAO_SESSAO;
+    cabecalho.numSalas = sessao->mansao->numSalas;
+    cabecalho.salaAtual = sessao->salaAtual;
+    cabecalho.numColetadas = (uint32_t)sessao->numColetadas;
+    cabecalho.numSuspeitos = (uint32_t)sessao->mansao->dicionario->suspeitos.quantidade;
+    cabecalho.conferencia = conferenciaDasColetas(sessao->mansao, sessao->salasColetadas, cabecalho.numColetadas);
+    cabecalho.comandos = (uint64_t)sessao->comandos;
+
+    memcpy(destino, &cabecalho, sizeof(cabecalho));
+    unsigned char *posicao = destino + sizeof(cabecalho);
+    if (cabecalho.numColetadas > 0)
+    {
+        memcpy(posicao, sessao->salasColetadas, sizeof(uint32_t) * cabecalho.numColetadas);
+    }
+    posicao += sizeof(uint32_t) * cabecalho.numColetadas;
+    for (uint32_t i = 0; i < cabecalho.numSuspeitos; i++)
+    {
+        uint32_t citacoes = (uint32_t)citacoesDe(&sessao->placar, (int)i);
+        memcpy(posicao, &citacoes, sizeof(citacoes));
+        posicao += sizeof(citacoes);
+    }
+    return tamanho;
+}
+
+/**
+ * @brief Restaura a sessão a partir de um snapshot da mesma mansão: refaz as coletas na
+ * ordem original e confere as citações gravadas com as reconstruídas.
+ * @return 1 em caso de sucesso; 0 se o snapshot for inválido (a sessão volta à raiz).
+ */
+int restaurarSessao(Sessao *sessao, const unsigned char *dados, size_t tamanho)
+{
+    const Mansao *mansao = sessao->mansao;
+    reiniciarSessao(sessao);
+
+    CabecalhoSessao cabecalho;
+    if (tamanho < sizeof(cabecalho))
+    {
+        return 0;
+    }
+    memcpy(&cabecalho, dados, sizeof(cabecalho));
+    int valido = memcmp(cabecalho.assinatura, ASSINATURA_SESSAO, sizeof(cabecalho.assinatura)) == 0 &&
+                 cabecalho.versao == VERSAO_SESSAO &&
+                 cabecalho.numSalas == mansao->numSalas &&
+                 cabecalho.salaAtual < mansao->numSalas &&
+                 cabecalho.numColetadas <= mansao->numSalas &&
+                 cabecalho.numSuspeitos == (uint32_t)mansao->dicionario->suspeitos.quantidade &&
+                 tamanho == sizeof(cabecalho) + sizeof(uint32_t) * ((size_t)cabecalho.numColetadas + cabecalho.numSuspeitos);
+
+    // Refaz as coletas em lote: cada sala precisa existir, ter pista e aparecer uma única vez
+    const unsigned char *posicao = dados + sizeof(cabecalho);
+    if (valido)
+    {
+        uint32_t *salas = (uint32_t *)malloc(sizeof(uint32_t) * (cabecalho.numColetadas ? cabecalho.numColetadas : 1));
+        if (salas == NULL)
+        {
+            perror("Erro ao alocar memória para o snapshot");
+            exit(EXIT_FAILURE);
+        }
+        memcpy(salas, posicao, sizeof(uint32_t) * cabecalho.numColetadas);
+        valido = carregarColetasEmLote(sessao, salas, cabecalho.numColetadas) &&
+                 conferenciaDasColetas(mansao, salas, cabecalho.numColetadas) == cabecalho.conferencia;
+        free(salas);
+    }
+
+    // As citações reconstruídas precisam bater com as gravadas
+    posicao += sizeof(uint32_t) * cabecalho.numColetadas;
+    for (uint32_t i = 0; valido && i < cabecalho.numSuspeitos; i++)
+    {
+        uint32_t citacoes;
+        memcpy(&citacoes, posicao + sizeof(uint32_t) * i, sizeof(citacoes));
+        valido = citacoes == (uint32_t)citacoesDe(&sessao->placar, (int)i);
+    }
+
+    if (!valido)
+    {
+        reiniciarSessao(sessao);
+        return 0;
+    }
+    sessao->salaAtual = cabecalho.salaAtual;
+    sessao->comandos = (long)cabecalho.comandos;
+    return 1;
+}
+
+/**
+ * @brief Salva o snapshot da sessão em um arquivo. Grava em "<caminho>.tmp" e renomeia,
+ * então um arquivo antigo nunca fica pela metade.
+ * @return 1 em caso de sucesso, 0 em caso de erro.
+ */
+int salvarSessao(const Sessao *sessao, const char *caminho)
+{
+    size_t tamanho = tamanhoSnapshot(sessao);
+    unsigned char *dados = (unsigned char *)malloc(tamanho);
+    char *temporario = (char *)malloc(strlen(caminho) + 5);
+    if (dados == NULL || temporario == NULL)
+    {
+        perror("Erro ao alocar memória para o snapshot");
+        exit(EXIT_FAILURE);
+    }
+    serializarSessao(sessao, dados, tamanho);
+    sprintf(temporario, "%s.tmp", caminho);
+
+    FILE *arquivo = fopen(temporario, "wb");
+    int ok = arquivo != NULL;
+    ok = ok && fwrite(dados, 1, tamanho, arquivo) == tamanho;
+    ok = (arquivo != NULL && fclose(arquivo) == 0) && ok;
+    ok = ok && rename(temporario, caminho) == 0;
+    if (!ok)
+    {
+        perror("Erro ao gravar o snapshot da sessão");
+        unlink(temporario);
+    }
+    free(temporario);
+    free(dados);
+    return ok;
+}
+
+/**
+ * @brief Restaura a sessão a partir de um arquivo gravado por salvarSessao.
+ * @return 1 em caso de sucesso, 0 se o arquivo não abrir ou for inválido.
+ */
+int carregarSessao(Sessao *sessao, const char *caminho)
+{
+    FILE *arquivo = fopen(caminho, "rb");
+    if (arquivo == NULL)
+    {
+        perror("Erro ao abrir o snapshot da sessão");
+        return 0;
+    }
+    size_t capacidade = sizeof(CabecalhoSessao);
+    size_t tamanho = 0;
+    unsigned char *dados = NULL;
+    while (1)
+    {
+        unsigned char *novos = (unsigned char *)realloc(dados, capacidade);
+        if (novos == NULL)
+        {
+            perror("Erro ao alocar memória para o snapshot");
+            exit(EXIT_FAILURE);
+        }
+        dados = novos;
+        tamanho += fread(dados + tamanho, 1, capacidade - tamanho, arquivo);
+        if (tamanho < capacidade)
+        {
+            break;
+        }
+        capacidade *= 2;
+    }
+    fclose(arquivo);
+
+    int ok = restaurarSessao(sessao, dados, tamanho);
+    if (!ok)
+    {
+        fprintf(stderr, "%s: snapshot inválido ou de outro mapa.\n", caminho);
+    }
+    free(dados);
+    return ok;
+}
+
+/**
+ * @brief Compara duas sessões sobre a mesma mansão: diário em ordem alfabética, evidências
+ * na ordem de coleta, placar (inclusive a ordem dos empatados) e dedução. Confere que a
+ * carga em lote e o snapshot refazem a sessão de coleta em coleta (teste e benchmark).
+ * @return 1 se forem iguais.
+ */
+int sessoesEquivalentes(const Sessao *a, const Sessao *b)
+{
+    IteradorPistas x;
+    IteradorPistas y;
+    iniciarIteradorNaPosicao(&x, a->pistasRaiz, 0);
+    iniciarIteradorNaPosicao(&y, b->pistasRaiz, 0);
+    const Pista *p;
+    const Pista *q;
+    do
+    {
+        p = proximaPista(&x);
+        q = proximaPista(&y);
+        if ((p == NULL) != (q == NULL) || (p != NULL && p->descricao != q->descricao))
+        {
+            return 0;
+        }
+    } while (p != NULL);
+
+    if (a->numColetadas != b->numColetadas || a->evidencias.quantidade != b->evidencias.quantidade)
+    {
+        return 0;
+    }
+    for (int i = 0; i < a->evidencias.quantidade; i++)
+    {
+        const Associacao *e = &a->evidencias.entradas[i];
+        const Associacao *f = &b->evidencias.entradas[i];
+        if (e->pista != f->pista || e->suspeito_id != f->suspeito_id || buscarPista(&b->evidencias, textoDe(a->mansao->dicionario, e->pista)) != f)
+        {
+            return 0;
+        }
+    }
+    for (int s = 0; s < a->mansao->dicionario->suspeitos.quantidade; s++)
+    {
+        if (citacoesDe(&a->placar, s) != citacoesDe(&b->placar, s) ||
+            (s < a->placar.numSuspeitos && a->placar.ranking[s] != b->placar.ranking[s]))
+        {
+            return 0;
+        }
+    }
+    Deducao d = deduzir(a);
+    Deducao e = deduzir(b);
+    return d.suspeito == e.suspeito && d.empate == e.empate && d.citacoes == e.citacoes &&
+           d.maisProvavel.suspeito == e.maisProvavel.suspeito &&
+           d.maisProvavel.probabilidade == e.maisProvavel.probabilidade;
+}
+
+// ==========================================================
+//              LEITOR DE COMANDOS (ENTRADA)
+// ==========================================================
+
+/**
+ * @brief Prepara o leitor sobre um descritor já aberto (ex.: STDIN_FILENO).
+ */
+void iniciarLeitor(LeitorComandos *leitor, int descritor, Renderizador *saida)
+{
+    leitor->descritor = descritor;
+    leitor->saida = saida;
+    leitor->posicao = 0;
+    leitor->tamanho = 0;
+}
+
+/**
+ * @brief Lê o próximo byte da entrada, recarregando o buffer com um único read() quando esvazia.
+ * @return O byte lido ou EOF.
+ */
+int proximoCaractere(LeitorComandos *leitor)
+{
+    if (leitor->posicao == leitor->tamanho)
+    {
+        // Antes de esperar por mais comandos, mostra tudo o que o passo produziu
+        if (leitor->saida != NULL)
+        {
+            descarregarSaida(leitor->saida);
+        }
+        ssize_t lidos = read(leitor->descritor, leitor->buffer, sizeof(leitor->buffer));
+        if (lidos <= 0)
+        {
+            return EOF;
+        }
+        leitor->posicao = 0;
+        leitor->tamanho = (size_t)lidos;
+    }
+    return leitor->buffer[leitor->posicao++];
+}
+
+/**
+ * @brief Lê o próximo comando, pulando espaços e quebras de linha (equivale a scanf(" %c")).
+ * @return O comando em minúsculo ou EOF.
+ */
+int lerComando(LeitorComandos *leitor)
+{
+    int c;
+    do
+    {
+        c = proximoCaractere(leitor);
+    } while (c != EOF && isspace(c));
+    return c == EOF ? EOF : tolower(c);
+}
+
+/**
+ * @brief Descarta o restante da linha atual.
+ */
+void descartarLinha(LeitorComandos *leitor)
+{
+    int c;
+    while ((c = proximoCaractere(leitor)) != '\n' && c != EOF)
+        ;
+}
+
+/**
+ * @brief Lê o restante da linha atual (o argumento de um comando), sem os espaços das
+ * pontas. O que passar da capacidade é descartado.
+ * @return O texto lido, dentro de 'destino'.
+ */
+char *lerArgumento(LeitorComandos *leitor, char *destino, size_t capacidade)
+{
+    size_t tamanho = 0;
+    int c;
+    while ((c = proximoCaractere(leitor)) != '\n' && c != EOF)
+    {
+        if (tamanho + 1 < capacidade)
+        {
+            destino[tamanho++] = (char)c;
+        }
+    }
+    destino[tamanho] = '\0';
+    return aparar(destino);
+}
+
+/**
+ * @brief Separa um argumento em até 'maximo' campos por '|', sem os espaços das pontas.
+ * Os campos que faltarem ficam vazios; o que passar do último fica nele.
+ */
+void separarCampos(char *texto, char **campos, int maximo)
+{
+    for (int i = 0; i < maximo; i++)
+    {
+        char *barra = i + 1 < maximo ? strchr(texto, '|') : NULL;
+        if (barra != NULL)
+        {
+            *barra = '\0';
+        }
+        campos[i] = aparar(texto);
+        texto = barra != NULL ? barra + 1 : texto + strlen(texto);
+    }
+}
+
+/**
+ * @brief Pesquisa no diário da sessão. A consulta pode ser "n [m]" (posições n a m,
+ * contadas de 1), "A..B" (pistas de A a B em ordem alfabética), um prefixo ou vazia
+ * (diário inteiro). Cada forma custa O(log n + pistas listadas).
+ */
+void pesquisarDiario(Renderizador *saida, const Dicionario *dicionario, const Pista *raiz, const char *consulta)
+{
+    int total = tamanhoPista(raiz);
+    int listadas;
+    const char *separador = strstr(consulta, "..");
+    if (isdigit((unsigned char)consulta[0]))
+    {
+        char *resto;
+        long inicio = strtol(consulta, &resto, 10);
+        long fim = *aparar(resto) != '\0' ? strtol(resto, NULL, 10) : inicio + 9;
+        if (inicio < 1)
+        {
+            inicio = 1;
+        }
+        if (fim > total)
+        {
+            fim = total;
+        }
+        escrever(saida, "\n📜 Diário, posições %ld a %ld de %d:\n", inicio, fim, total);
+        listadas = fim >= inicio ? listarPaginaDePistas(saida, dicionario, raiz, (int)inicio - 1, (int)fim) : 0;
+    }
+    else if (separador != NULL)
+    {
+        char de[MAX_NOME * 4];
+        snprintf(de, sizeof(de), "%.*s", (int)(separador - consulta), consulta);
+        const char *ate = separador + 2;
+        while (isspace((unsigned char)*ate))
+        {
+            ate++;
+        }
+        escrever(saida, "\n📜 Diário, de '%s' a '%s':\n", aparar(de), ate);
+        listadas = listarPistasNaFaixa(saida, dicionario, raiz, aparar(de), ate);
+    }
+    else
+    {
+        if (consulta[0] == '\0')
+        {
+            escreverTexto(saida, "\n📜 Diário completo:\n");
+        }
+        else
+        {
+            escrever(saida, "\n📜 Diário, pistas começando com '%s':\n", consulta);
+        }
+        listadas = listarPistasComPrefixo(saida, dicionario, raiz, consulta);
+    }
+    escrever(saida, "   (%d de %d pista(s))\n", listadas, total);
+}
+
+/**
+ * @brief Mostra as pistas coletadas que contêm 'trecho' (até LIMITE_BUSCA_TRECHO) e os
+ * suspeitos ligados a elas.
+ */
+void mostrarPistasComTrecho(Renderizador *saida, Sessao *sessao, const char *trecho)
+{
+    int entradas[LIMITE_BUSCA_TRECHO];
+    int total = buscarPorTrecho(&sessao->trechos, &sessao->evidencias, trecho, entradas, LIMITE_BUSCA_TRECHO);
+    int mostradas = total < LIMITE_BUSCA_TRECHO ? total : LIMITE_BUSCA_TRECHO;
+    escrever(saida, "\n🔍 Pistas com '%s':\n", trecho);
+    for (int i = 0; i < mostradas; i++)
+    {
+        const Associacao *evidencia = &sessao->evidencias.entradas[entradas[i]];
+        escrever(saida, "   -> %s (%s)\n", textoDe(sessao->mansao->dicionario, evidencia->pista),
+                 textoDe(sessao->mansao->dicionario, evidencia->suspeito));
+    }
+    if (total > mostradas)
+    {
+        escrever(saida, "   (%d pista(s), mostrando as %d primeiras)\n", total, mostradas);
+    }
+    else
+    {
+        escrever(saida, "   (%d pista(s))\n", total);
+    }
+}
+
+/**
+ * @brief Mostra as pistas coletadas contra um suspeito, pelo índice invertido (O(pistas dele)),
+ * e quantas das pistas do mapa o implicam.
+ */
+void mostrarPistasDoSuspeito(Renderizador *saida, Sessao *sessao, const char *nome)
+{
+    int suspeito = buscarSuspeito(sessao->mansao->dicionario, nome, &sessao->estatisticas);
+    if (suspeito < 0)
+    {
+        escrever(saida, "\n❓ Nenhum suspeito se chama '%s'.\n", nome);
+        return;
+    }
+    int quantidade;
+    const PistaPonderada *pistas = pistasDoSuspeito(&sessao->porSuspeito, suspeito, &quantidade);
+    escrever(saida, "\n🧾 Pistas contra %s (peso total %d):\n", nome, pesoDoSuspeito(&sessao->porSuspeito, suspeito));
+    for (int i = 0; i < quantidade; i++)
+    {
+        escrever(saida, "   -> %s (peso %d)\n", textoDe(sessao->mansao->dicionario, pistas[i].pista), pistas[i].peso);
+    }
+    int noMapa;
+    pistasDoSuspeito(catalogoDaSessao(sessao), suspeito, &noMapa);
+    escrever(saida, "   (%d de %d pista(s) do mapa contra %s)\n", quantidade, noMapa, nome);
+}
+
+/**
+ * @brief Aplica um comando de edição (n, r, l ou m) à sala atual e mostra o resultado
+ * (no resumo ou na completa). O argumento começa pelo lado ('e' ou 'd'), exceto em 'm'.
+ */
+void editarMansao(Sessao *sessao, Mansao *mansao, int comando, char *argumento, Renderizador *saida)
+{
+    const Dicionario *dicionario = mansao->dicionario;
+    uint32_t atual = sessao->salaAtual;
+    int resumo = mostrar(saida, VERBOSIDADE_RESUMO);
+    int lado = tolower((unsigned char)argumento[0]);
+    const char *nomeDoLado = lado == 'e' ? "esquerda" : "direita";
+    char *resto = aparar(argumento[0] != '\0' ? argumento + 1 : argumento);
+    uint32_t salasNaAla;
+
+    if (dicionario->congelado)
+    {
+        if (resumo)
+        {
+            escreverTexto(saida, "\n🚫 A mansão está congelada para sessões em paralelo e não pode ser editada.\n");
+        }
+    }
+    else if (comando == 'n')
+    {
+        char *campos[3];
+        separarCampos(resto, campos, 3);
+        if (adicionarSala(sessao, mansao, atual, lado, campos[0], campos[1], campos[2]) == SEM_SALA)
+        {
+            if (resumo)
+            {
+                escreverTexto(saida, "\n🚫 Não dá para construir: use 'n e|d Nome | pista | suspeito[:peso], ...' com um lado livre.\n");
+            }
+        }
+        else if (resumo)
+        {
+            escrever(saida, "\n🧱 Sala '%s' construída à %s de '%s'.\n", campos[0], nomeDoLado, textoDe(dicionario, mansao->salas[atual].nome));
+        }
+    }
+    else if (comando == 'r')
+    {
+        uint32_t topo = desanexarAla(sessao, mansao, atual, lado, &salasNaAla);
+        if (topo == SEM_SALA)
+        {
+            if (resumo)
+            {
+                escreverTexto(saida, "\n🚫 Não há ala para desanexar desse lado (use 'r e' ou 'r d').\n");
+            }
+        }
+        else if (resumo)
+        {
+            escrever(saida, "\n✂️ Ala '%s' desanexada (%u sala(s)). Use 'l %c %s' para religá-la.\n",
+                     textoDe(dicionario, mansao->salas[topo].nome), salasNaAla, lado, textoDe(dicionario, mansao->salas[topo].nome));
+        }
+    }
+    else if (comando == 'l')
+    {
+        uint32_t topo = buscarAlaSolta(sessao, resto);
+        if (topo == SEM_SALA || !anexarAla(sessao, mansao, topo, atual, lado, &salasNaAla))
+        {
+            if (resumo)
+            {
+                escrever(saida, "\n🚫 Não dá para religar: nenhuma ala solta se chama '%s', ou o lado não está livre.\n", resto);
+            }
+        }
+        else if (resumo)
+        {
+            escrever(saida, "\n🔗 Ala '%s' religada à %s de '%s' (%u sala(s)).\n", resto, nomeDoLado,
+                     textoDe(dicionario, mansao->salas[atual].nome), salasNaAla);
+        }
+    }
+    else
+    {
+        char *campos[2];
+        separarCampos(argumento, campos, 2);
+        if (!alterarPistaDaSala(sessao, mansao, atual, campos[0], campos[1]))
+        {
+            if (resumo)
+            {
+                escreverTexto(saida, "\n🚫 Não dá para trocar a pista: use 'm pista | suspeito[:peso], ...' em uma sala da mansão.\n");
+            }
+        }
+        else if (resumo)
+        {
+            escrever(saida, "\n📝 A pista de '%s' agora é '%s' (%s).\n", textoDe(dicionario, mansao->salas[atual].nome),
+                     campos[0][0] != '\0' ? campos[0] : "nenhuma", campos[1][0] != '\0' ? campos[1] : "sem suspeito");
+        }
+    }
+}
+
+/**
+ * @brief Navegação interativa na mansão.
+ * É um laço (não recursivo): cada comando só troca a sala atual, então a pilha
+ * não cresce com a duração da sessão. O texto de cada passo vai para o renderizador
+ * e é escrito de uma vez quando o leitor precisa esperar pelo próximo comando.
+ * @param sessao A investigação em andamento (mansão, sala atual e pistas coletadas).
+ * @param mansao A mansão da sessão, que os comandos de edição alteram.
+ * @param entrada Leitor de onde vêm os comandos do jogador.
+ * @param saida Renderizador para onde vai o texto do jogo.
+ */
+void explorarSalas(Sessao *sessao, Mansao *mansao, LeitorComandos *entrada, Renderizador *saida)
+{
+    const Dicionario *dicionario = mansao->dicionario;
+    int completa = mostrar(saida, VERBOSIDADE_COMPLETA);
+    int resumo = mostrar(saida, VERBOSIDADE_RESUMO);
+    int escolha;
+
+    while (1)
+    {
+        const SalaCompilada *salaAtual = &mansao->salas[sessao->salaAtual];
+
+        if (completa)
+        {
+            escrever(saida, "\n-------------------------------------------------\n"
+                     "🚪 Você está em: %s\n", textoDe(dicionario, salaAtual->nome));
+        }
+        else if (resumo)
+        {
+            escrever(saida, "🚪 %s\n", textoDe(dicionario, salaAtual->nome));
+        }
+
+        // --- Coleta a pista da sala (BST e Tabela Hash); aqui só se mostra o resultado ---
+        int coleta = coletarPistaDaSala(sessao);
+        if (coleta != COLETA_NENHUMA)
+        {
+            if (completa)
+            {
+                escrever(saida, "\n 🌟 PISTA ENCONTRADA! Você encontrou: \"%s\"\n"
+                         "  Esta pista está ligada ao: %s \n", textoDe(dicionario, salaAtual->pista), textoDe(dicionario, salaAtual->suspeito));
+                if (coleta == COLETA_NOVA)
+                {
+                    escrever(saida, "\n✅ Pista '%s' adicionada ao Diário! (Suspeito: %s)\n", textoDe(dicionario, salaAtual->pista), textoDe(dicionario, salaAtual->suspeito));
+                }
+                else
+                {
+                    escrever(saida, "⚠️ Pista '%s' duplicada ignorada.\n", textoDe(dicionario, salaAtual->pista));
+                }
+            }
+            else if (resumo)
+            {
+                escrever(saida, "🌟 \"%s\" -> %s\n", textoDe(dicionario, salaAtual->pista), textoDe(dicionario, salaAtual->suspeito));
+            }
+        }
+
+        // Verifica se é um nó folha
+        if (ehFolha(mansao, sessao->salaAtual))
+        {
+            if (completa)
+            {
+                escreverTexto(saida, "\n🎉 Você chegou ao fim deste caminho da mansão !\n" // Nó-Folha
+                              "\n🤔 Deseja fazer sua dedução final? [a] Analisar Evidências / [s] Sair: ");
+            }
+            escolha = lerComando(entrada);
+            if (escolha == 'a')
+            {
+                mostrarDeducao(sessao, saida); // Chama a função de dedução!
+            }
+            if (escolha != EOF)
+            {
+                descartarLinha(entrada);
+            }
+            return;
+        }
+
+        // --- Opções de Navegação ---
+        if (completa)
+        {
+            escrever(saida, "\n Escolha o próximo caminho:\n"
+                     "\n  [e] -> Esquerda (%s)\n"
+                     "  [d] -> Direita (%s)\n"
+                     "  [a] -> Analisar Evidências Coletadas\n"
+                     "  [p] -> Pesquisar no Diário (p 1 10, p A..C ou p prefixo)\n"
+                     "  [b] -> Buscar trecho nas pistas (b veneno)\n"
+                     "  [t] -> Teleportar para uma sala (t Cozinha)  [c] -> Caminho até uma sala  [v] -> Voltar\n"
+                     "  [i] -> Pistas contra um suspeito (i Mordomo)  [x] -> Estatísticas das estruturas\n"
+                     "  [n] -> Construir sala (n e Adega | pista | suspeito)  [m] -> Mudar a pista daqui (m pista | suspeito)\n"
+                     "  [r] -> Desanexar ala (r d)  [l] -> Religar ala (l d Adega)\n"
+                     "  [s] -> Sair da Exploração\n"
+                     "\n Sua escolha: ",
+                     salaAtual->esquerda != SEM_SALA ? textoDe(dicionario, mansao->salas[salaAtual->esquerda].nome) : "Caminho Bloqueado 🚧",
+                     salaAtual->direita != SEM_SALA ? textoDe(dicionario, mansao->salas[salaAtual->direita].nome) : "Caminho Bloqueado 🚧");
+        }
+
+        escolha = lerComando(entrada);
+        if (escolha == EOF)
+        {
+            // Fim da entrada: não há como tentar de novo
+            if (completa)
+            {
+                escreverTexto(saida, "\n⚠️ Entrada encerrada. Saindo da exploração.\n");
+            }
+            return;
+        }
+
+        // Processa a escolha: o passo só atualiza a sessão e volta ao início do laço
+        switch (escolha)
+        {
+        case 'e':
+        case 'd':
+            if (!moverSessao(sessao, escolha) && resumo)
+            {
+                escreverTexto(saida, "\n🚫 Caminho Bloqueado! Tente outra direção.\n");
+            }
+            break;
+        case 'a':
+            mostrarDeducao(sessao, saida); // Opção de análise durante o jogo
+            break;
+        case 'p':
+        {
+            char argumento[MAX_NOME * 4];
+            const char *consulta = lerArgumento(entrada, argumento, sizeof(argumento));
+            if (resumo)
+            {
+                pesquisarDiario(saida, dicionario, sessao->pistasRaiz, consulta);
+            }
+            break;
+        }
+        case 'v':
+            if (!voltarSessao(sessao) && resumo)
+            {
+                escreverTexto(saida, "\n🚫 Você já está na entrada da mansão.\n");
+            }
+            break;
+        case 't':
+        {
+            char argumento[MAX_NOME * 4];
+            const char *nome = lerArgumento(entrada, argumento, sizeof(argumento));
+            uint32_t passos;
+            if (teleportarSessao(sessao, nome, &passos))
+            {
+                if (resumo)
+                {
+                    escrever(saida, "\n✨ Teleporte para '%s' (%u passo(s) pelo caminho normal).\n", nome, passos);
+                }
+            }
+            else if (resumo)
+            {
+                escrever(saida, "\n❓ Nenhuma sala se chama '%s'.\n", nome);
+            }
+            break;
+        }
+        case 'c':
+        {
+            char argumento[MAX_NOME * 4];
+            const char *nome = lerArgumento(entrada, argumento, sizeof(argumento));
+            const IndiceSalas *indice = indiceDaSessao(sessao);
+            uint32_t destino = buscarSalaPorNome(indice, nome);
+            if (destino == SEM_SALA)
+            {
+                if (resumo)
+                {
+                    escrever(saida, "\n❓ Nenhuma sala se chama '%s'.\n", nome);
+                }
+            }
+            else if (resumo)
+            {
+                mostrarCaminho(saida, indice, sessao->salaAtual, destino);
+            }
+            break;
+        }
+        case 'b':
+        {
+            char argumento[MAX_NOME * 4];
+            const char *trecho = lerArgumento(entrada, argumento, sizeof(argumento));
+            if (resumo)
+            {
+                mostrarPistasComTrecho(saida, sessao, trecho);
+            }
+            break;
+        }
+        case 'i':
+        {
+            char argumento[MAX_NOME * 4];
+            const char *nome = lerArgumento(entrada, argumento, sizeof(argumento));
+            if (resumo)
+            {
+                mostrarPistasDoSuspeito(saida, sessao, nome);
+            }
+            break;
+        }
+        case 'x':
+            if (resumo)
+            {
+                mostrarEstatisticas(saida, sessao);
+            }
+            break;
+        case 'n':
+        case 'r':
+        case 'l':
+        case 'm':
+        {
+            char argumento[MAX_NOME * 4];
+            editarMansao(sessao, mansao, escolha, lerArgumento(entrada, argumento, sizeof(argumento)), saida);
+            break;
+        }
+        case 's':
+            if (completa)
+            {
+                escreverTexto(saida, "\n👋 Saindo da exploração da mansão.\n");
+            }
+            return;
+        default:
+            if (resumo)
+            {
+                escreverTexto(saida, "\n⚠️  Opção inválida. Por favor, escolha: 'e', 'd', 'a', 'p', 'b', 't', 'c', 'v', 'i', 'x', 'n', 'r', 'l', 'm' ou 's'.\n");
+            }
+            break;
+        }
+    }
+}
+
+// ==========================================================
+//                 RELÓGIO E SORTEIO
+// ==========================================================
+
+/**
+ * @brief Relógio monotônico em segundos (para medir intervalos).
+ */
+double agoraSegundos()
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+/**
+ * @brief Gerador xorshift64 (rápido e determinístico para uma semente fixa).
+ */
+unsigned long long proximoAleatorio(unsigned long long *estado)
+{
+    *estado ^= *estado << 13;
+    *estado ^= *estado >> 7;
+    *estado ^= *estado << 17;
+    return *estado;
+}
+
+// ==========================================================
+//                      MODO EM LOTE
+// ==========================================================
+
+/**
+ * @brief Executa uma sessão (uma linha da entrada) com os mesmos comandos do jogo,
+ * sem prompts: 'e'/'d' movem, 'a' analisa, 's' encerra; espaços são ignorados.
+ * Ao chegar em uma folha, o próximo comando é a resposta da dedução final ('a' analisa).
+ * @return 0 se a entrada acabou antes de a sessão começar, 1 caso contrário.
+ */
+int executarSessaoLote(Sessao *sessao, LeitorComandos *entrada)
+{
+    int c = proximoCaractere(entrada);
+    if (c == EOF)
+    {
+        return 0;
+    }
+
+    coletarPistaDaSala(sessao);
+    for (; c != '\n' && c != EOF; c = proximoCaractere(entrada))
+    {
+        if (isspace(c))
+        {
+            continue;
+        }
+        if (aplicarComando(sessao, tolower(c)))
+        {
+            break; // Saída ou resposta da dedução final em uma folha
+        }
+    }
+    if (c != '\n' && c != EOF)
+    {
+        descartarLinha(entrada);
+    }
+    return 1;
+}
+
+/**
+ * @brief Roda todas as sessões de um arquivo (uma por linha) e imprime uma linha de
+ * resultado por sessão (mais a análise completa, na verbosidade completa; nada, na
+ * silenciosa). A vazão (sessões/s e comandos/s) vai para stderr.
+ * @param caminho Arquivo de comandos ou NULL / "-" para a entrada padrão.
+ * @param estatisticas Recebe os contadores da sessão do lote (reaproveitada em todas as linhas).
+ */
+int executarLote(const Mansao *mansao, const char *caminho, Renderizador *saida, Estatisticas *estatisticas)
+{
+    LeitorComandos *entrada = (LeitorComandos *)malloc(sizeof(LeitorComandos));
+    if (entrada == NULL)
+    {
+        perror("Erro ao alocar memória para o leitor");
+        exit(EXIT_FAILURE);
+    }
+
+    int descritor = STDIN_FILENO;
+    if (caminho != NULL && strcmp(caminho, "-") != 0)
+    {
+        descritor = open(caminho, O_RDONLY);
+        if (descritor < 0)
+        {
+            perror("Erro ao abrir o arquivo de comandos");
+            free(entrada);
+            return EXIT_FAILURE;
+        }
+    }
+    iniciarLeitor(entrada, descritor, saida);
+
+    Sessao sessao;
+    iniciarSessao(&sessao, mansao);
+    long sessoes = 0;
+    double inicioTempo = agoraSegundos();
+
+    while (executarSessaoLote(&sessao, entrada))
+    {
+        sessoes++;
+        if (mostrar(saida, VERBOSIDADE_RESUMO))
+        {
+            Deducao deducao = deduzirDoPlacar(&sessao.evidencias, &sessao.placar);
+            escrever(saida, "Sessão %ld: %s | %d pista(s) | %s\n", sessoes, textoDe(mansao->dicionario, mansao->salas[sessao.salaAtual].nome),
+                     deducao.pistas, textoDoVeredito(mansao->dicionario, &deducao));
+        }
+        if (mostrar(saida, VERBOSIDADE_COMPLETA))
+        {
+            analisarEvidencias(saida, &sessao.evidencias, &sessao.placar);
+        }
+        reiniciarSessao(&sessao);
+    }
+
+    descarregarSaida(saida);
+    double duracao = agoraSegundos() - inicioTempo;
+    fprintf(stderr, "%ld sessões, %ld comandos em %.3f s (%.0f sessões/s, %.0f comandos/s)\n",
+            sessoes, sessao.comandos, duracao,
+            duracao > 0 ? sessoes / duracao : 0.0, duracao > 0 ? sessao.comandos / duracao : 0.0);
+
+    *estatisticas = sessao.estatisticas;
+    liberarSessao(&sessao);
+    if (descritor != STDIN_FILENO)
+    {
+        close(descritor);
+    }
+    free(entrada);
+    return EXIT_SUCCESS;
+}
+
+// ==========================================================
+//              SERVIDOR (VÁRIAS SESSÕES)
+// ==========================================================
+
+// Pedido de encerramento vindo de SIGINT/SIGTERM.
+volatile sig_atomic_t encerramentoPedido = 0;
+
+/**
+ * @brief Tratador de SIGINT/SIGTERM: só marca o pedido; o laço principal encerra.
+ */
+void pedirEncerramento(int sinal)
+{
+    (void)sinal;
+    encerramentoPedido = 1;
+}
+
+/**
+ * @brief Coloca uma conexão com dados para ler na fila dos trabalhadores.
+ */
+void enfileirarConexao(Servidor *servidor, Conexao *conexao)
+{
+    pthread_mutex_lock(&servidor->trava);
+    if (servidor->tamanhoFila == servidor->capacidadeFila)
+    {
+        // Desenrola a fila circular em um array maior
+        int novaCapacidade = servidor->capacidadeFila ? servidor->capacidadeFila * 2 : TAMANHO_HASH;
+        Conexao **nova = (Conexao **)malloc(sizeof(Conexao *) * novaCapacidade);
+        if (nova == NULL)
+        {
+            perror("Erro ao alocar memória para a fila do servidor");
+            exit(EXIT_FAILURE);
+        }
+        for (int i = 0; i < servidor->tamanhoFila; i++)
+        {
+            nova[i] = servidor->fila[(servidor->inicioFila + i) % servidor->capacidadeFila];
+        }
+        free(servidor->fila);
+        servidor->fila = nova;
+        servidor->capacidadeFila = novaCapacidade;
+        servidor->inicioFila = 0;
+    }
+    servidor->fila[(servidor->inicioFila + servidor->tamanhoFila) % servidor->capacidadeFila] = conexao;
+    servidor->tamanhoFila++;
+    pthread_cond_signal(&servidor->temTrabalho);
+    pthread_mutex_unlock(&servidor->trava);
+}
+
+/**
+ * @brief Espera a próxima conexão da fila.
+ * @return A conexão, ou NULL quando o servidor está encerrando e a fila acabou.
+ */
+Conexao *proximaConexao(Servidor *servidor)
+{
+    pthread_mutex_lock(&servidor->trava);
+    while (servidor->tamanhoFila == 0 && !servidor->encerrando)
+    {
+        pthread_cond_wait(&servidor->temTrabalho, &servidor->trava);
+    }
+    Conexao *conexao = NULL;
+    if (servidor->tamanhoFila > 0)
+    {
+        conexao = servidor->fila[servidor->inicioFila];
+        servidor->inicioFila = (servidor->inicioFila + 1) % servidor->capacidadeFila;
+        servidor->tamanhoFila--;
+    }
+    pthread_mutex_unlock(&servidor->trava);
+    return conexao;
+}
+
+/**
+ * @brief Cria a conexão de um cliente recém-aceito, com sessão própria na raiz da mansão.
+ */
+Conexao *abrirConexao(Servidor *servidor, int descritor)
+{
+    Conexao *conexao = (Conexao *)malloc(sizeof(Conexao));
+    if (conexao == NULL)
+    {
+        perror("Erro ao alocar memória para a conexão");
+        exit(EXIT_FAILURE);
+    }
+    conexao->descritor = descritor;
+    iniciarSessao(&conexao->sessao, servidor->mansao);
+    coletarPistaDaSala(&conexao->sessao);
+    iniciarSaida(&conexao->saida, SAIDA_EM_MEMORIA, servidor->verbosidade, TAMANHO_BUFFER_CONEXAO);
+    conexao->enviados = 0;
+    conexao->fimDaEntrada = 0;
+    conexao->descartando = 0;
+
+    pthread_mutex_lock(&servidor->trava);
+    conexao->anterior = NULL;
+    conexao->proxima = servidor->abertas;
+    if (servidor->abertas != NULL)
+    {
+        servidor->abertas->anterior = conexao;
+    }
+    servidor->abertas = conexao;
+    servidor->numAbertas++;
+    servidor->conexoesAtendidas++;
+    pthread_mutex_unlock(&servidor->trava);
+    return conexao;
+}
+
+/**
+ * @brief Fecha o socket do cliente e libera a sua sessão.
+ */
+void fecharConexao(Servidor *servidor, Conexao *conexao)
+{
+    pthread_mutex_lock(&servidor->trava);
+    if (conexao->anterior != NULL)
+    {
+        conexao->anterior->proxima = conexao->proxima;
+    }
+    else
+    {
+        servidor->abertas = conexao->proxima;
+    }
+    if (conexao->proxima != NULL)
+    {
+        conexao->proxima->anterior = conexao->anterior;
+    }
+    servidor->numAbertas--;
+    pthread_mutex_unlock(&servidor->trava);
+
+    liberarSaida(&conexao->saida);
+    close(conexao->descritor); // Também tira o descritor do epoll
+    liberarSessao(&conexao->sessao);
+    free(conexao);
+}
+
+/**
+ * @brief Escreve o estado da investigação em uma linha ("Sala:" ou "Fim:").
+ */
+void responderEstado(Conexao *conexao, const char *rotulo)
+{
+    const Sessao *sessao = &conexao->sessao;
+    const Dicionario *dicionario = sessao->mansao->dicionario;
+    Deducao deducao = deduzirDoPlacar(&sessao->evidencias, &sessao->placar);
+    escrever(&conexao->saida, "%s %s | %d pista(s) | %s\n", rotulo,
+             textoDe(dicionario, sessao->mansao->salas[sessao->salaAtual].nome), deducao.pistas, textoDoVeredito(dicionario, &deducao));
+}
+
+/**
+ * @brief Aplica os comandos recebidos de um cliente, com os mesmos comandos do --lote.
+ * A investigação continua de uma linha para a outra; cada linha recebe uma resposta:
+ * "Sala: ..." com o estado atual, ou "Fim: ..." se a investigação terminou nela
+ * (o resto da linha é ignorado e uma nova investigação começa na raiz).
+ * @return O número de investigações concluídas neste bloco.
+ */
+long processarEntradaConexao(Conexao *conexao, const char *dados, size_t tamanho)
+{
+    Sessao *sessao = &conexao->sessao;
+    int resumo = mostrar(&conexao->saida, VERBOSIDADE_RESUMO);
+    long concluidas = 0;
+
+    for (size_t i = 0; i < tamanho; i++)
+    {
+        int c = (unsigned char)dados[i];
+        if (c == '\n')
+        {
+            if (!conexao->descartando && resumo)
+            {
+                responderEstado(conexao, "Sala:");
+            }
+            conexao->descartando = 0;
+            continue;
+        }
+        if (conexao->descartando || isspace(c))
+        {
+            continue;
+        }
+
+        c = tolower(c);
+        if (c == 'a' && mostrar(&conexao->saida, VERBOSIDADE_COMPLETA))
+        {
+            mostrarDeducao(sessao, &conexao->saida);
+        }
+        if (aplicarComando(sessao, c))
+        {
+            if (resumo)
+            {
+                responderEstado(conexao, "Fim:");
+            }
+            concluidas++;
+            reiniciarSessao(sessao);
+            coletarPistaDaSala(sessao);
+            conexao->descartando = 1;
+        }
+    }
+    return concluidas;
+}
+
+/**
+ * @brief Bytes de resposta que o cliente ainda não recebeu.
+ */
+size_t saidaPendente(const Conexao *conexao)
+{
+    return conexao->saida.tamanhoMemoria - conexao->enviados;
+}
+
+/**
+ * @brief Envia o que der da saída pendente sem bloquear. Quando tudo sai, a memória
+ * da saída é reaproveitada do início.
+ * @return 0 se o envio falhou (o cliente sumiu), 1 caso contrário.
+ */
+int enviarPendente(Conexao *conexao)
+{
+    descarregarSaida(&conexao->saida); // Passa o buffer para a memória da saída
+    while (saidaPendente(conexao) > 0)
+    {
+        ssize_t escritos = send(conexao->descritor, conexao->saida.memoria + conexao->enviados,
+                                saidaPendente(conexao), MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (escritos < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+        conexao->enviados += (size_t)escritos;
+    }
+    conexao->saida.tamanhoMemoria = 0;
+    conexao->enviados = 0;
+    return 1;
+}
+
+/**
+ * @brief Laço de um trabalhador: pega uma conexão pronta, envia o que estava pendente,
+ * lê o que houver e devolve a conexão ao epoll (ou a fecha). Nada aqui bloqueia: um
+ * cliente que não lê as respostas acumula no máximo ~LIMITE_SAIDA_PENDENTE bytes, e aí
+ * deixa de ser lido (só EPOLLOUT) até esvaziar, sem prender o trabalhador.
+ */
+void *executarTrabalhador(void *argumento)
+{
+    Servidor *servidor = (Servidor *)argumento;
+    char bloco[TAMANHO_LEITURA_CONEXAO];
+    Conexao *conexao;
+
+    while ((conexao = proximaConexao(servidor)) != NULL)
+    {
+        int aberta = enviarPendente(conexao);
+        long concluidas = 0;
+
+        // Limita as leituras por vez para um cliente apressado não monopolizar o trabalhador
+        for (int leitura = 0; aberta && !conexao->fimDaEntrada && leitura < LEITURAS_POR_VEZ &&
+                              saidaPendente(conexao) < LIMITE_SAIDA_PENDENTE;
+             leitura++)
+        {
+            ssize_t lidos = recv(conexao->descritor, bloco, sizeof(bloco), MSG_DONTWAIT);
+            if (lidos > 0)
+            {
+                concluidas += processarEntradaConexao(conexao, bloco, (size_t)lidos);
+                aberta = enviarPendente(conexao);
+                continue;
+            }
+            if (lidos < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (lidos == 0)
+            {
+                conexao->fimDaEntrada = 1; // O cliente não manda mais nada; falta só responder
+            }
+            else if (errno != EAGAIN && errno != EWOULDBLOCK)
+            {
+                aberta = 0;
+            }
+            break;
+        }
+
+        if (concluidas > 0)
+        {
+            pthread_mutex_lock(&servidor->trava);
+            servidor->investigacoesConcluidas += concluidas;
+            pthread_mutex_unlock(&servidor->trava);
+        }
+
+        // Com saída pendente espera o cliente ler (EPOLLOUT); abaixo do limite também lê
+        struct epoll_event evento;
+        evento.events = EPOLLONESHOT;
+        if (saidaPendente(conexao) > 0)
+        {
+            evento.events |= EPOLLOUT;
+        }
+        if (!conexao->fimDaEntrada && saidaPendente(conexao) < LIMITE_SAIDA_PENDENTE)
+        {
+            evento.events |= EPOLLIN | EPOLLRDHUP;
+        }
+        evento.data.ptr = conexao;
+        if (!aberta || (conexao->fimDaEntrada && saidaPendente(conexao) == 0) ||
+            epoll_ctl(servidor->epoll, EPOLL_CTL_MOD, conexao->descritor, &evento) < 0)
+        {
+            fecharConexao(servidor, conexao);
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Cria o socket Unix de escuta em 'caminho' (um socket antigo no caminho é removido).
+ * @return O descritor, ou -1 em caso de erro (com mensagem em stderr).
+ */
+int abrirSocketEscuta(const char *caminho)
+{
+    struct sockaddr_un endereco;
+    if (strlen(caminho) >= sizeof(endereco.sun_path))
+    {
+        fprintf(stderr, "Caminho do socket muito longo: '%s'.\n", caminho);
+        return -1;
+    }
+
+    struct stat info;
+    if (lstat(caminho, &info) == 0 && S_ISSOCK(info.st_mode))
+    {
+        unlink(caminho);
+    }
+
+    int escuta = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (escuta < 0)
+    {
+        perror("Erro ao criar o socket do servidor");
+        return -1;
+    }
+    memset(&endereco, 0, sizeof(endereco));
+    endereco.sun_family = AF_UNIX;
+    strcpy(endereco.sun_path, caminho);
+    if (bind(escuta, (struct sockaddr *)&endereco, sizeof(endereco)) < 0 || listen(escuta, SOMAXCONN) < 0)
+    {
+        perror("Erro ao abrir o socket do servidor");
+        close(escuta);
+        return -1;
+    }
+    return escuta;
+}
+
+/**
+ * @brief Aceita todos os clientes pendentes e passa a vigiá-los no epoll.
+ */
+void aceitarClientes(Servidor *servidor)
+{
+    while (1)
+    {
+        int descritor = accept4(servidor->escuta, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (descritor < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+            {
+                perror("Erro ao aceitar cliente");
+            }
+            return;
+        }
+
+        Conexao *conexao = abrirConexao(servidor, descritor);
+        struct epoll_event evento;
+        evento.events = EPOLLIN | EPOLLRDHUP | EPOLLONESHOT;
+        evento.data.ptr = conexao;
+        if (epoll_ctl(servidor->epoll, EPOLL_CTL_ADD, descritor, &evento) < 0)
+        {
+            perror("Erro ao vigiar cliente");
+            fecharConexao(servidor, conexao);
+        }
+    }
+}
+
+/**
+ * @brief Servidor local: cada cliente do socket Unix 'caminho' joga a sua própria
+ * investigação sobre a mesma mansão, que é compartilhada só para leitura.
+ * Uma thread espera eventos no epoll e 'numThreads' trabalhadores atendem as conexões
+ * prontas. SIGINT/SIGTERM encerram e o resumo vai para stderr.
+ */
+int executarServidor(const Mansao *mansao, const char *caminho, int numThreads, int verbosidade)
+{
+    Servidor servidor;
+    memset(&servidor, 0, sizeof(servidor));
+    servidor.mansao = mansao;
+    servidor.verbosidade = verbosidade;
+    servidor.escuta = abrirSocketEscuta(caminho);
+    if (servidor.escuta < 0)
+    {
+        return EXIT_FAILURE;
+    }
+    servidor.epoll = epoll_create1(EPOLL_CLOEXEC);
+    struct epoll_event evento;
+    evento.events = EPOLLIN;
+    evento.data.ptr = NULL; // NULL marca o socket de escuta
+    if (servidor.epoll < 0 || epoll_ctl(servidor.epoll, EPOLL_CTL_ADD, servidor.escuta, &evento) < 0)
+    {
+        perror("Erro ao preparar o epoll do servidor");
+        close(servidor.escuta);
+        unlink(caminho);
+        return EXIT_FAILURE;
+    }
+    pthread_mutex_init(&servidor.trava, NULL);
+    pthread_cond_init(&servidor.temTrabalho, NULL);
+    congelarDicionario(mansao); // As sessões dos trabalhadores só leem o pool e o registro
+
+    // Um cliente que fecha a conexão não pode derrubar o servidor com SIGPIPE
+    signal(SIGPIPE, SIG_IGN);
+    struct sigaction acao;
+    memset(&acao, 0, sizeof(acao));
+    acao.sa_handler = pedirEncerramento;
+    sigaction(SIGINT, &acao, NULL);
+    sigaction(SIGTERM, &acao, NULL);
+
+    // Os sinais ficam bloqueados o tempo todo (os trabalhadores herdam a máscara) e só são
+    // liberados dentro do epoll_pwait: um SIGINT entre o teste de encerramentoPedido e a
+    // espera fica pendente e interrompe a espera, em vez de se perder até o próximo evento
+    sigset_t sinais;
+    sigset_t mascaraAnterior;
+    sigemptyset(&sinais);
+    sigaddset(&sinais, SIGINT);
+    sigaddset(&sinais, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &sinais, &mascaraAnterior);
+    sigset_t mascaraDaEspera = mascaraAnterior;
+    sigdelset(&mascaraDaEspera, SIGINT);
+    sigdelset(&mascaraDaEspera, SIGTERM);
+    pthread_t *trabalhadores = (pthread_t *)malloc(sizeof(pthread_t) * numThreads);
+    if (trabalhadores == NULL)
+    {
+        perror("Erro ao alocar memória para os trabalhadores");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < numThreads; i++)
+    {
+        if (pthread_create(&trabalhadores[i], NULL, executarTrabalhador, &servidor) != 0)
+        {
+            perror("Erro ao criar trabalhador");
+            exit(EXIT_FAILURE);
+        }
+    }
+    fprintf(stderr, "Servidor ouvindo em '%s' com %d trabalhador(es).\n", caminho, numThreads);
+
+    double inicioTempo = agoraSegundos();
+    struct epoll_event eventos[EVENTOS_POR_ESPERA];
+    while (!encerramentoPedido)
+    {
+        int prontos = epoll_pwait(servidor.epoll, eventos, EVENTOS_POR_ESPERA, -1, &mascaraDaEspera);
+        for (int i = 0; i < prontos; i++)
+        {
+            if (eventos[i].data.ptr == NULL)
+            {
+                aceitarClientes(&servidor);
+            }
+            else
+            {
+                enfileirarConexao(&servidor, (Conexao *)eventos[i].data.ptr);
+            }
+        }
+    }
+
+    // Encerramento: os trabalhadores esvaziam a fila e saem; as conexões restantes são fechadas
+    pthread_mutex_lock(&servidor.trava);
+    servidor.encerrando = 1;
+    pthread_cond_broadcast(&servidor.temTrabalho);
+    pthread_mutex_unlock(&servidor.trava);
+    for (int i = 0; i < numThreads; i++)
+    {
+        pthread_join(trabalhadores[i], NULL);
+    }
+    free(trabalhadores);
+    pthread_sigmask(SIG_SETMASK, &mascaraAnterior, NULL);
+    while (servidor.abertas != NULL)
+    {
+        fecharConexao(&servidor, servidor.abertas);
+    }
+
+    double duracao = agoraSegundos() - inicioTempo;
+    fprintf(stderr, "Servidor encerrado: %ld conexões, %ld investigações concluídas em %.1f s.\n",
+            servidor.conexoesAtendidas, servidor.investigacoesConcluidas, duracao);
+
+    close(servidor.epoll);
+    close(servidor.escuta);
+    unlink(caminho);
+    free(servidor.fila);
+    pthread_mutex_destroy(&servidor.trava);
+    pthread_cond_destroy(&servidor.temTrabalho);
+    return EXIT_SUCCESS;
+}
+
+// ==========================================================
+//            RESOLVEDOR DE ROTAS (PARALELO)
+// ==========================================================
+
+/**
+ * @brief Id do suspeito da pista de uma sala (todos foram registrados antes das threads).
+ */
+int suspeitoDaSala(const Dicionario *dicionario, const SalaCompilada *sala)
+{
+    return dicionario->suspeitos.idPorString[sala->suspeito];
+}
+
+/**
+ * @brief Soma uma citação ao suspeito na rota, mantendo o máximo e o histograma.
+ */
+void citarNaRota(TrabalhadorRotas *trabalhador, int id)
+{
+    int antes = trabalhador->citacoes[id]++;
+    if (antes + 1 >= trabalhador->capacidadeContagem)
+    {
+        int novaCapacidade = trabalhador->capacidadeContagem * 2;
+        int *contagens = (int *)realloc(trabalhador->porContagem, sizeof(int) * novaCapacidade);
+        int *xors = (int *)realloc(trabalhador->xorPorContagem, sizeof(int) * novaCapacidade);
+        if (contagens == NULL || xors == NULL)
+        {
+            perror("Erro ao alocar memória para o resolvedor");
+            exit(EXIT_FAILURE);
+        }
+        memset(contagens + trabalhador->capacidadeContagem, 0, sizeof(int) * (novaCapacidade - trabalhador->capacidadeContagem));
+        memset(xors + trabalhador->capacidadeContagem, 0, sizeof(int) * (novaCapacidade - trabalhador->capacidadeContagem));
+        trabalhador->porContagem = contagens;
+        trabalhador->xorPorContagem = xors;
+        trabalhador->capacidadeContagem = novaCapacidade;
+    }
+    trabalhador->porContagem[antes]--;
+    trabalhador->xorPorContagem[antes] ^= id;
+    trabalhador->porContagem[antes + 1]++;
+    trabalhador->xorPorContagem[antes + 1] ^= id;
+    if (antes + 1 > trabalhador->maximo)
+    {
+        trabalhador->maximo = antes + 1;
+    }
+}
+
+/**
+ * @brief Desfaz uma citação ao suspeito na rota (o inverso de citarNaRota).
+ */
+void descitarNaRota(TrabalhadorRotas *trabalhador, int id)
+{
+    int antes = trabalhador->citacoes[id]--;
+    trabalhador->porContagem[antes]--;
+    trabalhador->xorPorContagem[antes] ^= id;
+    trabalhador->porContagem[antes - 1]++;
+    trabalhador->xorPorContagem[antes - 1] ^= id;
+    if (antes == trabalhador->maximo && trabalhador->porContagem[antes] == 0)
+    {
+        trabalhador->maximo--;
+    }
+}
+
+/**
+ * @brief Acrescenta a sala ao fim da rota e coleta a sua pista (uma vez por texto,
+ * como a BST e a Tabela Hash fazem em uma sessão).
+ */
+void entrarNaRota(TrabalhadorRotas *trabalhador, uint32_t indice)
+{
+    const Mansao *mansao = trabalhador->resolvedor->mansao;
+    if (trabalhador->profundidade == trabalhador->capacidadeTrilha)
+    {
+        uint32_t novaCapacidade = trabalhador->capacidadeTrilha * 2;
+        uint32_t *trilha = (uint32_t *)realloc(trabalhador->trilha, sizeof(uint32_t) * novaCapacidade);
+        char *rota = (char *)realloc(trabalhador->rota, novaCapacidade + 1);
+        if (trilha == NULL || rota == NULL)
+        {
+            perror("Erro ao alocar memória para o resolvedor");
+            exit(EXIT_FAILURE);
+        }
+        trabalhador->trilha = trilha;
+        trabalhador->rota = rota;
+        trabalhador->capacidadeTrilha = novaCapacidade;
+    }
+
+    uint32_t profundidade = trabalhador->profundidade++;
+    trabalhador->trilha[profundidade] = indice;
+    trabalhador->rota[profundidade] = profundidade == 0 ? '-' :
+                                      mansao->salas[trabalhador->trilha[profundidade - 1]].esquerda == indice ? 'e' : 'd';
+
+    const SalaCompilada *sala = &mansao->salas[indice];
+    if (sala->pista != STRING_VAZIA && trabalhador->ocorrencias[sala->pista]++ == 0)
+    {
+        trabalhador->pistasNaRota++;
+        citarNaRota(trabalhador, suspeitoDaSala(mansao->dicionario, sala));
+    }
+}
+
+/**
+ * @brief Tira a última sala da rota, desfazendo a coleta da sua pista.
+ */
+void sairDaRota(TrabalhadorRotas *trabalhador)
+{
+    const Mansao *mansao = trabalhador->resolvedor->mansao;
+    const SalaCompilada *sala = &mansao->salas[trabalhador->trilha[--trabalhador->profundidade]];
+    if (sala->pista != STRING_VAZIA && --trabalhador->ocorrencias[sala->pista] == 0)
+    {
+        trabalhador->pistasNaRota--;
+        descitarNaRota(trabalhador, suspeitoDaSala(mansao->dicionario, sala));
+    }
+}
+
+/**
+ * @brief Contabiliza a rota atual (que termina em uma folha) e, na verbosidade completa,
+ * escreve "rota | pistas | veredito", listando os suspeitos empatados.
+ */
+void registrarRota(TrabalhadorRotas *trabalhador)
+{
+    uint32_t movimentos = trabalhador->profundidade - 1;
+    trabalhador->folhas++;
+    trabalhador->somaProfundidades += movimentos;
+    if (movimentos > trabalhador->maiorProfundidade)
+    {
+        trabalhador->maiorProfundidade = movimentos;
+    }
+
+    int maximo = trabalhador->maximo;
+    int empate = maximo > 0 && trabalhador->porContagem[maximo] > 1;
+    if (maximo == 0)
+    {
+        trabalhador->semPistas++;
+    }
+    else if (empate)
+    {
+        trabalhador->empates++;
+    }
+    else
+    {
+        trabalhador->vereditos[trabalhador->xorPorContagem[maximo]]++;
+    }
+
+    Renderizador *saida = &trabalhador->saida;
+    if (!mostrar(saida, VERBOSIDADE_COMPLETA))
+    {
+        return;
+    }
+
+    // Todos escrevem no mesmo descritor: a linha inteira precisa caber no buffer para não
+    // ser descarregada pela metade e misturada com a de outro trabalhador. Uma linha maior
+    // que o buffer inteiro é escrita com a trava de saída presa.
+    pthread_mutex_t *travaSaida = &trabalhador->resolvedor->travaSaida;
+    const Dicionario *dicionario = trabalhador->resolvedor->mansao->dicionario;
+    size_t necessario = movimentos + 64;
+    for (int i = 0; maximo > 0 && i < dicionario->suspeitos.quantidade; i++)
+    {
+        if (trabalhador->citacoes[i] == maximo)
+        {
+            necessario += strlen(nomeDoSuspeito(dicionario, i)) + 2;
+        }
+    }
+    int linhaGigante = necessario > saida->capacidade;
+    if (necessario > saida->capacidade - saida->usado)
+    {
+        pthread_mutex_lock(travaSaida);
+        descarregarSaida(saida);
+        if (!linhaGigante)
+        {
+            pthread_mutex_unlock(travaSaida);
+        }
+    }
+    trabalhador->rota[trabalhador->profundidade] = '\0';
+    escrever(saida, "%s | %d pista(s) | ", movimentos ? trabalhador->rota + 1 : "(raiz)", trabalhador->pistasNaRota);
+    if (maximo == 0)
+    {
+        escreverTexto(saida, "SEM PISTAS\n");
+    }
+    else if (!empate)
+    {
+        escrever(saida, "%s\n", nomeDoSuspeito(dicionario, trabalhador->xorPorContagem[maximo]));
+    }
+    else
+    {
+        escreverTexto(saida, "EMPATE (");
+        for (int i = 0, primeiro = 1; i < dicionario->suspeitos.quantidade; i++)
+        {
+            if (trabalhador->citacoes[i] == maximo)
+            {
+                escrever(saida, "%s%s", primeiro ? "" : ", ", nomeDoSuspeito(dicionario, i));
+                primeiro = 0;
+            }
+        }
+        escrever(saida, ": %d cada)\n", maximo);
+    }
+    if (linhaGigante)
+    {
+        descarregarSaida(saida);
+        pthread_mutex_unlock(travaSaida);
+    }
+}
+
+/**
+ * @brief Guarda uma subárvore pendente no topo do deque do trabalhador.
+ */
+void empilharTarefa(TrabalhadorRotas *trabalhador, uint32_t sala, uint32_t profundidade)
+{
+    pthread_mutex_lock(&trabalhador->trava);
+    if (trabalhador->topoDeque == trabalhador->capacidadeDeque)
+    {
+        if (trabalhador->baseDeque > 0)
+        {
+            // A base andou com os roubos: recupera o espaço antes de crescer
+            memmove(trabalhador->deque, trabalhador->deque + trabalhador->baseDeque,
+                    sizeof(TarefaRota) * (trabalhador->topoDeque - trabalhador->baseDeque));
+            trabalhador->topoDeque -= trabalhador->baseDeque;
+            trabalhador->baseDeque = 0;
+        }
+        else
+        {
+            int novaCapacidade = trabalhador->capacidadeDeque * 2;
+            TarefaRota *novo = (TarefaRota *)realloc(trabalhador->deque, sizeof(TarefaRota) * novaCapacidade);
+            if (novo == NULL)
+            {
+                perror("Erro ao alocar memória para o resolvedor");
+                exit(EXIT_FAILURE);
+            }
+            trabalhador->deque = novo;
+            trabalhador->capacidadeDeque = novaCapacidade;
+        }
+    }
+    trabalhador->deque[trabalhador->topoDeque].sala = sala;
+    trabalhador->deque[trabalhador->topoDeque].profundidade = profundidade;
+    trabalhador->topoDeque++;
+    pthread_mutex_unlock(&trabalhador->trava);
+}
+
+/**
+ * @brief Rouba a subárvore mais antiga (a maior) do deque de outro trabalhador.
+ * O ladrão volta a contar como ativo antes de soltar a trava da vítima, então o
+ * resolvedor nunca vê 'ativos' zerado com uma tarefa em trânsito.
+ * @return 1 se conseguiu uma tarefa, 0 se todos os deques estavam vazios.
+ */
+int roubarTarefa(TrabalhadorRotas *ladrao, TarefaRota *tarefa)
+{
+    Resolvedor *resolvedor = ladrao->resolvedor;
+    for (int i = 1; i < resolvedor->numTrabalhadores; i++)
+    {
+        TrabalhadorRotas *vitima = &resolvedor->trabalhadores[(ladrao->id + i) % resolvedor->numTrabalhadores];
+        pthread_mutex_lock(&vitima->trava);
+        int conseguiu = vitima->baseDeque < vitima->topoDeque;
+        if (conseguiu)
+        {
+            *tarefa = vitima->deque[vitima->baseDeque++];
+            pthread_mutex_lock(&resolvedor->trava);
+            resolvedor->ativos++;
+            pthread_mutex_unlock(&resolvedor->trava);
+        }
+        pthread_mutex_unlock(&vitima->trava);
+        if (conseguiu)
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Próxima subárvore do trabalhador, com a rota já posicionada no pai dela:
+ * a do topo do próprio deque (basta voltar na trilha) ou uma roubada (a rota é
+ * refeita da raiz pelos pais).
+ * @return 1 se há tarefa, 0 quando a mansão inteira já foi percorrida.
+ */
+int obterTarefa(TrabalhadorRotas *trabalhador, TarefaRota *tarefa)
+{
+    Resolvedor *resolvedor = trabalhador->resolvedor;
+    pthread_mutex_lock(&trabalhador->trava);
+    int temPropria = trabalhador->baseDeque < trabalhador->topoDeque;
+    if (temPropria)
+    {
+        *tarefa = trabalhador->deque[--trabalhador->topoDeque];
+        if (trabalhador->topoDeque == trabalhador->baseDeque)
+        {
+            trabalhador->baseDeque = trabalhador->topoDeque = 0;
+        }
+    }
+    pthread_mutex_unlock(&trabalhador->trava);
+    if (temPropria)
+    {
+        while (trabalhador->profundidade > tarefa->profundidade)
+        {
+            sairDaRota(trabalhador);
+        }
+        return 1;
+    }
+
+    // Sem trabalho próprio: procura nos outros até todos ficarem sem
+    pthread_mutex_lock(&resolvedor->trava);
+    resolvedor->ativos--;
+    pthread_mutex_unlock(&resolvedor->trava);
+    while (!roubarTarefa(trabalhador, tarefa))
+    {
+        pthread_mutex_lock(&resolvedor->trava);
+        int terminou = resolvedor->ativos == 0;
+        pthread_mutex_unlock(&resolvedor->trava);
+        if (terminou)
+        {
+            return 0;
+        }
+        sched_yield();
+    }
+    trabalhador->roubos++;
+
+    while (trabalhador->profundidade > 0)
+    {
+        sairDaRota(trabalhador);
+    }
+    uint32_t numAncestrais = 0;
+    for (uint32_t sala = resolvedor->pais[tarefa->sala]; sala != SEM_SALA; sala = resolvedor->pais[sala])
     {
-        soma += chave[i];
+        trabalhador->ancestrais[numAncestrais++] = sala;
     }
-    return soma % TAMANHO_HASH;
-}
-
-/**
- * @brief Cria um novo nó de Associação.
- */
-Associacao *criarAssociacao(const char *pista, const char *suspeito)
-{
-    Associacao *nova = (Associacao *)malloc(sizeof(Associacao));
-    if (nova == NULL)
+    while (numAncestrais > 0)
     {
-        perror("Erro ao alocar memória para Associacao");
-        exit(EXIT_FAILURE);
+        entrarNaRota(trabalhador, trabalhador->ancestrais[--numAncestrais]);
     }
-    strncpy(nova->pista, pista, sizeof(nova->pista) - 1);
-    nova->pista[sizeof(nova->pista) - 1] = '\0';
-    strncpy(nova->suspeito, suspeito, sizeof(nova->suspeito) - 1);
-    nova->suspeito[sizeof(nova->suspeito) - 1] = '\0';
-    nova->proximo = NULL;
-    return nova;
+    return 1;
 }
 
 /**
- * @brief Insere uma nova associação Pista-Suspeito na Tabela Hash.
+ * @brief Thread do resolvedor: desce sempre pela esquerda, deixando a direita no deque,
+ * até uma folha; depois pega a próxima subárvore (própria ou roubada).
  */
-void inserirNaHash(const char *pista, const char *suspeito)
+void *executarTrabalhadorRotas(void *argumento)
 {
-    int indice = funcaoHash(pista);
-
-    // Verifica se a associação já existe (evita duplicação)
-    Associacao *atual = tabelaHash[indice];
-    while (atual != NULL)
+    TrabalhadorRotas *trabalhador = (TrabalhadorRotas *)argumento;
+    const Mansao *mansao = trabalhador->resolvedor->mansao;
+    TarefaRota tarefa;
+    while (obterTarefa(trabalhador, &tarefa))
     {
-        if (strcmp(atual->pista, pista) == 0)
+        uint32_t indice = tarefa.sala;
+        while (1)
         {
-            // Se já existe, apenas garante que o suspeito está correto (ou ignora, conforme simplificação)
-            // printf("Associação '%s' -> '%s' já existe. Ignorando.\n", pista, suspeito);
-            return;
+            entrarNaRota(trabalhador, indice);
+            const SalaCompilada *sala = &mansao->salas[indice];
+            if (sala->esquerda == SEM_SALA && sala->direita == SEM_SALA)
+            {
+                registrarRota(trabalhador);
+                break;
+            }
+            if (sala->esquerda != SEM_SALA && sala->direita != SEM_SALA)
+            {
+                empilharTarefa(trabalhador, sala->direita, trabalhador->profundidade);
+            }
+            indice = sala->esquerda != SEM_SALA ? sala->esquerda : sala->direita;
         }
-        atual = atual->proximo;
     }
-
-    // Cria e insere no início da lista (encadeamento)
-    Associacao *nova = criarAssociacao(pista, suspeito);
-    nova->proximo = tabelaHash[indice];
-    tabelaHash[indice] = nova;
-
-    // printf("Associação Hash: '%s' -> '%s' (Índice %d)\n", pista, suspeito, indice); // Debug
+    return NULL;
 }
 
 /**
- * @brief Inicializa a Tabela Hash com NULL.
+ * @brief Prepara o estado de um trabalhador (contagens zeradas para a rota vazia).
  */
-void inicializarHash()
+void iniciarTrabalhadorRotas(TrabalhadorRotas *trabalhador, Resolvedor *resolvedor, int id, int verbosidade)
 {
-    for (int i = 0; i < TAMANHO_HASH; i++)
+    const Dicionario *dicionario = resolvedor->mansao->dicionario;
+    int numSuspeitos = dicionario->suspeitos.quantidade;
+    memset(trabalhador, 0, sizeof(*trabalhador));
+    trabalhador->resolvedor = resolvedor;
+    trabalhador->id = id;
+    pthread_mutex_init(&trabalhador->trava, NULL);
+    trabalhador->capacidadeDeque = TAMANHO_DEQUE_ROTAS;
+    trabalhador->deque = (TarefaRota *)malloc(sizeof(TarefaRota) * trabalhador->capacidadeDeque);
+    trabalhador->capacidadeTrilha = TAMANHO_DEQUE_ROTAS;
+    trabalhador->trilha = (uint32_t *)malloc(sizeof(uint32_t) * trabalhador->capacidadeTrilha);
+    trabalhador->rota = (char *)malloc(trabalhador->capacidadeTrilha + 1);
+    trabalhador->ancestrais = (uint32_t *)malloc(sizeof(uint32_t) * (resolvedor->mansao->numSalas + 1));
+    trabalhador->ocorrencias = (uint32_t *)calloc((size_t)dicionario->pool.quantidade, sizeof(uint32_t));
+    trabalhador->citacoes = (int *)calloc((size_t)numSuspeitos + 1, sizeof(int));
+    trabalhador->capacidadeContagem = TAMANHO_HASH;
+    trabalhador->porContagem = (int *)calloc((size_t)trabalhador->capacidadeContagem, sizeof(int));
+    trabalhador->xorPorContagem = (int *)calloc((size_t)trabalhador->capacidadeContagem, sizeof(int));
+    trabalhador->vereditos = (long *)calloc((size_t)numSuspeitos + 1, sizeof(long));
+    if (trabalhador->deque == NULL || trabalhador->trilha == NULL || trabalhador->rota == NULL ||
+        trabalhador->ancestrais == NULL || trabalhador->ocorrencias == NULL || trabalhador->citacoes == NULL ||
+        trabalhador->porContagem == NULL || trabalhador->xorPorContagem == NULL || trabalhador->vereditos == NULL)
+    {
+        perror("Erro ao alocar memória para o resolvedor");
+        exit(EXIT_FAILURE);
+    }
+
+    // Na rota vazia, todos os suspeitos estão com zero citações
+    trabalhador->porContagem[0] = numSuspeitos;
+    for (int i = 0; i < numSuspeitos; i++)
     {
-        tabelaHash[i] = NULL;
+        trabalhador->xorPorContagem[0] ^= i;
     }
+    iniciarSaida(&trabalhador->saida, STDOUT_FILENO, verbosidade, TAMANHO_BUFFER_SAIDA);
 }
 
 /**
- * @brief Libera a memória alocada para a Tabela Hash.
+ * @brief Libera o estado de um trabalhador, descarregando o relatório que falta.
  */
-void liberarHash()
+void liberarTrabalhadorRotas(TrabalhadorRotas *trabalhador)
 {
-    for (int i = 0; i < TAMANHO_HASH; i++)
-    {
-        Associacao *atual = tabelaHash[i];
-        Associacao *temp;
-        while (atual != NULL)
-        {
-            temp = atual;
-            atual = atual->proximo;
-            free(temp);
-        }
-        tabelaHash[i] = NULL;
-    }
+    liberarSaida(&trabalhador->saida);
+    pthread_mutex_destroy(&trabalhador->trava);
+    free(trabalhador->deque);
+    free(trabalhador->trilha);
+    free(trabalhador->rota);
+    free(trabalhador->ancestrais);
+    free(trabalhador->ocorrencias);
+    free(trabalhador->citacoes);
+    free(trabalhador->porContagem);
+    free(trabalhador->xorPorContagem);
+    free(trabalhador->vereditos);
 }
 
-// ==========================================================
-//             FUNÇÕES DE ANÁLISE E DEDUÇÃO
-// ==========================================================
-
 /**
- * @brief Analisa a Tabela Hash e identifica o suspeito mais citado.
+ * @brief Percorre todas as rotas da raiz até cada folha com 'numThreads' threads e
+ * calcula a dedução de cada uma. Na verbosidade completa sai uma linha por rota (em
+ * ordem de término, que varia com os roubos); no resumo, só os totais por suspeito,
+ * empates e rotas sem pistas. O tempo e os roubos vão para stderr.
  */
-void analisarEvidencias()
+int executarResolvedor(const Mansao *mansao, int numThreads, Renderizador *saida)
 {
-    printf("\n=============================================\n");
-    printf("🕵️  ANÁLISE DE EVIDÊNCIAS (DEDUÇÃO) \n");
-    printf("=============================================\n");
+    // Uma sala com pista e sem suspeito registra o nome vazio, como faria uma sessão
+    congelarDicionario(mansao);
 
-    // Usa um array simples para contagem de votos, pois o número de suspeitos é pequeno e fixo.
-    // Estrutura mais robusta usaria outra Hash ou BST para contagem, mas simplificaremos.
-
-    // Supondo 3 Suspeitos Fixos: "Mordomo", "Jardineiro", "Dama"
-    char *suspeitos[] = {"Mordomo", "Jardineiro", "Dama"};
-    int contagem[3] = {0, 0, 0};
-    int num_suspeitos = 3;
-
-    int total_pistas = 0;
-
-    // 1. Percorre a Tabela Hash e Conta as Citações
-    for (int i = 0; i < TAMANHO_HASH; i++)
+    Resolvedor resolvedor;
+    resolvedor.mansao = mansao;
+    resolvedor.numTrabalhadores = numThreads;
+    resolvedor.ativos = numThreads;
+    pthread_mutex_init(&resolvedor.trava, NULL);
+    pthread_mutex_init(&resolvedor.travaSaida, NULL);
+    resolvedor.pais = (uint32_t *)malloc(sizeof(uint32_t) * (mansao->numSalas + 1));
+    resolvedor.trabalhadores = (TrabalhadorRotas *)malloc(sizeof(TrabalhadorRotas) * numThreads);
+    pthread_t *threads = (pthread_t *)malloc(sizeof(pthread_t) * numThreads);
+    if (resolvedor.pais == NULL || resolvedor.trabalhadores == NULL || threads == NULL)
     {
-        Associacao *atual = tabelaHash[i];
-        while (atual != NULL)
-        {
-            total_pistas++;
-            printf("Evidência: '%s' -> Suspeito: %s\n", atual->pista, atual->suspeito);
-
-            // Incrementa o contador do suspeito correspondente
-            for (int j = 0; j < num_suspeitos; j++)
-            {
-                if (strcmp(atual->suspeito, suspeitos[j]) == 0)
-                {
-                    contagem[j]++;
-                    break;
-                }
-            }
-            atual = atual->proximo;
-        }
+        perror("Erro ao alocar memória para o resolvedor");
+        exit(EXIT_FAILURE);
     }
-
-    if (total_pistas == 0)
+    for (uint32_t i = 0; i < mansao->numSalas; i++)
     {
-        printf("Não há pistas coletadas para realizar a dedução.\n");
-        return;
+        resolvedor.pais[i] = SEM_SALA;
     }
-
-    // 2. Encontra o suspeito mais citado
-    int max_citacoes = -1;
-    char culpado_final[MAX_NOME] = "INDEFINIDO";
-    int empates = 0;
-
-    for (int i = 0; i < num_suspeitos; i++)
+    for (uint32_t i = 0; i < mansao->numSalas; i++)
     {
-        printf("\nTotal de Pistas ligadas a %s: %d", suspeitos[i], contagem[i]);
-        if (contagem[i] > max_citacoes)
+        if (mansao->salas[i].esquerda != SEM_SALA)
         {
-            max_citacoes = contagem[i];
-            strncpy(culpado_final, suspeitos[i], MAX_NOME - 1);
-            empates = 0; // Novo máximo, zera empates
+            resolvedor.pais[mansao->salas[i].esquerda] = i;
         }
-        else if (contagem[i] == max_citacoes)
+        if (mansao->salas[i].direita != SEM_SALA)
         {
-            empates = 1; // Encontrou um empate
+            resolvedor.pais[mansao->salas[i].direita] = i;
         }
     }
-
-    // 3. Exibe o resultado final
-    printf("\n\n---------------------------------------------\n");
-    if (empates)
-    {
-        printf("🛑 DEDUÇÃO FINAL: EMPATE!\n");
-        printf("Vários suspeitos têm o mesmo número máximo de %d evidências.\n", max_citacoes);
-    }
-    else
+    for (int i = 0; i < numThreads; i++)
     {
-        printf("🎉 DEDUÇÃO FINAL: O suspeito mais citado é: %s\n", culpado_final);
-        printf("Com um total de %d evidências encontradas.\n", max_citacoes);
+        iniciarTrabalhadorRotas(&resolvedor.trabalhadores[i], &resolvedor, i, saida->verbosidade);
     }
-    printf("---------------------------------------------\n");
-}
-
-// ==========================================================
-//            FUNÇÕES DA BST E NAVEGAÇÃO (Reutilizadas)
-// ==========================================================
+    empilharTarefa(&resolvedor.trabalhadores[0], mansao->raiz, 0);
 
-// --- BST de Pistas ---
-
-Pista *criarPista(const char *descricao)
-{
-    Pista *novaPista = (Pista *)malloc(sizeof(Pista));
-    if (novaPista == NULL)
+    double inicio = agoraSegundos();
+    for (int i = 0; i < numThreads; i++)
     {
-        exit(EXIT_FAILURE);
+        if (pthread_create(&threads[i], NULL, executarTrabalhadorRotas, &resolvedor.trabalhadores[i]) != 0)
+        {
+            perror("Erro ao criar trabalhador");
+            exit(EXIT_FAILURE);
+        }
     }
-    strncpy(novaPista->descricao, descricao, sizeof(novaPista->descricao) - 1);
-    novaPista->descricao[sizeof(novaPista->descricao) - 1] = '\0';
-    novaPista->esquerda = NULL;
-    novaPista->direita = NULL;
-    return novaPista;
-}
-
-Pista *inserirPista(Pista *raiz, const char *descricao, const char *suspeito_a_associar)
-{
-    if (raiz == NULL)
+    for (int i = 0; i < numThreads; i++)
     {
-        printf("\n✅ Pista '%s' adicionada ao Diário! (Suspeito: %s)\n", descricao, suspeito_a_associar);
-        // NOVO: Insere a associação na Tabela Hash
-        inserirNaHash(descricao, suspeito_a_associar);
-        return criarPista(descricao);
+        pthread_join(threads[i], NULL);
     }
+    double duracao = agoraSegundos() - inicio;
 
-    int comparacao = strcmp(descricao, raiz->descricao);
-
-    if (comparacao < 0)
+    // Junta os totais e descarrega os relatórios antes do resumo
+    const Dicionario *dicionario = mansao->dicionario;
+    int numSuspeitos = dicionario->suspeitos.quantidade;
+    long *vereditos = (long *)calloc((size_t)numSuspeitos + 1, sizeof(long));
+    if (vereditos == NULL)
     {
-        raiz->esquerda = inserirPista(raiz->esquerda, descricao, suspeito_a_associar);
+        perror("Erro ao alocar memória para o resolvedor");
+        exit(EXIT_FAILURE);
     }
-    else if (comparacao > 0)
+    long folhas = 0, empates = 0, semPistas = 0, roubos = 0;
+    unsigned long long somaProfundidades = 0;
+    uint32_t maiorProfundidade = 0;
+    for (int i = 0; i < numThreads; i++)
     {
-        raiz->direita = inserirPista(raiz->direita, descricao, suspeito_a_associar);
+        TrabalhadorRotas *trabalhador = &resolvedor.trabalhadores[i];
+        for (int j = 0; j < numSuspeitos; j++)
+        {
+            vereditos[j] += trabalhador->vereditos[j];
+        }
+        folhas += trabalhador->folhas;
+        empates += trabalhador->empates;
+        semPistas += trabalhador->semPistas;
+        roubos += trabalhador->roubos;
+        somaProfundidades += trabalhador->somaProfundidades;
+        if (trabalhador->maiorProfundidade > maiorProfundidade)
+        {
+            maiorProfundidade = trabalhador->maiorProfundidade;
+        }
+        liberarTrabalhadorRotas(trabalhador);
     }
-    else
+
+    if (mostrar(saida, VERBOSIDADE_RESUMO))
     {
-        printf("⚠️ Pista '%s' duplicada ignorada.\n", descricao);
+        escrever(saida, "Rotas até as folhas: %ld (profundidade média %.2f, máxima %u)\n",
+                 folhas, folhas ? (double)somaProfundidades / folhas : 0.0, maiorProfundidade);
+        for (int j = 0; j < numSuspeitos; j++)
+        {
+            escrever(saida, "  %-20s %ld rota(s) (%.2f%%)\n", nomeDoSuspeito(dicionario, j),
+                     vereditos[j], folhas ? 100.0 * vereditos[j] / folhas : 0.0);
+        }
+        escrever(saida, "  %-20s %ld rota(s) (%.2f%%)\n", "EMPATE", empates, folhas ? 100.0 * empates / folhas : 0.0);
+        escrever(saida, "  %-20s %ld rota(s) (%.2f%%)\n", "SEM PISTAS", semPistas, folhas ? 100.0 * semPistas / folhas : 0.0);
     }
+    fprintf(stderr, "Resolvedor: %ld rotas em %.3f s (%.0f rotas/s) com %d thread(s), %ld roubo(s).\n",
+            folhas, duracao, duracao > 0 ? folhas / duracao : 0.0, numThreads, roubos);
 
-    return raiz;
+    free(vereditos);
+    free(threads);
+    free(resolvedor.trabalhadores);
+    free(resolvedor.pais);
+    pthread_mutex_destroy(&resolvedor.trava);
+    pthread_mutex_destroy(&resolvedor.travaSaida);
+    return EXIT_SUCCESS;
 }
 
-void liberarPistas(Pista *raiz)
+// ==========================================================
+//                 MOTORES EM PARALELO
+// ==========================================================
+
+/**
+ * @brief Soma um valor à assinatura de um motor (depende da ordem dos valores).
+ */
+unsigned long long misturarAssinatura(unsigned long long assinatura, unsigned long long valor)
 {
-    if (raiz != NULL)
-    {
-        liberarPistas(raiz->esquerda);
-        liberarPistas(raiz->direita);
-        free(raiz);
-    }
+    return misturar64(assinatura ^ valor, 0x9E3779B97F4A7C15ULL);
 }
 
-// --- Árvore de Salas ---
-
-Sala *criarSala(const char *nome, const char *pista_inicial, const char *suspeito_assoc)
+/**
+ * @brief Laço de um motor: investigações aleatórias só com os passos sem E/S (mover,
+ * voltar, teleportar, coletar e deduzir), cada uma até uma folha ou PASSOS_POR_INVESTIGACAO.
+ * A mesma semente dá a mesma assinatura, esteja o motor sozinho ou ao lado de outros.
+ */
+void *executarMotorJogo(void *argumento)
 {
-    Sala *novaSala = (Sala *)malloc(sizeof(Sala));
-    if (novaSala == NULL)
+    MotorJogo *motor = (MotorJogo *)argumento;
+    const Mansao *mansao = motor->mansao;
+    unsigned long long estado = motor->semente;
+    Sessao sessao;
+    iniciarSessao(&sessao, mansao);
+
+    for (long i = 0; i < motor->investigacoes; i++)
     {
-        exit(EXIT_FAILURE);
-    }
+        coletarPistaDaSala(&sessao);
+        for (int passo = 0; passo < PASSOS_POR_INVESTIGACAO && !ehFolha(mansao, sessao.salaAtual); passo++)
+        {
+            unsigned long long bits = proximoAleatorio(&estado);
+            int moveu;
+            if ((bits & 63) == 0)
+            {
+                // Teleporte pelo nome: exercita o índice de salas e a busca no pool congelado
+                uint32_t sala = (uint32_t)((bits >> 8) % mansao->numSalas);
+                moveu = teleportarSessao(&sessao, textoDe(mansao->dicionario, mansao->salas[sala].nome), NULL);
+            }
+            else if ((bits & 7) == 0)
+            {
+                moveu = voltarSessao(&sessao);
+            }
+            else
+            {
+                moveu = moverSessao(&sessao, (bits & 8) ? 'e' : 'd');
+            }
+            if (moveu)
+            {
+                coletarPistaDaSala(&sessao);
+                motor->passos++;
+            }
+        }
 
-    strncpy(novaSala->nome, nome, MAX_NOME - 1);
-    strncpy(novaSala->pista_encontrada, pista_inicial, sizeof(novaSala->pista_encontrada) - 1);
-    strncpy(novaSala->suspeito_associado, suspeito_assoc, MAX_NOME - 1);
+        Deducao deducao = deduzir(&sessao);
+        unsigned long long probabilidade;
+        memcpy(&probabilidade, &deducao.maisProvavel.probabilidade, sizeof(probabilidade));
+        motor->assinatura = misturarAssinatura(motor->assinatura, ((unsigned long long)(unsigned int)deducao.suspeito << 32) |
+                                                                      ((unsigned long long)deducao.empate << 31) | (unsigned int)deducao.citacoes);
+        motor->assinatura = misturarAssinatura(motor->assinatura, ((unsigned long long)sessao.salaAtual << 32) | (unsigned int)deducao.pistas);
+        motor->assinatura = misturarAssinatura(motor->assinatura, probabilidade ^ (unsigned int)deducao.maisProvavel.suspeito);
+        if (deducao.pistas > 0 && !deducao.empate)
+        {
+            motor->vereditos++;
+        }
+        reiniciarSessao(&sessao);
+    }
 
-    novaSala->pista_coletada = (strlen(pista_inicial) == 0);
-    novaSala->esquerda = NULL;
-    novaSala->direita = NULL;
-    return novaSala;
+    liberarSessao(&sessao);
+    return NULL;
 }
 
-void liberarArvoreSalas(Sala *raiz)
+/**
+ * @brief Prepara um motor com a semente de índice 'i' e os totais zerados.
+ */
+void iniciarMotorJogo(MotorJogo *motor, const Mansao *mansao, int i, long investigacoes)
 {
-    if (raiz != NULL)
-    {
-        liberarArvoreSalas(raiz->esquerda);
-        liberarArvoreSalas(raiz->direita);
-        free(raiz);
-    }
+    motor->mansao = mansao;
+    motor->semente = (unsigned long long)(i + 1) * 0x9E3779B97F4A7C15ULL; // Nunca zero (xorshift)
+    motor->investigacoes = investigacoes;
+    motor->passos = 0;
+    motor->vereditos = 0;
+    motor->assinatura = 0;
 }
 
-void explorarSalas(Sala *salaAtual, Pista **pistasRaiz)
+/**
+ * @brief Roda 'numThreads' motores independentes ao mesmo tempo, cada um com a sua sessão,
+ * e depois os mesmos motores um após o outro em uma só thread. As assinaturas têm de ser
+ * iguais: se um motor enxergasse o estado de outro, a ordem das threads mudaria o resultado.
+ * @return EXIT_SUCCESS se todas as assinaturas coincidem, EXIT_FAILURE caso contrário.
+ */
+int executarMotores(const Mansao *mansao, int numThreads, long investigacoes, Renderizador *saida)
 {
-    char escolha;
+    congelarDicionario(mansao); // Daqui em diante o pool e o registro são só lidos
 
-    if (salaAtual == NULL)
+    MotorJogo *motores = (MotorJogo *)malloc(sizeof(MotorJogo) * numThreads);
+    unsigned long long *assinaturas = (unsigned long long *)malloc(sizeof(unsigned long long) * numThreads);
+    pthread_t *threads = (pthread_t *)malloc(sizeof(pthread_t) * numThreads);
+    if (motores == NULL || assinaturas == NULL || threads == NULL)
     {
-        printf("\n❌ Fim do caminho! Você chegou a uma parede.\n");
-        return;
+        perror("Erro ao alocar memória para os motores");
+        exit(EXIT_FAILURE);
     }
 
-    printf("\n-------------------------------------------------\n");
-    printf("🚪 Você está em: %s\n", salaAtual->nome);
+    double inicio = agoraSegundos();
+    for (int i = 0; i < numThreads; i++)
+    {
+        iniciarMotorJogo(&motores[i], mansao, i, investigacoes);
+        if (pthread_create(&threads[i], NULL, executarMotorJogo, &motores[i]) != 0)
+        {
+            perror("Erro ao criar motor");
+            exit(EXIT_FAILURE);
+        }
+    }
+    for (int i = 0; i < numThreads; i++)
+    {
+        pthread_join(threads[i], NULL);
+    }
+    double duracaoParalela = agoraSegundos() - inicio;
 
-    // --- Lógica de Encontrar e Coletar Pista (NOVO: Associa Suspeito) ---
-    if (strlen(salaAtual->pista_encontrada) > 0 && salaAtual->pista_coletada == 0)
+    long passos = 0, vereditos = 0;
+    for (int i = 0; i < numThreads; i++)
     {
-        printf("\n 🌟 PISTA ENCONTRADA! Você encontrou: \"%s\"\n", salaAtual->pista_encontrada);
-        printf("  Esta pista está ligada ao: %s \n", salaAtual->suspeito_associado);
+        assinaturas[i] = motores[i].assinatura;
+        passos += motores[i].passos;
+        vereditos += motores[i].vereditos;
+    }
 
-        // Insere a pista na BST E a associação na Tabela Hash
-        *pistasRaiz = inserirPista(*pistasRaiz, salaAtual->pista_encontrada, salaAtual->suspeito_associado);
-        salaAtual->pista_coletada = 1;
+    // A mesma carga em sequência, para comparar o resultado e o tempo
+    inicio = agoraSegundos();
+    int divergentes = 0;
+    for (int i = 0; i < numThreads; i++)
+    {
+        iniciarMotorJogo(&motores[i], mansao, i, investigacoes);
+        executarMotorJogo(&motores[i]);
+        divergentes += motores[i].assinatura != assinaturas[i];
     }
+    double duracaoSequencial = agoraSegundos() - inicio;
 
-    // Verifica se é um nó folha
-    if (salaAtual->esquerda == NULL && salaAtual->direita == NULL)
+    long total = investigacoes * numThreads;
+    if (mostrar(saida, VERBOSIDADE_RESUMO))
     {
-        printf("\n🎉 Você chegou ao fim deste caminho da mansão !\n"); // Nó-Folha
-        printf("\n🤔 Deseja fazer sua dedução final? [a] Analisar Evidências / [s] Sair: ");
-        if (scanf(" %c", &escolha) == 1)
+        escrever(saida, "Motores: %d em paralelo, %ld investigação(ões) cada, %ld passo(s), %ld veredito(s) sem empate\n",
+                 numThreads, investigacoes, passos, vereditos);
+        if (mostrar(saida, VERBOSIDADE_COMPLETA))
         {
-            escolha = tolower(escolha);
-            if (escolha == 'a')
+            for (int i = 0; i < numThreads; i++)
             {
-                analisarEvidencias(); // Chama a função de dedução!
+                escrever(saida, "  motor %d: assinatura %016llx\n", i, assinaturas[i]);
             }
         }
-        int c;
-        while ((c = getchar()) != '\n' && c != EOF)
-            ;
-        return;
+        escrever(saida, "Resultado igual ao da execução sequencial: %s\n", divergentes ? "NÃO" : "sim");
     }
-
-    // --- Opções de Navegação ---
-    printf("\n Escolha o próximo caminho:\n");
-    printf("\n  [e] -> Esquerda (%s)\n", salaAtual->esquerda ? salaAtual->esquerda->nome : "Caminho Bloqueado 🚧");
-    printf("  [d] -> Direita (%s)\n", salaAtual->direita ? salaAtual->direita->nome : "Caminho Bloqueado 🚧");
-    printf("  [a] -> Analisar Evidências Coletadas\n");
-    printf("  [s] -> Sair da Exploração\n");
-    printf("\n Sua escolha: ");
-
-    if (scanf(" %c", &escolha) != 1)
+    fprintf(stderr, "Motores: %ld investigações em %.3f s com %d thread(s) (%.0f/s); em sequência %.3f s (%.0f/s), aceleração %.2fx.\n",
+            total, duracaoParalela, numThreads, duracaoParalela > 0 ? total / duracaoParalela : 0.0,
+            duracaoSequencial, duracaoSequencial > 0 ? total / duracaoSequencial : 0.0,
+            duracaoParalela > 0 ? duracaoSequencial / duracaoParalela : 0.0);
+    if (divergentes)
     {
-        int c;
-        while ((c = getchar()) != '\n' && c != EOF)
-            ;
-        printf("\n⚠️ Entrada inválida. Tente novamente.\n");
-        explorarSalas(salaAtual, pistasRaiz);
-        return;
+        fprintf(stderr, "Erro: %d motor(es) deram resultado diferente em paralelo.\n", divergentes);
     }
 
-    escolha = tolower(escolha);
+    free(threads);
+    free(assinaturas);
+    free(motores);
+    return divergentes ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+// ==========================================================
+//                 MAPA DA MANSÃO E MAIN
+// ==========================================================
+
+/**
+ * @brief Monta a Árvore Binária (Mapa) padrão com Pistas e Suspeitos.
+ * Argumentos de criarSala: (dicionario, arena, nome, pista_encontrada, suspeito_associado)
+ * O mesmo mapa está em mapa-mansao.txt para uso com --mapa.
+ * @return A raiz do mapa (Hall de Entrada).
+ */
+Sala *montarMansao(Dicionario *dicionario, Arena *arena)
+{
+    // Raiz (Nível 0)
+    Sala *hallEntrada = criarSala(dicionario, arena, "Hall de Entrada", "", "");
+
+    // Nível 1
+    Sala *biblioteca = criarSala(dicionario, arena, "Biblioteca", "Lupa quebrada", "Mordomo");
+    Sala *cozinha = criarSala(dicionario, arena, "Cozinha", "Faca de prata", "Jardineiro");
+    hallEntrada->esquerda = biblioteca;
+    hallEntrada->direita = cozinha;
+
+    // Nível 2 - Ramo Esquerdo (Biblioteca)
+    Sala *estufa = criarSala(dicionario, arena, "Estufa", "Pegadas de barro", "Jardineiro"); // Nó Folha
+    Sala *escritorio = criarSala(dicionario, arena, "Escritório", "Carta rasgada", "Dama");
+    biblioteca->esquerda = estufa;
+    biblioteca->direita = escritorio;
+
+    // Nível 2 - Ramo Direito (Cozinha)
+    cozinha->esquerda = criarSala(dicionario, arena, "Quarto Principal", "Luva de seda", "Dama"); // Nó Folha
+    // cozinha->direita fica NULL
+
+    // Nível 3 - Ramo Esquerdo (Escritório)
+    escritorio->esquerda = criarSala(dicionario, arena, "Sala de Jantar", "Poeira de veneno", "Mordomo");
+    escritorio->direita = criarSala(dicionario, arena, "Porão", "Chave enferrujada", "Mordomo"); // Nó Folha
+    // Sala de Jantar é Nó Folha
+
+    return hallEntrada;
+}
+
+// --- 5. Função Principal (main) ---
 
-    switch (escolha)
+int main(int argc, char *argv[])
+{
+    // Opções: --mapa <arquivo>, --lote [arquivo], --compilar-mapa <saída>, --ordem <layout>,
+    // --verbosidade <nível>, --servidor <socket> [--threads n], --sessao <snapshot>, --resolver,
+    // --motores [investigações] [--threads n], --estatisticas <arquivo>
+    const char *caminhoMapa = NULL;
+    const char *caminhoEstatisticas = NULL;
+    const char *caminhoSessao = NULL;
+    int tipoOrdem = -1;
+    int verbosidade = -1;
+    const char *caminhoCompilado = NULL;
+    const char *caminhoLote = NULL;
+    int modoLote = 0;
+    const char *caminhoServidor = NULL;
+    int modoResolver = 0;
+    long investigacoesMotores = 0; // > 0 no modo --motores
+    long numThreads = sysconf(_SC_NPROCESSORS_ONLN);
+    for (int i = 1; i < argc; i++)
     {
-    case 'e':
-        if (salaAtual->esquerda != NULL)
+        if (strcmp(argv[i], "--mapa") == 0 && i + 1 < argc)
         {
-            explorarSalas(salaAtual->esquerda, pistasRaiz);
+            caminhoMapa = argv[++i];
         }
-        else
+        else if (strcmp(argv[i], "--compilar-mapa") == 0 && i + 1 < argc)
+        {
+            caminhoCompilado = argv[++i];
+        }
+        else if (strcmp(argv[i], "--ordem") == 0 && i + 1 < argc && ordemPorNome(argv[i + 1]) >= 0)
+        {
+            tipoOrdem = ordemPorNome(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--verbosidade") == 0 && i + 1 < argc && verbosidadePorNome(argv[i + 1]) >= 0)
+        {
+            verbosidade = verbosidadePorNome(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--servidor") == 0 && i + 1 < argc)
+        {
+            caminhoServidor = argv[++i];
+        }
+        else if (strcmp(argv[i], "--resolver") == 0)
+        {
+            modoResolver = 1;
+        }
+        else if (strcmp(argv[i], "--motores") == 0)
+        {
+            investigacoesMotores = 10000;
+            if (i + 1 < argc && strncmp(argv[i + 1], "--", 2) != 0 && atol(argv[i + 1]) > 0)
+            {
+                investigacoesMotores = atol(argv[++i]);
+            }
+        }
+        else if (strcmp(argv[i], "--sessao") == 0 && i + 1 < argc)
+        {
+            caminhoSessao = argv[++i];
+        }
+        else if (strcmp(argv[i], "--estatisticas") == 0 && i + 1 < argc)
+        {
+            caminhoEstatisticas = argv[++i];
+        }
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc && atol(argv[i + 1]) > 0)
         {
-            printf("\n🚫 Caminho Bloqueado! Tente outra direção.\n");
-            explorarSalas(salaAtual, pistasRaiz);
+            numThreads = atol(argv[++i]);
         }
-        break;
-    case 'd':
-        if (salaAtual->direita != NULL)
+        else if (strcmp(argv[i], "--lote") == 0)
         {
-            explorarSalas(salaAtual->direita, pistasRaiz);
+            modoLote = 1;
+            if (i + 1 < argc && strncmp(argv[i + 1], "--", 2) != 0)
+            {
+                caminhoLote = argv[++i];
+            }
         }
         else
         {
-            printf("\n🚫 Caminho Bloqueado! Tente outra direção.\n");
-            explorarSalas(salaAtual, pistasRaiz);
+            fprintf(stderr, "Uso: %s [--mapa arquivo] [--compilar-mapa saida] [--ordem largura|profundidade|veb] [--verbosidade silenciosa|resumo|completa] [--sessao snapshot] [--estatisticas arquivo] [--lote [arquivo] | --servidor socket [--threads n] | --resolver [--threads n] | --motores [investigacoes] [--threads n]]\n", argv[0]);
+            return EXIT_FAILURE;
         }
-        break;
-    case 'a':
-        analisarEvidencias(); // Opção de análise durante o jogo
-        explorarSalas(salaAtual, pistasRaiz);
-        break;
-    case 's':
-        printf("\n👋 Saindo da exploração da mansão.\n");
-        break;
-    default:
-        printf("\n⚠️  Opção inválida. Por favor, escolha: 'e', 'd', 'a', ou 's'.\n");
-        explorarSalas(salaAtual, pistasRaiz);
-        break;
     }
-}
-
-// --- 5. Função Principal (main) ---
 
-int main()
-{
-    Pista *pistasRaiz = NULL;
+    // O jogo interativo mostra tudo por padrão; o lote, o servidor, o resolvedor e os motores, só o essencial
+    if (verbosidade < 0)
+    {
+        verbosidade = modoLote || caminhoServidor != NULL || modoResolver || investigacoesMotores > 0 ? VERBOSIDADE_RESUMO : VERBOSIDADE_COMPLETA;
+    }
+    if (numThreads < 1)
+    {
+        numThreads = 1;
+    }
+    if (caminhoEstatisticas != NULL && !ESTATISTICAS_ATIVAS)
+    {
+        fprintf(stderr, "Aviso: --estatisticas ignorado (compile com -DDQ_ESTATISTICAS para coletar).\n");
+    }
+    // O renderizador da saída padrão (jogo interativo, lote e compilação de mapas)
+    Renderizador saidaPadrao;
+    iniciarSaida(&saidaPadrao, STDOUT_FILENO, verbosidade, TAMANHO_BUFFER_SAIDA);
 
-    printf("=============================================\n");
-    printf(" 👑 Detective Quest - Nível Mestre \n");
-    printf("  Hash Table (Suspeitos & Dedução)\n");
-    printf("=============================================\n");
+    // O dicionário do mapa: Pool de Strings e Registro de Suspeitos (as evidências ficam na sessão)
+    Dicionario dicionario;
+    iniciarDicionario(&dicionario);
 
-    // Inicializa a Tabela Hash
-    inicializarHash();
+    // A mansão vem de um arquivo (texto ou compilado) ou do mapa padrão montado com criarSala
+    Mansao mansao;
+    if (caminhoMapa != NULL)
+    {
+        if (!carregarMapa(caminhoMapa, &dicionario, &mansao))
+        {
+            liberarDicionario(&dicionario);
+            liberarSaida(&saidaPadrao);
+            return EXIT_FAILURE;
+        }
+    }
+    else
+    {
+        Arena arenaSalas;
+        iniciarArena(&arenaSalas);
+        Sala *hallEntrada = montarMansao(&dicionario, &arenaSalas);
+        compilarMansao(hallEntrada, &dicionario, &mansao);
+        liberarArvoreSalas(&arenaSalas);
+    }
+    if (tipoOrdem >= 0)
+    {
+        reordenarMansao(&mansao, tipoOrdem);
+    }
+    registrarSuspeitosDoMapa(&mansao);
 
-    //  Montagem da Árvore Binária (Mapa) com Pistas e Suspeitos
-    // Argumentos de criarSala: (nome, pista_encontrada, suspeito_associado)
+    int status = EXIT_SUCCESS;
+    Estatisticas estatisticasDaSessao; // Da única sessão do jogo interativo ou do lote
+    memset(&estatisticasDaSessao, 0, sizeof(estatisticasDaSessao));
+    int comSessao = 0;
+    if (caminhoCompilado != NULL)
+    {
+        status = salvarMapaCompilado(&mansao, caminhoCompilado) ? EXIT_SUCCESS : EXIT_FAILURE;
+        if (status == EXIT_SUCCESS && mostrar(&saidaPadrao, VERBOSIDADE_RESUMO))
+        {
+            escrever(&saidaPadrao, "Mapa compilado em '%s': %u salas, %d textos.\n", caminhoCompilado, mansao.numSalas, dicionario.pool.quantidade);
+        }
+    }
+    else if (modoLote)
+    {
+        status = executarLote(&mansao, caminhoLote, &saidaPadrao, &estatisticasDaSessao);
+        comSessao = 1;
+    }
+    else if (modoResolver)
+    {
+        status = executarResolvedor(&mansao, (int)numThreads, &saidaPadrao);
+    }
+    else if (investigacoesMotores > 0)
+    {
+        status = executarMotores(&mansao, (int)numThreads, investigacoesMotores, &saidaPadrao);
+    }
+    else if (caminhoServidor != NULL)
+    {
+        status = executarServidor(&mansao, caminhoServidor, (int)numThreads, verbosidade);
+    }
+    else
+    {
+        Sessao sessao;
+        iniciarSessao(&sessao, &mansao);
 
-    // Raiz (Nível 0)
-    Sala *hallEntrada = criarSala("Hall de Entrada", "", "");
+        // Um snapshot que existe mas não carrega (corrompido, de outro mapa ou versão) não é
+        // sobrescrito nem apagado: o jogo nem começa, e o progresso salvo continua no arquivo
+        int retomada = caminhoSessao != NULL && access(caminhoSessao, F_OK) == 0;
+        if (retomada && !carregarSessao(&sessao, caminhoSessao))
+        {
+            fprintf(stderr, "%s: o arquivo não foi alterado; remova-o ou use outro caminho em --sessao.\n", caminhoSessao);
+            status = EXIT_FAILURE;
+        }
+        else
+        {
+            if (mostrar(&saidaPadrao, VERBOSIDADE_COMPLETA))
+            {
+                escreverTexto(&saidaPadrao, "=============================================\n"
+                              " 👑 Detective Quest - Nível Mestre \n"
+                              "  Hash Table (Suspeitos & Dedução)\n"
+                              "=============================================\n");
 
-    // Nível 1
-    Sala *biblioteca = criarSala("Biblioteca", "Lupa quebrada", "Mordomo");
-    Sala *cozinha = criarSala("Cozinha", "Faca de prata", "Jardineiro");
-    hallEntrada->esquerda = biblioteca;
-    hallEntrada->direita = cozinha;
+                // Início do Jogo
+                escreverTexto(&saidaPadrao, "\n Iniciando a investigação! Colete as pistas para ligá-las aos Suspeitos.\n"
+                              " Suspeitos:");
+                for (int i = 0; i < dicionario.suspeitos.quantidade; i++)
+                {
+                    escrever(&saidaPadrao, "%s %s", i ? "," : "", nomeDoSuspeito(&dicionario, i));
+                }
+                escreverTexto(&saidaPadrao, "!\n");
+            }
 
-    // Nível 2 - Ramo Esquerdo (Biblioteca)
-    Sala *estufa = criarSala("Estufa", "Pegadas de barro", "Jardineiro"); // Nó Folha
-    Sala *escritorio = criarSala("Escritório", "Carta rasgada", "Dama");
-    biblioteca->esquerda = estufa;
-    biblioteca->direita = escritorio;
+            LeitorComandos *entrada = (LeitorComandos *)malloc(sizeof(LeitorComandos));
+            if (entrada == NULL)
+            {
+                perror("Erro ao alocar memória para o leitor");
+                exit(EXIT_FAILURE);
+            }
+            iniciarLeitor(entrada, STDIN_FILENO, &saidaPadrao);
 
-    // Nível 2 - Ramo Direito (Cozinha)
-    cozinha->esquerda = criarSala("Quarto Principal", "Luva de seda", "Dama"); // Nó Folha
-    // cozinha->direita fica NULL
+            // Investigação retomada de um snapshot
+            if (retomada && mostrar(&saidaPadrao, VERBOSIDADE_COMPLETA))
+            {
+                escrever(&saidaPadrao, "\n📂 Investigação retomada de '%s' (%zu pista(s) já coletada(s)).\n", caminhoSessao, sessao.numColetadas);
+            }
+            explorarSalas(&sessao, &mansao, entrada, &saidaPadrao);
+            free(entrada);
 
-    // Nível 3 - Ramo Esquerdo (Escritório)
-    escritorio->esquerda = criarSala("Sala de Jantar", "Poeira de veneno", "Mordomo");
-    escritorio->direita = criarSala("Porão", "Chave enferrujada", "Mordomo"); // Nó Folha
-    // Sala de Jantar é Nó Folha
+            // Quem sai antes de um nó folha pode continuar depois; ao concluir, o snapshot é apagado.
+            // O snapshot só guarda a sessão, então depois de uma edição ele não valeria no mapa
+            // original: o arquivo fica como estava.
+            if (caminhoSessao != NULL)
+            {
+                if (mansao.editada)
+                {
+                    fprintf(stderr, "Aviso: a mansão foi editada, então a investigação não foi salva em '%s' (o arquivo não foi alterado).\n", caminhoSessao);
+                }
+                else if (ehFolha(&mansao, sessao.salaAtual))
+                {
+                    unlink(caminhoSessao);
+                }
+                else if (salvarSessao(&sessao, caminhoSessao) && mostrar(&saidaPadrao, VERBOSIDADE_COMPLETA))
+                {
+                    escrever(&saidaPadrao, "💾 Investigação salva em '%s'.\n", caminhoSessao);
+                }
+            }
 
-    // ----------------------------------------------------
+            // Tentativa final de dedução (caso o jogador saia antes de um nó folha)
+            if (sessao.pistasRaiz != NULL)
+            {
+                if (mostrar(&saidaPadrao, VERBOSIDADE_COMPLETA))
+                {
+                    escreverTexto(&saidaPadrao, "📊 Análise final ao sair do jogo:\n"
+                                  "📜 Diário de pistas (ordem alfabética):\n");
+                    listarPistasEmOrdem(&saidaPadrao, &dicionario, sessao.pistasRaiz);
+                }
+                mostrarDeducao(&sessao, &saidaPadrao);
+            }
+        }
+        estatisticasDaSessao = sessao.estatisticas;
+        comSessao = 1;
+        liberarSessao(&sessao);
+    }
 
-    // Início do Jogo
-    printf("\n Iniciando a investigação! Colete as pistas para ligá-las aos Suspeitos.\n");
-    printf(" Suspeitos Fixos: Mordomo, Jardineiro, Dama!\n");
-    explorarSalas(hallEntrada, &pistasRaiz);
+    // Limpeza de memória (o pool pode apontar para o mapa mapeado, então sai antes)
+    Estatisticas estatisticasDaMansao = dicionario.estatisticas;
+    liberarDicionario(&dicionario);
+    liberarMansao(&mansao);
 
-    // Tentativa final de dedução (caso o jogador saia antes de um nó folha)
-    if (pistasRaiz != NULL)
+    if (!modoLote && !modoResolver && investigacoesMotores == 0 && caminhoCompilado == NULL && caminhoServidor == NULL && mostrar(&saidaPadrao, VERBOSIDADE_COMPLETA))
     {
-        printf("📊 Análise final ao sair do jogo:\n");
-        analisarEvidencias();
+        escreverTexto(&saidaPadrao, "\nPrograma finalizado e memória liberada.\n");
     }
+    liberarSaida(&saidaPadrao);
 
-    // Limpeza de memória
-    liberarArvoreSalas(hallEntrada);
-    liberarPistas(pistasRaiz);
-    liberarHash();
-
-    printf("\nPrograma finalizado e memória liberada.\n");
+    // Com as estatísticas compiladas, o retrato final sai em JSON (no arquivo pedido ou em stderr).
+    // Os modos com várias sessões (servidor, resolvedor, motores) só gravam as da mansão.
+    if (ESTATISTICAS_ATIVAS &&
+        !gravarEstatisticas(caminhoEstatisticas, &estatisticasDaMansao, comSessao ? &estatisticasDaSessao : NULL))
+    {
+        status = EXIT_FAILURE;
+    }
 
-    return 0;
-}
\ No newline at end of file
+    return status;
+}
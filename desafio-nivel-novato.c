@@ -57,6 +57,8 @@ void liberarArvore(Sala *raiz)
 
 /**
  * @brief Função principal para navegação interativa na mansão.
+ * É um laço (não recursivo): cada comando só troca a sala atual, então a pilha
+ * não cresce com a duração da sessão.
  * @param salaAtual O ponteiro para a sala onde o jogador está atualmente.
  */
 void explorarSalas(Sala *salaAtual)
@@ -70,85 +72,82 @@ void explorarSalas(Sala *salaAtual)
         return;
     }
 
-    printf("\n🚪 Você entrou na sala: %s\n", salaAtual->nome);
-
-    // Verifica se é um nó folha
-    if (salaAtual->esquerda == NULL && salaAtual->direita == NULL)
-    {
-        printf("🎉 Você chegou ao fim deste caminho da mansão !\n");
-        return;
-    }
-
-    printf(" Escolha o próximo caminho:\n\n");
-
-    // Exibe as opções de forma dinâmica
-    if (salaAtual->esquerda != NULL)
-    {
-        printf("  [e] -> Esquerda (%s)\n", salaAtual->esquerda->nome);
-    }
-    else
+    while (1)
     {
-        printf("  [e] -> Esquerda (Caminho Bloqueado 🚧)\n");
-    }
-
-    if (salaAtual->direita != NULL)
-    {
-        printf("  [d] -> Direita (%s)\n", salaAtual->direita->nome);
-    }
-    else
-    {
-        printf("  [d] -> Direita (Caminho Bloqueado 🚧)\n");
-    }
-
-    printf("  [s] -> Sair da Exploração\n");
-    printf("\n Sua escolha: ");
+        printf("\n🚪 Você entrou na sala: %s\n", salaAtual->nome);
 
-    // Leitura da escolha do usuário e limpeza do buffer de entrada
-    if (scanf(" %c", &escolha) != 1)
-    {
-        int c;
-        while ((c = getchar()) != '\n' && c != EOF)
-            ;
-        printf("\n⚠️ Entrada inválida. Tente novamente.\n");
-        explorarSalas(salaAtual); // Tenta novamente
-        return;
-    }
+        // Verifica se é um nó folha
+        if (salaAtual->esquerda == NULL && salaAtual->direita == NULL)
+        {
+            printf("🎉 Você chegou ao fim deste caminho da mansão !\n");
+            return;
+        }
 
-    // Converte para minúsculo
-    escolha = tolower(escolha);
+        printf(" Escolha o próximo caminho:\n\n");
 
-    // Processa a escolha
-    switch (escolha)
-    {
-    case 'e':
+        // Exibe as opções de forma dinâmica
         if (salaAtual->esquerda != NULL)
         {
-            explorarSalas(salaAtual->esquerda);
+            printf("  [e] -> Esquerda (%s)\n", salaAtual->esquerda->nome);
         }
         else
         {
-            printf("\n🚫 Caminho para a Esquerda Bloqueado! Escolha outra direção.\n");
-            explorarSalas(salaAtual); // Volta à sala atual
+            printf("  [e] -> Esquerda (Caminho Bloqueado 🚧)\n");
         }
-        break;
-    case 'd':
+
         if (salaAtual->direita != NULL)
         {
-            explorarSalas(salaAtual->direita);
+            printf("  [d] -> Direita (%s)\n", salaAtual->direita->nome);
         }
         else
         {
-            printf("\n🚫 Caminho para a Direita Bloqueado! Escolha outra direção.\n");
-            explorarSalas(salaAtual); // Volta à sala atual
+            printf("  [d] -> Direita (Caminho Bloqueado 🚧)\n");
+        }
+
+        printf("  [s] -> Sair da Exploração\n");
+        printf("\n Sua escolha: ");
+
+        // Leitura da escolha do usuário e limpeza do buffer de entrada
+        if (scanf(" %c", &escolha) != 1)
+        {
+            // Fim da entrada: não há como tentar de novo
+            printf("\n⚠️ Entrada encerrada. Saindo da exploração.\n");
+            return;
+        }
+
+        // Converte para minúsculo
+        escolha = tolower(escolha);
+
+        // Processa a escolha: apenas atualiza a sala atual e volta ao início do laço
+        switch (escolha)
+        {
+        case 'e':
+            if (salaAtual->esquerda != NULL)
+            {
+                salaAtual = salaAtual->esquerda;
+            }
+            else
+            {
+                printf("\n🚫 Caminho para a Esquerda Bloqueado! Escolha outra direção.\n");
+            }
+            break;
+        case 'd':
+            if (salaAtual->direita != NULL)
+            {
+                salaAtual = salaAtual->direita;
+            }
+            else
+            {
+                printf("\n🚫 Caminho para a Direita Bloqueado! Escolha outra direção.\n");
+            }
+            break;
+        case 's':
+            printf("\n👋 Saindo da exploração da mansão. Obrigado por jogar!\n");
+            return;
+        default:
+            printf("\n⚠️  Opção inválida. Por favor, escolha:'e', 'd', ou 's'.\n");
+            break;
         }
-        break;
-    case 's':
-        printf("\n👋 Saindo da exploração da mansão. Obrigado por jogar!\n");
-        break;
-    default:
-        printf("\n⚠️  Opção inválida. Por favor, escolha:'e', 'd', ou 's'.\n");
-        explorarSalas(salaAtual); // Volta à sala atual
-        break;
     }
 }
 
@@ -0,0 +1,155 @@
+/**
+ * @file apoio.h
+ * @brief Apoio dos testes do Nível Mestre: inclui o programa inteiro (com o main
+ * renomeado, para cada teste ter o seu) e reúne as conferências usadas por mais de um teste.
+ * Os testes comparam as estruturas do jogo com uma versão ingênua (força bruta) em
+ * entradas aleatórias de semente fixa, e o make check os roda com AddressSanitizer e UBSan.
+ */
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include <stdarg.h>
+
+#define main mainDoJogo
+#include "../desafio-nivel-mestre.c"
+#undef main
+
+// Semente fixa: uma falha se repete igual na próxima execução
+#define SEMENTE_TESTES 88172645463325252ULL
+
+/**
+ * @brief Mostra a falha (com o contexto no formato do printf) e encerra o teste.
+ */
+void falhar(const char *formato, ...)
+{
+    va_list argumentos;
+    va_start(argumentos, formato);
+    fprintf(stderr, "FALHA: ");
+    vfprintf(stderr, formato, argumentos);
+    fprintf(stderr, "\n");
+    va_end(argumentos);
+    exit(EXIT_FAILURE);
+}
+
+/**
+ * @brief Número aleatório em [0, limite) (xorshift64, determinístico para a semente).
+ */
+unsigned long long sortear(unsigned long long *estado, unsigned long long limite)
+{
+    *estado ^= *estado << 13;
+    *estado ^= *estado >> 7;
+    *estado ^= *estado << 17;
+    return *estado % limite;
+}
+
+/**
+ * @brief Confere as invariantes da AVL de pistas: ordem estrita dos textos, altura e
+ * tamanho guardados iguais aos recalculados e fator de balanceamento entre -1 e 1.
+ * @param altura Recebe a altura da subárvore (vazia = 0).
+ * @param tamanho Recebe quantas pistas a subárvore tem.
+ * @return 1 se a subárvore é uma AVL válida, 0 caso contrário.
+ */
+int conferirAvl(const Dicionario *dicionario, const Pista *no, int *altura, int *tamanho)
+{
+    if (no == NULL)
+    {
+        *altura = 0;
+        *tamanho = 0;
+        return 1;
+    }
+    int alturaEsquerda, tamanhoEsquerda, alturaDireita, tamanhoDireita;
+    if (!conferirAvl(dicionario, no->esquerda, &alturaEsquerda, &tamanhoEsquerda) ||
+        !conferirAvl(dicionario, no->direita, &alturaDireita, &tamanhoDireita))
+    {
+        return 0;
+    }
+    *altura = (alturaEsquerda > alturaDireita ? alturaEsquerda : alturaDireita) + 1;
+    *tamanho = tamanhoEsquerda + tamanhoDireita + 1;
+
+    const char *texto = textoDe(dicionario, no->descricao);
+    if (no->esquerda != NULL && strcmp(textoDe(dicionario, no->esquerda->descricao), texto) >= 0)
+    {
+        return 0;
+    }
+    if (no->direita != NULL && strcmp(textoDe(dicionario, no->direita->descricao), texto) <= 0)
+    {
+        return 0;
+    }
+    return no->altura == *altura && no->tamanho == *tamanho && abs(alturaEsquerda - alturaDireita) <= 1;
+}
+
+/**
+ * @brief Retorna 1 se uma AVL com 'tamanho' nós pode ter essa altura: a menor AVL de
+ * altura h tem N(h) = N(h-1) + N(h-2) + 1 nós (a altura fica abaixo de ~1,44 log2 n).
+ */
+int alturaDeAvlPossivel(int altura, int tamanho)
+{
+    long minimo = 0, anterior = 0;
+    for (int h = 1; h <= altura; h++)
+    {
+        long proximo = h == 1 ? 1 : minimo + anterior + 1;
+        anterior = minimo;
+        minimo = proximo;
+    }
+    return tamanho >= minimo;
+}
+
+/**
+ * @brief Ordena ids de textos pela ordem de strcmp (a mesma da AVL).
+ */
+int compararTextosDoDicionario(const void *a, const void *b, void *dicionario)
+{
+    return strcmp(textoDe((const Dicionario *)dicionario, *(const int *)a),
+                  textoDe((const Dicionario *)dicionario, *(const int *)b));
+}
+
+/**
+ * @brief Copia os ids da AVL em ordem (esquerda, raiz, direita) para 'ids'.
+ * @return Quantos ids foram copiados.
+ */
+int pistasEmOrdem(const Pista *no, int *ids, int usados)
+{
+    if (no == NULL)
+    {
+        return usados;
+    }
+    usados = pistasEmOrdem(no->esquerda, ids, usados);
+    ids[usados++] = no->descricao;
+    return pistasEmOrdem(no->direita, ids, usados);
+}
+
+/**
+ * @brief Aloca uma mansão de 'numSalas' salas em forma de árvore completa (os filhos de i
+ * são 2i+1 e 2i+2), sem nomes, pistas ou suspeitos: cada teste preenche os textos.
+ */
+void montarMansaoDeTeste(Mansao *mansao, Dicionario *dicionario, uint32_t numSalas)
+{
+    alocarMansao(mansao, dicionario, numSalas);
+    for (uint32_t i = 0; i < numSalas; i++)
+    {
+        SalaCompilada *sala = &mansao->salasProprias[i];
+        sala->nome = STRING_VAZIA;
+        sala->pista = STRING_VAZIA;
+        sala->suspeito = STRING_VAZIA;
+        sala->implicacoes = LISTA_VAZIA;
+        sala->esquerda = 2 * i + 1 < numSalas ? 2 * i + 1 : SEM_SALA;
+        sala->direita = 2 * i + 2 < numSalas ? 2 * i + 2 : SEM_SALA;
+    }
+}
+
+/**
+ * @brief Lê (e apaga) o que o renderizador escreveu no arquivo temporário.
+ */
+const char *lerSaida(Renderizador *saida, FILE *arquivo, char *buffer, size_t capacidade)
+{
+    descarregarSaida(saida);
+    int descritor = fileno(arquivo);
+    off_t tamanho = lseek(descritor, 0, SEEK_CUR);
+    if (tamanho < 0 || (size_t)tamanho >= capacidade || pread(descritor, buffer, (size_t)tamanho, 0) != tamanho ||
+        ftruncate(descritor, 0) != 0 || lseek(descritor, 0, SEEK_SET) != 0)
+    {
+        falhar("não foi possível ler a saída do renderizador");
+    }
+    buffer[tamanho] = '\0';
+    return buffer;
+}
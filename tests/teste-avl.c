@@ -0,0 +1,125 @@
+/**
+ * @file teste-avl.c
+ * @brief Teste da BST de pistas balanceada (AVL): insere pistas em ordem aleatória,
+ * crescente, decrescente, com prefixos longos e com muitas repetidas, e confere as
+ * invariantes da AVL, o retorno de cada inserção e a ordem alfabética do diário.
+ */
+#include "apoio.h"
+
+#define RODADAS_AVL 300
+#define FORMAS_AVL 5
+
+/**
+ * @brief Monta o texto da i-ésima pista de uma rodada, conforme a forma da entrada.
+ */
+void textoDaForma(int forma, long i, long n, unsigned long long *estado, char *texto, size_t tamanho)
+{
+    switch (forma)
+    {
+    case 0: // Aleatória, com repetidas
+        snprintf(texto, tamanho, "Pista %llu", sortear(estado, (unsigned long long)n));
+        break;
+    case 1: // Crescente (o pior caso de uma BST sem balanceamento)
+        snprintf(texto, tamanho, "%08ld", i);
+        break;
+    case 2: // Decrescente
+        snprintf(texto, tamanho, "%08ld", n - i);
+        break;
+    case 3: // Prefixo longo em comum: a comparação só decide no fim do texto
+        snprintf(texto, tamanho, "Carta rasgada com um texto longo e repetido %llu", sortear(estado, (unsigned long long)n * 2));
+        break;
+    default: // Alfabeto pequeno: quase tudo é repetido
+        snprintf(texto, tamanho, "%c%c", 'a' + (int)sortear(estado, 3), 'a' + (int)sortear(estado, 3));
+        break;
+    }
+}
+
+int main()
+{
+    unsigned long long estado = SEMENTE_TESTES;
+    char texto[128];
+
+    for (int rodada = 0; rodada < RODADAS_AVL; rodada++)
+    {
+        int forma = rodada % FORMAS_AVL;
+        long n = 1 + (long)sortear(&estado, rodada < RODADAS_AVL - 20 ? 300 : 50000);
+        Dicionario dicionario;
+        iniciarDicionario(&dicionario);
+        Arena arena;
+        iniciarArena(&arena);
+
+        // A arena é reiniciada e reaproveitada, como na sessão ao recomeçar a investigação
+        for (int uso = 0; uso < 2; uso++)
+        {
+            Pista *raiz = NULL;
+            char *inserida = (char *)calloc((size_t)(2 * n + 16), 1);
+            int *ids = (int *)malloc(sizeof(int) * (size_t)n);
+            int distintas = 0;
+            if (inserida == NULL || ids == NULL)
+            {
+                perror("Erro ao alocar memória para o teste");
+                exit(EXIT_FAILURE);
+            }
+
+            for (long i = 0; i < n; i++)
+            {
+                textoDaForma(forma, i, n, &estado, texto, sizeof(texto));
+                int id = internar(&dicionario, texto);
+                if (id >= 2 * n + 16)
+                {
+                    falhar("id %d fora do esperado na rodada %d", id, rodada);
+                }
+                int esperado = !inserida[id];
+                if (inserirPistaBalanceada(&dicionario, &arena, &raiz, id, NULL) != esperado)
+                {
+                    falhar("rodada %d (forma %d): inserir '%s' devolveu %d", rodada, forma, texto, !esperado);
+                }
+                if (esperado)
+                {
+                    inserida[id] = 1;
+                    ids[distintas++] = id;
+                }
+
+                int altura, tamanho;
+                if ((n <= 300 || i == n - 1) && !conferirAvl(&dicionario, raiz, &altura, &tamanho))
+                {
+                    falhar("rodada %d (forma %d): AVL inválida depois de %ld inserções", rodada, forma, i + 1);
+                }
+            }
+
+            int altura, tamanho;
+            conferirAvl(&dicionario, raiz, &altura, &tamanho);
+            if (tamanho != distintas || !alturaDeAvlPossivel(altura, tamanho))
+            {
+                falhar("rodada %d (forma %d): %d pistas (esperado %d), altura %d", rodada, forma, tamanho, distintas, altura);
+            }
+
+            // O diário em ordem alfabética é a lista das distintas ordenada por strcmp
+            qsort_r(ids, (size_t)distintas, sizeof(int), compararTextosDoDicionario, &dicionario);
+            IteradorPistas iterador;
+            iniciarIteradorNaPosicao(&iterador, raiz, 0);
+            const Pista *pista;
+            int posicao = 0;
+            while ((pista = proximaPista(&iterador)) != NULL)
+            {
+                if (posicao >= distintas || pista->descricao != ids[posicao])
+                {
+                    falhar("rodada %d (forma %d): diário fora de ordem na posição %d", rodada, forma, posicao);
+                }
+                posicao++;
+            }
+            if (posicao != distintas)
+            {
+                falhar("rodada %d (forma %d): diário com %d pistas, esperado %d", rodada, forma, posicao, distintas);
+            }
+
+            free(ids);
+            free(inserida);
+            reiniciarArena(&arena);
+        }
+        liberarArena(&arena);
+        liberarDicionario(&dicionario);
+    }
+    printf("teste-avl: %d rodadas ok\n", RODADAS_AVL);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,168 @@
+/**
+ * @file teste-carga-lote.c
+ * @brief Teste da carga em lote e do snapshot: coletar as salas de uma em uma
+ * (coletarPistaDe), de uma vez (carregarColetasEmLote) e restaurar o snapshot gravado
+ * (restaurarSessao) precisam dar sessões iguais, e lotes ou snapshots inválidos precisam
+ * ser recusados deixando a sessão vazia.
+ */
+#include "apoio.h"
+
+#define RODADAS_LOTE 400
+
+// Prefixos em comum: a ordenação do lote desempata além dos 16 bytes do prefixo empacotado
+const char *prefixosDeTeste[] = {"", "a", "Pista", "Carta rasgada com ", "Carta rasgada com um texto longo e ", "é", "Zz"};
+#define NUM_PREFIXOS_TESTE (int)(sizeof(prefixosDeTeste) / sizeof(prefixosDeTeste[0]))
+
+/**
+ * @brief Retorna 1 se a sessão está vazia, na raiz (como fica depois de uma carga recusada).
+ */
+int sessaoVazia(const Sessao *sessao)
+{
+    return sessao->numColetadas == 0 && sessao->evidencias.quantidade == 0 && sessao->pistasRaiz == NULL &&
+           sessao->salaAtual == sessao->mansao->raiz;
+}
+
+int main()
+{
+    unsigned long long estado = SEMENTE_TESTES;
+    char texto[128];
+    long recusados = 0;
+
+    for (int rodada = 0; rodada < RODADAS_LOTE; rodada++)
+    {
+        uint32_t numSalas = 1 + (uint32_t)sortear(&estado, rodada < RODADAS_LOTE - 40 ? 200 : 20000);
+        unsigned long long variedade = 1 + sortear(&estado, numSalas + 1);
+        unsigned long long numSuspeitos = 1 + sortear(&estado, 40);
+        Dicionario dicionario;
+        iniciarDicionario(&dicionario);
+        Mansao mansao;
+        montarMansaoDeTeste(&mansao, &dicionario, numSalas);
+        for (uint32_t i = 0; i < numSalas; i++)
+        {
+            SalaCompilada *sala = &mansao.salasProprias[i];
+            if (sortear(&estado, 10) != 0)
+            {
+                // Salas diferentes podem ter a mesma pista (a segunda coleta é repetida)
+                unsigned long long chave = sortear(&estado, variedade);
+                snprintf(texto, sizeof(texto), "%s%llu", prefixosDeTeste[chave % NUM_PREFIXOS_TESTE], chave * 7919 % 100003);
+                sala->pista = (uint32_t)internar(&dicionario, texto);
+            }
+            if (sortear(&estado, 7) != 0)
+            {
+                snprintf(texto, sizeof(texto), "S%llu", sortear(&estado, numSuspeitos));
+                sala->suspeito = (uint32_t)internar(&dicionario, texto);
+            }
+        }
+        congelarDicionario(&mansao);
+
+        // Um subconjunto das salas com pista, em ordem aleatória
+        uint32_t *ordem = (uint32_t *)malloc(sizeof(uint32_t) * numSalas);
+        if (ordem == NULL)
+        {
+            perror("Erro ao alocar memória para o teste");
+            exit(EXIT_FAILURE);
+        }
+        uint32_t quantidade = 0;
+        for (uint32_t i = 0; i < numSalas; i++)
+        {
+            if (mansao.salas[i].pista != STRING_VAZIA)
+            {
+                ordem[quantidade++] = i;
+            }
+        }
+        for (uint32_t i = quantidade; i > 1; i--)
+        {
+            uint32_t j = (uint32_t)sortear(&estado, i);
+            uint32_t troca = ordem[i - 1];
+            ordem[i - 1] = ordem[j];
+            ordem[j] = troca;
+        }
+        quantidade = (uint32_t)sortear(&estado, (unsigned long long)quantidade + 1);
+
+        Sessao umaPorVez, emLote, restaurada;
+        iniciarSessao(&umaPorVez, &mansao);
+        iniciarSessao(&emLote, &mansao);
+        iniciarSessao(&restaurada, &mansao);
+        for (uint32_t i = 0; i < quantidade; i++)
+        {
+            coletarPistaDe(&umaPorVez, ordem[i]);
+        }
+
+        // Lote: a mesma sessão, com a AVL montada já balanceada
+        int altura, tamanho;
+        if (!carregarColetasEmLote(&emLote, ordem, quantidade) || !sessoesEquivalentes(&umaPorVez, &emLote) ||
+            !conferirAvl(&dicionario, emLote.pistasRaiz, &altura, &tamanho) ||
+            tamanho != emLote.evidencias.quantidade || !alturaDeAvlPossivel(altura, tamanho))
+        {
+            falhar("rodada %d: lote de %u salas diferente da coleta uma por vez", rodada, quantidade);
+        }
+
+        // A sessão reiniciada aceita outro lote
+        reiniciarSessao(&emLote);
+        if (!carregarColetasEmLote(&emLote, ordem, quantidade) || !sessoesEquivalentes(&umaPorVez, &emLote))
+        {
+            falhar("rodada %d: lote depois de reiniciar a sessão", rodada);
+        }
+
+        // Lotes inválidos (sala repetida ou inexistente) são recusados por inteiro
+        if (quantidade >= 2)
+        {
+            uint32_t original = ordem[1];
+            ordem[1] = ordem[0];
+            reiniciarSessao(&emLote);
+            if (carregarColetasEmLote(&emLote, ordem, quantidade) || !sessaoVazia(&emLote))
+            {
+                falhar("rodada %d: lote com sala repetida foi aceito", rodada);
+            }
+            ordem[1] = numSalas;
+            if (carregarColetasEmLote(&emLote, ordem, quantidade) || !sessaoVazia(&emLote))
+            {
+                falhar("rodada %d: lote com sala inexistente foi aceito", rodada);
+            }
+            ordem[1] = original;
+        }
+
+        // Snapshot: gravar e restaurar dá a mesma sessão, na mesma sala
+        umaPorVez.salaAtual = quantidade ? ordem[quantidade - 1] : mansao.raiz;
+        size_t tamanhoDados = tamanhoSnapshot(&umaPorVez);
+        unsigned char *dados = (unsigned char *)malloc(tamanhoDados);
+        if (dados == NULL)
+        {
+            perror("Erro ao alocar memória para o teste");
+            exit(EXIT_FAILURE);
+        }
+        serializarSessao(&umaPorVez, dados, tamanhoDados);
+        if (!restaurarSessao(&restaurada, dados, tamanhoDados) || !sessoesEquivalentes(&umaPorVez, &restaurada) ||
+            restaurada.salaAtual != umaPorVez.salaAtual)
+        {
+            falhar("rodada %d: snapshot de %u salas restaurado diferente", rodada, quantidade);
+        }
+
+        // Snapshot truncado: sempre recusado. Um bit trocado: recusado, ou aceito só se a
+        // troca cair numa sala com a mesma pista (a conferência é sobre os textos)
+        if (restaurarSessao(&restaurada, dados, tamanhoDados - 1) || !sessaoVazia(&restaurada))
+        {
+            falhar("rodada %d: snapshot truncado foi aceito", rodada);
+        }
+        size_t posicao = (size_t)sortear(&estado, tamanhoDados);
+        dados[posicao] ^= (unsigned char)(1u << sortear(&estado, 8));
+        if (!restaurarSessao(&restaurada, dados, tamanhoDados))
+        {
+            if (!sessaoVazia(&restaurada))
+            {
+                falhar("rodada %d: snapshot recusado deixou a sessão com estado", rodada);
+            }
+            recusados++;
+        }
+
+        free(dados);
+        free(ordem);
+        liberarSessao(&umaPorVez);
+        liberarSessao(&emLote);
+        liberarSessao(&restaurada);
+        liberarDicionario(&dicionario);
+        liberarMansao(&mansao);
+    }
+    printf("teste-carga-lote: %d rodadas ok (%ld snapshots corrompidos recusados)\n", RODADAS_LOTE, recusados);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,523 @@
+/**
+ * @file teste-catalogo.c
+ * @brief Teste do índice invertido suspeito -> pistas: associações aleatórias (com pares
+ * repetidos e pistas em vários suspeitos) são comparadas com uma matriz de pesos, na fase
+ * em crescimento (listas em ordem de associação) e depois de congelado em CSR (listas
+ * ordenadas por pista, repetidos somados). O catálogo de um mapa (salas com listas de
+ * suspeitos com pesos) é conferido sala a sala, e o índice e o motor de dedução de uma
+ * sessão com as evidências coletadas. Um mapa texto fixo com pesos confere o que
+ * mostrarPistasDoSuspeito mostra e o mais provável pelos pesos, antes e depois de
+ * compilado, a leitura de um compilado da versão 2 e os campos de suspeitos inválidos.
+ */
+#include "apoio.h"
+
+#define RODADAS_CATALOGO 300
+#define MAXIMO_SUSPEITOS 40
+#define MAXIMO_PISTAS 64
+#define MAXIMO_TEXTOS 128 // Ids do pool no catálogo do mapa: pistas, suspeitos e o texto vazio
+#define MAXIMO_SALAS 400
+#define MAXIMO_POR_SALA 4 // Suspeitos na lista de uma sala
+
+// Mapa texto fixo: a Lupa implica dois suspeitos e a Chave três, com pesos
+#define MAPA_COM_PESOS                                                   \
+    "0 | Hall       | 1 | 2 |               |\n"                        \
+    "1 | Biblioteca | - | - | Lupa quebrada | Mordomo:3, Dama\n"         \
+    "2 | Cozinha    | 3 | - | Faca de prata | Jardineiro\n"              \
+    "3 | Porão      | - | - | Chave         | Dama:2, Jardineiro:5 , Mordomo\n"
+
+/**
+ * @brief Confere as listas do índice em crescimento com as associações feitas, na ordem.
+ */
+void conferirCrescendo(const IndiceSuspeitos *indice, const int *suspeitos, const int *pistas, const int *pesos,
+                       int associacoes, int numSuspeitos, int rodada)
+{
+    for (int s = 0; s < numSuspeitos; s++)
+    {
+        int quantidade;
+        const PistaPonderada *lista = pistasDoSuspeito(indice, s, &quantidade);
+        int posicao = 0, peso = 0;
+        for (int i = 0; i < associacoes; i++)
+        {
+            if (suspeitos[i] != s)
+            {
+                continue;
+            }
+            if (posicao >= quantidade || lista[posicao].pista != pistas[i] || lista[posicao].peso != pesos[i])
+            {
+                falhar("rodada %d: lista do suspeito %d em crescimento errada na posição %d", rodada, s, posicao);
+            }
+            posicao++;
+            peso += pesos[i];
+        }
+        if (posicao != quantidade || pesoDoSuspeito(indice, s) != peso)
+        {
+            falhar("rodada %d: suspeito %d com %d pista(s) e peso %d, esperado %d e %d", rodada, s, quantidade,
+                   pesoDoSuspeito(indice, s), posicao, peso);
+        }
+    }
+}
+
+/**
+ * @brief Confere o índice congelado com a matriz de pesos: cada lista em ordem crescente
+ * de pista, um par por pista, com a soma dos pesos.
+ */
+void conferirCongelado(const IndiceSuspeitos *indice, int matriz[][MAXIMO_TEXTOS], int numSuspeitos, int numPistas,
+                       int rodada)
+{
+    int total = 0;
+    for (int s = 0; s < numSuspeitos; s++)
+    {
+        int quantidade;
+        const PistaPonderada *lista = pistasDoSuspeito(indice, s, &quantidade);
+        int posicao = 0, peso = 0;
+        for (int p = 0; p < numPistas; p++)
+        {
+            if (matriz[s][p] == 0)
+            {
+                continue;
+            }
+            if (posicao >= quantidade || lista[posicao].pista != p || lista[posicao].peso != matriz[s][p])
+            {
+                falhar("rodada %d: lista congelada do suspeito %d errada na posição %d", rodada, s, posicao);
+            }
+            posicao++;
+            peso += matriz[s][p];
+        }
+        if (posicao != quantidade || pesoDoSuspeito(indice, s) != peso)
+        {
+            falhar("rodada %d: suspeito %d congelado com %d pista(s) e peso %d, esperado %d e %d", rodada, s,
+                   quantidade, pesoDoSuspeito(indice, s), posicao, peso);
+        }
+        total += quantidade;
+    }
+    if (indice->totalPistas != total)
+    {
+        falhar("rodada %d: %d pares no CSR, esperado %d", rodada, indice->totalPistas, total);
+    }
+}
+
+/**
+ * @brief Confere as probabilidades do motor da sessão com a regra de Bayes em double: cada
+ * associação (suspeito, peso) das evidências multiplica o suspeito por
+ * (peso + RUIDO_DEDUCAO) / RUIDO_DEDUCAO, a partir do prior uniforme.
+ */
+void conferirMotor(const MotorDeducao *motor, const int *suspeitos, const int *pesos, int associacoes, int rodada)
+{
+    double referencia[MAXIMO_TEXTOS];
+    double soma = 0.0;
+    if (motor->numSuspeitos > MAXIMO_TEXTOS)
+    {
+        falhar("rodada %d: %d suspeitos no motor", rodada, motor->numSuspeitos);
+    }
+    for (int s = 0; s < motor->numSuspeitos; s++)
+    {
+        referencia[s] = 1.0;
+    }
+    for (int i = 0; i < associacoes; i++)
+    {
+        if (suspeitos[i] >= motor->numSuspeitos)
+        {
+            falhar("rodada %d: suspeito %d implicado fora do motor", rodada, suspeitos[i]);
+        }
+        referencia[suspeitos[i]] *= (pesos[i] + (double)RUIDO_DEDUCAO) / RUIDO_DEDUCAO;
+    }
+    for (int s = 0; s < motor->numSuspeitos; s++)
+    {
+        soma += referencia[s];
+    }
+    for (int s = 0; s < motor->numSuspeitos; s++)
+    {
+        double diferenca = probabilidadeDeCulpa(motor, s) - referencia[s] / soma;
+        if (diferenca > 1e-4 || diferenca < -1e-4)
+        {
+            falhar("rodada %d: probabilidade do suspeito %d %.6f, esperado %.6f", rodada, s,
+                   probabilidadeDeCulpa(motor, s), referencia[s] / soma);
+        }
+    }
+}
+
+/**
+ * @brief Grava 'texto' em um arquivo novo em 'caminho'.
+ */
+void escreverArquivo(const char *caminho, const char *texto)
+{
+    FILE *arquivo = fopen(caminho, "w");
+    if (arquivo == NULL || fputs(texto, arquivo) == EOF || fclose(arquivo) != 0)
+    {
+        falhar("não foi possível escrever %s", caminho);
+    }
+}
+
+/**
+ * @brief Grava a mansão como um compilado da versão 2: cabeçalho sem as listas e salas
+ * de 20 bytes, sem 'implicacoes'.
+ */
+void gravarMapaVersao2(const Mansao *mansao, const char *caminho)
+{
+    const PoolStrings *pool = &mansao->dicionario->pool;
+    uint64_t tamanhoCabecalho = offsetof(CabecalhoMapa, offsetListas);
+    uint64_t tamanhoSala = offsetof(SalaCompilada, implicacoes);
+    CabecalhoMapa cabecalho;
+    memset(&cabecalho, 0, sizeof(cabecalho));
+    memcpy(cabecalho.assinatura, ASSINATURA_MAPA, sizeof(cabecalho.assinatura));
+    cabecalho.versao = 2;
+    cabecalho.funcaoHash = FUNCAO_HASH;
+    cabecalho.numSalas = mansao->numSalas;
+    cabecalho.raiz = mansao->raiz;
+    cabecalho.numStrings = (uint32_t)pool->quantidade;
+    cabecalho.bytesStrings = pool->usado;
+    cabecalho.offsetSalas = alinhar8(tamanhoCabecalho);
+    cabecalho.offsetOffsets = alinhar8(cabecalho.offsetSalas + tamanhoSala * mansao->numSalas);
+    cabecalho.offsetHashes = alinhar8(cabecalho.offsetOffsets + sizeof(uint32_t) * (uint64_t)cabecalho.numStrings);
+    cabecalho.offsetDados = alinhar8(cabecalho.offsetHashes + sizeof(uint32_t) * (uint64_t)cabecalho.numStrings);
+
+    FILE *arquivo = fopen(caminho, "wb");
+    int ok = arquivo != NULL && fwrite(&cabecalho, tamanhoCabecalho, 1, arquivo) == 1;
+    for (uint32_t i = 0; ok && i < mansao->numSalas; i++)
+    {
+        ok = fseek(arquivo, (long)(cabecalho.offsetSalas + i * tamanhoSala), SEEK_SET) == 0 &&
+             fwrite(&mansao->salas[i], tamanhoSala, 1, arquivo) == 1;
+    }
+    ok = ok && fseek(arquivo, (long)cabecalho.offsetOffsets, SEEK_SET) == 0 &&
+         fwrite(pool->offsets, sizeof(uint32_t), cabecalho.numStrings, arquivo) == cabecalho.numStrings;
+    ok = ok && fseek(arquivo, (long)cabecalho.offsetHashes, SEEK_SET) == 0 &&
+         fwrite(pool->hashes, sizeof(uint32_t), cabecalho.numStrings, arquivo) == cabecalho.numStrings;
+    ok = ok && fseek(arquivo, (long)cabecalho.offsetDados, SEEK_SET) == 0 &&
+         fwrite(pool->dados, 1, pool->usado, arquivo) == pool->usado;
+    if (arquivo == NULL || fclose(arquivo) != 0 || !ok)
+    {
+        falhar("não foi possível gravar o mapa da versão 2");
+    }
+}
+
+/**
+ * @brief Confere o que mostrarPistasDoSuspeito mostra de uma sessão que coletou todas as
+ * salas do MAPA_COM_PESOS (na ordem dos índices).
+ */
+void conferirPistasMostradas(const Mansao *mansao, Renderizador *saida, FILE *arquivo, const char *origem)
+{
+    const char *nomes[] = {"Mordomo", "Dama", "Jardineiro"};
+    const char *esperados[] = {
+        "\n🧾 Pistas contra Mordomo (peso total 4):\n   -> Lupa quebrada (peso 3)\n   -> Chave (peso 1)\n"
+        "   (2 de 2 pista(s) do mapa contra Mordomo)\n",
+        "\n🧾 Pistas contra Dama (peso total 3):\n   -> Lupa quebrada (peso 1)\n   -> Chave (peso 2)\n"
+        "   (2 de 2 pista(s) do mapa contra Dama)\n",
+        "\n🧾 Pistas contra Jardineiro (peso total 6):\n   -> Faca de prata (peso 1)\n   -> Chave (peso 5)\n"
+        "   (2 de 2 pista(s) do mapa contra Jardineiro)\n",
+    };
+    char obtido[512];
+    Sessao sessao;
+    iniciarSessao(&sessao, mansao);
+    for (uint32_t sala = 0; sala < mansao->numSalas; sala++)
+    {
+        coletarPistaDe(&sessao, sala);
+    }
+    for (int i = 0; i < 3; i++)
+    {
+        mostrarPistasDoSuspeito(saida, &sessao, nomes[i]);
+        if (strcmp(lerSaida(saida, arquivo, obtido, sizeof(obtido)), esperados[i]) != 0)
+        {
+            falhar("mapa %s: pistas contra %s mostradas como '%s'", origem, nomes[i], obtido);
+        }
+    }
+
+    // Cada principal é citado uma vez (empate no placar), mas pelos pesos o Jardineiro
+    // lidera: 21 * 5 contra 13 * 5 do Mordomo e 5 * 9 da Dama
+    Deducao deducao = deduzir(&sessao);
+    double diferenca = deducao.maisProvavel.probabilidade - 105.0 / 215.0;
+    if (!deducao.empate || strcmp(nomeDoSuspeito(mansao->dicionario, deducao.maisProvavel.suspeito), "Jardineiro") != 0 ||
+        diferenca > 1e-5 || diferenca < -1e-5)
+    {
+        falhar("mapa %s: dedução ponderada com %s a %.4f", origem, nomeDoSuspeito(mansao->dicionario, deducao.maisProvavel.suspeito),
+               deducao.maisProvavel.probabilidade);
+    }
+    liberarSessao(&sessao);
+}
+
+/**
+ * @brief O MAPA_COM_PESOS lido do texto, gravado e relido compilado (versão atual, com as
+ * listas, e versão 2, só com o suspeito principal), e campos de suspeitos inválidos.
+ */
+void conferirMapaComPesos()
+{
+    char caminhoTexto[] = "/tmp/teste-catalogo-XXXXXX";
+    int descritor = mkstemp(caminhoTexto);
+    FILE *arquivoSaida = tmpfile();
+    if (descritor < 0 || arquivoSaida == NULL)
+    {
+        perror("Erro ao preparar o teste");
+        exit(EXIT_FAILURE);
+    }
+    close(descritor);
+    char caminhoCompilado[sizeof(caminhoTexto) + 4];
+    snprintf(caminhoCompilado, sizeof(caminhoCompilado), "%s.bin", caminhoTexto);
+    Renderizador saida;
+    iniciarSaida(&saida, fileno(arquivoSaida), VERBOSIDADE_RESUMO, TAMANHO_BUFFER_SAIDA);
+
+    Dicionario dicionario;
+    iniciarDicionario(&dicionario);
+    Mansao mansao;
+    escreverArquivo(caminhoTexto, MAPA_COM_PESOS);
+    if (!carregarMapa(caminhoTexto, &dicionario, &mansao))
+    {
+        falhar("o mapa texto com pesos foi recusado");
+    }
+    registrarSuspeitosDoMapa(&mansao);
+    conferirPistasMostradas(&mansao, &saida, arquivoSaida, "texto");
+
+    // Compilado: as mesmas salas, com as mesmas listas, vindas do arquivo mapeado
+    Dicionario dicionarioCompilado;
+    iniciarDicionario(&dicionarioCompilado);
+    Mansao compilada;
+    if (!salvarMapaCompilado(&mansao, caminhoCompilado) || !carregarMapa(caminhoCompilado, &dicionarioCompilado, &compilada) ||
+        !dicionarioCompilado.implicacoes.emprestado || compilada.numSalas != mansao.numSalas)
+    {
+        falhar("o mapa com pesos não voltou do formato compilado");
+    }
+    for (uint32_t i = 0; i < mansao.numSalas; i++)
+    {
+        Implicacao unico, unicoCompilado;
+        uint32_t quantidade, quantidadeCompilada;
+        const Implicacao *pares = implicacoesDaSala(&dicionario, &mansao.salas[i], &unico, &quantidade);
+        const Implicacao *paresCompilados = implicacoesDaSala(&dicionarioCompilado, &compilada.salas[i], &unicoCompilado,
+                                                              &quantidadeCompilada);
+        if (quantidade != quantidadeCompilada)
+        {
+            falhar("sala %u com %u suspeito(s) no texto e %u no compilado", i, quantidade, quantidadeCompilada);
+        }
+        for (uint32_t j = 0; j < quantidade; j++)
+        {
+            if (strcmp(textoDe(&dicionario, (int)pares[j].suspeito), textoDe(&dicionarioCompilado, (int)paresCompilados[j].suspeito)) != 0 ||
+                pares[j].peso != paresCompilados[j].peso)
+            {
+                falhar("sala %u: suspeito %u diferente no compilado", i, j);
+            }
+        }
+    }
+    registrarSuspeitosDoMapa(&compilada);
+    conferirPistasMostradas(&compilada, &saida, arquivoSaida, "compilado");
+    liberarDicionario(&dicionarioCompilado);
+    liberarMansao(&compilada);
+
+    // Versão 2: as salas são convertidas e implicam só o suspeito principal, com peso 1
+    gravarMapaVersao2(&mansao, caminhoCompilado);
+    iniciarDicionario(&dicionarioCompilado);
+    if (!carregarMapa(caminhoCompilado, &dicionarioCompilado, &compilada) || compilada.numSalas != mansao.numSalas ||
+        dicionarioCompilado.implicacoes.quantidade != 1)
+    {
+        falhar("o mapa compilado da versão 2 foi recusado");
+    }
+    for (uint32_t i = 0; i < mansao.numSalas; i++)
+    {
+        if (compilada.salas[i].implicacoes != LISTA_VAZIA ||
+            strcmp(textoDe(&dicionario, (int)mansao.salas[i].suspeito), textoDe(&dicionarioCompilado, (int)compilada.salas[i].suspeito)) != 0 ||
+            compilada.salas[i].esquerda != mansao.salas[i].esquerda || compilada.salas[i].direita != mansao.salas[i].direita)
+        {
+            falhar("sala %u mal convertida da versão 2", i);
+        }
+    }
+    liberarDicionario(&dicionarioCompilado);
+    liberarMansao(&compilada);
+    liberarMansao(&mansao);
+    liberarDicionario(&dicionario);
+
+    // Campos de suspeitos inválidos recusam o mapa inteiro; o peso máximo ainda vale
+    const char *campos[] = {"Mordomo:0", "Mordomo:1001", "Mordomo:", "Mordomo:x", ":2", "Mordomo, ", "Dama, Dama:2",
+                            "Mordomo:1000"};
+    int quantosCampos = (int)(sizeof(campos) / sizeof(campos[0]));
+    char texto[128];
+    fflush(stderr);
+    int erros = dup(STDERR_FILENO); // As recusas esperadas não vão para a saída do teste
+    int nulo = open("/dev/null", O_WRONLY);
+    if (erros < 0 || nulo < 0 || dup2(nulo, STDERR_FILENO) < 0)
+    {
+        perror("Erro ao preparar o teste");
+        exit(EXIT_FAILURE);
+    }
+    close(nulo);
+    for (int i = 0; i < quantosCampos; i++)
+    {
+        snprintf(texto, sizeof(texto), "0 | Hall | - | - | Lupa | %s\n", campos[i]);
+        escreverArquivo(caminhoTexto, texto);
+        iniciarDicionario(&dicionario);
+        int aceito = carregarMapa(caminhoTexto, &dicionario, &mansao);
+        if (aceito != (i == quantosCampos - 1))
+        {
+            dup2(erros, STDERR_FILENO);
+            falhar("campo de suspeitos '%s' %s", campos[i], aceito ? "aceito" : "recusado");
+        }
+        if (aceito)
+        {
+            liberarMansao(&mansao);
+        }
+        liberarDicionario(&dicionario);
+    }
+    dup2(erros, STDERR_FILENO);
+    close(erros);
+
+    unlink(caminhoCompilado);
+    unlink(caminhoTexto);
+    liberarSaida(&saida);
+    fclose(arquivoSaida);
+}
+
+int main()
+{
+    unsigned long long estado = SEMENTE_TESTES;
+    int suspeitos[MAXIMO_SUSPEITOS * MAXIMO_PISTAS], pistas[MAXIMO_SUSPEITOS * MAXIMO_PISTAS];
+    int pesos[MAXIMO_SUSPEITOS * MAXIMO_PISTAS];
+    int matriz[MAXIMO_SUSPEITOS][MAXIMO_TEXTOS];
+    Implicacao esperadas[MAXIMO_SALAS][MAXIMO_POR_SALA];
+    int numEsperadas[MAXIMO_SALAS];
+    uint32_t salaDaEvidencia[MAXIMO_TEXTOS];
+    char texto[64];
+
+    conferirMapaComPesos();
+
+    for (int rodada = 0; rodada < RODADAS_CATALOGO; rodada++)
+    {
+        int numSuspeitos = 1 + (int)sortear(&estado, MAXIMO_SUSPEITOS);
+        int numPistas = 1 + (int)sortear(&estado, MAXIMO_PISTAS);
+        IndiceSuspeitos indice;
+        iniciarIndiceSuspeitos(&indice);
+
+        // Em crescimento, às vezes esvaziado e reaproveitado no meio
+        int associacoes = 0;
+        int total = (int)sortear(&estado, (unsigned long long)numSuspeitos * numPistas);
+        for (int i = 0; i < total; i++)
+        {
+            if (sortear(&estado, 200) == 0)
+            {
+                reiniciarIndiceSuspeitos(&indice);
+                associacoes = 0;
+            }
+            suspeitos[associacoes] = (int)sortear(&estado, (unsigned long long)numSuspeitos);
+            pistas[associacoes] = (int)sortear(&estado, (unsigned long long)numPistas);
+            pesos[associacoes] = 1 + (int)sortear(&estado, 5);
+            associarPistaAoSuspeito(&indice, pistas[associacoes], suspeitos[associacoes], pesos[associacoes]);
+            associacoes++;
+        }
+        conferirCrescendo(&indice, suspeitos, pistas, pesos, associacoes, numSuspeitos, rodada);
+
+        memset(matriz, 0, sizeof(matriz));
+        for (int i = 0; i < associacoes; i++)
+        {
+            matriz[suspeitos[i]][pistas[i]] += pesos[i];
+        }
+        congelarIndiceSuspeitos(&indice);
+        conferirCongelado(&indice, matriz, numSuspeitos, numPistas, rodada);
+        int quantidade;
+        if (pistasDoSuspeito(&indice, -1, &quantidade) != NULL || quantidade != 0 ||
+            pistasDoSuspeito(&indice, indice.numSuspeitos, &quantidade) != NULL || quantidade != 0 ||
+            pesoDoSuspeito(&indice, indice.numSuspeitos) != 0)
+        {
+            falhar("rodada %d: suspeito fora do índice com pistas", rodada);
+        }
+        liberarIndiceSuspeitos(&indice);
+
+        // Catálogo de um mapa: cada sala com pista soma, no par com cada suspeito dela, o
+        // peso dele (1 sem lista); às vezes a sala tem uma lista de até MAXIMO_POR_SALA
+        Dicionario dicionario;
+        iniciarDicionario(&dicionario);
+        Mansao mansao;
+        uint32_t numSalas = 1 + (uint32_t)sortear(&estado, MAXIMO_SALAS);
+        montarMansaoDeTeste(&mansao, &dicionario, numSalas);
+        memset(matriz, 0, sizeof(matriz));
+        for (uint32_t i = 0; i < numSalas; i++)
+        {
+            SalaCompilada *sala = &mansao.salasProprias[i];
+            if (sortear(&estado, 6) != 0)
+            {
+                snprintf(texto, sizeof(texto), "Pista %llu", sortear(&estado, (unsigned long long)numPistas));
+                sala->pista = (uint32_t)internar(&dicionario, texto);
+            }
+            numEsperadas[i] = 0;
+            if (sortear(&estado, 6) != 0)
+            {
+                snprintf(texto, sizeof(texto), "Suspeito %llu", sortear(&estado, (unsigned long long)numSuspeitos));
+                sala->suspeito = (uint32_t)internar(&dicionario, texto);
+                esperadas[i][numEsperadas[i]].suspeito = sala->suspeito;
+                esperadas[i][numEsperadas[i]++].peso = 1;
+            }
+            if (sala->suspeito != STRING_VAZIA && sortear(&estado, 3) == 0)
+            {
+                esperadas[i][0].peso = 1 + (uint32_t)sortear(&estado, 5);
+                for (unsigned long long outros = sortear(&estado, MAXIMO_POR_SALA); outros > 0; outros--)
+                {
+                    snprintf(texto, sizeof(texto), "Suspeito %llu", sortear(&estado, (unsigned long long)numSuspeitos));
+                    uint32_t outro = (uint32_t)internar(&dicionario, texto);
+                    int repetido = 0;
+                    for (int j = 0; j < numEsperadas[i]; j++)
+                    {
+                        repetido |= esperadas[i][j].suspeito == outro;
+                    }
+                    if (!repetido)
+                    {
+                        esperadas[i][numEsperadas[i]].suspeito = outro;
+                        esperadas[i][numEsperadas[i]++].peso = 1 + (uint32_t)sortear(&estado, 5);
+                    }
+                }
+                sala->implicacoes = criarListaDeImplicacoes(&dicionario, esperadas[i], (uint32_t)numEsperadas[i]);
+            }
+            for (int j = 0; sala->pista != STRING_VAZIA && j < numEsperadas[i]; j++)
+            {
+                matriz[registrarSuspeito(&dicionario, (int)esperadas[i][j].suspeito)][sala->pista] += (int)esperadas[i][j].peso;
+            }
+        }
+        registrarSuspeitosDoMapa(&mansao);
+        IndiceSuspeitos catalogo;
+        construirCatalogoSuspeitos(&mansao, &catalogo);
+        conferirCongelado(&catalogo, matriz, dicionario.suspeitos.quantidade, dicionario.pool.quantidade, rodada);
+        liberarIndiceSuspeitos(&catalogo);
+
+        // Índice da sessão: as evidências coletadas, na ordem, sob cada suspeito da sala de
+        // onde vieram, com o peso dele (sem suspeito, o nome vazio com peso 1)
+        Sessao sessao;
+        iniciarSessao(&sessao, &mansao);
+        for (uint32_t passo = 0; passo < numSalas; passo++)
+        {
+            if (sortear(&estado, 100) == 0)
+            {
+                reiniciarSessao(&sessao);
+            }
+            uint32_t sala = (uint32_t)sortear(&estado, numSalas);
+            int antes = sessao.evidencias.quantidade;
+            coletarPistaDe(&sessao, sala);
+            if (sessao.evidencias.quantidade > antes)
+            {
+                salaDaEvidencia[antes] = sala;
+            }
+        }
+        associacoes = 0;
+        for (int i = 0; i < sessao.evidencias.quantidade; i++)
+        {
+            const Associacao *evidencia = &sessao.evidencias.entradas[i];
+            uint32_t sala = salaDaEvidencia[i];
+            for (int j = 0; j < numEsperadas[sala]; j++)
+            {
+                suspeitos[associacoes] = registrarSuspeito(&dicionario, (int)esperadas[sala][j].suspeito);
+                pistas[associacoes] = evidencia->pista;
+                pesos[associacoes++] = (int)esperadas[sala][j].peso;
+            }
+            if (numEsperadas[sala] == 0)
+            {
+                suspeitos[associacoes] = evidencia->suspeito_id;
+                pistas[associacoes] = evidencia->pista;
+                pesos[associacoes++] = 1;
+            }
+            if (evidencia->suspeito != STRING_VAZIA && matriz[evidencia->suspeito_id][evidencia->pista] == 0)
+            {
+                falhar("rodada %d: evidência fora do catálogo do mapa", rodada);
+            }
+        }
+        conferirCrescendo(&sessao.porSuspeito, suspeitos, pistas, pesos, associacoes, dicionario.suspeitos.quantidade,
+                          rodada);
+        conferirMotor(&sessao.motor, suspeitos, pesos, associacoes, rodada);
+        liberarSessao(&sessao);
+
+        liberarMansao(&mansao);
+        liberarDicionario(&dicionario);
+    }
+    printf("teste-catalogo: %d rodadas e o mapa com pesos ok\n", RODADAS_CATALOGO);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,169 @@
+/**
+ * @file teste-consultas.c
+ * @brief Teste das consultas na BST de pistas (posição, página, faixa e prefixo):
+ * cada resposta, inclusive o texto listado, é comparada com uma busca linear no
+ * array ordenado das pistas distintas.
+ */
+#include "apoio.h"
+
+#define RODADAS_CONSULTAS 200
+#define CONSULTAS_POR_RODADA 200
+
+/**
+ * @brief Texto curto sobre um alfabeto de 4 letras, para que prefixos e faixas
+ * peguem muitas pistas e também nenhuma.
+ */
+void sortearTextoCurto(unsigned long long *estado, char *texto)
+{
+    int tamanho = (int)sortear(estado, 6);
+    for (int i = 0; i < tamanho; i++)
+    {
+        texto[i] = (char)('a' + sortear(estado, 4));
+    }
+    texto[tamanho] = '\0';
+}
+
+/**
+ * @brief Acrescenta ao texto esperado, no formato do printf.
+ */
+void esperar(char *esperado, size_t capacidade, const char *formato, ...)
+{
+    size_t usado = strlen(esperado);
+    va_list argumentos;
+    va_start(argumentos, formato);
+    vsnprintf(esperado + usado, capacidade - usado, formato, argumentos);
+    va_end(argumentos);
+}
+
+int main()
+{
+    unsigned long long estado = SEMENTE_TESTES;
+    FILE *arquivo = tmpfile();
+    size_t capacidadeTexto = 1 << 20;
+    char *obtido = (char *)malloc(capacidadeTexto);
+    char *esperado = (char *)malloc(capacidadeTexto);
+    if (arquivo == NULL || obtido == NULL || esperado == NULL)
+    {
+        perror("Erro ao preparar o teste");
+        exit(EXIT_FAILURE);
+    }
+    Renderizador saida;
+    iniciarSaida(&saida, fileno(arquivo), VERBOSIDADE_COMPLETA, TAMANHO_BUFFER_SAIDA);
+    char texto[16], de[16], ate[16];
+
+    for (int rodada = 0; rodada < RODADAS_CONSULTAS; rodada++)
+    {
+        Dicionario dicionario;
+        iniciarDicionario(&dicionario);
+        Arena arena;
+        iniciarArena(&arena);
+        Pista *raiz = NULL;
+        int n = (int)sortear(&estado, 1500);
+        int *ids = (int *)malloc(sizeof(int) * (size_t)(n + 1));
+        if (ids == NULL)
+        {
+            perror("Erro ao alocar memória para o teste");
+            exit(EXIT_FAILURE);
+        }
+        int distintas = 0;
+        for (int i = 0; i < n; i++)
+        {
+            sortearTextoCurto(&estado, texto);
+            int id = internar(&dicionario, texto);
+            if (inserirPistaBalanceada(&dicionario, &arena, &raiz, id, NULL))
+            {
+                ids[distintas++] = id;
+            }
+        }
+        qsort_r(ids, (size_t)distintas, sizeof(int), compararTextosDoDicionario, &dicionario);
+
+        // Posição k: a k-ésima do array ordenado (NULL fora do diário)
+        for (int k = -2; k <= distintas + 1; k++)
+        {
+            const Pista *pista = pistaNaPosicao(raiz, k);
+            int dentro = k >= 0 && k < distintas;
+            if ((pista != NULL) != dentro || (dentro && pista->descricao != ids[k]))
+            {
+                falhar("rodada %d: pistaNaPosicao(%d) errada (%d pistas)", rodada, k, distintas);
+            }
+        }
+
+        for (int consulta = 0; consulta < CONSULTAS_POR_RODADA; consulta++)
+        {
+            sortearTextoCurto(&estado, de);
+            sortearTextoCurto(&estado, ate);
+
+            // Posição de um texto: quantas pistas vêm antes dele
+            int antes = 0;
+            while (antes < distintas && strcmp(textoDe(&dicionario, ids[antes]), de) < 0)
+            {
+                antes++;
+            }
+            if (posicaoDaPista(&dicionario, raiz, de) != antes)
+            {
+                falhar("rodada %d: posicaoDaPista('%s') = %d, esperado %d", rodada, de,
+                       posicaoDaPista(&dicionario, raiz, de), antes);
+            }
+
+            // Página [inicio, fim)
+            int inicio = (int)sortear(&estado, (unsigned long long)distintas + 3) - 1;
+            int fim = inicio + (int)sortear(&estado, 40);
+            esperado[0] = '\0';
+            int quantas = 0;
+            for (int k = inicio < 0 ? 0 : inicio; k < fim && k < distintas; k++, quantas++)
+            {
+                esperar(esperado, capacidadeTexto, "   %d. %s\n", k + 1, textoDe(&dicionario, ids[k]));
+            }
+            int listadas = listarPaginaDePistas(&saida, &dicionario, raiz, inicio, fim);
+            if (listadas != quantas || strcmp(lerSaida(&saida, arquivo, obtido, capacidadeTexto), esperado) != 0)
+            {
+                falhar("rodada %d: página [%d, %d) com %d pistas, esperado %d", rodada, inicio, fim, listadas, quantas);
+            }
+
+            // Faixa [de, ate], inclusive nas duas pontas
+            esperado[0] = '\0';
+            quantas = 0;
+            for (int k = 0; k < distintas; k++)
+            {
+                const char *atual = textoDe(&dicionario, ids[k]);
+                if (strcmp(atual, de) >= 0 && strcmp(atual, ate) <= 0)
+                {
+                    esperar(esperado, capacidadeTexto, "   -> %s\n", atual);
+                    quantas++;
+                }
+            }
+            listadas = listarPistasNaFaixa(&saida, &dicionario, raiz, de, ate);
+            if (listadas != quantas || strcmp(lerSaida(&saida, arquivo, obtido, capacidadeTexto), esperado) != 0)
+            {
+                falhar("rodada %d: faixa '%s'..'%s' com %d pistas, esperado %d", rodada, de, ate, listadas, quantas);
+            }
+
+            // Prefixo (o vazio pega o diário inteiro)
+            esperado[0] = '\0';
+            quantas = 0;
+            for (int k = 0; k < distintas; k++)
+            {
+                const char *atual = textoDe(&dicionario, ids[k]);
+                if (strncmp(atual, de, strlen(de)) == 0)
+                {
+                    esperar(esperado, capacidadeTexto, "   -> %s\n", atual);
+                    quantas++;
+                }
+            }
+            listadas = listarPistasComPrefixo(&saida, &dicionario, raiz, de);
+            if (listadas != quantas || strcmp(lerSaida(&saida, arquivo, obtido, capacidadeTexto), esperado) != 0)
+            {
+                falhar("rodada %d: prefixo '%s' com %d pistas, esperado %d", rodada, de, listadas, quantas);
+            }
+        }
+        free(ids);
+        liberarArena(&arena);
+        liberarDicionario(&dicionario);
+    }
+    liberarSaida(&saida);
+    fclose(arquivo);
+    free(obtido);
+    free(esperado);
+    printf("teste-consultas: %d rodadas ok\n", RODADAS_CONSULTAS);
+    return EXIT_SUCCESS;
+}
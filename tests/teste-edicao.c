@@ -0,0 +1,441 @@
+/**
+ * @file teste-edicao.c
+ * @brief Teste da edição da mansão: sequências aleatórias de salas novas, alas
+ * desanexadas e religadas e pistas trocadas (às vezes com dois suspeitos e pesos), jogadas
+ * com a sessão em salas sorteadas (a troca de pista às vezes pelo comando m, conferindo o
+ * texto mostrado).
+ * Depois de cada lote de edições, o índice de salas e o catálogo mantidos aos poucos são
+ * comparados com os montados do zero (construirIndiceSalas e construirCatalogoSuspeitos)
+ * sobre uma cópia da mansão só com as salas alcançáveis da raiz.
+ */
+#include "apoio.h"
+
+#define RODADAS_EDICAO 120
+#define EDICOES_POR_LOTE 25
+
+/**
+ * @brief Marca as salas alcançáveis da raiz e guarda o pai de cada uma (descida com pilha).
+ * @return Quantas salas estão na mansão.
+ */
+uint32_t marcarAlcancaveis(const Mansao *mansao, char *alcancavel, uint32_t *pais, uint32_t *pilha)
+{
+    memset(alcancavel, 0, mansao->numSalas);
+    uint32_t topo = 0, quantidade = 0;
+    pilha[topo++] = mansao->raiz;
+    pais[mansao->raiz] = SEM_SALA;
+    while (topo > 0)
+    {
+        uint32_t sala = pilha[--topo];
+        alcancavel[sala] = 1;
+        quantidade++;
+        uint32_t filhos[2] = {mansao->salas[sala].esquerda, mansao->salas[sala].direita};
+        for (int f = 0; f < 2; f++)
+        {
+            if (filhos[f] != SEM_SALA)
+            {
+                pais[filhos[f]] = sala;
+                pilha[topo++] = filhos[f];
+            }
+        }
+    }
+    return quantidade;
+}
+
+/**
+ * @brief Sorteia uma sala da mansão (alcançável da raiz).
+ */
+uint32_t sortearSalaDaMansao(const Mansao *mansao, const char *alcancavel, unsigned long long *estado)
+{
+    uint32_t sala;
+    do
+    {
+        sala = (uint32_t)sortear(estado, mansao->numSalas);
+    } while (!alcancavel[sala]);
+    return sala;
+}
+
+/**
+ * @brief Texto sorteado de um conjunto pequeno (repete bastante), ou vazio.
+ */
+const char *sortearTexto(const char *prefixo, unsigned long long variedade, unsigned long long *estado, char *texto,
+                         size_t capacidade)
+{
+    if (sortear(estado, 5) == 0)
+    {
+        return "";
+    }
+    snprintf(texto, capacidade, "%s %llu", prefixo, sortear(estado, variedade));
+    return texto;
+}
+
+/**
+ * @brief Campo de suspeitos sorteado: vazio, um nome ou, às vezes, dois nomes distintos
+ * com pesos ("Suspeito 2:3, Suspeito 5:1").
+ */
+const char *sortearSuspeitos(unsigned long long *estado, char *texto, size_t capacidade)
+{
+    if (sortear(estado, 3) != 0)
+    {
+        return sortearTexto("Suspeito", 8, estado, texto, capacidade);
+    }
+    unsigned long long primeiro = sortear(estado, 8);
+    unsigned long long segundo = (primeiro + 1 + sortear(estado, 7)) % 8;
+    unsigned long long pesoPrimeiro = 1 + sortear(estado, 4);
+    unsigned long long pesoSegundo = 1 + sortear(estado, 4);
+    snprintf(texto, capacidade, "Suspeito %llu:%llu, Suspeito %llu:%llu", primeiro, pesoPrimeiro, segundo, pesoSegundo);
+    return texto;
+}
+
+/**
+ * @brief Copia só as salas alcançáveis da raiz para uma mansão nova, renumeradas (a raiz
+ * vira a sala 0): é a mansão que um mapa com as edições já aplicadas carregaria.
+ * @param numero Recebe o índice de cada sala na cópia (SEM_SALA para as de alas soltas).
+ */
+void copiarMansaoAlcancavel(const Mansao *mansao, const char *alcancavel, uint32_t *numero, Mansao *copia)
+{
+    uint32_t quantidade = 0;
+    numero[mansao->raiz] = quantidade++;
+    for (uint32_t i = 0; i < mansao->numSalas; i++)
+    {
+        if (i != mansao->raiz)
+        {
+            numero[i] = alcancavel[i] ? quantidade++ : SEM_SALA;
+        }
+    }
+    alocarMansao(copia, mansao->dicionario, quantidade);
+    for (uint32_t i = 0; i < mansao->numSalas; i++)
+    {
+        if (alcancavel[i])
+        {
+            SalaCompilada *sala = &copia->salasProprias[numero[i]];
+            *sala = mansao->salas[i];
+            sala->esquerda = sala->esquerda == SEM_SALA ? SEM_SALA : numero[sala->esquerda];
+            sala->direita = sala->direita == SEM_SALA ? SEM_SALA : numero[sala->direita];
+        }
+    }
+}
+
+/**
+ * @brief Compara o índice de salas e o catálogo mantidos pela edição com os montados do
+ * zero (construirIndiceSalas e construirCatalogoSuspeitos) sobre a cópia alcançável.
+ */
+void conferirEdicao(Sessao *sessao, const Mansao *mansao, unsigned long long *estado, int rodada)
+{
+    uint32_t n = mansao->numSalas;
+    char *alcancavel = (char *)malloc(n);
+    uint32_t *pais = (uint32_t *)malloc(sizeof(uint32_t) * n);
+    uint32_t *pilha = (uint32_t *)malloc(sizeof(uint32_t) * n);
+    uint32_t *numero = (uint32_t *)malloc(sizeof(uint32_t) * n);
+    if (alcancavel == NULL || pais == NULL || pilha == NULL || numero == NULL)
+    {
+        perror("Erro ao alocar memória para o teste");
+        exit(EXIT_FAILURE);
+    }
+    marcarAlcancaveis(mansao, alcancavel, pais, pilha);
+    Mansao copia;
+    copiarMansaoAlcancavel(mansao, alcancavel, numero, &copia);
+
+    // Índice de salas: pai, profundidade e ancestral comum iguais aos do índice novo, e
+    // as salas das alas soltas fora da mansão
+    const IndiceSalas *editado = sessao->indiceSalas;
+    IndiceSalas novo;
+    construirIndiceSalas(&copia, &novo);
+    for (uint32_t i = 0; i < n; i++)
+    {
+        if (salaNaMansao(sessao, i) != alcancavel[i])
+        {
+            falhar("rodada %d: sala %u %s da mansão", rodada, i, alcancavel[i] ? "fora" : "dentro");
+        }
+        uint32_t paiNovo = alcancavel[i] ? novo.pais[numero[i]] : SEM_SALA;
+        if (alcancavel[i] && (editado->pais[i] != pais[i] || (paiNovo == SEM_SALA) != (pais[i] == SEM_SALA) ||
+                              (paiNovo != SEM_SALA && paiNovo != numero[pais[i]]) ||
+                              editado->profundidades[i] != novo.profundidades[numero[i]]))
+        {
+            falhar("rodada %d: pai ou profundidade da sala %u diferente do índice novo", rodada, i);
+        }
+    }
+    for (int consulta = 0; consulta < 200; consulta++)
+    {
+        uint32_t a = sortearSalaDaMansao(mansao, alcancavel, estado);
+        uint32_t b = sortearSalaDaMansao(mansao, alcancavel, estado);
+        if (numero[ancestralComum(editado, a, b)] != ancestralComum(&novo, numero[a], numero[b]))
+        {
+            falhar("rodada %d: ancestral comum de %u e %u diferente do índice novo", rodada, a, b);
+        }
+    }
+
+    // Nomes (inclusive os que só existem em alas soltas): a sala achada tem o nome, está
+    // na mansão e é tão rasa quanto a do índice novo
+    for (uint32_t i = 0; i < n; i++)
+    {
+        const char *nome = textoDe(mansao->dicionario, mansao->salas[i].nome);
+        uint32_t achada = buscarSalaPorNome(editado, nome);
+        uint32_t esperada = buscarSalaPorNome(&novo, nome);
+        if ((achada == SEM_SALA) != (esperada == SEM_SALA) ||
+            (achada != SEM_SALA && (!alcancavel[achada] || mansao->salas[achada].nome != mansao->salas[i].nome ||
+                                    novo.profundidades[numero[achada]] != novo.profundidades[esperada])))
+        {
+            falhar("rodada %d: sala do nome '%s' (%u) diferente do índice novo (%u)", rodada, nome, achada, esperada);
+        }
+    }
+    liberarIndiceSalas(&novo);
+
+    // Catálogo: cada lista, ordenada por pista, igual à do catálogo congelado novo
+    IndiceSuspeitos catalogoNovo;
+    construirCatalogoSuspeitos(&copia, &catalogoNovo);
+    const IndiceSuspeitos *catalogo = sessao->catalogo;
+    PistaPonderada *ordenadas = (PistaPonderada *)malloc(sizeof(PistaPonderada) * ((size_t)catalogo->totalPistas + 1));
+    if (ordenadas == NULL)
+    {
+        perror("Erro ao alocar memória para o teste");
+        exit(EXIT_FAILURE);
+    }
+    int total = 0;
+    int numSuspeitos = catalogo->numSuspeitos > catalogoNovo.numSuspeitos ? catalogo->numSuspeitos : catalogoNovo.numSuspeitos;
+    for (int s = 0; s < numSuspeitos; s++)
+    {
+        int quantidade, esperadas;
+        const PistaPonderada *lista = pistasDoSuspeito(catalogo, s, &quantidade);
+        const PistaPonderada *listaNova = pistasDoSuspeito(&catalogoNovo, s, &esperadas);
+        if (quantidade != esperadas || pesoDoSuspeito(catalogo, s) != pesoDoSuspeito(&catalogoNovo, s))
+        {
+            falhar("rodada %d: suspeito %d com %d pista(s) e peso %d no catálogo, esperado %d e %d", rodada, s,
+                   quantidade, pesoDoSuspeito(catalogo, s), esperadas, pesoDoSuspeito(&catalogoNovo, s));
+        }
+        if (quantidade == 0)
+        {
+            continue;
+        }
+        memcpy(ordenadas, lista, sizeof(PistaPonderada) * (size_t)quantidade);
+        qsort(ordenadas, (size_t)quantidade, sizeof(PistaPonderada), compararPistasPonderadas);
+        for (int i = 0; i < quantidade; i++)
+        {
+            if (ordenadas[i].pista != listaNova[i].pista || ordenadas[i].peso != listaNova[i].peso)
+            {
+                falhar("rodada %d: pista '%s' do suspeito %d com peso %d, esperado '%s' com %d", rodada,
+                       textoDe(mansao->dicionario, ordenadas[i].pista), s, ordenadas[i].peso, textoDe(mansao->dicionario, listaNova[i].pista), listaNova[i].peso);
+            }
+        }
+        total += quantidade;
+    }
+    if (total != catalogo->totalPistas)
+    {
+        falhar("rodada %d: catálogo com %d pares, as listas somam %d", rodada, catalogo->totalPistas, total);
+    }
+
+    free(ordenadas);
+    liberarIndiceSuspeitos(&catalogoNovo);
+    liberarMansao(&copia);
+    free(alcancavel);
+    free(pais);
+    free(pilha);
+    free(numero);
+}
+
+int main()
+{
+    unsigned long long estado = SEMENTE_TESTES;
+    char nome[64], pista[64], suspeito[64], argumento[160], obtido[512];
+    long edicoes = 0, recusadas = 0;
+    FILE *arquivoSaida = tmpfile();
+    if (arquivoSaida == NULL)
+    {
+        perror("Erro ao preparar o teste");
+        exit(EXIT_FAILURE);
+    }
+    Renderizador saida;
+    iniciarSaida(&saida, fileno(arquivoSaida), VERBOSIDADE_RESUMO, TAMANHO_BUFFER_SAIDA);
+
+    for (int rodada = 0; rodada < RODADAS_EDICAO; rodada++)
+    {
+        uint32_t numSalas = 1 + (uint32_t)sortear(&estado, rodada < RODADAS_EDICAO - 10 ? 60 : 3000);
+        unsigned long long variedade = 1 + sortear(&estado, numSalas + 10);
+        Dicionario dicionario;
+        iniciarDicionario(&dicionario);
+        Mansao mansao;
+        montarMansaoDeTeste(&mansao, &dicionario, numSalas);
+        for (uint32_t i = 0; i < numSalas; i++)
+        {
+            SalaCompilada *sala = &mansao.salasProprias[i];
+            snprintf(nome, sizeof(nome), "Sala %llu", sortear(&estado, variedade));
+            sala->nome = (uint32_t)internar(&dicionario, nome);
+            sala->pista = (uint32_t)internar(&dicionario, sortearTexto("Pista", variedade, &estado, pista, sizeof(pista)));
+            sala->suspeito = (uint32_t)internar(&dicionario, sortearTexto("Suspeito", 8, &estado, suspeito, sizeof(suspeito)));
+        }
+        registrarSuspeitosDoMapa(&mansao);
+
+        Sessao sessao;
+        iniciarSessao(&sessao, &mansao);
+        if (!prepararEdicao(&sessao, &mansao))
+        {
+            falhar("rodada %d: prepararEdicao recusou um dicionário que não está congelado", rodada);
+        }
+        uint32_t *soltas = (uint32_t *)malloc(sizeof(uint32_t) * 4096);
+        char *alcancavel = NULL;
+        uint32_t *pais = NULL, *pilha = NULL;
+        int numSoltas = 0;
+        if (soltas == NULL)
+        {
+            perror("Erro ao alocar memória para o teste");
+            exit(EXIT_FAILURE);
+        }
+
+        int lotes = 1 + (int)sortear(&estado, 8);
+        for (int lote = 0; lote < lotes; lote++)
+        {
+            for (int e = 0; e < EDICOES_POR_LOTE; e++)
+            {
+                // A visão ingênua da mansão é refeita a cada edição (as salas mudam)
+                free(alcancavel);
+                free(pais);
+                free(pilha);
+                alcancavel = (char *)malloc(mansao.numSalas);
+                pais = (uint32_t *)malloc(sizeof(uint32_t) * mansao.numSalas);
+                pilha = (uint32_t *)malloc(sizeof(uint32_t) * mansao.numSalas);
+                if (alcancavel == NULL || pais == NULL || pilha == NULL)
+                {
+                    perror("Erro ao alocar memória para o teste");
+                    exit(EXIT_FAILURE);
+                }
+                marcarAlcancaveis(&mansao, alcancavel, pais, pilha);
+                if (sortear(&estado, 3) == 0)
+                {
+                    sessao.salaAtual = sortearSalaDaMansao(&mansao, alcancavel, &estado);
+                    coletarPistaDaSala(&sessao);
+                }
+
+                uint32_t pai = sortearSalaDaMansao(&mansao, alcancavel, &estado);
+                int lado = sortear(&estado, 2) ? 'e' : 'd';
+                uint32_t ocupante = lado == 'e' ? mansao.salas[pai].esquerda : mansao.salas[pai].direita;
+                uint32_t salasNaAla;
+                unsigned long long tipo = sortear(&estado, 4);
+                if (tipo == 0)
+                {
+                    snprintf(nome, sizeof(nome), "Sala %llu", sortear(&estado, variedade + 5));
+                    uint32_t nova = adicionarSala(&sessao, &mansao, pai, lado, nome,
+                                                  sortearTexto("Pista", variedade, &estado, pista, sizeof(pista)),
+                                                  sortearSuspeitos(&estado, suspeito, sizeof(suspeito)));
+                    if ((nova == SEM_SALA) != (ocupante != SEM_SALA) ||
+                        (nova != SEM_SALA && (nova != mansao.numSalas - 1 || strcmp(textoDe(&dicionario, mansao.salas[nova].nome), nome) != 0)))
+                    {
+                        falhar("rodada %d: adicionarSala no lado %c de %u devolveu %u", rodada, lado, pai, nova);
+                    }
+                    recusadas += nova == SEM_SALA;
+                }
+                else if (tipo == 1)
+                {
+                    // Recusada se o lado está vazio ou se a sessão está dentro da ala
+                    int sessaoNaAla = 0;
+                    for (uint32_t sala = sessao.salaAtual; ocupante != SEM_SALA && sala != SEM_SALA; sala = pais[sala])
+                    {
+                        sessaoNaAla |= sala == ocupante;
+                    }
+                    uint32_t topo = desanexarAla(&sessao, &mansao, pai, lado, &salasNaAla);
+                    int aceita = ocupante != SEM_SALA && !sessaoNaAla;
+                    uint32_t naAla = 0;
+                    for (uint32_t i = 0; aceita && i < mansao.numSalas; i++)
+                    {
+                        uint32_t sala = i;
+                        while (alcancavel[i] && sala != SEM_SALA && sala != ocupante)
+                        {
+                            sala = pais[sala];
+                        }
+                        naAla += alcancavel[i] && sala == ocupante;
+                    }
+                    if (topo != (aceita ? ocupante : SEM_SALA) || (aceita && salasNaAla != naAla))
+                    {
+                        falhar("rodada %d: desanexarAla no lado %c de %u devolveu %u", rodada, lado, pai, topo);
+                    }
+                    if (aceita && numSoltas < 4096)
+                    {
+                        soltas[numSoltas++] = topo;
+                    }
+                    recusadas += !aceita;
+                }
+                else if (tipo == 2 && numSoltas > 0)
+                {
+                    int escolhida = (int)sortear(&estado, (unsigned long long)numSoltas);
+                    uint32_t topo = soltas[escolhida];
+                    int religada = anexarAla(&sessao, &mansao, topo, pai, lado, &salasNaAla);
+                    if (religada != (ocupante == SEM_SALA))
+                    {
+                        falhar("rodada %d: anexarAla no lado %c de %u devolveu %d", rodada, lado, pai, religada);
+                    }
+                    if (religada)
+                    {
+                        soltas[escolhida] = soltas[--numSoltas];
+                    }
+                    // Uma ala que já está na mansão não pode ser religada de novo
+                    if (religada && (anexarAla(&sessao, &mansao, topo, mansao.raiz, 'e', &salasNaAla) ||
+                                     anexarAla(&sessao, &mansao, topo, mansao.raiz, 'd', &salasNaAla)))
+                    {
+                        falhar("rodada %d: anexarAla aceitou uma sala que não é de ala solta", rodada);
+                    }
+                    recusadas += !religada;
+                }
+                else
+                {
+                    uint32_t sala = sortear(&estado, 8) == 0 && numSoltas > 0 ? soltas[0] : pai;
+                    sortearTexto("Pista", variedade, &estado, pista, sizeof(pista));
+                    sortearSuspeitos(&estado, suspeito, sizeof(suspeito));
+                    uint32_t pistaAntes = mansao.salas[sala].pista;
+                    int alterada;
+                    if (sortear(&estado, 4) == 0)
+                    {
+                        // Pelo comando m, com a sessão na sala: o texto diz se a troca aconteceu
+                        uint32_t onde = sessao.salaAtual;
+                        sessao.salaAtual = sala;
+                        snprintf(argumento, sizeof(argumento), "%s | %s", pista, suspeito);
+                        editarMansao(&sessao, &mansao, 'm', argumento, &saida);
+                        sessao.salaAtual = onde;
+                        const char *texto = lerSaida(&saida, arquivoSaida, obtido, sizeof(obtido));
+                        alterada = strstr(texto, "📝") != NULL;
+                        if (alterada == (strstr(texto, "🚫") != NULL))
+                        {
+                            falhar("rodada %d: comando m na sala %u mostrou '%s'", rodada, sala, texto);
+                        }
+                    }
+                    else
+                    {
+                        alterada = alterarPistaDaSala(&sessao, &mansao, sala, pista, suspeito);
+                    }
+                    const char *pistaDepois = textoDe(&dicionario, mansao.salas[sala].pista);
+                    if (alterada != (sala == pai) || (alterada && strcmp(pistaDepois, pista) != 0) ||
+                        (!alterada && mansao.salas[sala].pista != pistaAntes))
+                    {
+                        falhar("rodada %d: troca de pista na sala %u devolveu %d", rodada, sala, alterada);
+                    }
+                    recusadas += !alterada;
+                }
+                edicoes++;
+            }
+            conferirEdicao(&sessao, &mansao, &estado, rodada);
+        }
+
+        // Depois de congelar o dicionário para sessões em paralelo, toda edição é recusada
+        congelarDicionario(&mansao);
+        uint32_t salasAntes = mansao.numSalas;
+        snprintf(argumento, sizeof(argumento), "Pista congelada | Suspeito 0");
+        editarMansao(&sessao, &mansao, 'm', argumento, &saida);
+        if (prepararEdicao(&sessao, &mansao) ||
+            adicionarSala(&sessao, &mansao, sessao.salaAtual, 'e', "Nova", "", "") != SEM_SALA ||
+            mansao.numSalas != salasAntes ||
+            strstr(lerSaida(&saida, arquivoSaida, obtido, sizeof(obtido)), "🚫") == NULL ||
+            strcmp(textoDe(&dicionario, mansao.salas[sessao.salaAtual].pista), "Pista congelada") == 0)
+        {
+            falhar("rodada %d: edição aceita com o dicionário congelado", rodada);
+        }
+
+        free(alcancavel);
+        free(pais);
+        free(pilha);
+        free(soltas);
+        liberarSessao(&sessao);
+        liberarMansao(&mansao);
+        liberarDicionario(&dicionario);
+    }
+    liberarSaida(&saida);
+    fclose(arquivoSaida);
+    printf("teste-edicao: %d rodadas, %ld edições (%ld recusadas) ok\n", RODADAS_EDICAO, edicoes, recusadas);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,285 @@
+/**
+ * @file teste-nomes.c
+ * @brief Teste do índice de salas: pai, profundidade, ancestral numa profundidade,
+ * ancestral comum e distância são comparados com subidas de um pai por vez, e a sala de
+ * cada nome com a mais rasa entre as salas com esse nome. Os comandos t (teleporte) e
+ * v (voltar) são jogados de verdade em explorarSalas.
+ */
+#include "apoio.h"
+
+#define RODADAS_NOMES 200
+#define CONSULTAS_POR_RODADA 300
+
+/**
+ * @brief Monta uma mansão de forma aleatória: o pai de cada sala nova é sorteado entre
+ * as 'janela' salas anteriores (janela 1 dá uma corrente, a mais funda possível). Os
+ * índices são embaralhados, então a raiz nem sempre é a sala 0.
+ */
+void montarMansaoAleatoria(Mansao *mansao, Dicionario *dicionario, uint32_t numSalas, uint32_t janela, unsigned long long variedade,
+                           unsigned long long *estado)
+{
+    char texto[64];
+    uint32_t *rotulo = (uint32_t *)calloc(numSalas, sizeof(uint32_t));
+    if (rotulo == NULL)
+    {
+        perror("Erro ao alocar memória para o teste");
+        exit(EXIT_FAILURE);
+    }
+    for (uint32_t i = 0; i < numSalas; i++)
+    {
+        rotulo[i] = i;
+    }
+    for (uint32_t i = numSalas; i > 1; i--)
+    {
+        uint32_t j = (uint32_t)sortear(estado, i);
+        uint32_t troca = rotulo[i - 1];
+        rotulo[i - 1] = rotulo[j];
+        rotulo[j] = troca;
+    }
+
+    montarMansaoDeTeste(mansao, dicionario, numSalas);
+    for (uint32_t i = 0; i < numSalas; i++)
+    {
+        SalaCompilada *sala = &mansao->salasProprias[i];
+        sala->esquerda = SEM_SALA;
+        sala->direita = SEM_SALA;
+        snprintf(texto, sizeof(texto), "Sala %llu", sortear(estado, variedade));
+        sala->nome = (uint32_t)internar(dicionario, texto);
+    }
+    mansao->raiz = rotulo[0];
+    for (uint32_t i = 1; i < numSalas; i++)
+    {
+        uint32_t recuo = 1 + (uint32_t)sortear(estado, janela < i ? janela : i);
+        SalaCompilada *pai = &mansao->salasProprias[rotulo[i - recuo]];
+        if (pai->esquerda != SEM_SALA && pai->direita != SEM_SALA)
+        {
+            pai = &mansao->salasProprias[rotulo[i - 1]]; // A sala anterior ainda não tem filhos
+        }
+        if (pai->esquerda == SEM_SALA && (pai->direita != SEM_SALA || sortear(estado, 2)))
+        {
+            pai->esquerda = rotulo[i];
+        }
+        else
+        {
+            pai->direita = rotulo[i];
+        }
+    }
+    free(rotulo);
+}
+
+/**
+ * @brief Ancestral comum pela subida ingênua: iguala as profundidades e sobe as duas
+ * salas um pai por vez.
+ */
+uint32_t ancestralIngenuo(const uint32_t *pais, const uint32_t *profundidades, uint32_t a, uint32_t b)
+{
+    while (profundidades[a] > profundidades[b])
+    {
+        a = pais[a];
+    }
+    while (profundidades[b] > profundidades[a])
+    {
+        b = pais[b];
+    }
+    while (a != b)
+    {
+        a = pais[a];
+        b = pais[b];
+    }
+    return a;
+}
+
+/**
+ * @brief Joga uma linha de comandos (seguida de 's') na sessão e devolve a saída.
+ */
+const char *jogar(Sessao *sessao, Mansao *mansao, const char *comandos, FILE *entrada, FILE *arquivoSaida,
+                  Renderizador *saida, char *buffer, size_t capacidade)
+{
+    int descritor = fileno(entrada);
+    size_t tamanho = strlen(comandos);
+    if (ftruncate(descritor, 0) != 0 || pwrite(descritor, comandos, tamanho, 0) != (ssize_t)tamanho ||
+        pwrite(descritor, "\ns\n", 3, (off_t)tamanho) != 3 || lseek(descritor, 0, SEEK_SET) != 0)
+    {
+        falhar("não foi possível preparar os comandos");
+    }
+    LeitorComandos leitor;
+    iniciarLeitor(&leitor, descritor, saida);
+    explorarSalas(sessao, mansao, &leitor, saida);
+    return lerSaida(saida, arquivoSaida, buffer, capacidade);
+}
+
+int main()
+{
+    unsigned long long estado = SEMENTE_TESTES;
+    FILE *entrada = tmpfile();
+    FILE *arquivoSaida = tmpfile();
+    size_t capacidadeTexto = 1 << 16;
+    char *obtido = (char *)malloc(capacidadeTexto);
+    if (entrada == NULL || arquivoSaida == NULL || obtido == NULL)
+    {
+        perror("Erro ao preparar o teste");
+        exit(EXIT_FAILURE);
+    }
+    Renderizador saida;
+    iniciarSaida(&saida, fileno(arquivoSaida), VERBOSIDADE_RESUMO, TAMANHO_BUFFER_SAIDA);
+    char texto[128], esperado[160];
+    long teleportes = 0;
+
+    for (int rodada = 0; rodada < RODADAS_NOMES; rodada++)
+    {
+        uint32_t numSalas = 1 + (uint32_t)sortear(&estado, rodada < RODADAS_NOMES - 10 ? 300 : 100000);
+        uint32_t janelas[] = {1, 2, 8, numSalas};
+        uint32_t janela = janelas[rodada % 4];
+        unsigned long long variedade = 1 + sortear(&estado, numSalas);
+        Dicionario dicionario;
+        iniciarDicionario(&dicionario);
+        internar(&dicionario, "Texto que não é nome de sala");
+        Mansao mansao;
+        montarMansaoAleatoria(&mansao, &dicionario, numSalas, janela, variedade, &estado);
+
+        // Pais, profundidades e a sala mais rasa de cada nome, descendo da raiz com uma pilha
+        uint32_t *pais = (uint32_t *)malloc(sizeof(uint32_t) * numSalas);
+        uint32_t *profundidades = (uint32_t *)malloc(sizeof(uint32_t) * numSalas);
+        uint32_t *pilha = (uint32_t *)malloc(sizeof(uint32_t) * numSalas);
+        uint32_t *maisRasa = (uint32_t *)malloc(sizeof(uint32_t) * (size_t)(dicionario.pool.quantidade + 1));
+        if (pais == NULL || profundidades == NULL || pilha == NULL || maisRasa == NULL)
+        {
+            perror("Erro ao alocar memória para o teste");
+            exit(EXIT_FAILURE);
+        }
+        for (int i = 0; i < dicionario.pool.quantidade; i++)
+        {
+            maisRasa[i] = SEM_SALA;
+        }
+        uint32_t topo = 0;
+        pilha[topo++] = mansao.raiz;
+        pais[mansao.raiz] = SEM_SALA;
+        profundidades[mansao.raiz] = 0;
+        while (topo > 0)
+        {
+            uint32_t sala = pilha[--topo];
+            uint32_t nome = mansao.salas[sala].nome;
+            if (maisRasa[nome] == SEM_SALA || profundidades[maisRasa[nome]] > profundidades[sala])
+            {
+                maisRasa[nome] = sala;
+            }
+            uint32_t filhos[2] = {mansao.salas[sala].esquerda, mansao.salas[sala].direita};
+            for (int f = 0; f < 2; f++)
+            {
+                if (filhos[f] != SEM_SALA)
+                {
+                    pais[filhos[f]] = sala;
+                    profundidades[filhos[f]] = profundidades[sala] + 1;
+                    pilha[topo++] = filhos[f];
+                }
+            }
+        }
+
+        IndiceSalas indice;
+        construirIndiceSalas(&mansao, &indice);
+        for (uint32_t i = 0; i < numSalas; i++)
+        {
+            if (indice.pais[i] != pais[i] || indice.profundidades[i] != profundidades[i])
+            {
+                falhar("rodada %d: pai ou profundidade da sala %u errados", rodada, i);
+            }
+        }
+
+        for (int consulta = 0; consulta < CONSULTAS_POR_RODADA; consulta++)
+        {
+            uint32_t a = (uint32_t)sortear(&estado, numSalas);
+            uint32_t b = (uint32_t)sortear(&estado, numSalas);
+            if (sortear(&estado, 4) == 0)
+            {
+                b = pais[a] != SEM_SALA ? pais[a] : a; // Uma sala e o próprio pai
+            }
+            uint32_t comum = ancestralIngenuo(pais, profundidades, a, b);
+            if (ancestralComum(&indice, a, b) != comum ||
+                distanciaEntreSalas(&indice, a, b) != profundidades[a] + profundidades[b] - 2 * profundidades[comum])
+            {
+                falhar("rodada %d (janela %u): ancestral comum de %u e %u errado", rodada, janela, a, b);
+            }
+
+            uint32_t profundidade = (uint32_t)sortear(&estado, (unsigned long long)profundidades[a] + 1);
+            uint32_t ancestral = a;
+            while (profundidades[ancestral] > profundidade)
+            {
+                ancestral = pais[ancestral];
+            }
+            if (salaAncestral(&indice, a, profundidade) != ancestral)
+            {
+                falhar("rodada %d (janela %u): ancestral de %u na profundidade %u errado", rodada, janela, a, profundidade);
+            }
+
+            // Nome: a sala achada tem o nome e é a mais rasa (entre as de mesma
+            // profundidade, qualquer uma serve)
+            snprintf(texto, sizeof(texto), "Sala %llu", sortear(&estado, variedade + 2));
+            int id = buscarString(&dicionario, texto, NULL);
+            uint32_t sala = buscarSalaPorNome(&indice, texto);
+            int existe = id >= 0 && maisRasa[id] != SEM_SALA;
+            if ((sala != SEM_SALA) != existe ||
+                (existe && (mansao.salas[sala].nome != (uint32_t)id || profundidades[sala] != profundidades[maisRasa[id]])))
+            {
+                falhar("rodada %d: sala do nome '%s' errada", rodada, texto);
+            }
+        }
+        if (buscarSalaPorNome(&indice, "Texto que não é nome de sala") != SEM_SALA ||
+            buscarSalaPorNome(&indice, "Nunca internado") != SEM_SALA)
+        {
+            falhar("rodada %d: um texto que não é nome achou uma sala", rodada);
+        }
+
+        // Teleporte e volta no jogo: a sessão vai para a sala do nome (ou para o pai) e a
+        // saída informa os passos do caminho normal
+        Sessao sessao;
+        iniciarSessao(&sessao, &mansao);
+        for (int jogada = 0; jogada < 20; jogada++)
+        {
+            if (ehFolha(&mansao, sessao.salaAtual))
+            {
+                sessao.salaAtual = mansao.raiz; // Em uma folha o próximo comando encerraria o jogo
+            }
+            uint32_t de = sessao.salaAtual;
+            if (sortear(&estado, 4) == 0)
+            {
+                jogar(&sessao, &mansao, "v", entrada, arquivoSaida, &saida, obtido, capacidadeTexto);
+                if (sessao.salaAtual != (pais[de] != SEM_SALA ? pais[de] : de))
+                {
+                    falhar("rodada %d: 'v' na sala %u foi para %u", rodada, de, sessao.salaAtual);
+                }
+                continue;
+            }
+            uint32_t alvo = (uint32_t)sortear(&estado, numSalas);
+            const char *nome = textoDe(&dicionario, mansao.salas[alvo].nome);
+            snprintf(texto, sizeof(texto), "t %s", nome);
+            const char *saidaObtida =
+                jogar(&sessao, &mansao, texto, entrada, arquivoSaida, &saida, obtido, capacidadeTexto);
+            uint32_t destino = sessao.salaAtual;
+            uint32_t comum = ancestralIngenuo(pais, profundidades, de, destino);
+            snprintf(esperado, sizeof(esperado), "✨ Teleporte para '%s' (%u passo(s) pelo caminho normal).", nome,
+                     profundidades[de] + profundidades[destino] - 2 * profundidades[comum]);
+            if (mansao.salas[destino].nome != mansao.salas[alvo].nome ||
+                profundidades[destino] != profundidades[maisRasa[mansao.salas[alvo].nome]] ||
+                strstr(saidaObtida, esperado) == NULL)
+            {
+                falhar("rodada %d: teleporte de %u para '%s' foi para %u\n%s", rodada, de, nome, destino, saidaObtida);
+            }
+            teleportes++;
+        }
+        liberarSessao(&sessao);
+
+        liberarIndiceSalas(&indice);
+        free(pais);
+        free(profundidades);
+        free(pilha);
+        free(maisRasa);
+        liberarMansao(&mansao);
+        liberarDicionario(&dicionario);
+    }
+    liberarSaida(&saida);
+    fclose(entrada);
+    fclose(arquivoSaida);
+    free(obtido);
+    printf("teste-nomes: %d rodadas, %ld teleportes ok\n", RODADAS_NOMES, teleportes);
+    return EXIT_SUCCESS;
+}
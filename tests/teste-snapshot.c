@@ -0,0 +1,199 @@
+/**
+ * @file teste-snapshot.c
+ * @brief Teste do snapshot da sessão: sessões com caminhadas aleatórias são gravadas
+ * (serializarSessao) e restauradas (restaurarSessao) em outra sessão, que precisa ficar
+ * igual. Snapshots truncados, corrompidos ou de outro mapa precisam ser recusados com a
+ * sessão de volta à raiz, sem pistas.
+ */
+#include "apoio.h"
+#include <stddef.h>
+
+#define RODADAS_SNAPSHOT 300
+
+/**
+ * @brief Retorna 1 se as duas sessões têm o mesmo progresso: mesma sala, mesmas coletas
+ * na mesma ordem, mesmo diário, mesmas evidências e mesmas citações.
+ */
+int mesmaSessao(const Sessao *a, const Sessao *b, int *idsA, int *idsB)
+{
+    if (a->salaAtual != b->salaAtual || a->comandos != b->comandos || a->numColetadas != b->numColetadas ||
+        a->evidencias.quantidade != b->evidencias.quantidade)
+    {
+        return 0;
+    }
+    for (int i = 0; i < a->numColetadas; i++)
+    {
+        if (a->salasColetadas[i] != b->salasColetadas[i])
+        {
+            return 0;
+        }
+    }
+    for (int i = 0; i < a->mansao->dicionario->suspeitos.quantidade; i++)
+    {
+        if (citacoesDe(&a->placar, i) != citacoesDe(&b->placar, i))
+        {
+            return 0;
+        }
+    }
+    int quantas = pistasEmOrdem(a->pistasRaiz, idsA, 0);
+    if (quantas != pistasEmOrdem(b->pistasRaiz, idsB, 0))
+    {
+        return 0;
+    }
+    return memcmp(idsA, idsB, sizeof(int) * (size_t)quantas) == 0;
+}
+
+/**
+ * @brief Retorna 1 se a sessão está vazia, na raiz (como fica depois de um snapshot recusado).
+ */
+int sessaoVazia(const Sessao *sessao)
+{
+    return sessao->numColetadas == 0 && sessao->evidencias.quantidade == 0 && sessao->pistasRaiz == NULL &&
+           sessao->salaAtual == sessao->mansao->raiz;
+}
+
+/**
+ * @brief Preenche as pistas e suspeitos da mansão de teste. 'prefixo' separa os textos
+ * de duas mansões com a mesma forma.
+ */
+void preencherMansao(Mansao *mansao, const char *prefixo, unsigned long long numSuspeitos, unsigned long long *estado)
+{
+    char texto[64];
+    for (uint32_t i = 0; i < mansao->numSalas; i++)
+    {
+        SalaCompilada *sala = &mansao->salasProprias[i];
+        if (sortear(estado, 5) != 0)
+        {
+            snprintf(texto, sizeof(texto), "%sPista %llu", prefixo, sortear(estado, mansao->numSalas));
+            sala->pista = (uint32_t)internar(mansao->dicionario, texto);
+        }
+        snprintf(texto, sizeof(texto), "S%llu", sortear(estado, numSuspeitos));
+        sala->suspeito = (uint32_t)internar(mansao->dicionario, texto);
+    }
+    registrarSuspeitosDoMapa(mansao);
+}
+
+int main()
+{
+    unsigned long long estado = SEMENTE_TESTES;
+    long recusados = 0;
+
+    for (int rodada = 0; rodada < RODADAS_SNAPSHOT; rodada++)
+    {
+        uint32_t numSalas = 1 + (uint32_t)sortear(&estado, rodada < RODADAS_SNAPSHOT - 30 ? 300 : 20000);
+        unsigned long long numSuspeitos = 1 + sortear(&estado, 30);
+        Dicionario dicionario, dicionarioDaOutra;
+        iniciarDicionario(&dicionario);
+        iniciarDicionario(&dicionarioDaOutra);
+        Mansao mansao, outra;
+        montarMansaoDeTeste(&mansao, &dicionario, numSalas);
+        montarMansaoDeTeste(&outra, &dicionarioDaOutra, numSalas);
+        preencherMansao(&mansao, "", numSuspeitos, &estado);
+        preencherMansao(&outra, "Outra ", numSuspeitos, &estado);
+
+        int *idsA = (int *)malloc(sizeof(int) * numSalas);
+        int *idsB = (int *)malloc(sizeof(int) * numSalas);
+        if (idsA == NULL || idsB == NULL)
+        {
+            perror("Erro ao alocar memória para o teste");
+            exit(EXIT_FAILURE);
+        }
+
+        // Caminhadas aleatórias da raiz até uma folha, às vezes recomeçando a investigação
+        Sessao original, restaurada, estrangeira;
+        iniciarSessao(&original, &mansao);
+        iniciarSessao(&restaurada, &mansao);
+        iniciarSessao(&estrangeira, &outra);
+        long passos = (long)sortear(&estado, 4 * (unsigned long long)numSalas + 1);
+        for (long p = 0; p < passos; p++)
+        {
+            if (sortear(&estado, 50) == 0)
+            {
+                reiniciarSessao(&original);
+            }
+            else if (aplicarComando(&original, sortear(&estado, 2) ? 'e' : 'd'))
+            {
+                original.salaAtual = mansao.raiz; // Folha: volta à raiz sem perder as pistas
+            }
+        }
+
+        size_t tamanho = tamanhoSnapshot(&original);
+        unsigned char *dados = (unsigned char *)malloc(tamanho);
+        if (dados == NULL)
+        {
+            perror("Erro ao alocar memória para o teste");
+            exit(EXIT_FAILURE);
+        }
+        if (serializarSessao(&original, dados, tamanho - 1) != 0 || serializarSessao(&original, dados, tamanho) != tamanho)
+        {
+            falhar("rodada %d: serializarSessao com capacidade errada", rodada);
+        }
+
+        // A sessão que recebe o snapshot já tem progresso próprio: a restauração descarta tudo
+        coletarPistaDe(&restaurada, (uint32_t)sortear(&estado, numSalas));
+        restaurada.salaAtual = (uint32_t)sortear(&estado, numSalas);
+        if (!restaurarSessao(&restaurada, dados, tamanho) || !mesmaSessao(&original, &restaurada, idsA, idsB))
+        {
+            falhar("rodada %d: snapshot de %d coletas restaurado diferente", rodada, original.numColetadas);
+        }
+
+        // Truncado: sempre recusado
+        if (restaurarSessao(&restaurada, dados, tamanho - 1 - sortear(&estado, tamanho)) || !sessaoVazia(&restaurada))
+        {
+            falhar("rodada %d: snapshot truncado foi aceito", rodada);
+        }
+
+        // Outro mapa com a mesma forma: as pistas coletadas não conferem
+        if (original.numColetadas > 0)
+        {
+            coletarPistaDe(&estrangeira, 0);
+            if (restaurarSessao(&estrangeira, dados, tamanho) || !sessaoVazia(&estrangeira))
+            {
+                falhar("rodada %d: snapshot de outro mapa foi aceito", rodada);
+            }
+        }
+
+        // Assinatura, versão e número de salas trocados: sempre recusado
+        size_t campos[] = {offsetof(CabecalhoSessao, assinatura), offsetof(CabecalhoSessao, versao),
+                           offsetof(CabecalhoSessao, numSalas)};
+        for (size_t c = 0; c < sizeof(campos) / sizeof(campos[0]); c++)
+        {
+            dados[campos[c]] ^= 0x10;
+            if (restaurarSessao(&restaurada, dados, tamanho) || !sessaoVazia(&restaurada))
+            {
+                falhar("rodada %d: snapshot com cabeçalho trocado (byte %zu) foi aceito", rodada, campos[c]);
+            }
+            dados[campos[c]] ^= 0x10;
+        }
+
+        // Um bit qualquer trocado: recusado, ou aceito só se a troca cair onde não muda a
+        // sessão reconstruída (ex.: uma sala com a mesma pista e o mesmo suspeito)
+        size_t posicao = (size_t)sortear(&estado, tamanho);
+        dados[posicao] ^= (unsigned char)(1u << sortear(&estado, 8));
+        if (!restaurarSessao(&restaurada, dados, tamanho))
+        {
+            if (!sessaoVazia(&restaurada))
+            {
+                falhar("rodada %d: snapshot recusado deixou a sessão com estado", rodada);
+            }
+            recusados++;
+        }
+        else if (restaurada.evidencias.quantidade != original.evidencias.quantidade)
+        {
+            falhar("rodada %d: snapshot corrompido (byte %zu) aceito com outras evidências", rodada, posicao);
+        }
+
+        free(dados);
+        free(idsA);
+        free(idsB);
+        liberarSessao(&original);
+        liberarSessao(&restaurada);
+        liberarSessao(&estrangeira);
+        liberarMansao(&mansao);
+        liberarMansao(&outra);
+        liberarDicionario(&dicionario);
+        liberarDicionario(&dicionarioDaOutra);
+    }
+    printf("teste-snapshot: %d rodadas ok (%ld snapshots corrompidos recusados)\n", RODADAS_SNAPSHOT, recusados);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,175 @@
+/**
+ * @file teste-trigramas.c
+ * @brief Teste da busca por trecho com o índice de trigramas: em sessões que coletam
+ * pistas aos poucos (e recomeçam), cada busca é comparada com uma varredura de todas as
+ * evidências usando strstr sobre cópias em minúsculo (inclusive as letras acentuadas).
+ */
+#include "apoio.h"
+
+#define RODADAS_TRIGRAMAS 60
+#define MAXIMO_ENCONTRADAS 64
+
+// Palavras das pistas: maiúsculas, repetições e bytes fora do ASCII (UTF-8), com letras
+// acentuadas nas duas caixas e caracteres de dois e três bytes que não têm caixa
+const char *palavrasDeTeste[] = {"Faca", "de", "prata", "PEGADAS", "barro", "veneno", "Veneno", "luva",
+                                 "seda", "ção", "é", "Chave", "enferrujada", "aaa", "aaaa", "x",
+                                 "ESCRITÓRIO", "escritório", "AÇÃO", "Época", "×", "÷", "“aspas”", "ÿ"};
+#define NUM_PALAVRAS_TESTE (int)(sizeof(palavrasDeTeste) / sizeof(palavrasDeTeste[0]))
+
+/**
+ * @brief Cópia do texto em minúsculo: ASCII e as maiúsculas acentuadas do Latin-1 em
+ * UTF-8 (0xC3 0x80..0x9E, menos o × em 0xC3 0x97), que ganham 0x20 no segundo byte.
+ */
+void copiarEmMinusculo(char *destino, const char *texto)
+{
+    unsigned char anterior = 0;
+    for (; *texto != '\0'; texto++, destino++)
+    {
+        unsigned char c = (unsigned char)*texto;
+        int acentuada = anterior == 0xC3 && c >= 0x80 && c <= 0x9E && c != 0x97;
+        *destino = acentuada ? (char)(c + 0x20) : (char)tolower(c);
+        anterior = c;
+    }
+    *destino = '\0';
+}
+
+/**
+ * @brief Troca a caixa do caractere que começa em texto[i] (ASCII ou letra acentuada do
+ * Latin-1) e retorna quantos bytes ele tem.
+ */
+size_t trocarCaixa(char *texto, size_t i)
+{
+    unsigned char c = (unsigned char)texto[i];
+    if (c == 0xC3 && texto[i + 1] != '\0')
+    {
+        unsigned char segundo = (unsigned char)texto[i + 1];
+        if (segundo != 0x97 && segundo != 0xB7 && segundo >= 0x80 && segundo <= 0xBE)
+        {
+            texto[i + 1] = (char)(segundo ^ 0x20);
+        }
+        return 2;
+    }
+    texto[i] = (char)(islower(c) ? toupper(c) : tolower(c));
+    return 1;
+}
+
+/**
+ * @brief Monta um trecho de busca: um pedaço de uma pista da mansão com letras trocadas
+ * de caixa, ou um texto curto qualquer (que pode não estar em pista nenhuma).
+ */
+void sortearTrecho(const Mansao *mansao, unsigned long long *estado, char *trecho, size_t capacidade)
+{
+    const char *texto = textoDe(mansao->dicionario, mansao->salas[sortear(estado, mansao->numSalas)].pista);
+    size_t tamanho = strlen(texto);
+    if (tamanho == 0 || sortear(estado, 5) == 0)
+    {
+        size_t quantos = (size_t)sortear(estado, 5);
+        for (size_t i = 0; i < quantos; i++)
+        {
+            trecho[i] = (char)("aAxXé "[sortear(estado, 7)]);
+        }
+        trecho[quantos] = '\0';
+        return;
+    }
+    size_t inicio = (size_t)sortear(estado, tamanho);
+    size_t quantos = (size_t)sortear(estado, 9);
+    if (quantos > tamanho - inicio)
+    {
+        quantos = tamanho - inicio;
+    }
+    if (quantos >= capacidade)
+    {
+        quantos = capacidade - 1;
+    }
+    memcpy(trecho, texto + inicio, quantos);
+    trecho[quantos] = '\0';
+    for (size_t i = 0; i < quantos;)
+    {
+        i += sortear(estado, 2) ? trocarCaixa(trecho, i) : 1;
+    }
+}
+
+int main()
+{
+    unsigned long long estado = SEMENTE_TESTES;
+    char texto[256], trecho[16], trechoMinusculo[16], pistaMinuscula[256];
+    int entradas[MAXIMO_ENCONTRADAS];
+    long buscas = 0, encontradas = 0;
+
+    for (int rodada = 0; rodada < RODADAS_TRIGRAMAS; rodada++)
+    {
+        Dicionario dicionario;
+        iniciarDicionario(&dicionario);
+        Mansao mansao;
+        uint32_t numSalas = 1 + (uint32_t)sortear(&estado, rodada < RODADAS_TRIGRAMAS - 5 ? 400 : 5000);
+        montarMansaoDeTeste(&mansao, &dicionario, numSalas);
+        for (uint32_t i = 0; i < numSalas; i++)
+        {
+            SalaCompilada *sala = &mansao.salasProprias[i];
+            if (sortear(&estado, 8) == 0)
+            {
+                continue; // Sala sem pista
+            }
+            texto[0] = '\0';
+            int palavras = 1 + (int)sortear(&estado, 5);
+            for (int p = 0; p < palavras; p++)
+            {
+                strcat(texto, p ? " " : "");
+                strcat(texto, palavrasDeTeste[sortear(&estado, NUM_PALAVRAS_TESTE)]);
+            }
+            sala->pista = (uint32_t)internar(&dicionario, texto);
+            snprintf(texto, sizeof(texto), "S%llu", sortear(&estado, 6));
+            sala->suspeito = (uint32_t)internar(&dicionario, texto);
+        }
+        congelarDicionario(&mansao);
+
+        Sessao sessao;
+        iniciarSessao(&sessao, &mansao);
+        uint32_t coletas = numSalas * 2;
+        for (uint32_t passo = 0; passo < coletas; passo++)
+        {
+            coletarPistaDe(&sessao, (uint32_t)sortear(&estado, numSalas));
+            if (sortear(&estado, numSalas) == 0)
+            {
+                reiniciarSessao(&sessao); // O índice recomeça com uma nova geração
+            }
+            if (sortear(&estado, 4) != 0)
+            {
+                continue; // Várias coletas entre as buscas: o índice é atualizado aos poucos
+            }
+
+            sortearTrecho(&mansao, &estado, trecho, sizeof(trecho));
+            copiarEmMinusculo(trechoMinusculo, trecho);
+            int capacidade = (int)sortear(&estado, MAXIMO_ENCONTRADAS + 1);
+            int total = buscarPorTrecho(&sessao.trechos, &sessao.evidencias, trecho, entradas, capacidade);
+
+            int esperadas = 0;
+            for (int i = 0; i < sessao.evidencias.quantidade; i++)
+            {
+                copiarEmMinusculo(pistaMinuscula, textoDe(&dicionario, sessao.evidencias.entradas[i].pista));
+                if (strstr(pistaMinuscula, trechoMinusculo) == NULL)
+                {
+                    continue;
+                }
+                if (esperadas < capacidade && entradas[esperadas] != i)
+                {
+                    falhar("rodada %d: '%s' devolveu a evidência %d na posição %d, esperado %d",
+                           rodada, trecho, entradas[esperadas], esperadas, i);
+                }
+                esperadas++;
+            }
+            if (total != esperadas)
+            {
+                falhar("rodada %d: '%s' achou %d evidência(s), esperado %d (de %d)",
+                       rodada, trecho, total, esperadas, sessao.evidencias.quantidade);
+            }
+            buscas++;
+            encontradas += total;
+        }
+        liberarSessao(&sessao);
+        liberarDicionario(&dicionario);
+        liberarMansao(&mansao);
+    }
+    printf("teste-trigramas: %d rodadas, %ld buscas (%ld evidências encontradas) ok\n", RODADAS_TRIGRAMAS, buscas, encontradas);
+    return EXIT_SUCCESS;
+}